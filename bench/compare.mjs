@@ -0,0 +1,74 @@
+// Comparison of two benchmark reports
+// All results are times per operation, so larger values are slower.
+
+function indexResults(report) {
+    const map = new Map();
+    for (const suite of report.suites ?? []) {
+        for (const result of suite.results) {
+            map.set(`${suite.suite}/${result.name}`, result);
+        }
+    }
+    return map;
+}
+
+/**
+ * Compare a report against a baseline
+ * @param baseline Earlier report
+ * @param current New report
+ * @param thresholdPct Slowdown in percent above which a benchmark counts as a regression
+ * @returns Rows of {name, baseline, current, changePct, status} plus the regression count
+ */
+export function compareReports(baseline, current, thresholdPct) {
+    const before = indexResults(baseline);
+    const after = indexResults(current);
+    const rows = [];
+
+    for (const [name, result] of after) {
+        const base = before.get(name);
+        if (!base) {
+            rows.push({ name, baseline: null, current: result.value, changePct: null, status: 'new' });
+            continue;
+        }
+        const changePct = (result.value - base.value) / base.value * 100;
+        let status = 'ok';
+        if (changePct > thresholdPct) status = 'regression';
+        else if (changePct < -thresholdPct) status = 'improvement';
+        rows.push({ name, baseline: base.value, current: result.value, changePct, status });
+    }
+    for (const [name, base] of before) {
+        if (!after.has(name)) {
+            rows.push({ name, baseline: base.value, current: null, changePct: null, status: 'missing' });
+        }
+    }
+
+    const regressions = rows.filter(row => row.status === 'regression').length;
+    return { rows, regressions };
+}
+
+/**
+ * Format a time per operation with a readable unit
+ */
+export function formatNs(ns) {
+    if (ns === null) return '-';
+    if (ns >= 1e6) return `${(ns / 1e6).toFixed(2)} ms`;
+    if (ns >= 1e3) return `${(ns / 1e3).toFixed(2)} µs`;
+    return `${ns.toFixed(1)} ns`;
+}
+
+/**
+ * Print a comparison as a table
+ */
+export function printComparison(comparison, thresholdPct) {
+    console.log(`\nComparison against baseline (threshold ${thresholdPct}%):`);
+    for (const row of comparison.rows) {
+        const change = row.changePct === null ? '' : `${row.changePct >= 0 ? '+' : ''}${row.changePct.toFixed(1)}%`;
+        const mark = row.status === 'regression' ? '✗' : row.status === 'improvement' ? '↑' : ' ';
+        console.log(`  ${mark} ${row.name.padEnd(32)} ${formatNs(row.baseline).padStart(12)} → ` +
+            `${formatNs(row.current).padStart(12)}  ${change.padStart(8)}  ${row.status}`);
+    }
+    if (comparison.regressions > 0) {
+        console.log(`\n${comparison.regressions} benchmark(s) regressed by more than ${thresholdPct}%`);
+    } else {
+        console.log('\nNo regressions');
+    }
+}
@@ -0,0 +1,372 @@
+/**
+ * Microbenchmarks of the native decode and encode pipeline
+ *
+ * Every benchmark runs on the same deterministic synthetic slot, so numbers
+ * are comparable between runs and machines. Results are printed to stdout as
+ * JSON for bench/run.mjs.
+ *
+ * Usage: ft8_bench [--protocol FT8|FT4] [--min-time ms] [--filter text]
+ */
+
+#include "cpu_features.h"
+#include "decoder_core.h"
+#include "decode_stages.h"
+#include "gfsk.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <ft8/message.h>
+#include <ft8/encode.h>
+#include <ft8/constants.h>
+#include <ft8/crc.h>
+}
+
+namespace {
+
+const int SAMPLE_RATE = 12000;
+
+// Messages placed in the synthetic slot, one every 150 Hz from 500 Hz
+const char* const SLOT_MESSAGES[] = {
+    "CQ K1ABC FN42",
+    "K1ABC W9XYZ EN37",
+    "W9XYZ K1ABC -11",
+    "K1ABC W9XYZ R-09",
+    "W9XYZ K1ABC RRR",
+    "CQ DX JA1XYZ PM95",
+    "JA1XYZ VK2ABC QF56",
+    "CQ G4ABC IO91",
+    "G4ABC DL1XYZ JO62",
+    "DL1XYZ G4ABC 73",
+};
+const int NUM_SLOT_MESSAGES = sizeof(SLOT_MESSAGES) / sizeof(SLOT_MESSAGES[0]);
+
+// Keeps results alive so the compiler cannot drop the measured work
+volatile uint64_t g_sink = 0;
+
+struct BenchResult {
+    std::string name;
+    double ns_per_op;
+    uint64_t iterations;
+};
+
+uint64_t NowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Time a function until min_time_ms has passed and report the median of batches
+ *
+ * The batch size is calibrated so each batch takes about a millisecond, which
+ * keeps clock overhead out of the fast kernels.
+ */
+BenchResult Measure(const char* name, double min_time_ms, const std::function<void()>& fn) {
+    // Warm caches and calibrate the batch size
+    fn();
+    uint64_t batch = 1;
+    for (;;) {
+        uint64_t start = NowNs();
+        for (uint64_t i = 0; i < batch; ++i) {
+            fn();
+        }
+        uint64_t elapsed = NowNs() - start;
+        if (elapsed >= 1000000 || batch >= (1u << 24)) {
+            break;
+        }
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    uint64_t iterations = 0;
+    uint64_t budget = (uint64_t)(min_time_ms * 1e6);
+    uint64_t begin = NowNs();
+    while (samples.size() < 5 || NowNs() - begin < budget) {
+        uint64_t start = NowNs();
+        for (uint64_t i = 0; i < batch; ++i) {
+            fn();
+        }
+        samples.push_back((double)(NowNs() - start) / batch);
+        iterations += batch;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return BenchResult{name, samples[samples.size() / 2], iterations};
+}
+
+/**
+ * Encode a message and synthesize it into a slot at the given frequency and amplitude
+ */
+bool AddSignal(ftx_protocol_t protocol, const char* text, float frequency, float amplitude, std::vector<float>* slot) {
+    ftx_message_t message;
+    ftx_message_init(&message);
+    if (ftx_message_encode(&message, nullptr, text) != FTX_MESSAGE_RC_OK) {
+        return false;
+    }
+
+    bool ft8 = (protocol == FTX_PROTOCOL_FT8);
+    int num_tones = ft8 ? FT8_NN : FT4_NN;
+    uint8_t tones[FT8_NN > FT4_NN ? FT8_NN : FT4_NN];
+    if (ft8) {
+        ft8_encode(message.payload, tones);
+    } else {
+        ft4_encode(message.payload, tones);
+    }
+
+    float symbol_period = ft8 ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+    int num_samples = (int)(0.5f + num_tones * symbol_period * SAMPLE_RATE);
+    std::vector<float> signal(num_samples);
+    GenerateGfskSignal(tones, num_tones, frequency, ft8 ? FT8_SYMBOL_BT : FT4_SYMBOL_BT,
+                       symbol_period, SAMPLE_RATE, signal.data());
+
+    // Start half a second into the slot like a real transmission
+    int start = SAMPLE_RATE / 2;
+    for (int i = 0; i < num_samples && start + i < (int)slot->size(); ++i) {
+        (*slot)[start + i] += amplitude * signal[i];
+    }
+    return true;
+}
+
+/**
+ * A slot of ten signals at -10 dB SNR in 2500 Hz of white noise
+ */
+std::vector<float> SynthesizeSlot(ftx_protocol_t protocol) {
+    float slot_time = (protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+    std::vector<float> slot((size_t)(slot_time * SAMPLE_RATE), 0.0f);
+
+    float noise_rms = 0.03f;
+    float snr_db = -10.0f;
+    // SNR is referenced to 2500 Hz of noise bandwidth, the signal is a unit-amplitude sine
+    float amplitude = std::sqrt(2.0f) * noise_rms * std::sqrt(2500.0f / (SAMPLE_RATE / 2.0f)) *
+                      std::pow(10.0f, snr_db / 20.0f);
+
+    for (int i = 0; i < NUM_SLOT_MESSAGES; ++i) {
+        AddSignal(protocol, SLOT_MESSAGES[i], 500.0f + 150.0f * i, amplitude, &slot);
+    }
+
+    std::mt19937 rng(12345);
+    std::normal_distribution<float> noise(0.0f, noise_rms);
+    for (float& sample : slot) {
+        sample += noise(rng);
+    }
+    return slot;
+}
+
+// Hash callbacks for the message benchmarks; nothing is remembered between calls
+bool NoHashLookup(ftx_callsign_hash_type_t hash_type, uint32_t hash, char* callsign) {
+    return false;
+}
+
+void NoHashSave(const char* callsign, uint32_t hash) {
+}
+
+void PrintJsonString(const std::string& text) {
+    putchar('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            putchar('\\');
+        }
+        putchar(c);
+    }
+    putchar('"');
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ftx_protocol_t protocol = FTX_PROTOCOL_FT8;
+    double min_time_ms = 300;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--protocol" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "FT8") {
+                protocol = FTX_PROTOCOL_FT8;
+            } else if (value == "FT4") {
+                protocol = FTX_PROTOCOL_FT4;
+            } else {
+                fprintf(stderr, "Unknown protocol: %s\n", value.c_str());
+                return 2;
+            }
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time_ms = atof(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--protocol FT8|FT4] [--min-time ms] [--filter text]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ft8 = (protocol == FTX_PROTOCOL_FT8);
+    std::vector<float> slot = SynthesizeSlot(protocol);
+
+    DecoderConfig config;
+    config.protocol = protocol;
+    DecoderCore core(config);
+
+    // Fixtures shared by the stage benchmarks
+    core.ProcessAudio(slot.data(), (int)slot.size(), SAMPLE_RATE);
+    std::vector<ftx_candidate_t> candidates;
+    core.FindCandidates(&candidates);
+    std::vector<DecodeResult> decoded;
+    core.Decode(&decoded);
+    if (candidates.empty() || decoded.empty()) {
+        fprintf(stderr, "Synthetic slot did not decode (%zu candidates, %zu messages)\n",
+                candidates.size(), decoded.size());
+        return 1;
+    }
+
+    // A candidate that decodes, and its intermediate results, for the stage benchmarks
+    const ftx_waterfall_t* wf = core.Waterfall();
+    ftx_candidate_t good = decoded[0].candidate;
+    float log174[FTX_LDPC_N];
+    ExtractLikelihood(wf, &good, log174);
+    uint8_t plain174[FTX_LDPC_N];
+    int iterations = 0;
+    DecodeLdpc(log174, config.max_ldpc_iterations, plain174, &iterations);
+
+    ftx_message_t message = decoded[0].message;
+    uint8_t a91[FTX_LDPC_K_BYTES] = {0};
+    memcpy(a91, message.payload, FTX_PAYLOAD_LENGTH_BYTES);
+
+    int num_tones = ft8 ? FT8_NN : FT4_NN;
+    float symbol_period = ft8 ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+    uint8_t tones[FT8_NN > FT4_NN ? FT8_NN : FT4_NN];
+    if (ft8) {
+        ft8_encode(message.payload, tones);
+    } else {
+        ft4_encode(message.payload, tones);
+    }
+    std::vector<float> signal((size_t)(0.5f + num_tones * symbol_period * SAMPLE_RATE));
+
+    // 100 Hz around the first decoded message, as an auto-sequencer would search
+    FocusRegion focus;
+    focus.freq_min = decoded[0].frequency - 50.0f;
+    focus.freq_max = decoded[0].frequency + 50.0f;
+    focus.time_min = -10 * symbol_period;
+    focus.time_max = 19 * symbol_period;
+    focus.min_score = config.min_score / 2;
+    focus.max_candidates = 20;
+    focus.max_ldpc_iterations = config.max_ldpc_iterations * 2;
+
+    ftx_callsign_hash_interface_t hash_if;
+    hash_if.lookup_hash = NoHashLookup;
+    hash_if.save_hash = NoHashSave;
+
+    struct Benchmark {
+        const char* name;
+        std::function<void()> fn;
+    };
+
+    const std::vector<Benchmark> benchmarks = {
+        {"monitor.slot", [&]() {
+            core.ProcessAudio(slot.data(), (int)slot.size(), SAMPLE_RATE);
+            g_sink = g_sink + core.NumBlocks();
+        }},
+        {"candidates.find", [&]() {
+            core.FindCandidates(&candidates);
+            g_sink = g_sink + candidates.size();
+        }},
+        {"likelihood.extract", [&]() {
+            ExtractLikelihood(wf, &good, log174);
+            g_sink = g_sink + (log174[0] > 0);
+        }},
+        {"ldpc.decode", [&]() {
+            int iters = 0;
+            g_sink = g_sink + DecodeLdpc(log174, config.max_ldpc_iterations, plain174, &iters) + iters;
+        }},
+        {"ldpc.decodeMinSum", [&]() {
+            int iters = 0;
+            g_sink = g_sink + DecodeLdpc(log174, config.max_ldpc_iterations, plain174, &iters, LDPC_ENGINE_MIN_SUM) + iters;
+        }},
+        {"crc.compute", [&]() {
+            g_sink = g_sink + ftx_compute_crc(a91, 96 - 14);
+        }},
+        {"message.pack", [&]() {
+            ftx_message_t packed;
+            ftx_message_init(&packed);
+            ftx_message_encode(&packed, &hash_if, SLOT_MESSAGES[1]);
+            g_sink = g_sink + packed.payload[0];
+        }},
+        {"message.unpack", [&]() {
+            char text[FTX_MAX_MESSAGE_LENGTH];
+            ftx_message_decode(&message, &hash_if, text);
+            g_sink = g_sink + (uint8_t)text[0];
+        }},
+        {"tones.encode", [&]() {
+            if (ft8) {
+                ft8_encode(message.payload, tones);
+            } else {
+                ft4_encode(message.payload, tones);
+            }
+            g_sink = g_sink + tones[num_tones - 1];
+        }},
+        {"gfsk.synthesize", [&]() {
+            GenerateGfskSignal(tones, num_tones, 1000.0f, ft8 ? FT8_SYMBOL_BT : FT4_SYMBOL_BT,
+                               symbol_period, SAMPLE_RATE, signal.data());
+            g_sink = g_sink + (signal[signal.size() / 2] > 0);
+        }},
+        {"decode.slot", [&]() {
+            // Candidate search plus decoding of every candidate on a ready waterfall
+            core.InvalidateLikelihoods();
+            decoded.clear();
+            core.Decode(&decoded);
+            g_sink = g_sink + decoded.size();
+        }},
+        {"decode.focused", [&]() {
+            decoded.clear();
+            core.DecodeFocused(focus, &decoded);
+            g_sink = g_sink + decoded.size();
+        }},
+        {"decode.endToEnd", [&]() {
+            core.ProcessAudio(slot.data(), (int)slot.size(), SAMPLE_RATE);
+            decoded.clear();
+            core.Decode(&decoded);
+            g_sink = g_sink + decoded.size();
+        }},
+    };
+
+    std::vector<BenchResult> results;
+    for (const Benchmark& benchmark : benchmarks) {
+        if (!filter.empty() && std::string(benchmark.name).find(filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(Measure(benchmark.name, min_time_ms, benchmark.fn));
+        // The stage fixtures expect the waterfall of the synthetic slot
+        core.ProcessAudio(slot.data(), (int)slot.size(), SAMPLE_RATE);
+    }
+
+    printf("{\"suite\":\"native\",\"meta\":{\"protocol\":\"%s\",\"sampleRate\":%d,\"signals\":%d,"
+           "\"decoded\":%zu,\"minTimeMs\":%g,\"kernels\":\"%s\",\"compiler\":",
+           ft8 ? "FT8" : "FT4", SAMPLE_RATE, NUM_SLOT_MESSAGES, decoded.size(), min_time_ms,
+           KernelIsaName(ActiveKernelIsa()));
+#if defined(__VERSION__)
+    PrintJsonString(__VERSION__);
+#elif defined(_MSC_FULL_VER)
+    PrintJsonString("MSVC " + std::to_string(_MSC_FULL_VER));
+#else
+    PrintJsonString("unknown");
+#endif
+    printf("},\"results\":[");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        printf("%s\n{\"name\":", i ? "," : "");
+        PrintJsonString(result.name);
+        printf(",\"unit\":\"ns/op\",\"value\":%.3f,\"iterations\":%llu,\"opsPerSec\":%.3f}",
+               result.ns_per_op, (unsigned long long)result.iterations, 1e9 / result.ns_per_op);
+    }
+    printf("\n]}\n");
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Node-level throughput benchmarks of the public API
+// Every input is synthesized from a fixed seed, so runs are comparable.
+
+import { MessageEncoder, MessageDecoder, Utils } from '../index.mjs';
+
+const MESSAGES = [
+    "CQ K1ABC FN42",
+    "K1ABC W9XYZ EN37",
+    "W9XYZ K1ABC -11",
+    "K1ABC W9XYZ R-09",
+    "W9XYZ K1ABC RRR",
+    "CQ DX JA1XYZ PM95",
+    "JA1XYZ VK2ABC QF56",
+    "CQ G4ABC IO91",
+    "G4ABC DL1XYZ JO62",
+    "DL1XYZ G4ABC 73"
+];
+
+function bandOptions(protocol) {
+    return {
+        protocol,
+        signals: MESSAGES.map((text, i) => ({ text, frequency: 500 + 150 * i, timeOffset: 0.5, snr: -10 })),
+        seed: 12345
+    };
+}
+
+/**
+ * Run fn repeatedly for at least minTimeMs and return the median time per call
+ */
+function measure(name, minTimeMs, fn) {
+    // Warm up, and size batches to about a millisecond so fast calls are not dominated by the clock
+    fn();
+    let batch = 1;
+    for (;;) {
+        const start = process.hrtime.bigint();
+        for (let i = 0; i < batch; i++) fn();
+        const elapsed = Number(process.hrtime.bigint() - start);
+        if (elapsed >= 1e6 || batch >= 1 << 20) break;
+        batch *= 2;
+    }
+
+    const samples = [];
+    let iterations = 0;
+    const begin = process.hrtime.bigint();
+    while (samples.length < 5 || Number(process.hrtime.bigint() - begin) < minTimeMs * 1e6) {
+        const start = process.hrtime.bigint();
+        for (let i = 0; i < batch; i++) fn();
+        samples.push(Number(process.hrtime.bigint() - start) / batch);
+        iterations += batch;
+    }
+
+    samples.sort((a, b) => a - b);
+    const value = samples[Math.floor(samples.length / 2)];
+    return { name, unit: 'ns/op', value, iterations, opsPerSec: 1e9 / value };
+}
+
+/**
+ * Run the Node benchmark suite
+ * @param {{minTimeMs?: number, filter?: string}} options
+ * @returns Suite result in the same layout as the native suite
+ */
+export function runNodeSuite(options = {}) {
+    const minTimeMs = options.minTimeMs ?? 300;
+    const filter = options.filter ?? '';
+
+    const ft8Band = Utils.Audio.synthesizeBand(bandOptions('FT8'));
+    const ft4Band = Utils.Audio.synthesizeBand(bandOptions('FT4'));
+    const ft8Decoder = new MessageDecoder({ protocol: 'FT8' });
+    const ft4Decoder = new MessageDecoder({ protocol: 'FT4' });
+    const multiPassDecoder = new MessageDecoder({ protocol: 'FT8', passes: 3 });
+    const encoder = new MessageEncoder({ protocol: 'FT8' });
+    const batch = Array.from({ length: 1000 }, (_, i) => MESSAGES[i % MESSAGES.length]);
+
+    const spectrumDecoder = new MessageDecoder({ protocol: 'FT8' });
+    spectrumDecoder.decode(ft8Band.audio);
+    const ft8Spectrum = spectrumDecoder.serializeSpectrum();
+
+    const decodedFt8 = ft8Decoder.decode(ft8Band.audio).length;
+    const decodedFt4 = ft4Decoder.decode(ft4Band.audio).length;
+    if (decodedFt8 === 0 || decodedFt4 === 0) {
+        throw new Error(`Synthetic slots did not decode (FT8: ${decodedFt8}, FT4: ${decodedFt4})`);
+    }
+
+    const benchmarks = [
+        ['decode.ft8Slot', () => ft8Decoder.decode(ft8Band.audio)],
+        ['decode.ft4Slot', () => ft4Decoder.decode(ft4Band.audio)],
+        ['decode.ft8Passes3', () => multiPassDecoder.decode(ft8Band.audio)],
+        // Everything after the FFT: candidate search, LDPC and unpacking of a stored spectrum
+        ['decode.ft8Spectrum', () => {
+            spectrumDecoder.loadSpectrum(ft8Spectrum);
+            return spectrumDecoder.decode(null);
+        }],
+        ['decodeFocused.ft8', () => ft8Decoder.decodeFocused(ft8Band.audio, { centerHz: ft8Band.signals[0].frequency })],
+        ['encodeToAudio.ft8', () => encoder.encodeToAudio(MESSAGES[0])],
+        ['encodeBatch.1000', () => encoder.encodeBatch(batch)],
+        ['synthesizeBand.ft8', () => Utils.Audio.synthesizeBand(bandOptions('FT8'))]
+    ];
+
+    const results = [];
+    for (const [name, fn] of benchmarks) {
+        if (filter && !name.includes(filter)) continue;
+        results.push(measure(name, minTimeMs, fn));
+    }
+
+    return {
+        suite: 'node',
+        meta: { node: process.version, kernels: Utils.getCpuFeatures().kernels, signals: MESSAGES.length, decodedFt8, decodedFt4, minTimeMs },
+        results
+    };
+}
@@ -0,0 +1,145 @@
+#!/usr/bin/env node
+// Benchmark runner: native microbenchmarks plus Node-level throughput
+//
+// Usage: node bench/run.mjs [options]
+//   --native-only / --node-only   Run one suite
+//   --protocol FT8|FT4            Protocol of the native suite (default: FT8)
+//   --min-time <ms>               Minimum measuring time per benchmark (default: 300)
+//   --filter <text>               Only run benchmarks whose name contains text
+//   --out <file>                  Write the JSON report to a file
+//   --compare <file>              Compare against a baseline report; exits 1 on regressions
+//   --threshold <pct>             Slowdown that counts as a regression (default: 10)
+//   --rebuild                     Rebuild the native benchmark binary first
+
+import { spawnSync } from 'child_process';
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { compareReports, printComparison, formatNs } from './compare.mjs';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const ROOT = path.resolve(__dirname, '..');
+const BENCH_BINARY = path.join(ROOT, 'build', 'Release', process.platform === 'win32' ? 'ft8_bench.exe' : 'ft8_bench');
+
+function parseArgs(argv) {
+    const options = {
+        native: true,
+        node: true,
+        protocol: 'FT8',
+        minTimeMs: 300,
+        filter: '',
+        out: null,
+        compare: null,
+        threshold: 10,
+        rebuild: false
+    };
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        const value = () => {
+            if (i + 1 >= argv.length) throw new Error(`Missing value for ${arg}`);
+            return argv[++i];
+        };
+        switch (arg) {
+            case '--native-only': options.node = false; break;
+            case '--node-only': options.native = false; break;
+            case '--protocol': options.protocol = value(); break;
+            case '--min-time': options.minTimeMs = Number(value()); break;
+            case '--filter': options.filter = value(); break;
+            case '--out': options.out = value(); break;
+            case '--compare': options.compare = value(); break;
+            case '--threshold': options.threshold = Number(value()); break;
+            case '--rebuild': options.rebuild = true; break;
+            default: throw new Error(`Unknown option: ${arg}`);
+        }
+    }
+    return options;
+}
+
+/**
+ * Build the ft8_bench target; it is only part of the gyp project when build_bench is set
+ */
+function buildNativeBench() {
+    console.log('Building native benchmark (GYP_DEFINES=build_bench=true)...');
+    const env = { ...process.env, GYP_DEFINES: `${process.env.GYP_DEFINES ?? ''} build_bench=true`.trim() };
+    const result = spawnSync('npx', ['node-pre-gyp', 'configure', 'build'], {
+        cwd: ROOT,
+        env,
+        stdio: 'inherit',
+        shell: process.platform === 'win32'
+    });
+    if (result.status !== 0 || !fs.existsSync(BENCH_BINARY)) {
+        throw new Error('Failed to build the native benchmark');
+    }
+}
+
+function runNativeSuite(options) {
+    if (options.rebuild || !fs.existsSync(BENCH_BINARY)) {
+        buildNativeBench();
+    }
+
+    const args = ['--protocol', options.protocol, '--min-time', String(options.minTimeMs)];
+    if (options.filter) args.push('--filter', options.filter);
+
+    const result = spawnSync(BENCH_BINARY, args, { encoding: 'utf8', stdio: ['ignore', 'pipe', 'inherit'] });
+    if (result.status !== 0) {
+        throw new Error(`Native benchmark exited with status ${result.status}`);
+    }
+    return JSON.parse(result.stdout);
+}
+
+function printSuite(suite) {
+    console.log(`\n${suite.suite} suite:`);
+    for (const result of suite.results) {
+        console.log(`  ${result.name.padEnd(24)} ${formatNs(result.value).padStart(12)}/op ` +
+            `${result.opsPerSec.toFixed(1).padStart(14)} ops/s`);
+    }
+}
+
+async function main() {
+    const options = parseArgs(process.argv.slice(2));
+    const report = {
+        timestamp: new Date().toISOString(),
+        host: {
+            platform: process.platform,
+            arch: process.arch,
+            cpu: os.cpus()[0]?.model ?? 'unknown',
+            cpus: os.cpus().length,
+            node: process.version
+        },
+        suites: []
+    };
+
+    if (options.native) {
+        const suite = runNativeSuite(options);
+        printSuite(suite);
+        report.suites.push(suite);
+    }
+
+    if (options.node) {
+        // Loaded lazily so the native suite runs without a built addon
+        const { runNodeSuite } = await import('./node.mjs');
+        const suite = runNodeSuite({ minTimeMs: options.minTimeMs, filter: options.filter });
+        printSuite(suite);
+        report.suites.push(suite);
+    }
+
+    if (options.out) {
+        fs.writeFileSync(options.out, JSON.stringify(report, null, 2) + '\n');
+        console.log(`\nReport written to ${options.out}`);
+    }
+
+    if (options.compare) {
+        const baseline = JSON.parse(fs.readFileSync(options.compare, 'utf8'));
+        const comparison = compareReports(baseline, report, options.threshold);
+        printComparison(comparison, options.threshold);
+        if (comparison.regressions > 0) {
+            process.exitCode = 1;
+        }
+    }
+}
+
+main().catch(error => {
+    console.error(`Benchmark failed: ${error.message}`);
+    process.exitCode = 2;
+});
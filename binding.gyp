@@ -1,4 +1,10 @@
 {
+  "variables": {
+    # Set to true (GYP_DEFINES="build_bench=true") to also build the ft8_bench microbenchmark
+    "build_bench%": "false",
+    # Set to true (GYP_DEFINES="build_cli=true") to also build the ft8decode command line decoder
+    "build_cli%": "false"
+  },
   "targets": [
     {
       "target_name": "ft8_lib",
@@ -8,6 +14,27 @@
         "src/encoder_wrapper.cpp",
         "src/decoder_wrapper.cpp",
         "src/audio_utils.cpp",
+        "src/wav_file.cpp",
+        "src/wav_reader.cpp",
+        "src/decoder_core.cpp",
+        "src/decode_stages.cpp",
+        "src/decode_stats.cpp",
+        "src/pcm_convert.cpp",
+        "src/ring_receiver.cpp",
+        "src/slot_scheduler.cpp",
+        "src/trace.cpp",
+        "src/trace_utils.cpp",
+        "src/gfsk.cpp",
+        "src/decoder_tuner.cpp",
+        "src/load_controller.cpp",
+        "src/waterfall_history.cpp",
+        "src/spectrum_file.cpp",
+        "src/message_pack.cpp",
+        "src/cpu_features.cpp",
+        "src/monitor_kernels.cpp",
+        "src/decoder_options.cpp",
+        "src/slot_pool.cpp",
+        "src/callsign_hash.cpp",
         "ft8_lib/ft8/constants.c",
         "ft8_lib/ft8/crc.c",
         "ft8_lib/ft8/decode.c",
@@ -33,6 +60,15 @@
       ],
       "libraries": [],
       "conditions": [
+        ["target_arch=='x64' and OS!='win'", {
+          "dependencies": [
+            "ft8_monitor_avx2",
+            "ft8_monitor_avx512"
+          ],
+          "defines": [
+            "FT8_LIB_MONITOR_VARIANTS"
+          ]
+        }],
         ["OS=='win'", {
           "defines": [
             "_WIN32_WINNT=0x0600",
@@ -52,7 +88,8 @@
             ["\"<!@(node -p \"process.env.CC || ''\")\"==\"gcc\"", {
               "cflags_cc": [
                 "-std=c++20",
-                "-fexceptions"
+                "-fexceptions",
+                "-ffp-contract=off"
               ],
               "cflags_c": [
                 "-std=c99"
@@ -70,7 +107,8 @@
         ["OS=='linux'", {
           "cflags_cc": [
             "-std=c++17",
-            "-fexceptions"
+            "-fexceptions",
+            "-ffp-contract=off"
           ]
         }]
       ]
@@ -116,5 +154,213 @@
         }]
       ]
     }
+  ],
+  "conditions": [
+    # ft8_lib's monitor and FFT, built again for AVX2 and AVX-512 under renamed
+    # symbols (see src/monitor_isa.h); the addon selects one at run time
+    ["target_arch=='x64' and OS!='win'", {
+      "targets": [
+        {
+          "target_name": "ft8_monitor_avx2",
+          "type": "static_library",
+          "sources": [
+            "src/monitor_isa_monitor.c",
+            "src/monitor_isa_kiss_fft.c",
+            "src/monitor_isa_kiss_fftr.c"
+          ],
+          "include_dirs": [
+            "ft8_lib",
+            "ft8_lib/ft8",
+            "ft8_lib/common",
+            "ft8_lib/fft"
+          ],
+          "defines": [
+            "FT8_ISA_SUFFIX=_avx2",
+            "LOG_LEVEL=0"
+          ],
+          "cflags": [
+            "-std=c99",
+            "-mavx2",
+            "-ffp-contract=off"
+          ],
+          "xcode_settings": {
+            "OTHER_CFLAGS": [
+              "-mavx2",
+              "-ffp-contract=off"
+            ]
+          }
+        },
+        {
+          "target_name": "ft8_monitor_avx512",
+          "type": "static_library",
+          "sources": [
+            "src/monitor_isa_monitor.c",
+            "src/monitor_isa_kiss_fft.c",
+            "src/monitor_isa_kiss_fftr.c"
+          ],
+          "include_dirs": [
+            "ft8_lib",
+            "ft8_lib/ft8",
+            "ft8_lib/common",
+            "ft8_lib/fft"
+          ],
+          "defines": [
+            "FT8_ISA_SUFFIX=_avx512",
+            "LOG_LEVEL=0"
+          ],
+          "cflags": [
+            "-std=c99",
+            "-mavx512f",
+            "-mavx512bw",
+            "-mavx512vl",
+            "-ffp-contract=off"
+          ],
+          "xcode_settings": {
+            "OTHER_CFLAGS": [
+              "-mavx512f",
+              "-mavx512bw",
+              "-mavx512vl",
+              "-ffp-contract=off"
+            ]
+          }
+        }
+      ]
+    }],
+    ["build_bench=='true'", {
+      "targets": [
+        {
+          "target_name": "ft8_bench",
+          "type": "executable",
+          "dependencies": [
+            "ft8_lib_static"
+          ],
+          "sources": [
+            "bench/native/bench.cpp",
+            "src/decoder_core.cpp",
+            "src/decode_stages.cpp",
+            "src/decode_stats.cpp",
+            "src/callsign_hash.cpp",
+            "src/gfsk.cpp",
+            "src/trace.cpp",
+            "src/cpu_features.cpp",
+            "src/monitor_kernels.cpp"
+          ],
+          "include_dirs": [
+            "src",
+            "ft8_lib",
+            "ft8_lib/ft8",
+            "ft8_lib/common",
+            "ft8_lib/fft"
+          ],
+          "conditions": [
+            ["target_arch=='x64' and OS!='win'", {
+              "dependencies": [
+                "ft8_monitor_avx2",
+                "ft8_monitor_avx512"
+              ],
+              "defines": [
+                "FT8_LIB_MONITOR_VARIANTS"
+              ]
+            }],
+            ["OS=='win'", {
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": ["/std:c++20", "/Zc:__cplusplus"]
+                }
+              }
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+                "MACOSX_DEPLOYMENT_TARGET": "10.12"
+              }
+            }],
+            ["OS=='linux'", {
+              "cflags_cc": [
+                "-std=c++17",
+                "-fexceptions",
+                "-ffp-contract=off"
+              ],
+              "libraries": [
+                "-lpthread"
+              ]
+            }]
+          ]
+        }
+      ]
+    }],
+    ["build_cli=='true'", {
+      "targets": [
+        {
+          "target_name": "ft8decode",
+          "type": "executable",
+          "dependencies": [
+            "ft8_lib_static"
+          ],
+          "sources": [
+            "cli/ft8decode.cpp",
+            "src/decoder_core.cpp",
+            "src/decode_stages.cpp",
+            "src/decode_stats.cpp",
+            "src/decoder_options.cpp",
+            "src/slot_pool.cpp",
+            "src/callsign_hash.cpp",
+            "src/gfsk.cpp",
+            "src/wav_file.cpp",
+            "src/pcm_convert.cpp",
+            "src/cpu_features.cpp",
+            "src/monitor_kernels.cpp",
+            "src/trace.cpp"
+          ],
+          "include_dirs": [
+            "src",
+            "ft8_lib",
+            "ft8_lib/ft8",
+            "ft8_lib/common",
+            "ft8_lib/fft"
+          ],
+          "conditions": [
+            ["target_arch=='x64' and OS!='win'", {
+              "dependencies": [
+                "ft8_monitor_avx2",
+                "ft8_monitor_avx512"
+              ],
+              "defines": [
+                "FT8_LIB_MONITOR_VARIANTS"
+              ]
+            }],
+            ["OS=='win'", {
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": ["/std:c++20", "/Zc:__cplusplus"]
+                }
+              }
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+                "MACOSX_DEPLOYMENT_TARGET": "10.12"
+              }
+            }],
+            ["OS=='linux'", {
+              "cflags_cc": [
+                "-std=c++17",
+                "-fexceptions",
+                "-ffp-contract=off"
+              ],
+              "libraries": [
+                "-lpthread"
+              ]
+            }]
+          ]
+        }
+      ]
+    }]
   ]
 }
@@ -0,0 +1,356 @@
+/**
+ * Headless FT8/FT4 decoder
+ *
+ * Decodes WAV files, or raw PCM from stdin, slot by slot on a pool of
+ * threads and prints one JSON object per decoded message (NDJSON) to stdout,
+ * in time order. Uses the same decoder core and tuning knobs as
+ * MessageDecoder, without Node.js, so it can run on hosts without Node and
+ * be profiled directly with perf.
+ *
+ * Usage: ft8decode [options] [file.wav ... | -]
+ */
+
+#include "callsign_hash.h"
+#include "cpu_features.h"
+#include "decoder_core.h"
+#include "decoder_options.h"
+#include "slot_pool.h"
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+extern "C" {
+#include <ft8/constants.h>
+}
+
+namespace {
+
+const char* const USAGE =
+    "Usage: ft8decode [options] [file.wav ... | -]\n"
+    "\n"
+    "Decodes WAV files, or raw PCM from stdin when no file or '-' is given, and\n"
+    "prints one JSON object per decoded message.\n"
+    "\n"
+    "  --protocol FT8|FT4         protocol (default FT8)\n"
+    "  --threads N                decoding threads (default: one per core)\n"
+    "  --start-time MS            UTC time of the first sample in ms since the epoch;\n"
+    "                             aligns slots to the UTC slot grid\n"
+    "  --rate HZ                  sample rate of stdin PCM (default 12000)\n"
+    "  --format s16le|s16be|f32le sample format of stdin PCM (default s16le)\n"
+    "  --channels 1|2             channels of stdin PCM (default 1)\n"
+    "  --callsigns FILE           known callsigns, one per line, to resolve hashed callsigns\n"
+    "  --stats                    print pipeline statistics to stderr at the end\n"
+    "\n"
+    "Decoder options, as in MessageDecoder:\n"
+    "  --min-score N  --max-candidates N  --max-ldpc-iterations N\n"
+    "  --max-decoded-messages N  --freq-osr N  --time-osr N\n"
+    "  --frequency-min HZ  --frequency-max HZ  --passes N\n";
+
+/**
+ * Command line settings
+ */
+struct Settings {
+    DecoderConfig config;
+    unsigned threads = 0;
+    bool has_start_time = false;
+    double start_time = 0;
+    int stream_rate = 12000;
+    PcmStreamFormat stream_format = PCM_STREAM_S16LE;
+    int stream_channels = 1;
+    // Callsign list file; indexed once all options, including --threads, are known
+    std::string callsigns_path;
+    std::shared_ptr<const CallsignIndex> callsign_index;
+    bool stats = false;
+    std::vector<std::string> inputs;
+};
+
+/**
+ * Decoder option name of a flag, e.g. "--max-ldpc-iterations" -> "maxLdpcIterations"
+ */
+std::string OptionName(const std::string& flag) {
+    std::string name;
+    bool upper = false;
+    for (size_t i = 2; i < flag.size(); ++i) {
+        if (flag[i] == '-') {
+            upper = true;
+        } else {
+            name += upper ? (char)toupper((unsigned char)flag[i]) : flag[i];
+            upper = false;
+        }
+    }
+    return name;
+}
+
+bool IsDecoderOption(const std::string& name) {
+    for (size_t i = 0; i < NUM_DECODER_NUMERIC_OPTIONS; ++i) {
+        if (name == DECODER_NUMERIC_OPTIONS[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Parse a number argument
+ */
+bool ParseNumber(const std::string& text, double* value) {
+    char* end = nullptr;
+    *value = strtod(text.c_str(), &end);
+    return !text.empty() && end && *end == '\0';
+}
+
+/**
+ * Index the callsigns of a list file
+ * @return false after printing the problem to stderr
+ */
+bool LoadCallsigns(const std::string& path, Settings* settings) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot open callsign list: %s\n", path.c_str());
+        return false;
+    }
+    std::string text;
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, read);
+    }
+    fclose(file);
+
+    std::vector<std::string> callsigns;
+    SplitCallsignList(text.data(), text.size(), &callsigns);
+    settings->callsign_index = CallsignIndex::Build(callsigns, settings->threads);
+    return true;
+}
+
+/**
+ * Parse the command line
+ * @return false after printing the problem to stderr
+ */
+bool ParseArguments(int argc, char** argv, Settings* settings) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-" || arg.compare(0, 2, "--") != 0) {
+            settings->inputs.push_back(arg);
+            continue;
+        }
+        if (arg == "--help") {
+            fputs(USAGE, stdout);
+            exit(0);
+        }
+        if (arg == "--stats") {
+            settings->stats = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        double number = 0;
+        bool numeric = ParseNumber(value, &number);
+
+        if (arg == "--protocol") {
+            if (!ParseProtocolName(value, &settings->config.protocol)) {
+                fprintf(stderr, "Unknown protocol: %s\n", value.c_str());
+                return false;
+            }
+        } else if (arg == "--format") {
+            if (value == "s16le") {
+                settings->stream_format = PCM_STREAM_S16LE;
+            } else if (value == "s16be") {
+                settings->stream_format = PCM_STREAM_S16BE;
+            } else if (value == "f32le") {
+                settings->stream_format = PCM_STREAM_F32LE;
+            } else {
+                fprintf(stderr, "Unknown sample format: %s\n", value.c_str());
+                return false;
+            }
+        } else if (arg == "--callsigns") {
+            settings->callsigns_path = value;
+        } else if (!numeric) {
+            fprintf(stderr, "Expected a number for %s: %s\n", arg.c_str(), value.c_str());
+            return false;
+        } else if (arg == "--threads") {
+            settings->threads = number > 0 ? (unsigned)number : 0;
+        } else if (arg == "--start-time") {
+            settings->has_start_time = true;
+            settings->start_time = number;
+        } else if (arg == "--rate") {
+            settings->stream_rate = (int)number;
+            if (settings->stream_rate <= 0) {
+                fprintf(stderr, "Invalid sample rate: %s\n", value.c_str());
+                return false;
+            }
+        } else if (arg == "--channels") {
+            settings->stream_channels = (int)number;
+            if (settings->stream_channels != 1 && settings->stream_channels != 2) {
+                fprintf(stderr, "Only 1 or 2 channels are supported\n");
+                return false;
+            }
+        } else if (IsDecoderOption(OptionName(arg))) {
+            std::string error;
+            if (!SetDecoderOption(&settings->config, OptionName(arg), number, &error)) {
+                fprintf(stderr, "%s\n", error.c_str());
+                return false;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n\n%s", arg.c_str(), USAGE);
+            return false;
+        }
+    }
+
+    if (!settings->callsigns_path.empty() && !LoadCallsigns(settings->callsigns_path, settings)) {
+        return false;
+    }
+    if (settings->inputs.empty()) {
+        settings->inputs.push_back("-");
+    }
+    return true;
+}
+
+void PrintJsonString(const std::string& text) {
+    putchar('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            putchar('\\');
+            putchar(c);
+        } else if ((unsigned char)c < 0x20) {
+            printf("\\u%04x", (unsigned)c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+/**
+ * Print the messages of a slot, one JSON object per line
+ */
+void PrintSlot(const Settings& settings, const std::string& source, int sample_rate, const DecodedSlot& slot) {
+    for (const DecodeResult& decoded : slot.messages) {
+        double file_time = (double)slot.start_sample / sample_rate + decoded.time_offset;
+
+        printf("{\"source\":");
+        PrintJsonString(source);
+        printf(",\"slot\":%lld,\"fileTime\":%.3f", (long long)slot.index, file_time);
+        if (settings.has_start_time) {
+            printf(",\"utcTime\":%.0f", settings.start_time + 1000.0 * file_time);
+        }
+        printf(",\"text\":");
+        PrintJsonString(decoded.text);
+        printf(",\"type\":\"%s\",\"frequency\":%.1f,\"timeOffset\":%.3f,\"snr\":%.0f,\"score\":%d,\"hash\":%u,"
+               "\"payload\":\"",
+               MessageTypeName(decoded.type), decoded.status.freq, decoded.status.time, std::round(decoded.snr),
+               decoded.candidate.score, (unsigned)decoded.message.hash);
+        for (int i = 0; i < FTX_PAYLOAD_LENGTH_BYTES; ++i) {
+            printf("%02x", decoded.message.payload[i]);
+        }
+        printf("\"}\n");
+    }
+    // Streams are decoded live, so every slot is flushed as soon as it is ready
+    fflush(stdout);
+}
+
+/**
+ * Decode one input
+ * @return false after printing the problem to stderr
+ */
+bool DecodeInput(const Settings& settings, const std::string& input, DecodeStats* stats, uint64_t* slots) {
+    float slot_time = (settings.config.protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+
+    SlotPoolOptions options;
+    options.config = settings.config;
+    options.callsign_index = settings.callsign_index;
+    options.threads = settings.threads;
+    options.thread_name = "ft8decode";
+    options.stats = settings.stats ? stats : nullptr;
+
+    std::string error;
+    bool ok;
+    if (input == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        WavSlotLayout layout = ComputeSlotLayout(settings.stream_rate, 0, slot_time, settings.has_start_time,
+                                                 settings.start_time);
+        PcmStreamSlotSource source(stdin, settings.stream_format, settings.stream_channels, layout.slot_samples,
+                                   layout.lead_samples);
+        options.sample_rate = settings.stream_rate;
+        options.slot_samples = layout.slot_samples;
+        ok = DecodeSlotsInOrder(&source, options, [&](DecodedSlot& slot) {
+            PrintSlot(settings, "stdin", options.sample_rate, slot);
+            ++*slots;
+        }, &error);
+    } else {
+        WavSlotSource source;
+        if (!source.Open(input, slot_time, settings.has_start_time, settings.start_time, &error)) {
+            fprintf(stderr, "%s: %s\n", input.c_str(), error.c_str());
+            return false;
+        }
+        options.sample_rate = source.SampleRate();
+        options.slot_samples = source.Layout().slot_samples;
+        ok = DecodeSlotsInOrder(&source, options, [&](DecodedSlot& slot) {
+            PrintSlot(settings, input, options.sample_rate, slot);
+            ++*slots;
+        }, &error);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "%s: %s\n", input.c_str(), error.c_str());
+    }
+    return ok;
+}
+
+double NsToMs(uint64_t ns) {
+    return ns / 1e6;
+}
+
+void PrintStats(const DecodeStats& stats, uint64_t slots, double wall_ms) {
+    fprintf(stderr,
+            "{\"stats\":{\"kernels\":\"%s\",\"slots\":%llu,\"decoded\":%llu,\"wallMs\":%.1f,"
+            "\"monitorMs\":%.1f,\"findMs\":%.1f,\"likelihoodMs\":%.1f,\"ldpcMs\":%.1f,\"unpackMs\":%.1f,"
+            "\"candidates\":%llu,\"ldpcRuns\":%llu,\"ldpcIterations\":%llu,\"ldpcFailures\":%llu,"
+            "\"crcFailures\":%llu}}\n",
+            KernelIsaName(ActiveKernelIsa()), (unsigned long long)slots, (unsigned long long)stats.decoded, wall_ms,
+            NsToMs(stats.monitor_ns), NsToMs(stats.find_ns), NsToMs(stats.likelihood_ns), NsToMs(stats.ldpc_ns),
+            NsToMs(stats.unpack_ns), (unsigned long long)stats.candidates, (unsigned long long)stats.ldpc_runs,
+            (unsigned long long)stats.ldpc_iterations, (unsigned long long)stats.ldpc_failures,
+            (unsigned long long)stats.crc_failures);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    if (!ParseArguments(argc, argv, &settings)) {
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    DecodeStats stats;
+    uint64_t slots = 0;
+    int status = 0;
+    for (const std::string& input : settings.inputs) {
+        if (!DecodeInput(settings, input, &stats, &slots)) {
+            status = 1;
+        }
+    }
+
+    if (settings.stats) {
+        double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        PrintStats(stats, slots, wall_ms);
+    }
+    return status;
+}
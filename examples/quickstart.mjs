@@ -39,7 +39,7 @@ decodedMessages.forEach((msg, i) => {
 console.log('\n=== WAV File Example ===');
 
 // Save to WAV file
-Utils.Audio.saveWav('quickstart_example.wav', audioBuffer);
+await Utils.Audio.saveWav('quickstart_example.wav', audioBuffer);
 console.log('Saved audio to quickstart_example.wav');
 
 // Load from WAV file
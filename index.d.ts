@@ -24,6 +24,12 @@ export type MessageType =
   | 'WWROF'
   | 'UNKNOWN';
 
+/**
+ * Return codes of the message encoder, in `EncodedBatch.status` order:
+ * 0 OK, 1 ERROR_CALLSIGN1, 2 ERROR_CALLSIGN2, 3 ERROR_SUFFIX, 4 ERROR_GRID, 5 ERROR_TYPE
+ */
+export type MessageReturnCode = 0 | 1 | 2 | 3 | 4 | 5;
+
 export type CallsignHashType = '22_BITS' | '12_BITS' | '10_BITS';
 
 /**
@@ -38,7 +44,7 @@ export interface DecodedMessage {
   hash: number;
   /** Message type classification */
   type: MessageType;
-  /** Signal-to-noise ratio in dB */
+  /** SNR in whole dB in a 2500 Hz bandwidth, as WSJT-X reports it (-24 at the lowest) */
   snr?: number;
   /** Frequency offset in Hz */
   frequency?: number;
@@ -64,6 +70,68 @@ export interface EncodedMessage {
   protocol: Protocol;
 }
 
+/**
+ * Result of encoding many messages at once, stored as one array per field.
+ * Entry `i` of each field belongs to `messages[i]`.
+ */
+export interface EncodedBatch {
+  /** Number of messages in the batch */
+  count: number;
+  /** Protocol used for encoding */
+  protocol: Protocol;
+  /** Tones per message (79 for FT8, 105 for FT4) */
+  tonesPerMessage: number;
+  /** Payloads, 10 bytes per message */
+  payloads: Uint8Array;
+  /** Tone symbols, `tonesPerMessage` bytes per message */
+  tones: Uint8Array;
+  /** Message hashes */
+  hashes: Uint32Array;
+  /** Encoder return code per message (0 = OK, see `MessageReturnCode`) */
+  status: Uint8Array;
+}
+
+/**
+ * Result of Utils.Message.analyze()
+ */
+export interface MessageAnalysis {
+  /** Whether the message can be encoded (for FT8 and FT4 alike) */
+  valid: boolean;
+  /** Encoder return code (0 = OK) */
+  status: MessageReturnCode;
+  /** Name of the return code for invalid messages, e.g. 'ERROR_GRID'; null when valid */
+  error: string | null;
+  /** Message type; UNKNOWN when invalid */
+  type: MessageType;
+  /** Payload bytes (10), or null when invalid */
+  payload: Uint8Array | null;
+  /** Fields of a standard message, or null for other types */
+  standard: { callTo: string; callDe: string; extra: string } | null;
+}
+
+/**
+ * Result of Utils.Message.analyzeBatch(), stored as one array per field.
+ * Entry `i` of each field belongs to `messages[i]`.
+ */
+export interface MessageAnalysisBatch {
+  /** Number of messages in the batch */
+  count: number;
+  /** 1 if the message can be encoded, 0 otherwise */
+  valid: Uint8Array;
+  /** Encoder return code per message (0 = OK, see `MessageReturnCode`) */
+  status: Uint8Array;
+  /** Message type code per message; `typeNames[code]` is its MessageType */
+  types: Uint8Array;
+  /** Names of the type codes */
+  typeNames: MessageType[];
+  /** Payloads, 10 bytes per message; zero for invalid messages */
+  payloads: Uint8Array;
+  /** Standard message fields; null for messages that are not standard */
+  callTo: Array<string | null>;
+  callDe: Array<string | null>;
+  extra: Array<string | null>;
+}
+
 /**
  * Audio buffer containing floating-point samples
  */
@@ -76,6 +144,274 @@ export interface AudioBuffer {
   channels: number;
 }
 
+/**
+ * One signal of a synthesized band. Fields left out are drawn from the
+ * band's seeded random ranges.
+ */
+export interface SynthSignalSpec {
+  /** Message text (default: random "CQ <call> <grid>") */
+  text?: string;
+  /** Base (tone 0) frequency in Hz */
+  frequency?: number;
+  /** Start of the transmission in seconds from the start of the buffer */
+  timeOffset?: number;
+  /** SNR in dB in a 2500 Hz reference bandwidth */
+  snr?: number;
+  /** Linear frequency drift in Hz per second */
+  drift?: number;
+}
+
+/**
+ * Options for synthesizing a test band
+ */
+export interface SynthesizeBandOptions {
+  /** Protocol of all signals (default: FT8) */
+  protocol?: Protocol;
+  /** Sample rate in Hz (default: 12000) */
+  sampleRate?: number;
+  /** Buffer length in seconds (default: one slot) */
+  duration?: number;
+  /** Signal specs, or a number of fully random signals */
+  signals?: SynthSignalSpec[] | number;
+  /** RMS level of the added white noise in dBFS, or null for no noise (default: -30) */
+  noiseDb?: number | null;
+  /** Random seed; the same seed and options always give the same output (default: 1) */
+  seed?: number;
+  /** Random frequency range in Hz (default: 200-2800) */
+  frequencyMin?: number;
+  frequencyMax?: number;
+  /** Random SNR range in dB (default: -20 to 0) */
+  snrMin?: number;
+  snrMax?: number;
+  /** Random start time range in seconds (default: 0 to 2, limited by the slot) */
+  timeOffsetMin?: number;
+  timeOffsetMax?: number;
+  /** Random drift is drawn from [-driftMax, driftMax] Hz/s (default: 0) */
+  driftMax?: number;
+}
+
+/**
+ * Synthesized band with the ground truth of every signal in it
+ */
+export interface SynthesizedBand {
+  /** Mixed signals plus noise */
+  audio: AudioBuffer;
+  /** Resolved parameters of every signal, in spec order */
+  signals: Array<Required<SynthSignalSpec> & { amplitude: number; hash: number }>;
+  protocol: Protocol;
+  noiseDb: number | null;
+  seed: number;
+}
+
+/**
+ * Byte order of raw 16-bit PCM
+ */
+export type PcmByteOrder = 'LE' | 'BE';
+
+/**
+ * Options for Utils.Audio.pcm16ToFloat32
+ */
+export interface Pcm16ToFloat32Options {
+  /** Preallocated destination; must hold at least one sample per input frame */
+  out?: Float32Array;
+  /** Byte order of the input (default: host order for Int16Array, LE for bytes) */
+  byteOrder?: PcmByteOrder;
+  /** 2 to average interleaved stereo down to mono (default: 1) */
+  channels?: 1 | 2;
+}
+
+/**
+ * Options for Utils.Audio.float32ToPcm16
+ */
+export interface Float32ToPcm16Options {
+  /** Preallocated destination; a Uint8Array/Buffer receives raw bytes */
+  out?: Int16Array | Uint8Array;
+  /** Byte order of the output; without out, giving it returns a Buffer */
+  byteOrder?: PcmByteOrder;
+  /** Triangular dither before rounding: true for +-1 LSB, or the peak in LSB */
+  dither?: boolean | number;
+  /** Dither generator seed for reproducible output (default: random) */
+  seed?: number;
+}
+
+/**
+ * One slot of audio produced by a WavReader
+ */
+export interface WavSlot extends AudioBuffer {
+  /** Slot number, starting at 0 */
+  index: number;
+  /** File sample index of the first slot sample (negative for a padded first slot) */
+  startSample: number;
+  /** File time of the first slot sample in seconds */
+  startTime: number;
+  /** Number of samples that came from the file; the rest is zero padding */
+  validSamples: number;
+  /** UTC time of the slot start in ms since the epoch (only with a startTime option) */
+  utcStart?: number;
+}
+
+/**
+ * Options for opening a WAV file for slot-by-slot reading
+ */
+export interface OpenWavOptions {
+  /** Protocol whose slot length is used (default: FT8, 15 s) */
+  protocol?: Protocol;
+  /**
+   * UTC time of the first sample (Date or ms since the epoch). When given, slots
+   * follow the UTC slot grid and the first slot is zero padded at the front.
+   */
+  startTime?: Date | number;
+}
+
+/**
+ * Async iterator over the slots of a WAV file. Memory use is bounded by the
+ * slots still referenced by the caller, regardless of file length.
+ */
+export interface WavReader extends AsyncIterableIterator<WavSlot> {
+  /** Close the file; iteration ends */
+  close(): void;
+  /** File format and slot layout */
+  getInfo(): {
+    sampleRate: number;
+    channels: number;
+    bitsPerSample: number;
+    format: 'int' | 'float';
+    totalSamples: number;
+    duration: number;
+    protocol: Protocol;
+    slotSamples: number;
+    leadSamples: number;
+    numSlots: number;
+  };
+}
+
+/**
+ * Waterfall magnitudes and their layout. Within a block, the magnitude of bin b
+ * at time subdivision t and frequency subdivision f is at
+ * (t * freqOsr + f) * numBins + b; bin b of subdivision f lies at
+ * minFrequency + (b + f / freqOsr) * binHz.
+ */
+export interface Waterfall {
+  /** numBlocks blocks of blockStride magnitudes */
+  mag: Uint8Array;
+  numBlocks: number;
+  numBins: number;
+  timeOsr: number;
+  freqOsr: number;
+  blockStride: number;
+  /** Frequency of bin 0 in Hz */
+  minFrequency: number;
+  /** Bin spacing in Hz (one tone spacing) */
+  binHz: number;
+  /** Block duration in seconds (one symbol) */
+  blockTime: number;
+  /** Magnitude to dB: dB = mag * magScale + magOffset */
+  magScale: number;
+  magOffset: number;
+}
+
+/**
+ * Waterfall blocks returned by RingReceiver.readWaterfall
+ */
+export interface WaterfallRows extends Waterfall {
+  /** Number of the first block in mag */
+  first: number;
+  /** Number to pass to the next readWaterfall call */
+  next: number;
+  /** UTC start time of each block in ms since the epoch */
+  times: Float64Array;
+}
+
+/**
+ * Options for MessageDecoder.decodeCandidate
+ */
+export interface DecodeCandidateOptions {
+  /** LDPC iteration limit (default: the decoder's maxLdpcIterations) */
+  iterations?: number;
+  /**
+   * LDPC check node rule: 'bp' is ft8_lib's belief propagation, 'min-sum'
+   * a normalized min-sum that sometimes converges where 'bp' does not
+   * (default: 'bp')
+   */
+  engine?: 'bp' | 'min-sum';
+}
+
+/**
+ * Options for MessageDecoder.decodeFocused
+ */
+export interface DecodeFocusedOptions {
+  /** Frequency of the lowest tone of the expected signal in Hz */
+  centerHz: number;
+  /** Width of the band searched around centerHz in Hz (default: 100); clipped to the decoder's frequency range */
+  spanHz?: number;
+  /** Range of message start times in seconds from the start of the audio (default: the full decode's range); clipped to the slot */
+  timeWindow?: [number, number];
+  /** Minimum sync score (default: half of the decoder's minScore) */
+  minScore?: number;
+  /** Maximum candidates to decode (default: 20) */
+  maxCandidates?: number;
+  /** LDPC iterations per candidate (default: twice the decoder's maxLdpcIterations) */
+  maxLdpcIterations?: number;
+}
+
+/**
+ * A message decoded by MessageDecoder.decodeFile
+ */
+export interface FileDecodedMessage extends DecodedMessage {
+  /** Slot the message was decoded in */
+  slot: number;
+  /** Message start time in seconds from the start of the file */
+  fileTime: number;
+  /** Message start time in ms since the epoch (only with a startTime option) */
+  utcTime?: number;
+}
+
+/**
+ * Messages of one slot, delivered to the onSlot callback of decodeFile
+ */
+export interface DecodedFileSlot {
+  /** Slot number, starting at 0 */
+  index: number;
+  /** File time of the first slot sample in seconds */
+  startTime: number;
+  /** UTC time of the slot start in ms since the epoch (only with a startTime option) */
+  utcStart?: number;
+  /** Number of samples that came from the file; the rest is zero padding */
+  validSamples: number;
+  /** Messages decoded in this slot */
+  messages: FileDecodedMessage[];
+}
+
+/**
+ * Options for MessageDecoder.decodeFile. Any DecoderConfig key overrides the
+ * decoder's own setting for this call.
+ */
+export interface DecodeFileOptions extends Partial<DecoderConfig> {
+  /** UTC time of the first sample (Date or ms since the epoch) */
+  startTime?: Date | number;
+  /** Worker threads (default: number of CPU cores) */
+  threads?: number;
+  /**
+   * Called with each slot's messages in time order as decoding progresses.
+   * When given, the resolved result carries no messages array.
+   */
+  onSlot?: (slot: DecodedFileSlot) => void;
+}
+
+/**
+ * Result of MessageDecoder.decodeFile
+ */
+export interface DecodeFileResult {
+  /** Number of slots in the file */
+  slots: number;
+  /** Total number of decoded messages */
+  decoded: number;
+  /** Sample rate of the file */
+  sampleRate: number;
+  /** All messages in time order (only without an onSlot callback) */
+  messages?: FileDecodedMessage[];
+}
+
 /**
  * Configuration for the decoder
  */
@@ -98,6 +434,12 @@ export interface DecoderConfig {
   frequencyMin?: number;
   /** Upper frequency bound in Hz (default: 3000) */
   frequencyMax?: number;
+  /**
+   * Decoding passes (default: 1). Each pass after the first subtracts the
+   * messages already decoded and searches the remaining spectrum again,
+   * which recovers weak signals hidden under strong ones.
+   */
+  passes?: number;
 }
 
 /**
@@ -184,6 +526,14 @@ declare class MessageEncoder {
    */
   encode(message: string, hashInterface?: CallsignHashInterface): EncodedMessage;
 
+  /**
+   * Encode many messages into contiguous arrays (split across threads for large batches)
+   * @param messages Message texts to encode
+   * @param config Optional protocol override
+   * @returns Batch result; failed messages have a non-zero status and zeroed payload/tones
+   */
+  encodeBatch(messages: string[], config?: Pick<EncoderConfig, 'protocol'>): EncodedBatch;
+
   /**
    * Generate audio samples from encoded tones
    * @param tones Array of tone symbols
@@ -206,43 +556,562 @@ declare class MessageEncoder {
   ): AudioBuffer;
 }
 
+/**
+ * Power-of-two histogram: counts[i] holds values below bounds[i]
+ * (and at least bounds[i - 1])
+ */
+export interface StatsHistogram {
+  bounds: number[];
+  counts: number[];
+}
+
+/**
+ * Run count and cumulative time of one pipeline stage
+ */
+export interface StageStats {
+  count: number;
+  totalMs: number;
+}
+
+/**
+ * Cumulative decode pipeline statistics of a MessageDecoder
+ */
+export interface DecodeStats {
+  /** Whether collection is currently on */
+  enabled: boolean;
+  /** decode() calls (and decodeFile() slots) measured */
+  calls: number;
+  /** Messages decoded by those calls */
+  decoded: number;
+  /** Time spent in those calls, excluding the monitor */
+  totalMs: number;
+  stages: {
+    /** Waterfall blocks processed (monitor_process) */
+    monitor: StageStats;
+    /** Candidate searches and candidates found */
+    findCandidates: StageStats & { candidates: number };
+    /** Log-likelihood extraction per candidate; cached counts candidates decoded again without extraction */
+    likelihood: StageStats & { cached: number };
+    /** LDPC decoding: iterations used and candidates that did not converge */
+    ldpc: StageStats & { iterations: number; failures: number };
+    /** Converged codewords with a bad CRC */
+    crc: { failures: number };
+    /** Message unpacking (ftx_message_decode) */
+    unpack: StageStats & { failures: number };
+  };
+  /** Callsign hash table lookups and insertions */
+  hash: { hits: number; misses: number; saves: number };
+  histograms: {
+    /** Decode time per call in ms */
+    decodeMs: StatsHistogram;
+    /** Candidates per call */
+    candidates: StatsHistogram;
+    /** Messages per call */
+    messages: StatsHistogram;
+    /** LDPC iterations per candidate */
+    ldpcIterations: StatsHistogram;
+  };
+  /** Profile of the last decode() when a loadController is attached, otherwise null */
+  profile: LoadProfile | null;
+}
+
 /**
  * FT8/FT4 Message decoder class
  */
 declare class MessageDecoder {
   /**
    * Create a new message decoder
-   * @param config Decoder configuration
+   * @param config Decoder configuration; collectStats turns on pipeline statistics
    */
-  constructor(config?: DecoderConfig);
+  constructor(config?: DecoderConfig & { collectStats?: boolean; loadController?: LoadController });
 
   /**
    * Decode messages from audio buffer
-   * @param audio Audio buffer containing FT8/FT4 signals
-   * @param hashInterface Optional callsign hash interface
+   * @param audio Audio buffer containing FT8/FT4 signals; null decodes the current waterfall again, e.g. one from loadSpectrum()
+   * @param hashInterface Optional callsign hash interface, consulted after the
+   *   decode once per hash the decoder could not resolve
    * @returns Array of decoded messages
    */
-  decode(audio: AudioBuffer, hashInterface?: CallsignHashInterface): DecodedMessage[];
+  decode(audio: AudioBuffer | null, hashInterface?: CallsignHashInterface): DecodedMessage[];
+
+  /**
+   * Decode like decode(), but pack the messages into one ArrayBuffer that a
+   * worker can transfer to another thread instead of having it cloned
+   * @param audio Audio buffer, or null to decode the current waterfall
+   * @param hashInterface Optional callsign hash interface
+   * @returns Packed messages; read them with MessageDecoder.unpackMessages()
+   */
+  decodeToBuffer(audio: AudioBuffer | null, hashInterface?: CallsignHashInterface): ArrayBuffer;
+
+  /**
+   * Turn a buffer from decodeToBuffer() back into message objects
+   * @param buffer Packed messages
+   * @returns The messages, as decode() would have returned them
+   */
+  static unpackMessages(buffer: ArrayBuffer | ArrayBufferView): DecodedMessage[];
 
   /**
    * Find message candidates in audio
-   * @param audio Audio buffer to analyze
+   * @param audio Audio buffer to analyze; null searches the current waterfall
    * @returns Array of message candidates
    */
-  findCandidates(audio: AudioBuffer): MessageCandidate[];
+  findCandidates(audio: AudioBuffer | null): MessageCandidate[];
 
   /**
-   * Decode a specific candidate
-   * @param audio Audio buffer containing the signal
+   * Decode a specific candidate. The candidate's log-likelihoods are cached
+   * with the waterfall, so retrying it with audio null, a larger iteration
+   * budget or another engine skips the extraction.
+   * @param audio Audio buffer containing the signal; null reuses the waterfall of the last call
    * @param candidate The candidate to decode
-   * @param hashInterface Optional callsign hash interface
+   * @param options LDPC iteration limit and engine
    * @returns Decoded message and status, or null if decoding failed
    */
   decodeCandidate(
-    audio: AudioBuffer,
+    audio: AudioBuffer | null,
     candidate: MessageCandidate,
-    hashInterface?: CallsignHashInterface
+    options?: DecodeCandidateOptions
   ): { message: DecodedMessage; status: DecodeStatus } | null;
+
+  /**
+   * Decode only a narrow band around a known frequency, with a relaxed score
+   * threshold and a larger LDPC budget than decode()
+   * @param audio Audio to decode; null searches the waterfall of the last decode()
+   * @param options Band, time window and effort of the search
+   * @returns Array of decoded messages, strongest first
+   */
+  decodeFocused(audio: AudioBuffer | null, options: DecodeFocusedOptions): DecodedMessage[];
+
+  /**
+   * Zero-copy view of the waterfall of the last decode. The view tracks later
+   * decodes in place; call again for the new numBlocks. When a configuration
+   * change reallocates the waterfall, old views become empty.
+   * @returns The waterfall, or null before any audio was processed
+   */
+  getWaterfall(): Waterfall | null;
+
+  /**
+   * Snapshot of the current waterfall in the versioned "FTXS" binary format:
+   * a 64-byte header with the monitor geometry followed by the magnitudes
+   * @returns The snapshot, or null before any audio was processed
+   */
+  serializeSpectrum(): Buffer | null;
+
+  /**
+   * Replace the waterfall with a snapshot from serializeSpectrum(). Protocol,
+   * oversampling and frequency range are taken from the snapshot; decode(null),
+   * findCandidates(null), decodeCandidate(null, ...) and decodeFocused(null, ...)
+   * then run on it without the FFT stage.
+   * @param snapshot Snapshot bytes, e.g. a Buffer over a memory-mapped file
+   * @returns View of the loaded waterfall
+   */
+  loadSpectrum(snapshot: ArrayBuffer | ArrayBufferView): Waterfall;
+
+  /**
+   * Decode a whole WAV recording slot by slot on a thread pool. Each thread
+   * has its own monitor and callsign hash table; results come back in time order.
+   * @param path Path of the WAV file
+   * @param options Slot alignment, thread count and progress callback
+   * @returns Promise resolving once the whole file has been decoded
+   */
+  decodeFile(path: string, options?: DecodeFileOptions): Promise<DecodeFileResult>;
+
+  /**
+   * Snapshot of the callsigns learned for hash lookups, in the versioned
+   * "FTXH" binary format
+   */
+  exportHashes(): Buffer;
+
+  /**
+   * Add the callsigns of a snapshot from exportHashes() to the hash table
+   * @param snapshot Snapshot bytes
+   * @returns Number of callsigns that were new to the table
+   */
+  importHashes(snapshot: ArrayBuffer | ArrayBufferView): number;
+
+  /**
+   * Replace the read-only index of known callsigns that hash lookups consult
+   * before the learned table; also used by decodeFile() threads
+   * @param callsigns Callsigns, or text with callsigns separated by whitespace or commas
+   * @param options Threads used to hash the list (default: all cores)
+   * @returns Number of distinct callsigns indexed and of entries that are not valid callsigns
+   */
+  seedHashes(
+    callsigns: string[] | string | ArrayBuffer | ArrayBufferView,
+    options?: { threads?: number }
+  ): { callsigns: number; rejected: number };
+
+  /**
+   * Cumulative pipeline statistics, including decodeFile() threads
+   */
+  getStats(): DecodeStats;
+
+  /**
+   * Clear the pipeline statistics
+   */
+  resetStats(): void;
+
+  /**
+   * Turn statistics collection on or off; collected values are kept
+   * @param enabled Whether to collect
+   */
+  setStatsEnabled(enabled: boolean): void;
+}
+
+/**
+ * Messages of one UTC slot decoded by a RingReceiver
+ */
+export interface RingSlot {
+  /** Slot number since start() */
+  index: number;
+  /** UTC time of the slot start in ms since the epoch */
+  utcStart: number;
+  /** Waterfall blocks that were decoded */
+  blocks: number;
+  /** Time spent decoding in ms */
+  decodeMs: number;
+  /** Decoded messages, each with an absolute utcTime in ms */
+  messages: Array<DecodedMessage & { utcTime: number }>;
+}
+
+/**
+ * Options for a RingReceiver. Any DecoderConfig key tunes its decoder.
+ */
+export interface RingReceiverOptions extends Partial<DecoderConfig> {
+  /**
+   * Control words over shared memory:
+   * [0] write index (producer), [1] read index (receiver),
+   * [2] flags (bit 0 = end of stream), [3] overrun count
+   */
+  control: Int32Array;
+  /** Sample ring over shared memory; length must be a power of two */
+  samples: Float32Array;
+  /** Sample rate of the ring (default: 12000) */
+  sampleRate?: number;
+  /** UTC time of the sample at the read index when start() is called (default: derived from now) */
+  startTime?: Date | number;
+  /** Called on the main thread with each decoded slot */
+  onDecode: (slot: RingSlot) => void;
+  /** Shared controller that lowers decoder effort when decodes fall behind */
+  loadController?: LoadController;
+  /** Number of recent waterfall blocks kept for readWaterfall (default: 0, off) */
+  waterfallRows?: number;
+}
+
+/**
+ * Decodes audio written by any thread into a SharedArrayBuffer ring. A native
+ * thread consumes the ring and decodes at UTC slot boundaries.
+ */
+declare class RingReceiver {
+  constructor(options: RingReceiverOptions);
+
+  /** Start the native consumer thread */
+  start(): void;
+
+  /** Stop the consumer thread; already queued results are still delivered */
+  stop(): void;
+
+  /** Consumer counters */
+  getStats(): {
+    running: boolean;
+    samplesConsumed: number;
+    slotsDecoded: number;
+    messagesDecoded: number;
+    overruns: number;
+    lastDecodeMs: number;
+    currentSlot: number;
+    firstSlotUtc: number;
+    capacity: number;
+    /** Decode time of the last slot plus the audio that queued up meanwhile, in ms */
+    lastLatencyMs: number;
+    /** Profile of the current slot when a loadController is attached, otherwise null */
+    profile: LoadProfile | null;
+  };
+
+  /**
+   * Waterfall blocks computed since a given block, for drawing a live
+   * waterfall without a second FFT. Needs the waterfallRows option.
+   * @param since next of the previous call (default: 0, all blocks kept)
+   */
+  readWaterfall(since?: number): WaterfallRows;
+}
+
+/**
+ * One decoder effort level; absent keys keep the receiver's own setting, and
+ * a profile never raises the receiver's effort above its own configuration
+ */
+export interface LoadProfile {
+  /** Index in the profile list, 0 = most effort (read-only) */
+  level?: number;
+  name?: string;
+  minScore?: number;
+  maxCandidates?: number;
+  maxLdpcIterations?: number;
+  freqOsr?: number;
+  timeOsr?: number;
+}
+
+/**
+ * Options for a LoadController. Loads are decode latency divided by the slot period.
+ */
+export interface LoadControllerOptions {
+  /** Profiles from most to least effort (default: full, reduced, light, minimal) */
+  profiles?: LoadProfile[];
+  /** Step down after downReports consecutive decodes above this load (default: 0.25) */
+  highLoad?: number;
+  /** Step up after upReports consecutive decodes below this load (default: 0.1) */
+  lowLoad?: number;
+  /** default: 2 */
+  downReports?: number;
+  /** default: 8 */
+  upReports?: number;
+}
+
+/**
+ * Shared controller that steps every attached RingReceiver and MessageDecoder
+ * through cheaper decoder profiles when decoding falls behind real time, and
+ * back up when there is headroom again
+ */
+declare class LoadController {
+  constructor(options?: LoadControllerOptions);
+
+  /**
+   * The profiles from most to least effort
+   */
+  getProfiles(): LoadProfile[];
+
+  /**
+   * Pin all receivers to a profile level, or resume automatic control with null
+   */
+  setLevel(level: number | null): void;
+
+  /**
+   * Current profile and controller counters
+   */
+  getStats(): {
+    level: number;
+    profile: LoadProfile;
+    /** Whether setLevel() pinned the level */
+    pinned: boolean;
+    /** Decodes reported by all receivers */
+    reports: number;
+    stepsDown: number;
+    stepsUp: number;
+    /** Load of the most recent report and the highest seen */
+    lastLoad: number;
+    peakLoad: number;
+  };
+}
+
+/**
+ * Lateness summary of scheduled events, in ms
+ */
+export interface JitterStats {
+  count: number;
+  meanMs: number;
+  maxMs: number;
+  p50Ms: number;
+  p99Ms: number;
+  lastMs: number;
+}
+
+/**
+ * Event fired by a SlotScheduler
+ */
+export interface SlotEvent {
+  /** slot: slot boundary, decode: decode offset reached, tx: TX audio rendered */
+  type: 'slot' | 'decode' | 'tx';
+  /** Slot number since the Unix epoch */
+  slot: number;
+  parity: 'even' | 'odd';
+  /** UTC start of the slot in ms */
+  slotStart: number;
+  /** UTC time the event was due in ms */
+  scheduledTime: number;
+  /** UTC time the native thread fired it in ms */
+  firedTime: number;
+  /** firedTime - scheduledTime */
+  lateMs: number;
+  /** How late the callback ran relative to scheduledTime */
+  deliveryLateMs: number;
+  /** decode only: index into decodeOffsets */
+  offsetIndex?: number;
+  /** decode only: offset into the slot in seconds */
+  offset?: number;
+  /** tx only: message text */
+  text?: string;
+  /** tx only: audio frequency in Hz */
+  frequency?: number;
+  /** tx only: UTC time at which playback should start, in ms */
+  playAt?: number;
+  /** tx only: sample rate of audio */
+  sampleRate?: number;
+  /** tx only: GFSK audio of the message, without padding */
+  audio?: Float32Array;
+}
+
+/**
+ * Options for a SlotScheduler
+ */
+export interface SlotSchedulerOptions {
+  /** Protocol whose slot length is used (default: 'FT8') */
+  protocol?: 'FT8' | 'FT4';
+  /** Seconds into every slot at which decode events fire (default: one second before the slot ends) */
+  decodeOffsets?: number[];
+  /** Seconds before a slot at which its queued transmissions are rendered (default: 1.0) */
+  txLead?: number;
+  /** Seconds into the slot at which transmission starts, reported as playAt (default: 0.5) */
+  txDelay?: number;
+  /** Sample rate of rendered TX audio (default: 12000) */
+  sampleRate?: number;
+  /** Default TX audio frequency in Hz (default: 1000) */
+  frequency?: number;
+  /** Correction in ms added to the system clock (default: 0) */
+  clockOffset?: number;
+  /** Called on the main thread with every event */
+  onEvent: (event: SlotEvent) => void;
+}
+
+/**
+ * Fires slot, decode and TX events on a native thread aligned to UTC slot
+ * boundaries. While running it keeps the process alive, like a timer.
+ */
+declare class SlotScheduler {
+  constructor(options: SlotSchedulerOptions);
+
+  /** Start the scheduler thread */
+  start(): void;
+
+  /** Stop the scheduler thread */
+  stop(): void;
+
+  /**
+   * Queue a message for transmission
+   * @param text Message text
+   * @param options Target slot ('next' by default, 'even', 'odd' or a slot number) and frequency
+   * @returns Slot number the message will be transmitted in
+   */
+  queueTx(text: string, options?: { slot?: 'next' | 'even' | 'odd' | number; frequency?: number }): number;
+
+  /** Drop queued transmissions; returns how many were dropped */
+  cancelTx(): number;
+
+  /** Current UTC time in ms according to the scheduler clock */
+  now(): number;
+
+  /** Event counters and jitter statistics */
+  getStats(): {
+    running: boolean;
+    fired: number;
+    /** Triggers skipped after a suspend or clock step, plus transmissions queued too late */
+    missed: number;
+    queuedTx: number;
+    /** How late the native thread fired */
+    trigger: JitterStats;
+    /** How late the JavaScript callback ran */
+    delivery: JitterStats;
+  };
+}
+
+/**
+ * One slot of a tuning corpus: a WAV path, or a file or buffer with the messages it contains
+ */
+export type TuneCorpusEntry = string | {
+  /** WAV file holding one slot */
+  path?: string;
+  /** Audio of one slot, used when path is not given */
+  audio?: AudioBuffer;
+  /** Messages known to be in the slot; without them, everything any configuration decodes counts */
+  expected?: string[];
+};
+
+/**
+ * Options for Utils.tuneDecoder
+ */
+export interface TuneDecoderOptions {
+  /** Protocol of the corpus (default: FT8) */
+  protocol?: Protocol;
+  /** Frequency range and message limit, shared by all configurations */
+  frequencyMin?: number;
+  frequencyMax?: number;
+  maxDecodedMessages?: number;
+  /** CPU time one slot may take; the recommendation's slowest slot stays within it */
+  cpuBudgetMs?: number;
+  /** Measure each slot this many times and keep the fastest (default: 1) */
+  repeat?: number;
+  /** Values to sweep; each axis is a number or a list */
+  grid?: {
+    /** default: [5, 10, 20] */
+    minScore?: number | number[];
+    /** default: [50, 100, 140, 200] */
+    maxCandidates?: number | number[];
+    /** default: [10, 25, 50] */
+    maxLdpcIterations?: number | number[];
+    /** default: [1, 2] */
+    freqOsr?: number | number[];
+    /** default: [1, 2] */
+    timeOsr?: number | number[];
+  };
+}
+
+/**
+ * Measurements of one decoder configuration over a corpus
+ */
+export interface TuneResult {
+  /** Ready to pass to new MessageDecoder() */
+  config: Required<Pick<DecoderConfig, 'protocol' | 'minScore' | 'maxCandidates' | 'maxLdpcIterations' | 'freqOsr' | 'timeOsr'>>;
+  /** Reference messages decoded */
+  found: number;
+  /** Decodes that are not in the slot's expected list */
+  extra: number;
+  /** found / referenceMessages */
+  recall: number;
+  /** Mean and worst CPU time per slot in milliseconds, monitor included */
+  meanMs: number;
+  maxMs: number;
+  /** No other configuration finds as many messages in less time */
+  pareto: boolean;
+}
+
+/**
+ * Result of Utils.tuneDecoder
+ */
+export interface TuneReport {
+  slots: number;
+  /** Messages configurations are scored against */
+  referenceMessages: number;
+  budgetMs: number | null;
+  /** Every configuration, fastest first */
+  configs: TuneResult[];
+  /** The Pareto-optimal configurations, fastest first */
+  pareto: TuneResult[];
+  /** Pareto configuration finding the most within the budget, or null if none fits */
+  recommended: TuneResult | null;
+}
+
+/**
+ * Result of Utils.getCpuFeatures
+ */
+export interface CpuFeatureReport {
+  /** Instruction set extensions the CPU and OS support */
+  features: {
+    sse2: boolean;
+    sse42: boolean;
+    avx: boolean;
+    avx2: boolean;
+    fma: boolean;
+    avx512f: boolean;
+    avx512bw: boolean;
+    avx512vl: boolean;
+    neon: boolean;
+  };
+  /** Variant of the decode, LDPC and GFSK kernels selected at load time */
+  kernels: 'baseline' | 'avx2' | 'avx512' | 'neon';
+  /** Variants compiled into this binary, lowest first */
+  availableKernels: Array<'baseline' | 'avx2' | 'avx512' | 'neon'>;
+  /** Variant of ft8_lib's monitor and FFT; 'baseline' where no other variant is compiled in */
+  monitorKernels: 'baseline' | 'avx2' | 'avx512' | 'neon';
+  /** Instruction set of the PCM conversion kernels */
+  pcmKernels: 'avx2' | 'sse2' | 'neon' | 'scalar';
 }
 
 /**
@@ -265,38 +1134,80 @@ declare namespace Utils {
     syncOffset: number;
   };
 
+  /**
+   * Sweep decoder configurations over slots with known decodes and weigh
+   * decodes found against CPU time per slot. Runs on a worker thread.
+   * @param corpus Slots to decode
+   * @param options Budget and parameter grid
+   * @returns Every configuration measured, the Pareto front and a recommendation
+   */
+  function tuneDecoder(corpus: TuneCorpusEntry[], options?: TuneDecoderOptions): Promise<TuneReport>;
+
+  /**
+   * CPU features of the host and the kernel variants selected for them.
+   * Set FT8_LIB_KERNELS=baseline (or avx2) before loading the module to
+   * force a lower variant.
+   */
+  function getCpuFeatures(): CpuFeatureReport;
+
   /**
    * Convert audio samples to/from different formats
    */
   namespace Audio {
     /**
-     * Convert 16-bit PCM to float32 samples
-     * @param pcm 16-bit PCM data
-     * @returns Float32 samples in range [-1.0, 1.0]
+     * Convert 16-bit PCM to float32 samples. Runs on SIMD kernels (AVX2, SSE2
+     * or NEON) where available.
+     * @param pcm 16-bit PCM as an Int16Array (host byte order) or raw bytes in a
+     *            Buffer/Uint8Array (little endian unless byteOrder says otherwise)
+     * @param options Output array, byte order and channel layout
+     * @returns Float32 samples in range [-1.0, 1.0); a view over options.out when given
      */
-    function pcm16ToFloat32(pcm: Int16Array): Float32Array;
+    function pcm16ToFloat32(pcm: Int16Array | Uint8Array, options?: Pcm16ToFloat32Options): Float32Array;
 
     /**
-     * Convert float32 samples to 16-bit PCM
+     * Convert float32 samples to 16-bit PCM, clipping to [-1.0, 1.0] and
+     * rounding to the nearest step, optionally with TPDF dither
      * @param samples Float32 samples in range [-1.0, 1.0]
-     * @returns 16-bit PCM data
+     * @param options Output array, byte order and dither
+     * @returns 16-bit PCM data: options.out when given, a Buffer when byteOrder is
+     *          given, otherwise an Int16Array
      */
-    function float32ToPcm16(samples: Float32Array): Int16Array;
+    function float32ToPcm16(samples: Float32Array, options?: Float32ToPcm16Options): Int16Array | Buffer;
 
     /**
-     * Load WAV file and return audio buffer
+     * Load WAV file and return audio buffer. The file is read and converted to
+     * mono float on a worker thread.
      * @param filePath Path to the WAV file
      * @returns Promise resolving to audio buffer
      */
     function loadWav(filePath: string): Promise<AudioBuffer>;
 
     /**
-     * Save audio buffer as WAV file
+     * Save audio buffer as 16-bit WAV file. The file is written on a worker
+     * thread directly from audio.samples, which must not be modified until
+     * the promise resolves.
      * @param audio Audio buffer to save
      * @param filePath Output file path
      * @returns Promise resolving when file is saved
      */
     function saveWav(filePath: string, audio: AudioBuffer): Promise<void>;
+
+    /**
+     * Render a deterministic slot of overlapping signals plus white noise,
+     * for decoder load and sensitivity testing
+     * @param options Band description
+     * @returns Audio and the ground-truth list of signals
+     */
+    function synthesizeBand(options: SynthesizeBandOptions): SynthesizedBand;
+
+    /**
+     * Open a WAV file of any length for slot-aligned streaming. Handles 8/16/24/32-bit
+     * integer and 32/64-bit float PCM and downmixes multi-channel audio to mono.
+     * @param filePath Path to the WAV file
+     * @param options Slot layout options
+     * @returns Async iterator yielding one slot at a time
+     */
+    function openWav(filePath: string, options?: OpenWavOptions): WavReader;
   }
 
   /**
@@ -328,6 +1239,21 @@ declare namespace Utils {
       callDe: string;
       extra: string;
     } | null;
+
+    /**
+     * Everything isValidMessage, getMessageType and parseStandardMessage
+     * report, from a single encode of the message
+     * @param message Message text
+     * @returns Analysis of the message
+     */
+    function analyze(message: string): MessageAnalysis;
+
+    /**
+     * Analyze many messages at once on a thread pool
+     * @param messages Message texts
+     * @returns One array per field; entry `i` belongs to `messages[i]`
+     */
+    function analyzeBatch(messages: string[]): MessageAnalysisBatch;
   }
 
   /**
@@ -349,15 +1275,41 @@ declare namespace Utils {
      */
     function verifyCrc14(data: Uint8Array, expectedCrc: number): boolean;
   }
+
+  /**
+   * Timeline tracing in Chrome Trace Event format
+   */
+  namespace Trace {
+    /**
+     * Start recording begin/end events of decoder, encoder and audio calls on all threads
+     * @param options bufferSize: events each thread can record (default: 65536); later events are dropped
+     */
+    function start(options?: { bufferSize?: number }): void;
+
+    /**
+     * Stop recording and write the trace as JSON for chrome://tracing or Perfetto
+     * @param path Output file
+     * @returns Promise resolving once the file is written
+     */
+    function stop(path: string): Promise<{ path: string; events: number; dropped: number; threads: number }>;
+
+    /**
+     * Whether a trace is being recorded
+     */
+    function isEnabled(): boolean;
+  }
 }
 
 // Named exports
-export { MessageEncoder, MessageDecoder, Utils };
+export { MessageEncoder, MessageDecoder, RingReceiver, SlotScheduler, LoadController, Utils };
 
 // Default export interface for CommonJS compatibility
 declare const ft8lib: {
   MessageEncoder: typeof MessageEncoder;
   MessageDecoder: typeof MessageDecoder;
+  RingReceiver: typeof RingReceiver;
+  SlotScheduler: typeof SlotScheduler;
+  LoadController: typeof LoadController;
   Utils: typeof Utils;
 };
 
@@ -365,6 +1317,6 @@ export default ft8lib;
 
 // Global module declaration for package name
 declare module "ft8-lib" {
-  export { MessageEncoder, MessageDecoder, Utils };
+  export { MessageEncoder, MessageDecoder, RingReceiver, SlotScheduler, LoadController, Utils };
   export default ft8lib;
 }
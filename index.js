@@ -18,6 +18,9 @@ try {
 /**
  * @typedef {import('./index.d.ts').MessageEncoder} MessageEncoder
  * @typedef {import('./index.d.ts').MessageDecoder} MessageDecoder  
+ * @typedef {import('./index.d.ts').RingReceiver} RingReceiver
+ * @typedef {import('./index.d.ts').SlotScheduler} SlotScheduler
+ * @typedef {import('./index.d.ts').LoadController} LoadController
  * @typedef {import('./index.d.ts').Utils} Utils
  */
 
@@ -27,6 +30,12 @@ module.exports = {
   MessageEncoder: ft8lib.MessageEncoder,
   /** @type {MessageDecoder} */
   MessageDecoder: ft8lib.MessageDecoder,
+  /** @type {RingReceiver} */
+  RingReceiver: ft8lib.RingReceiver,
+  /** @type {SlotScheduler} */
+  SlotScheduler: ft8lib.SlotScheduler,
+  /** @type {LoadController} */
+  LoadController: ft8lib.LoadController,
   /** @type {Utils} */
   Utils: ft8lib.Utils
 };
@@ -34,4 +43,7 @@ module.exports = {
 // Add named exports for ES module compatibility when used with require()
 module.exports.MessageEncoder = ft8lib.MessageEncoder;
 module.exports.MessageDecoder = ft8lib.MessageDecoder;
+module.exports.RingReceiver = ft8lib.RingReceiver;
+module.exports.SlotScheduler = ft8lib.SlotScheduler;
+module.exports.LoadController = ft8lib.LoadController;
 module.exports.Utils = ft8lib.Utils;
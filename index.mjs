@@ -7,6 +7,9 @@ import ft8lib from './index.js';
 // Re-export as named exports for ES modules
 export const MessageEncoder = ft8lib.MessageEncoder;
 export const MessageDecoder = ft8lib.MessageDecoder;
+export const RingReceiver = ft8lib.RingReceiver;
+export const SlotScheduler = ft8lib.SlotScheduler;
+export const LoadController = ft8lib.LoadController;
 export const Utils = ft8lib.Utils;
 
 // Re-export the default export for compatibility
@@ -0,0 +1,41 @@
+#ifndef ADDON_DATA_H
+#define ADDON_DATA_H
+
+#include <napi.h>
+#include <set>
+
+/**
+ * An object that runs a native thread on behalf of one environment
+ *
+ * Owners register with AddonData while their thread may be running, so the
+ * environment's cleanup hook can join the thread before the environment is
+ * torn down, e.g. when a worker is terminated.
+ */
+class NativeThreadOwner {
+public:
+    virtual ~NativeThreadOwner() = default;
+    
+    /**
+     * Ask the thread to finish and join it; must be safe to call repeatedly
+     */
+    virtual void StopThread() = 0;
+};
+
+/**
+ * Per-environment state of the addon
+ *
+ * Stored as N-API instance data so that every Node.js environment that loads
+ * the addon gets its own copy.
+ */
+struct AddonData {
+    // Constructor of WavReader, used by Utils.Audio.openWav
+    Napi::FunctionReference wav_reader_constructor;
+    
+    // Constructor of LoadController, used to validate loadController options
+    Napi::FunctionReference load_controller_constructor;
+    
+    // Owners whose thread may be running, stopped by the environment's cleanup hook
+    std::set<NativeThreadOwner*> thread_owners;
+};
+
+#endif // ADDON_DATA_H
@@ -1,45 +1,166 @@
 #include "audio_utils.h"
+#include "trace.h"
+#include "addon_data.h"
+#include "gfsk.h"
+#include "parallel.h"
+#include "pcm_convert.h"
+#include "wav_file.h"
 #include <cstring>
+#include <cmath>
 #include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
 
 extern "C" {
-#include <common/wave.h>
+#include <ft8/message.h>
+#include <ft8/encode.h>
+#include <ft8/constants.h>
 }
 
-Napi::Object AudioUtils::CreateAudioBuffer(Napi::Env env, const float* samples, 
-                                          int num_samples, int sample_rate, int channels) {
-    Napi::Object audioBuffer = Napi::Object::New(env);
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+Napi::Float32Array AudioUtils::WrapSamples(Napi::Env env, std::vector<float>* samples) {
+    size_t length = samples->size();
+    
+    // An empty vector may have no storage, and external buffers need a valid pointer
+    if (length == 0) {
+        delete samples;
+        return Napi::Float32Array::New(env, 0);
+    }
     
-    // Copy samples
-    Napi::Float32Array samplesArray = Napi::Float32Array::New(env, num_samples);
-    memcpy(samplesArray.Data(), samples, num_samples * sizeof(float));
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+        env, samples->data(), length * sizeof(float),
+        [](Napi::Env, void*, std::vector<float>* owned) { delete owned; }, samples);
     
-    audioBuffer.Set("samples", samplesArray);
-    audioBuffer.Set("sampleRate", Napi::Number::New(env, sample_rate));
-    audioBuffer.Set("channels", Napi::Number::New(env, channels));
+    return Napi::Float32Array::New(env, length, buffer, 0);
+}
+
+Napi::Function AudioUtils::OpenWav(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        AddonData* data = env.GetInstanceData<AddonData>();
+        Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
+        
+        return data->wav_reader_constructor.New({ info[0], options });
+    });
+}
+
+namespace {
+
+// Samples of dither generated per pass, so dithering needs no heap allocation
+const size_t DITHER_CHUNK = 4096;
+
+/**
+ * Start of a typed array's elements; also works for views over a SharedArrayBuffer
+ */
+uint8_t* TypedArrayBytes(const Napi::TypedArray& array) {
+    void* data = nullptr;
+    napi_get_typedarray_info(array.Env(), array, nullptr, nullptr, &data, nullptr, nullptr);
+    return (uint8_t*)data;
+}
+
+/**
+ * Read the byteOrder option ('LE' or 'BE')
+ * @return false if a JavaScript exception was thrown
+ */
+bool ParseByteOrder(Napi::Env env, const Napi::Object& options, PcmByteOrder* order, bool* given) {
+    *given = false;
+    if (!options.Has("byteOrder")) {
+        return true;
+    }
     
-    return audioBuffer;
+    std::string value = options.Get("byteOrder").As<Napi::String>().Utf8Value();
+    if (value == "LE") {
+        *order = PCM_LITTLE_ENDIAN;
+    } else if (value == "BE") {
+        *order = PCM_BIG_ENDIAN;
+    } else {
+        Napi::TypeError::New(env, "Invalid byteOrder. Must be 'LE' or 'BE'").ThrowAsJavaScriptException();
+        return false;
+    }
+    *given = true;
+    return true;
 }
 
+} // namespace
+
 Napi::Function AudioUtils::Pcm16ToFloat32(Napi::Env env) {
     return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
         Napi::Env env = info.Env();
+        TraceScope trace("pcm16ToFloat32", "audio");
         
         if (info.Length() < 1 || !info[0].IsTypedArray()) {
-            Napi::TypeError::New(env, "Expected Int16Array").ThrowAsJavaScriptException();
+            Napi::TypeError::New(env, "Expected Int16Array or Buffer").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        Napi::Int16Array pcm = info[0].As<Napi::Int16Array>();
-        int num_samples = pcm.ElementLength();
+        Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+        bool raw_bytes = input.TypedArrayType() == napi_uint8_array;
+        if (!raw_bytes && input.TypedArrayType() != napi_int16_array) {
+            Napi::TypeError::New(env, "Expected Int16Array or Buffer").ThrowAsJavaScriptException();
+            return env.Null();
+        }
         
-        Napi::Float32Array result = Napi::Float32Array::New(env, num_samples);
+        // Int16Array elements are in host order; raw bytes default to little endian like WAV data
+        PcmByteOrder order = raw_bytes ? PCM_LITTLE_ENDIAN : PcmNativeByteOrder();
+        int channels = 1;
+        Napi::Float32Array out;
+        bool has_out = false;
         
-        // Convert 16-bit PCM to float32 in range [-1.0, 1.0]
-        for (int i = 0; i < num_samples; ++i) {
-            result[i] = pcm[i] / 32768.0f;
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            bool order_given;
+            if (!ParseByteOrder(env, options, &order, &order_given)) {
+                return env.Null();
+            }
+            
+            if (options.Has("channels")) {
+                channels = options.Get("channels").As<Napi::Number>().Int32Value();
+                if (channels != 1 && channels != 2) {
+                    Napi::TypeError::New(env, "channels must be 1 or 2").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+            
+            if (options.Has("out")) {
+                Napi::Value value = options.Get("out");
+                if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+                    Napi::TypeError::New(env, "out must be a Float32Array").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                out = value.As<Napi::Float32Array>();
+                has_out = true;
+            }
         }
         
+        size_t num_frames = input.ByteLength() / (2 * channels);
+        
+        if (has_out && out.ElementLength() < num_frames) {
+            Napi::RangeError::New(env, "out is too small for the converted samples").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        Napi::Float32Array result;
+        if (!has_out) {
+            result = Napi::Float32Array::New(env, num_frames);
+        } else if (out.ElementLength() == num_frames) {
+            result = out;
+        } else {
+            // View over the part of out that was written
+            result = Napi::Float32Array::New(env, num_frames, out.ArrayBuffer(), out.ByteOffset());
+        }
+        
+        ConvertPcm16ToFloat(TypedArrayBytes(input), num_frames, channels, order, result.Data());
+        
         return result;
     });
 }
@@ -47,64 +168,217 @@ Napi::Function AudioUtils::Pcm16ToFloat32(Napi::Env env) {
 Napi::Function AudioUtils::Float32ToPcm16(Napi::Env env) {
     return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
         Napi::Env env = info.Env();
+        TraceScope trace("float32ToPcm16", "audio");
         
-        if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        if (info.Length() < 1 || !info[0].IsTypedArray() ||
+            info[0].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
             Napi::TypeError::New(env, "Expected Float32Array").ThrowAsJavaScriptException();
             return env.Null();
         }
         
         Napi::Float32Array samples = info[0].As<Napi::Float32Array>();
-        int num_samples = samples.ElementLength();
+        size_t num_samples = samples.ElementLength();
+        
+        PcmByteOrder order = PcmNativeByteOrder();
+        bool order_given = false;
+        float dither_amplitude = 0.0f;
+        uint32_t seed = 0;
+        Napi::TypedArray out;
+        bool has_out = false;
+        
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (!ParseByteOrder(env, options, &order, &order_given)) {
+                return env.Null();
+            }
+            
+            if (options.Has("dither")) {
+                Napi::Value dither = options.Get("dither");
+                if (dither.IsBoolean()) {
+                    dither_amplitude = dither.As<Napi::Boolean>().Value() ? 1.0f : 0.0f;
+                } else {
+                    dither_amplitude = dither.As<Napi::Number>().FloatValue();
+                }
+            }
+            
+            if (options.Has("seed")) {
+                seed = options.Get("seed").As<Napi::Number>().Uint32Value();
+            }
+            
+            if (options.Has("out")) {
+                Napi::Value value = options.Get("out");
+                napi_typedarray_type type = value.IsTypedArray() ? value.As<Napi::TypedArray>().TypedArrayType() : napi_float32_array;
+                if (type != napi_int16_array && type != napi_uint8_array) {
+                    Napi::TypeError::New(env, "out must be an Int16Array or Buffer").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                out = value.As<Napi::TypedArray>();
+                has_out = true;
+            }
+        }
         
-        Napi::Int16Array result = Napi::Int16Array::New(env, num_samples);
+        Napi::TypedArray result;
+        if (has_out) {
+            if (out.ByteLength() < num_samples * 2) {
+                Napi::RangeError::New(env, "out is too small for the converted samples").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            // Byte outputs hold little-endian PCM unless told otherwise
+            if (out.TypedArrayType() == napi_uint8_array && !order_given) {
+                order = PCM_LITTLE_ENDIAN;
+            }
+            result = out;
+        } else if (order_given) {
+            // An explicit byte order asks for raw bytes
+            result = Napi::Buffer<uint8_t>::New(env, num_samples * 2);
+        } else {
+            result = Napi::Int16Array::New(env, num_samples);
+        }
+        
+        uint8_t* dest = TypedArrayBytes(result);
+        
+        if (dither_amplitude <= 0.0f) {
+            ConvertFloatToPcm16(samples.Data(), num_samples, order, nullptr, dest);
+            return result;
+        }
         
-        // Convert float32 to 16-bit PCM with clipping
-        for (int i = 0; i < num_samples; ++i) {
-            float sample = samples[i];
-            // Clamp to [-1.0, 1.0] range
-            sample = std::max(-1.0f, std::min(1.0f, sample));
-            result[i] = (int16_t)(sample * 32767.0f);
+        uint32_t state = seed ? seed : (uint32_t)std::random_device()() | 1u;
+        float dither[DITHER_CHUNK];
+        for (size_t offset = 0; offset < num_samples; offset += DITHER_CHUNK) {
+            size_t count = std::min(DITHER_CHUNK, num_samples - offset);
+            FillTpdfDither(&state, dither, count, dither_amplitude);
+            ConvertFloatToPcm16(samples.Data() + offset, count, order, dither, dest + offset * 2);
         }
         
         return result;
     });
 }
 
-Napi::Function AudioUtils::LoadWav(Napi::Env env) {
-    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
-        Napi::Env env = info.Env();
+namespace {
+
+/**
+ * Reads and converts a whole WAV file on a worker thread
+ */
+class LoadWavWorker : public Napi::AsyncWorker {
+public:
+    LoadWavWorker(Napi::Env env, const std::string& path)
+        : Napi::AsyncWorker(env, "ft8_lib:Audio.loadWav"),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(path),
+          samples_(new std::vector<float>()),
+          sample_rate_(0) {
+    }
+    
+    ~LoadWavWorker() {
+        delete samples_;
+    }
+    
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        TraceScope trace("loadWav", "audio");
         
-        if (info.Length() < 1 || !info[0].IsString()) {
-            Napi::TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
-            return env.Null();
+        WavFile file;
+        std::string error;
+        if (!file.Open(path_, &error)) {
+            SetError(error);
+            return;
         }
         
-        std::string filePath = info[0].As<Napi::String>().Utf8Value();
+        sample_rate_ = file.SampleRate();
+        samples_->resize((size_t)file.NumFrames());
+        samples_->resize(file.Read(samples_->data(), samples_->size()));
+    }
+    
+    void OnOK() override {
+        Napi::Env env = Env();
         
-        // Load WAV file using ft8_lib's wave functions
-        int num_samples = 0;
-        int sample_rate = 0;
+        Napi::Object audioBuffer = Napi::Object::New(env);
+        audioBuffer.Set("samples", AudioUtils::WrapSamples(env, samples_));
+        samples_ = nullptr;
+        audioBuffer.Set("sampleRate", Napi::Number::New(env, sample_rate_));
+        audioBuffer.Set("channels", Napi::Number::New(env, 1));
         
-        // First, get the file size to allocate buffer
-        // We'll use a reasonable maximum size for FT8/FT4 files
-        const int MAX_SAMPLES = 15 * 48000; // 15 seconds at 48kHz max
-        float* samples = new float[MAX_SAMPLES];
-        num_samples = MAX_SAMPLES;
+        deferred_.Resolve(audioBuffer);
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    std::vector<float>* samples_;
+    int sample_rate_;
+};
+
+/**
+ * Writes a Float32Array as 16-bit WAV on a worker thread
+ *
+ * The array is kept alive by a reference and read in place; callers must not
+ * modify it until the promise settles.
+ */
+class SaveWavWorker : public Napi::AsyncWorker {
+public:
+    SaveWavWorker(Napi::Env env, const std::string& path, Napi::Float32Array samples, int sample_rate)
+        : Napi::AsyncWorker(env, "ft8_lib:Audio.saveWav"),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(path),
+          samples_ref_(Napi::Reference<Napi::Float32Array>::New(samples, 1)),
+          data_(samples.Data()),
+          num_samples_(samples.ElementLength()),
+          sample_rate_(sample_rate) {
+    }
+    
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        TraceScope trace("saveWav", "audio");
         
-        int result = load_wav(samples, &num_samples, &sample_rate, filePath.c_str());
+        std::string error;
+        if (!WriteWav16(path_, data_, num_samples_, sample_rate_, &error)) {
+            SetError(error);
+        }
+    }
+    
+    void OnOK() override {
+        deferred_.Resolve(Env().Undefined());
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    Napi::Reference<Napi::Float32Array> samples_ref_;
+    const float* data_;
+    size_t num_samples_;
+    int sample_rate_;
+};
+
+} // namespace
+
+Napi::Function AudioUtils::LoadWav(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
         
-        if (result != 0) {
-            delete[] samples;
-            Napi::Error::New(env, "Failed to load WAV file").ThrowAsJavaScriptException();
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        // Create AudioBuffer object
-        Napi::Object audioBuffer = CreateAudioBuffer(env, samples, num_samples, sample_rate, 1);
-        
-        delete[] samples;
+        std::string filePath = info[0].As<Napi::String>().Utf8Value();
         
-        return audioBuffer;
+        // File I/O and sample conversion run on the libuv thread pool
+        LoadWavWorker* worker = new LoadWavWorker(env, filePath);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
     });
 }
 
@@ -127,16 +401,315 @@ Napi::Function AudioUtils::SaveWav(Napi::Env env) {
         
         Napi::Float32Array samples = audioBuffer.Get("samples").As<Napi::Float32Array>();
         int sample_rate = audioBuffer.Get("sampleRate").As<Napi::Number>().Int32Value();
-        int num_samples = samples.ElementLength();
         
-        // Save WAV file using ft8_lib's wave functions
-        int result = save_wav(samples.Data(), num_samples, sample_rate, filePath.c_str());
+        // The samples are written in place from the worker thread
+        SaveWavWorker* worker = new SaveWavWorker(env, filePath, samples, sample_rate);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    });
+}
+
+namespace {
+
+// Samples per noise block; each block draws from its own seeded generator so the
+// output does not depend on how the blocks are spread across threads
+const size_t SYNTH_NOISE_BLOCK = 4096;
+
+// Reference bandwidth for SNR figures, as used by WSJT-X
+const float SNR_REFERENCE_BANDWIDTH = 2500.0f;
+
+/**
+ * Small deterministic generator (SplitMix64) with a portable Gaussian
+ *
+ * std::normal_distribution differs between standard libraries, which would make
+ * a seeded band differ between platforms.
+ */
+struct SynthRandom {
+    uint64_t state;
+    
+    explicit SynthRandom(uint64_t seed) : state(seed) {}
+    
+    uint64_t Next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    
+    // Uniform in [0, 1)
+    double Uniform() {
+        return (Next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+    
+    double Uniform(double lo, double hi) {
+        return lo + (hi - lo) * Uniform();
+    }
+    
+    // Pair of independent standard normal values (Box-Muller)
+    void Gaussian(float* a, float* b) {
+        double u1 = Uniform();
+        double u2 = Uniform();
+        if (u1 < 1e-300) {
+            u1 = 1e-300;
+        }
+        double r = sqrt(-2.0 * log(u1));
+        *a = (float)(r * cos(2 * M_PI * u2));
+        *b = (float)(r * sin(2 * M_PI * u2));
+    }
+    
+    static uint64_t Derive(uint64_t seed, uint64_t stream, uint64_t index) {
+        SynthRandom mix(seed ^ (stream * 0xD1B54A32D192ED03ull) ^ (index * 0x9E3779B97F4A7C15ull));
+        return mix.Next();
+    }
+};
+
+/**
+ * One signal of a synthesized band
+ */
+struct SynthSignal {
+    std::string text;
+    float frequency;
+    float time_offset;
+    float snr;
+    float drift;
+    float amplitude;
+    uint16_t hash;
+    uint8_t tones[FT4_NN > FT8_NN ? FT4_NN : FT8_NN];
+    std::vector<float> wave;
+};
+
+std::string RandomStandardMessage(SynthRandom& rng) {
+    const char* letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string call;
+    call += letters[rng.Next() % 26];
+    if (rng.Next() % 2) {
+        call += letters[rng.Next() % 26];
+    }
+    call += (char)('0' + rng.Next() % 10);
+    int suffix_len = 1 + (int)(rng.Next() % 3);
+    for (int i = 0; i < suffix_len; ++i) {
+        call += letters[rng.Next() % 26];
+    }
+    
+    std::string grid;
+    grid += (char)('A' + rng.Next() % 18);
+    grid += (char)('A' + rng.Next() % 18);
+    grid += (char)('0' + rng.Next() % 10);
+    grid += (char)('0' + rng.Next() % 10);
+    
+    return "CQ " + call + " " + grid;
+}
+
+float GetFloatOption(const Napi::Object& obj, const char* key, float fallback) {
+    if (obj.Has(key) && obj.Get(key).IsNumber()) {
+        return obj.Get(key).As<Napi::Number>().FloatValue();
+    }
+    return fallback;
+}
+
+} // namespace
+
+Napi::Function AudioUtils::SynthesizeBand(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        TraceScope trace("synthesizeBand", "audio");
+        
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected band options object").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        Napi::Object options = info[0].As<Napi::Object>();
+        
+        ftx_protocol_t protocol = FTX_PROTOCOL_FT8;
+        if (options.Has("protocol")) {
+            std::string protocolStr = options.Get("protocol").As<Napi::String>().Utf8Value();
+            if (protocolStr == "FT8") {
+                protocol = FTX_PROTOCOL_FT8;
+            } else if (protocolStr == "FT4") {
+                protocol = FTX_PROTOCOL_FT4;
+            } else {
+                Napi::TypeError::New(env, "Invalid protocol. Must be 'FT8' or 'FT4'").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
         
-        if (result != 0) {
-            Napi::Error::New(env, "Failed to save WAV file").ThrowAsJavaScriptException();
+        int sample_rate = (int)GetFloatOption(options, "sampleRate", 12000.0f);
+        if (sample_rate <= 0) {
+            Napi::RangeError::New(env, "sampleRate must be positive").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        return env.Undefined();
+        float symbol_period = (protocol == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+        float slot_time = (protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+        float symbol_bt = (protocol == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_BT : FT4_SYMBOL_BT;
+        int num_tones = (protocol == FTX_PROTOCOL_FT8) ? FT8_NN : FT4_NN;
+        int n_wave = GfskSignalLength(num_tones, symbol_period, sample_rate);
+        
+        float duration = GetFloatOption(options, "duration", slot_time);
+        if (!(duration > 0) || !std::isfinite(duration)) {
+            Napi::RangeError::New(env, "duration must be a positive finite number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        size_t num_samples = (size_t)(duration * sample_rate);
+        
+        // Noise level is the RMS of the added white noise in dBFS; it is also the
+        // reference the per-signal SNRs are computed against
+        bool add_noise = true;
+        float noise_db = -30.0f;
+        if (options.Has("noiseDb")) {
+            Napi::Value value = options.Get("noiseDb");
+            if (value.IsNull()) {
+                add_noise = false;
+            } else if (value.IsNumber()) {
+                noise_db = value.As<Napi::Number>().FloatValue();
+            }
+        }
+        float noise_sigma = powf(10.0f, noise_db / 20.0f);
+        
+        uint64_t seed = 1;
+        if (options.Has("seed") && options.Get("seed").IsNumber()) {
+            seed = (uint64_t)options.Get("seed").As<Napi::Number>().Int64Value();
+        }
+        
+        // Ranges for any field a signal spec leaves out
+        float freq_min = GetFloatOption(options, "frequencyMin", 200.0f);
+        float freq_max = GetFloatOption(options, "frequencyMax", 2800.0f);
+        float snr_min = GetFloatOption(options, "snrMin", -20.0f);
+        float snr_max = GetFloatOption(options, "snrMax", 0.0f);
+        float max_start = std::max(0.0f, duration - n_wave / (float)sample_rate - 0.1f);
+        float time_min = GetFloatOption(options, "timeOffsetMin", 0.0f);
+        float time_max = GetFloatOption(options, "timeOffsetMax", std::min(max_start, 2.0f));
+        float drift_max = GetFloatOption(options, "driftMax", 0.0f);
+        
+        // Signal specs: either an array of objects or a count of random CQ calls
+        std::vector<Napi::Object> specs;
+        size_t num_signals = 0;
+        if (options.Has("signals")) {
+            Napi::Value value = options.Get("signals");
+            if (value.IsArray()) {
+                Napi::Array array = value.As<Napi::Array>();
+                num_signals = array.Length();
+                for (uint32_t i = 0; i < array.Length(); ++i) {
+                    Napi::Value spec = array.Get(i);
+                    specs.push_back(spec.IsObject() ? spec.As<Napi::Object>() : Napi::Object::New(env));
+                }
+            } else if (value.IsNumber()) {
+                num_signals = value.As<Napi::Number>().Uint32Value();
+            } else {
+                Napi::TypeError::New(env, "signals must be an array of signal specs or a count").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+        
+        // Resolve every signal parameter on this thread, in order, so results only depend on the seed
+        std::vector<SynthSignal> signals(num_signals);
+        for (size_t i = 0; i < num_signals; ++i) {
+            SynthRandom rng(SynthRandom::Derive(seed, 1, i));
+            Napi::Object spec = i < specs.size() ? specs[i] : Napi::Object::New(env);
+            SynthSignal& sig = signals[i];
+            
+            if (spec.Has("text") && spec.Get("text").IsString()) {
+                sig.text = spec.Get("text").As<Napi::String>().Utf8Value();
+            } else {
+                sig.text = RandomStandardMessage(rng);
+            }
+            sig.frequency = GetFloatOption(spec, "frequency", (float)rng.Uniform(freq_min, freq_max));
+            sig.time_offset = GetFloatOption(spec, "timeOffset", (float)rng.Uniform(time_min, time_max));
+            sig.snr = GetFloatOption(spec, "snr", (float)rng.Uniform(snr_min, snr_max));
+            sig.drift = GetFloatOption(spec, "drift", (float)rng.Uniform(-drift_max, drift_max));
+            
+            // Peak amplitude for the requested SNR in the 2500 Hz reference bandwidth
+            float snr_linear = powf(10.0f, sig.snr / 10.0f);
+            sig.amplitude = noise_sigma * sqrtf(snr_linear * 4.0f * SNR_REFERENCE_BANDWIDTH / sample_rate);
+            
+            ftx_message_t msg;
+            ftx_message_init(&msg);
+            if (ftx_message_encode(&msg, nullptr, sig.text.c_str()) != FTX_MESSAGE_RC_OK) {
+                Napi::Error::New(env, "Failed to encode message for signal " + std::to_string(i) + ": " + sig.text)
+                    .ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            sig.hash = msg.hash;
+            if (protocol == FTX_PROTOCOL_FT8) {
+                ft8_encode(msg.payload, sig.tones);
+            } else {
+                ft4_encode(msg.payload, sig.tones);
+            }
+        }
+        
+        // Render waveforms in parallel, one signal per task
+        ParallelFor(num_signals, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                SynthSignal& sig = signals[i];
+                sig.wave.resize(n_wave);
+                GenerateGfskSignal(sig.tones, num_tones, sig.frequency, symbol_bt,
+                                   symbol_period, sample_rate, sig.wave.data(), sig.drift);
+            }
+        });
+        
+        // Mix signals and noise in fixed-size blocks; summation order is always signal order
+        Napi::Float32Array samples = Napi::Float32Array::New(env, num_samples);
+        float* out = samples.Data();
+        size_t num_blocks = (num_samples + SYNTH_NOISE_BLOCK - 1) / SYNTH_NOISE_BLOCK;
+        
+        ParallelFor(num_blocks, 4, [&](size_t block_begin, size_t block_end) {
+            for (size_t block = block_begin; block < block_end; ++block) {
+                size_t start = block * SYNTH_NOISE_BLOCK;
+                size_t stop = std::min(num_samples, start + SYNTH_NOISE_BLOCK);
+                std::fill(out + start, out + stop, 0.0f);
+                
+                for (const SynthSignal& sig : signals) {
+                    long long sig_start = llroundf(sig.time_offset * sample_rate);
+                    long long from = std::max<long long>((long long)start, sig_start);
+                    long long to = std::min<long long>((long long)stop, sig_start + n_wave);
+                    for (long long k = from; k < to; ++k) {
+                        out[k] += sig.amplitude * sig.wave[k - sig_start];
+                    }
+                }
+                
+                if (add_noise) {
+                    SynthRandom rng(SynthRandom::Derive(seed, 2, block));
+                    for (size_t k = start; k < stop; k += 2) {
+                        float n0, n1;
+                        rng.Gaussian(&n0, &n1);
+                        out[k] += noise_sigma * n0;
+                        if (k + 1 < stop) {
+                            out[k + 1] += noise_sigma * n1;
+                        }
+                    }
+                }
+            }
+        });
+        
+        // Ground truth, in the same units the decoder reports
+        Napi::Array truth = Napi::Array::New(env, num_signals);
+        for (size_t i = 0; i < num_signals; ++i) {
+            const SynthSignal& sig = signals[i];
+            Napi::Object entry = Napi::Object::New(env);
+            entry.Set("text", Napi::String::New(env, sig.text));
+            entry.Set("frequency", Napi::Number::New(env, sig.frequency));
+            entry.Set("timeOffset", Napi::Number::New(env, sig.time_offset));
+            entry.Set("snr", Napi::Number::New(env, sig.snr));
+            entry.Set("drift", Napi::Number::New(env, sig.drift));
+            entry.Set("amplitude", Napi::Number::New(env, sig.amplitude));
+            entry.Set("hash", Napi::Number::New(env, sig.hash));
+            truth.Set(static_cast<uint32_t>(i), entry);
+        }
+        
+        Napi::Object audio = Napi::Object::New(env);
+        audio.Set("samples", samples);
+        audio.Set("sampleRate", Napi::Number::New(env, sample_rate));
+        audio.Set("channels", Napi::Number::New(env, 1));
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("audio", audio);
+        result.Set("signals", truth);
+        result.Set("protocol", Napi::String::New(env, (protocol == FTX_PROTOCOL_FT8) ? "FT8" : "FT4"));
+        result.Set("noiseDb", add_noise ? Napi::Number::New(env, noise_db) : env.Null());
+        result.Set("seed", Napi::Number::New(env, (double)seed));
+        
+        return result;
     });
 }
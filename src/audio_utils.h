@@ -2,6 +2,7 @@
 #define AUDIO_UTILS_H
 
 #include <napi.h>
+#include <vector>
 
 /**
  * AudioUtils class provides utility functions for audio processing
@@ -38,19 +39,28 @@ public:
      * @return N-API function that saves WAV files
      */
     static Napi::Function SaveWav(Napi::Env env);
-
-private:
+    
+    /**
+     * Synthesize a band of overlapping FT8/FT4 signals with AWGN
+     * @param env N-API environment
+     * @return N-API function that renders a deterministic test slot and its ground truth
+     */
+    static Napi::Function SynthesizeBand(Napi::Env env);
+    
+    /**
+     * Open a WAV file for slot-by-slot streaming
+     * @param env N-API environment
+     * @return N-API function that creates a WavReader async iterator
+     */
+    static Napi::Function OpenWav(Napi::Env env);
+    
     /**
-     * Create an AudioBuffer object from samples and metadata
+     * Wrap a heap sample buffer in a Float32Array without copying
      * @param env N-API environment
-     * @param samples Audio samples
-     * @param num_samples Number of samples
-     * @param sample_rate Sample rate in Hz
-     * @param channels Number of channels
-     * @return AudioBuffer object
+     * @param samples Sample buffer; ownership passes to the returned array
+     * @return Float32Array backed by the buffer's memory
      */
-    static Napi::Object CreateAudioBuffer(Napi::Env env, const float* samples, 
-                                         int num_samples, int sample_rate, int channels);
+    static Napi::Float32Array WrapSamples(Napi::Env env, std::vector<float>* samples);
 };
 
 #endif // AUDIO_UTILS_H
@@ -0,0 +1,246 @@
+#include "callsign_hash.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const char CALLSIGN_HASH_MAGIC[4] = {'F', 'T', 'X', 'H'};
+
+// Characters of a hashed callsign, in ft8_lib's order
+const char CALLSIGN_ALPHABET[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ/";
+const int MAX_CALLSIGN_LENGTH = 11;
+const uint32_t HASH22_MASK = 0x3FFFFFu;
+
+// Callsigns handed to one thread while hashing a list
+const size_t HASHES_PER_THREAD = 16384;
+
+// Buckets of the first sorting pass, one per 10-bit hash
+const uint32_t NUM_INDEX_BUCKETS = 1024;
+
+int AlphabetIndex(char c) {
+    for (int i = 0; CALLSIGN_ALPHABET[i] != '\0'; ++i) {
+        if (CALLSIGN_ALPHABET[i] == c) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool HashLess(const CallsignHash& a, const CallsignHash& b) {
+    return a.n22 < b.n22 || (a.n22 == b.n22 && strcmp(a.callsign, b.callsign) < 0);
+}
+
+bool HashEqual(const CallsignHash& a, const CallsignHash& b) {
+    return a.n22 == b.n22 && strcmp(a.callsign, b.callsign) == 0;
+}
+
+void PutU16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+void PutU32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+uint16_t GetU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+} // namespace
+
+bool ComputeCallsignHash(const char* callsign, uint32_t* n22) {
+    if (callsign[0] == '\0') {
+        return false;
+    }
+
+    // Base 38 number of the callsign, padded with spaces to 11 characters
+    uint64_t n58 = 0;
+    int i = 0;
+    for (; callsign[i] != '\0'; ++i) {
+        int j = AlphabetIndex(callsign[i]);
+        if (i >= MAX_CALLSIGN_LENGTH || j < 0) {
+            return false;
+        }
+        n58 = 38 * n58 + j;
+    }
+    for (; i < MAX_CALLSIGN_LENGTH; ++i) {
+        n58 = 38 * n58;
+    }
+
+    *n22 = (uint32_t)((47055833459ull * n58) >> (64 - 22)) & HASH22_MASK;
+    return true;
+}
+
+int CallsignHashShift(ftx_callsign_hash_type_t type) {
+    switch (type) {
+        case FTX_CALLSIGN_HASH_10_BITS: return 12;
+        case FTX_CALLSIGN_HASH_12_BITS: return 10;
+        default: return 0;
+    }
+}
+
+const char* CallsignHashTypeName(ftx_callsign_hash_type_t type) {
+    switch (type) {
+        case FTX_CALLSIGN_HASH_10_BITS: return "10_BITS";
+        case FTX_CALLSIGN_HASH_12_BITS: return "12_BITS";
+        default: return "22_BITS";
+    }
+}
+
+void SplitCallsignList(const char* text, size_t size, std::vector<std::string>* callsigns) {
+    size_t begin = 0;
+    for (size_t i = 0; i <= size; ++i) {
+        if (i == size || isspace((unsigned char)text[i]) || text[i] == ',') {
+            if (i > begin) {
+                callsigns->emplace_back(text + begin, i - begin);
+            }
+            begin = i + 1;
+        }
+    }
+}
+
+std::shared_ptr<const CallsignIndex> CallsignIndex::Build(const std::vector<std::string>& callsigns, unsigned threads,
+                                                          size_t* rejected) {
+    // Hash every callsign; the ones that cannot be hashed are marked with an
+    // out of range hash
+    std::vector<CallsignHash> hashed(callsigns.size());
+    ParallelFor(callsigns.size(), HASHES_PER_THREAD, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            CallsignHash& entry = hashed[i];
+            entry.n22 = UINT32_MAX;
+            const std::string& callsign = callsigns[i];
+            if (callsign.size() > MAX_CALLSIGN_LENGTH) {
+                continue;
+            }
+            for (size_t c = 0; c < callsign.size(); ++c) {
+                entry.callsign[c] = (char)toupper((unsigned char)callsign[c]);
+            }
+            memset(entry.callsign + callsign.size(), 0, sizeof(entry.callsign) - callsign.size());
+            if (!ComputeCallsignHash(entry.callsign, &entry.n22)) {
+                entry.n22 = UINT32_MAX;
+            }
+        }
+    }, threads);
+
+    // Distribute by 10-bit hash, then sort the buckets in parallel
+    std::vector<size_t> bucket_start(NUM_INDEX_BUCKETS + 1, 0);
+    for (const CallsignHash& entry : hashed) {
+        if (entry.n22 != UINT32_MAX) {
+            bucket_start[(entry.n22 >> 12) + 1]++;
+        }
+    }
+    for (uint32_t b = 0; b < NUM_INDEX_BUCKETS; ++b) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+
+    size_t valid = bucket_start[NUM_INDEX_BUCKETS];
+    if (rejected) {
+        *rejected = callsigns.size() - valid;
+    }
+
+    auto index = std::make_shared<CallsignIndex>();
+    index->entries_.resize(valid);
+    std::vector<size_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (const CallsignHash& entry : hashed) {
+        if (entry.n22 != UINT32_MAX) {
+            index->entries_[fill[entry.n22 >> 12]++] = entry;
+        }
+    }
+    hashed = std::vector<CallsignHash>();
+
+    std::vector<CallsignHash>& entries = index->entries_;
+    ParallelFor(NUM_INDEX_BUCKETS, NUM_INDEX_BUCKETS / 64, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            std::sort(entries.begin() + bucket_start[b], entries.begin() + bucket_start[b + 1], HashLess);
+        }
+    }, threads);
+
+    entries.erase(std::unique(entries.begin(), entries.end(), HashEqual), entries.end());
+    entries.shrink_to_fit();
+    return index;
+}
+
+bool CallsignIndex::Lookup(ftx_callsign_hash_type_t type, uint32_t hash, char* callsign) const {
+    int shift = CallsignHashShift(type);
+    uint32_t first = (hash & (HASH22_MASK >> shift)) << shift;
+    uint32_t last = first + (1u << shift);
+
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), first,
+                               [](const CallsignHash& entry, uint32_t n22) { return entry.n22 < n22; });
+    if (it == entries_.end() || it->n22 >= last) {
+        return false;
+    }
+    auto next = it + 1;
+    if (next != entries_.end() && next->n22 < last) {
+        return false;
+    }
+    strcpy(callsign, it->callsign);
+    return true;
+}
+
+size_t CallsignHashesSize(size_t count) {
+    return CALLSIGN_HASH_HEADER_SIZE + count * CALLSIGN_HASH_ENTRY_SIZE;
+}
+
+void WriteCallsignHashes(const std::vector<CallsignHash>& entries, uint8_t* out) {
+    memset(out, 0, CallsignHashesSize(entries.size()));
+    memcpy(out, CALLSIGN_HASH_MAGIC, sizeof(CALLSIGN_HASH_MAGIC));
+    PutU16(out + 4, CALLSIGN_HASH_FORMAT_VERSION);
+    PutU16(out + 6, (uint16_t)CALLSIGN_HASH_HEADER_SIZE);
+    PutU32(out + 8, (uint32_t)entries.size());
+
+    uint8_t* p = out + CALLSIGN_HASH_HEADER_SIZE;
+    for (const CallsignHash& entry : entries) {
+        PutU32(p, entry.n22);
+        memcpy(p + 4, entry.callsign, strnlen(entry.callsign, sizeof(entry.callsign)));
+        p += CALLSIGN_HASH_ENTRY_SIZE;
+    }
+}
+
+bool ReadCallsignHashes(const uint8_t* data, size_t size, std::vector<CallsignHash>* entries, std::string* error) {
+    if (size < CALLSIGN_HASH_HEADER_SIZE || memcmp(data, CALLSIGN_HASH_MAGIC, sizeof(CALLSIGN_HASH_MAGIC)) != 0) {
+        *error = "Not a callsign hash snapshot";
+        return false;
+    }
+    uint16_t version = GetU16(data + 4);
+    if (version == 0 || version > CALLSIGN_HASH_FORMAT_VERSION) {
+        *error = "Unsupported callsign hash snapshot version " + std::to_string(version);
+        return false;
+    }
+    if (GetU16(data + 6) != CALLSIGN_HASH_HEADER_SIZE) {
+        *error = "Unexpected callsign hash snapshot header size";
+        return false;
+    }
+    uint32_t count = GetU32(data + 8);
+    if ((size - CALLSIGN_HASH_HEADER_SIZE) / CALLSIGN_HASH_ENTRY_SIZE < count) {
+        *error = "Callsign hash snapshot is truncated";
+        return false;
+    }
+
+    entries->clear();
+    entries->reserve(count);
+    const uint8_t* p = data + CALLSIGN_HASH_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; ++i, p += CALLSIGN_HASH_ENTRY_SIZE) {
+        CallsignHash entry;
+        entry.n22 = GetU32(p);
+        memcpy(entry.callsign, p + 4, sizeof(entry.callsign));
+
+        uint32_t n22;
+        if (memchr(entry.callsign, '\0', sizeof(entry.callsign)) == nullptr ||
+            !ComputeCallsignHash(entry.callsign, &n22) || n22 != entry.n22) {
+            *error = "Invalid entry " + std::to_string(i) + " in callsign hash snapshot";
+            return false;
+        }
+        entries->push_back(entry);
+    }
+    return true;
+}
@@ -0,0 +1,139 @@
+#ifndef CALLSIGN_HASH_H
+#define CALLSIGN_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <ft8/message.h>
+}
+
+/**
+ * Callsign with its 22-bit hash
+ */
+struct CallsignHash {
+    char callsign[12];
+    uint32_t n22;
+};
+
+/**
+ * Hash lookup that could not be resolved during a decode
+ */
+struct CallsignHashRequest {
+    ftx_callsign_hash_type_t type;
+    uint32_t hash;
+
+    bool operator==(const CallsignHashRequest& other) const { return type == other.type && hash == other.hash; }
+};
+
+/**
+ * Compute the 22-bit hash of a callsign the way ft8_lib does
+ *
+ * The 12 and 10-bit hashes of a callsign are the top bits of its 22-bit hash.
+ *
+ * @param callsign Callsign of up to 11 characters from A-Z, 0-9, space and /
+ * @param n22 Receives the hash
+ * @return false if the callsign is too long or has other characters
+ */
+bool ComputeCallsignHash(const char* callsign, uint32_t* n22);
+
+/**
+ * Number of bits a hash of the given type is shifted right from the 22-bit hash
+ */
+int CallsignHashShift(ftx_callsign_hash_type_t type);
+
+/**
+ * Name of a hash type, as reported to JavaScript
+ * @return "22_BITS", "12_BITS" or "10_BITS"
+ */
+const char* CallsignHashTypeName(ftx_callsign_hash_type_t type);
+
+/**
+ * Split a callsign list into callsigns
+ * @param text Callsigns separated by whitespace or commas, e.g. one per line
+ * @param size Length of text
+ * @param callsigns Receives the callsigns
+ */
+void SplitCallsignList(const char* text, size_t size, std::vector<std::string>* callsigns);
+
+/**
+ * Read-only index of a large callsign list
+ *
+ * Entries are sorted by 22-bit hash. Since the 12 and 10-bit hashes are
+ * prefixes of it, every hash width is a single binary search over the same
+ * array. A hash that matches more than one callsign is ambiguous and is not
+ * resolved, so a big list never turns a <...> into a wrong callsign.
+ */
+class CallsignIndex {
+public:
+    /**
+     * Build an index
+     *
+     * Hashes are computed in parallel; duplicates are dropped.
+     *
+     * @param callsigns Callsigns to index
+     * @param threads Worker threads (0 = hardware concurrency)
+     * @param rejected Receives the number of callsigns that cannot be hashed, if not null
+     */
+    static std::shared_ptr<const CallsignIndex> Build(const std::vector<std::string>& callsigns,
+                                                      unsigned threads = 0, size_t* rejected = nullptr);
+
+    /**
+     * Look up the callsign of a hash
+     * @param type Width of the hash
+     * @param hash Hash value
+     * @param callsign Receives the callsign (at least 12 bytes)
+     * @return true if exactly one callsign has this hash
+     */
+    bool Lookup(ftx_callsign_hash_type_t type, uint32_t hash, char* callsign) const;
+
+    /**
+     * Number of distinct callsigns in the index
+     */
+    size_t Size() const { return entries_.size(); }
+
+private:
+    std::vector<CallsignHash> entries_;
+};
+
+/**
+ * Binary snapshot of a callsign hash table
+ *
+ * A 16-byte little-endian header is followed by the entries, 16 bytes each:
+ * the 22-bit hash as u32 and the callsign, NUL padded to 12 bytes.
+ *
+ *   0  "FTXH"   4  u16 version   6  u16 header size   8  u32 count
+ *  12  u32 reserved (zero)
+ */
+
+// Current format version; readers reject newer versions
+const uint16_t CALLSIGN_HASH_FORMAT_VERSION = 1;
+const size_t CALLSIGN_HASH_HEADER_SIZE = 16;
+const size_t CALLSIGN_HASH_ENTRY_SIZE = 16;
+
+/**
+ * Size in bytes of a snapshot
+ */
+size_t CallsignHashesSize(size_t count);
+
+/**
+ * Write a snapshot
+ * @param entries Entries to write
+ * @param out Receives CallsignHashesSize(entries.size()) bytes
+ */
+void WriteCallsignHashes(const std::vector<CallsignHash>& entries, uint8_t* out);
+
+/**
+ * Parse and validate a snapshot
+ * @param data Snapshot bytes
+ * @param size Number of bytes available
+ * @param entries Receives the entries
+ * @param error Receives a description of the problem on failure
+ * @return true if the snapshot is complete and every entry matches its hash
+ */
+bool ReadCallsignHashes(const uint8_t* data, size_t size, std::vector<CallsignHash>* entries, std::string* error);
+
+#endif // CALLSIGN_HASH_H
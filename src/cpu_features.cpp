@@ -0,0 +1,99 @@
+#include "cpu_features.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace {
+
+CpuFeatures DetectCpuFeatures() {
+    CpuFeatures features;
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    // Also checks that the OS saves the AVX and AVX-512 register state
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx = __builtin_cpu_supports("avx");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.fma = __builtin_cpu_supports("fma");
+    features.avx512f = __builtin_cpu_supports("avx512f");
+    features.avx512bw = __builtin_cpu_supports("avx512bw");
+    features.avx512vl = __builtin_cpu_supports("avx512vl");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 0);
+    int max_leaf = regs[0];
+    __cpuid(regs, 1);
+    int ecx1 = regs[2];
+    int edx1 = regs[3];
+    int ebx7 = 0;
+    if (max_leaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        ebx7 = regs[1];
+    }
+
+    // The OS must save the YMM (and for AVX-512 the opmask and ZMM) state
+    unsigned long long xcr0 = (ecx1 & (1 << 27)) ? _xgetbv(0) : 0;
+    bool ymm_state = (xcr0 & 0x6) == 0x6;
+    bool zmm_state = (xcr0 & 0xe6) == 0xe6;
+
+    features.sse2 = (edx1 & (1 << 26)) != 0;
+    features.sse42 = (ecx1 & (1 << 20)) != 0;
+    features.avx = ymm_state && (ecx1 & (1 << 28));
+    features.fma = ymm_state && (ecx1 & (1 << 12));
+    features.avx2 = ymm_state && (ebx7 & (1 << 5));
+    features.avx512f = zmm_state && (ebx7 & (1 << 16));
+    features.avx512bw = zmm_state && (ebx7 & (1 << 30));
+    features.avx512vl = zmm_state && (ebx7 & (1u << 31));
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    features.neon = true;
+#endif
+    return features;
+}
+
+KernelIsa SelectKernelIsa() {
+    const CpuFeatures& features = GetCpuFeatures();
+#if defined(KERNEL_HAVE_X86_VARIANTS)
+    KernelIsa best = KERNEL_ISA_BASELINE;
+    if (features.avx512f && features.avx512bw && features.avx512vl) {
+        best = KERNEL_ISA_AVX512;
+    } else if (features.avx2) {
+        best = KERNEL_ISA_AVX2;
+    }
+
+    // A lower variant can be forced, never one the CPU lacks
+    const char* forced = getenv("FT8_LIB_KERNELS");
+    if (forced && strcmp(forced, "baseline") == 0) {
+        return KERNEL_ISA_BASELINE;
+    }
+    if (forced && strcmp(forced, "avx2") == 0 && best == KERNEL_ISA_AVX512) {
+        return KERNEL_ISA_AVX2;
+    }
+    return best;
+#else
+    return features.neon ? KERNEL_ISA_NEON : KERNEL_ISA_BASELINE;
+#endif
+}
+
+} // namespace
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+KernelIsa ActiveKernelIsa() {
+    static const KernelIsa isa = SelectKernelIsa();
+    return isa;
+}
+
+const char* KernelIsaName(KernelIsa isa) {
+    switch (isa) {
+        case KERNEL_ISA_AVX2: return "avx2";
+        case KERNEL_ISA_AVX512: return "avx512";
+        case KERNEL_ISA_NEON: return "neon";
+        default: return "baseline";
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * Runtime CPU feature detection and selection of the hot kernel variants
+ *
+ * Prebuilt binaries target the baseline instruction set. On x86 with GCC or
+ * Clang the hot decode, LDPC and GFSK kernels are additionally compiled for
+ * AVX2 and AVX-512, and the best variant the CPU supports is selected once
+ * when the module loads; on x64 ft8_lib's monitor and FFT follow the same
+ * selection (see monitor_kernels.h). On arm64 NEON is part of the baseline.
+ */
+
+// x86 builds with GCC or Clang carry AVX2 and AVX-512 variants of the hot kernels.
+// A variant is a flattened wrapper: the baseline kernel inlined and compiled for the target.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define KERNEL_HAVE_X86_VARIANTS 1
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2"), flatten))
+#define KERNEL_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl"), flatten))
+#endif
+
+/**
+ * Instruction set a kernel variant is compiled for
+ */
+enum KernelIsa {
+    KERNEL_ISA_BASELINE,
+    KERNEL_ISA_AVX2,
+    KERNEL_ISA_AVX512,
+    // arm64 baseline, which always includes NEON
+    KERNEL_ISA_NEON
+};
+
+/**
+ * Instruction set extensions of the host CPU that the operating system enables
+ */
+struct CpuFeatures {
+    bool sse2 = false;
+    bool sse42 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool neon = false;
+};
+
+/**
+ * Features of the host CPU, detected on first use
+ */
+const CpuFeatures& GetCpuFeatures();
+
+/**
+ * Kernel variant in use, selected on first use
+ *
+ * The best variant the CPU supports, unless the FT8_LIB_KERNELS environment
+ * variable names a lower one ("baseline" or "avx2"), e.g. to compare them.
+ */
+KernelIsa ActiveKernelIsa();
+
+/**
+ * Name of a kernel variant
+ * @return "baseline", "avx2", "avx512" or "neon"
+ */
+const char* KernelIsaName(KernelIsa isa);
+
+#endif // CPU_FEATURES_H
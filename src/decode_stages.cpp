@@ -0,0 +1,623 @@
+#include "decode_stages.h"
+#include "protocol_traits.h"
+#include "cpu_features.h"
+#include <algorithm>
+#include <cmath>
+
+// The AVX-512 variants must round like the baseline, so no fused multiply-adds;
+// GCC builds get -ffp-contract=off from binding.gyp instead
+#ifdef __clang__
+#pragma clang fp contract(off)
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+extern "C" {
+#include <ft8/crc.h>
+}
+
+// Noise bandwidth of the monitor's Hann window, in FFT bins
+const float HANN_NOISE_BANDWIDTH = 1.5f;
+
+// Reference bandwidth of reported SNRs, and the lowest SNR reported
+const float SNR_REFERENCE_BANDWIDTH = 2500.0f;
+const float SNR_MIN_DB = -24.0f;
+
+// Scale of min-sum check messages, compensating for their overestimated magnitude
+const float MIN_SUM_SCALE = 0.75f;
+
+namespace {
+
+/**
+ * Linear power of each quantized waterfall magnitude
+ */
+const float* PowerTable() {
+    static const std::vector<float> table = []() {
+        std::vector<float> powers(1 << (8 * sizeof(WF_ELEM_T)));
+        for (size_t i = 0; i < powers.size(); ++i) {
+            powers[i] = powf(10.0f, WF_ELEM_MAG((WF_ELEM_T)i) / 10.0f);
+        }
+        return powers;
+    }();
+    return table.data();
+}
+
+/**
+ * Scale the log-likelihoods to the variance the LDPC decoder was tuned for
+ */
+void NormalizeLikelihood(float* log174) {
+    float sum = 0;
+    float sum2 = 0;
+    for (int i = 0; i < FTX_LDPC_N; ++i) {
+        sum += log174[i];
+        sum2 += log174[i] * log174[i];
+    }
+    float inv_n = 1.0f / FTX_LDPC_N;
+    float variance = (sum2 - (sum * sum * inv_n)) * inv_n;
+
+    float norm_factor = sqrtf(24.0f / variance);
+    for (int i = 0; i < FTX_LDPC_N; ++i) {
+        log174[i] *= norm_factor;
+    }
+}
+
+// Rational approximations used by ft8_lib's belief propagation
+float FastTanh(float x) {
+    if (x < -4.97f) {
+        return -1.0f;
+    }
+    if (x > 4.97f) {
+        return 1.0f;
+    }
+    float x2 = x * x;
+    float a = x * (945.0f + x2 * (105.0f + x2));
+    float b = 945.0f + x2 * (420.0f + x2 * 15.0f);
+    return a / b;
+}
+
+float FastAtanh(float x) {
+    float x2 = x * x;
+    float a = x * (945.0f + x2 * (-735.0f + x2 * 64.0f));
+    float b = (945.0f + x2 * (-1050.0f + x2 * 225.0f));
+    return a / b;
+}
+
+/**
+ * Number of parity checks a codeword fails
+ */
+int LdpcCheck(const uint8_t* codeword) {
+    int errors = 0;
+    for (int m = 0; m < FTX_LDPC_M; ++m) {
+        uint8_t x = 0;
+        for (int i = 0; i < kFTX_LDPC_Num_rows[m]; ++i) {
+            x ^= codeword[kFTX_LDPC_Nm[m][i] - 1];
+        }
+        if (x != 0) {
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+void PackBits(const uint8_t* bits, int num_bits, uint8_t* packed) {
+    int num_bytes = (num_bits + 7) / 8;
+    for (int i = 0; i < num_bytes; ++i) {
+        packed[i] = 0;
+    }
+
+    uint8_t mask = 0x80;
+    int byte_idx = 0;
+    for (int i = 0; i < num_bits; ++i) {
+        if (bits[i]) {
+            packed[byte_idx] |= mask;
+        }
+        mask >>= 1;
+        if (!mask) {
+            mask = 0x80;
+            ++byte_idx;
+        }
+    }
+}
+
+/**
+ * Magnitudes of the first symbol of a candidate
+ */
+template <typename Osr>
+const WF_ELEM_T* CandidateMagnitudes(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate) {
+    int offset = candidate->time_offset;
+    offset = (offset * Osr::Time(wf->time_osr)) + candidate->time_sub;
+    offset = (offset * Osr::Freq(wf->freq_osr)) + candidate->freq_sub;
+    offset = (offset * wf->num_bins) + candidate->freq_offset;
+    return wf->mag + offset;
+}
+
+/**
+ * Distance between the rows of consecutive symbols
+ */
+template <typename Osr>
+int BlockStride(const ftx_waterfall_t* wf) {
+    return Osr::Time(wf->time_osr) * Osr::Freq(wf->freq_osr) * wf->num_bins;
+}
+
+/**
+ * Log-likelihoods of the bits of one symbol: for every bit, the strongest
+ * tone whose Gray code has the bit set against the strongest that has it clear
+ */
+template <typename Proto>
+void ExtractSymbol(const WF_ELEM_T* mag, float* logl) {
+    float s2[Proto::num_tones];
+    const uint8_t* gray_map = Proto::GrayMap();
+    for (int j = 0; j < Proto::num_tones; ++j) {
+        s2[j] = WF_ELEM_MAG(mag[gray_map[j]]);
+    }
+    for (int b = 0; b < Proto::bits_per_symbol; ++b) {
+        int mask = 1 << (Proto::bits_per_symbol - 1 - b);
+        float max_one = -INFINITY;
+        float max_zero = -INFINITY;
+        for (int j = 0; j < Proto::num_tones; ++j) {
+            if (j & mask) {
+                max_one = std::max(max_one, s2[j]);
+            } else {
+                max_zero = std::max(max_zero, s2[j]);
+            }
+        }
+        logl[b] = max_one - max_zero;
+    }
+}
+
+template <typename Proto, typename Osr>
+void ExtractLikelihoodKernel(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate, float* log174) {
+    const WF_ELEM_T* mag = CandidateMagnitudes<Osr>(wf, candidate);
+    int block_stride = BlockStride<Osr>(wf);
+
+    for (int k = 0; k < Proto::num_data_symbols; ++k) {
+        int sym_idx = Proto::DataSymbol(k);
+        int bit_idx = Proto::bits_per_symbol * k;
+        int block = candidate->time_offset + sym_idx;
+
+        if (block < 0 || block >= wf->num_blocks) {
+            for (int b = 0; b < Proto::bits_per_symbol; ++b) {
+                log174[bit_idx + b] = 0;
+            }
+        } else {
+            ExtractSymbol<Proto>(mag + sym_idx * block_stride, log174 + bit_idx);
+        }
+    }
+    NormalizeLikelihood(log174);
+}
+
+/**
+ * Costas sync score of a candidate, as ft8_lib's ft8_sync_score() and ft4_sync_score()
+ */
+template <typename Proto, typename Osr>
+int SyncScore(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate) {
+    const WF_ELEM_T* mag = CandidateMagnitudes<Osr>(wf, candidate);
+    int block_stride = BlockStride<Osr>(wf);
+    int score = 0;
+    int num_average = 0;
+
+    for (int m = 0; m < Proto::num_sync; ++m) {
+        for (int k = 0; k < Proto::length_sync; ++k) {
+            int block = Proto::first_sync_symbol + (Proto::sync_offset * m) + k;
+            int block_abs = candidate->time_offset + block;
+            if (block_abs < 0) {
+                continue;
+            }
+            if (block_abs >= wf->num_blocks) {
+                break;
+            }
+
+            const WF_ELEM_T* p = mag + (block * block_stride);
+            int sm = Proto::SyncTone(m, k);
+
+            // The sync tone against its neighbours in frequency and time
+            if (sm > 0) {
+                score += WF_ELEM_MAG_INT(p[sm]) - WF_ELEM_MAG_INT(p[sm - 1]);
+                ++num_average;
+            }
+            if (sm < Proto::num_tones - 1) {
+                score += WF_ELEM_MAG_INT(p[sm]) - WF_ELEM_MAG_INT(p[sm + 1]);
+                ++num_average;
+            }
+            if ((k > 0) && (block_abs > 0)) {
+                score += WF_ELEM_MAG_INT(p[sm]) - WF_ELEM_MAG_INT(p[sm - block_stride]);
+                ++num_average;
+            }
+            if (((k + 1) < Proto::length_sync) && ((block_abs + 1) < wf->num_blocks)) {
+                score += WF_ELEM_MAG_INT(p[sm]) - WF_ELEM_MAG_INT(p[sm + block_stride]);
+                ++num_average;
+            }
+        }
+    }
+
+    return (num_average > 0) ? score / num_average : score;
+}
+
+template <typename Proto, typename Osr>
+int FindCandidatesInRangeKernel(const ftx_waterfall_t* wf, const CandidateRange& range, int min_score,
+                                int max_candidates, ftx_candidate_t* candidates) {
+    int bin_min = std::max(range.bin_min, 0);
+    int bin_max = std::min(range.bin_max, wf->num_bins - Proto::num_tones);
+    int time_osr = Osr::Time(wf->time_osr);
+    int freq_osr = Osr::Freq(wf->freq_osr);
+
+    std::vector<ftx_candidate_t> found;
+    ftx_candidate_t candidate;
+    for (int time_sub = 0; time_sub < time_osr; ++time_sub) {
+        for (int freq_sub = 0; freq_sub < freq_osr; ++freq_sub) {
+            for (int time_offset = range.time_min; time_offset <= range.time_max; ++time_offset) {
+                for (int freq_offset = bin_min; freq_offset <= bin_max; ++freq_offset) {
+                    candidate.time_sub = (uint8_t)time_sub;
+                    candidate.freq_sub = (uint8_t)freq_sub;
+                    candidate.time_offset = (int16_t)time_offset;
+                    candidate.freq_offset = (int16_t)freq_offset;
+                    int score = SyncScore<Proto, Osr>(wf, &candidate);
+                    if (score < min_score) {
+                        continue;
+                    }
+                    candidate.score = (int16_t)score;
+                    found.push_back(candidate);
+                }
+            }
+        }
+    }
+
+    // A narrow region yields few candidates, so a sort is cheaper than ft8_lib's heap
+    int count = std::min((int)found.size(), max_candidates);
+    std::partial_sort(found.begin(), found.begin() + count, found.end(),
+                      [](const ftx_candidate_t& a, const ftx_candidate_t& b) { return a.score > b.score; });
+    std::copy(found.begin(), found.begin() + count, candidates);
+    return count;
+}
+
+template <typename Proto, typename Osr>
+float EstimateSnrKernel(const ftx_waterfall_t* wf, const std::vector<float>& noise_floor,
+                        const ftx_candidate_t* candidate, const uint8_t* tones) {
+    const float* power = PowerTable();
+    const WF_ELEM_T* mag = CandidateMagnitudes<Osr>(wf, candidate);
+    int block_stride = BlockStride<Osr>(wf);
+    const float* floor = noise_floor.data() + candidate->freq_sub * wf->num_bins + candidate->freq_offset;
+
+    float signal = 0;
+    float noise = 0;
+    for (int i = Proto::first_full_symbol; i < Proto::end_full_symbol; ++i) {
+        int block = candidate->time_offset + i;
+        if (block < 0 || block >= wf->num_blocks) {
+            continue;
+        }
+        signal += power[mag[i * block_stride + tones[i]]];
+        noise += floor[tones[i]];
+    }
+    if (noise <= 0) {
+        return SNR_MIN_DB;
+    }
+
+    // The measured power holds the noise of the bin as well
+    float ratio = std::max(signal / noise - 1.0f, 1e-3f);
+
+    // The analysis window spans freq_osr symbols, so a symbol fills only part
+    // of it; the coherent gain of a centred symbol under a Hann window is
+    // 1/F + sin(pi/F)/pi. Noise is measured in the window's noise bandwidth.
+    float span = (float)Osr::Freq(wf->freq_osr);
+    float coherent_gain = 1.0f / span + sinf((float)M_PI / span) / (float)M_PI;
+    float noise_bandwidth = HANN_NOISE_BANDWIDTH / (span * Proto::symbol_period);
+
+    float snr = 10.0f * log10f(ratio) - 20.0f * log10f(coherent_gain) +
+                10.0f * log10f(noise_bandwidth / SNR_REFERENCE_BANDWIDTH);
+    return std::max(snr, SNR_MIN_DB);
+}
+
+template <typename Proto, typename Osr>
+void SubtractTransmissionKernel(ftx_waterfall_t* wf, const std::vector<WF_ELEM_T>& median,
+                                const ftx_candidate_t* candidate, const uint8_t* tones) {
+    int time_osr = Osr::Time(wf->time_osr);
+    int freq_osr = Osr::Freq(wf->freq_osr);
+    int fine_bins = wf->num_bins * freq_osr;
+    int rows = wf->num_blocks * time_osr;
+    int row_stride = fine_bins;
+
+    for (int i = 0; i < Proto::num_symbols; ++i) {
+        // Row and fine frequency bin at the centre of the symbol's tone
+        int row = (candidate->time_offset + i) * time_osr + candidate->time_sub;
+        int fine = (candidate->freq_offset + tones[i]) * freq_osr + candidate->freq_sub;
+
+        for (int r = std::max(row - 1, 0); r <= std::min(row + 1, rows - 1); ++r) {
+            WF_ELEM_T* cells = wf->mag + (size_t)r * row_stride;
+            for (int f = std::max(fine - 1, 0); f <= std::min(fine + 1, fine_bins - 1); ++f) {
+                // Fine bin f is bin f / freq_osr of frequency subdivision f % freq_osr
+                int column = (f % freq_osr) * wf->num_bins + f / freq_osr;
+                if (cells[column] > median[column]) {
+                    cells[column] = median[column];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Iterative LDPC decoder, see DecodeLdpc
+ */
+int DecodeLdpcKernel(const float* codeword, int max_iterations, uint8_t* plain, int* iterations, LdpcEngine engine) {
+    float tov[FTX_LDPC_N][3];
+    float toc[FTX_LDPC_M][7];
+    int min_errors = FTX_LDPC_M;
+
+    for (int n = 0; n < FTX_LDPC_N; ++n) {
+        tov[n][0] = tov[n][1] = tov[n][2] = 0;
+    }
+
+    int iter = 0;
+    for (; iter < max_iterations; ++iter) {
+        // Hard decision guess from the current beliefs
+        int plain_sum = 0;
+        for (int n = 0; n < FTX_LDPC_N; ++n) {
+            plain[n] = ((codeword[n] + tov[n][0] + tov[n][1] + tov[n][2]) > 0) ? 1 : 0;
+            plain_sum += plain[n];
+        }
+
+        // Converged to the all-zeros codeword, which is never transmitted
+        if (plain_sum == 0) {
+            break;
+        }
+
+        int errors = LdpcCheck(plain);
+        if (errors < min_errors) {
+            min_errors = errors;
+            if (errors == 0) {
+                break;
+            }
+        }
+
+        // Messages from bits to check nodes
+        for (int m = 0; m < FTX_LDPC_M; ++m) {
+            for (int n_idx = 0; n_idx < kFTX_LDPC_Num_rows[m]; ++n_idx) {
+                int n = kFTX_LDPC_Nm[m][n_idx] - 1;
+                float Tnm = codeword[n];
+                for (int m_idx = 0; m_idx < 3; ++m_idx) {
+                    if ((kFTX_LDPC_Mn[n][m_idx] - 1) != m) {
+                        Tnm += tov[n][m_idx];
+                    }
+                }
+                // Min-sum works on the messages themselves rather than their tanh
+                toc[m][n_idx] = (engine == LDPC_ENGINE_MIN_SUM) ? Tnm : FastTanh(-Tnm / 2);
+            }
+        }
+
+        if (engine == LDPC_ENGINE_MIN_SUM) {
+            for (int n = 0; n < FTX_LDPC_N; ++n) {
+                for (int m_idx = 0; m_idx < 3; ++m_idx) {
+                    int m = kFTX_LDPC_Mn[n][m_idx] - 1;
+                    float magnitude = INFINITY;
+                    bool odd_ones = false;
+                    for (int n_idx = 0; n_idx < kFTX_LDPC_Num_rows[m]; ++n_idx) {
+                        if ((kFTX_LDPC_Nm[m][n_idx] - 1) != n) {
+                            float Tnm = toc[m][n_idx];
+                            magnitude = std::min(magnitude, fabsf(Tnm));
+                            odd_ones ^= (Tnm > 0);
+                        }
+                    }
+                    // Parity holds if this bit matches the others' likely ones
+                    tov[n][m_idx] = odd_ones ? MIN_SUM_SCALE * magnitude : -MIN_SUM_SCALE * magnitude;
+                }
+            }
+            continue;
+        }
+
+        // Messages from check nodes to bits
+        for (int n = 0; n < FTX_LDPC_N; ++n) {
+            for (int m_idx = 0; m_idx < 3; ++m_idx) {
+                int m = kFTX_LDPC_Mn[n][m_idx] - 1;
+                float Tmn = 1.0f;
+                for (int n_idx = 0; n_idx < kFTX_LDPC_Num_rows[m]; ++n_idx) {
+                    if ((kFTX_LDPC_Nm[m][n_idx] - 1) != n) {
+                        Tmn *= toc[m][n_idx];
+                    }
+                }
+                tov[n][m_idx] = -2 * FastAtanh(Tmn);
+            }
+        }
+    }
+
+    *iterations = iter;
+    return min_errors;
+}
+
+/**
+ * Entry points of the kernels of one protocol and oversampling. A variant
+ * compiled for an instruction set inlines the kernels into its entry points.
+ */
+#define DEFINE_KERNEL_VARIANT(Name, Target)                                                                    \
+    template <typename Proto, typename Osr>                                                                    \
+    struct Name {                                                                                              \
+        Target static int FindCandidatesInRange(const ftx_waterfall_t* wf, const CandidateRange& range,       \
+                                                int min_score, int max_candidates, ftx_candidate_t* candidates) { \
+            return FindCandidatesInRangeKernel<Proto, Osr>(wf, range, min_score, max_candidates, candidates);  \
+        }                                                                                                      \
+        Target static void ExtractLikelihood(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate,     \
+                                             float* log174) {                                                  \
+            ExtractLikelihoodKernel<Proto, Osr>(wf, candidate, log174);                                        \
+        }                                                                                                      \
+        Target static float EstimateSnr(const ftx_waterfall_t* wf, const std::vector<float>& noise_floor,     \
+                                        const ftx_candidate_t* candidate, const uint8_t* tones) {             \
+            return EstimateSnrKernel<Proto, Osr>(wf, noise_floor, candidate, tones);                           \
+        }                                                                                                      \
+        Target static void SubtractTransmission(ftx_waterfall_t* wf, const std::vector<WF_ELEM_T>& median,    \
+                                                const ftx_candidate_t* candidate, const uint8_t* tones) {     \
+            SubtractTransmissionKernel<Proto, Osr>(wf, median, candidate, tones);                              \
+        }                                                                                                      \
+    };
+
+DEFINE_KERNEL_VARIANT(BaselineKernels, )
+#ifdef KERNEL_HAVE_X86_VARIANTS
+DEFINE_KERNEL_VARIANT(Avx2Kernels, KERNEL_TARGET_AVX2)
+DEFINE_KERNEL_VARIANT(Avx512Kernels, KERNEL_TARGET_AVX512)
+
+KERNEL_TARGET_AVX2
+int DecodeLdpcAvx2(const float* codeword, int max_iterations, uint8_t* plain, int* iterations, LdpcEngine engine) {
+    return DecodeLdpcKernel(codeword, max_iterations, plain, iterations, engine);
+}
+
+KERNEL_TARGET_AVX512
+int DecodeLdpcAvx512(const float* codeword, int max_iterations, uint8_t* plain, int* iterations, LdpcEngine engine) {
+    return DecodeLdpcKernel(codeword, max_iterations, plain, iterations, engine);
+}
+#endif
+
+template <typename Variant>
+DecodeKernels MakeKernels() {
+    return DecodeKernels{
+        &Variant::FindCandidatesInRange,
+        &Variant::ExtractLikelihood,
+        &Variant::EstimateSnr,
+        &Variant::SubtractTransmission
+    };
+}
+
+typedef ProtocolTraits<FTX_PROTOCOL_FT8> Ft8;
+typedef ProtocolTraits<FTX_PROTOCOL_FT4> Ft4;
+
+/**
+ * All kernels compiled for one instruction set
+ *
+ * Specialised for the common oversampling factors; other factors use the
+ * generic kernels.
+ */
+struct KernelVariant {
+    DecodeKernels ft8_1x1;
+    DecodeKernels ft8_2x2;
+    DecodeKernels ft8;
+    DecodeKernels ft4_1x1;
+    DecodeKernels ft4_2x2;
+    DecodeKernels ft4;
+    int (*decode_ldpc)(const float* codeword, int max_iterations, uint8_t* plain, int* iterations,
+                       LdpcEngine engine);
+};
+
+template <template <typename, typename> class Variant>
+KernelVariant MakeVariant(int (*decode_ldpc)(const float*, int, uint8_t*, int*, LdpcEngine)) {
+    return KernelVariant{
+        MakeKernels<Variant<Ft8, Oversampling<1, 1>>>(),
+        MakeKernels<Variant<Ft8, Oversampling<2, 2>>>(),
+        MakeKernels<Variant<Ft8, Oversampling<0, 0>>>(),
+        MakeKernels<Variant<Ft4, Oversampling<1, 1>>>(),
+        MakeKernels<Variant<Ft4, Oversampling<2, 2>>>(),
+        MakeKernels<Variant<Ft4, Oversampling<0, 0>>>(),
+        decode_ldpc
+    };
+}
+
+KernelVariant SelectVariant() {
+#ifdef KERNEL_HAVE_X86_VARIANTS
+    switch (ActiveKernelIsa()) {
+        case KERNEL_ISA_AVX512: return MakeVariant<Avx512Kernels>(DecodeLdpcAvx512);
+        case KERNEL_ISA_AVX2: return MakeVariant<Avx2Kernels>(DecodeLdpcAvx2);
+        default: break;
+    }
+#endif
+    return MakeVariant<BaselineKernels>(DecodeLdpcKernel);
+}
+
+const KernelVariant& ActiveVariant() {
+    static const KernelVariant variant = SelectVariant();
+    return variant;
+}
+
+} // namespace
+
+const DecodeKernels& SelectDecodeKernels(ftx_protocol_t protocol, int time_osr, int freq_osr) {
+    const KernelVariant& variant = ActiveVariant();
+    bool ft4 = (protocol == FTX_PROTOCOL_FT4);
+    if (time_osr == 1 && freq_osr == 1) {
+        return ft4 ? variant.ft4_1x1 : variant.ft8_1x1;
+    }
+    if (time_osr == 2 && freq_osr == 2) {
+        return ft4 ? variant.ft4_2x2 : variant.ft8_2x2;
+    }
+    return ft4 ? variant.ft4 : variant.ft8;
+}
+
+/**
+ * Kernels for a waterfall
+ */
+static const DecodeKernels& WaterfallKernels(const ftx_waterfall_t* wf) {
+    return SelectDecodeKernels(wf->protocol, wf->time_osr, wf->freq_osr);
+}
+
+int FindCandidatesInRange(const ftx_waterfall_t* wf, const CandidateRange& range, int min_score,
+                          int max_candidates, ftx_candidate_t* candidates) {
+    return WaterfallKernels(wf).find_candidates_in_range(wf, range, min_score, max_candidates, candidates);
+}
+
+void EstimateNoiseFloor(const ftx_waterfall_t* wf, std::vector<float>* noise_floor,
+                        std::vector<WF_ELEM_T>* median) {
+    int columns = wf->freq_osr * wf->num_bins;
+    int rows = wf->num_blocks * wf->time_osr;
+    noise_floor->assign(columns, 0.0f);
+    if (median) {
+        median->assign(columns, 0);
+    }
+    if (rows == 0) {
+        return;
+    }
+
+    const float* power = PowerTable();
+    std::vector<WF_ELEM_T> column(rows);
+    for (int c = 0; c < columns; ++c) {
+        for (int r = 0; r < rows; ++r) {
+            column[r] = wf->mag[(size_t)r * columns + c];
+        }
+        std::nth_element(column.begin(), column.begin() + rows / 2, column.end());
+
+        // The median of exponentially distributed power is ln(2) times its mean
+        (*noise_floor)[c] = power[column[rows / 2]] / logf(2.0f);
+        if (median) {
+            (*median)[c] = column[rows / 2];
+        }
+    }
+}
+
+float EstimateSnr(const ftx_waterfall_t* wf, const std::vector<float>& noise_floor,
+                  const ftx_candidate_t* candidate, const uint8_t* tones) {
+    return WaterfallKernels(wf).estimate_snr(wf, noise_floor, candidate, tones);
+}
+
+void SubtractTransmission(ftx_waterfall_t* wf, const std::vector<WF_ELEM_T>& median,
+                          const ftx_candidate_t* candidate, const uint8_t* tones) {
+    WaterfallKernels(wf).subtract_transmission(wf, median, candidate, tones);
+}
+
+void ExtractLikelihood(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate, float* log174) {
+    WaterfallKernels(wf).extract_likelihood(wf, candidate, log174);
+}
+
+int DecodeLdpc(const float* codeword, int max_iterations, uint8_t* plain, int* iterations, LdpcEngine engine) {
+    return ActiveVariant().decode_ldpc(codeword, max_iterations, plain, iterations, engine);
+}
+
+bool CheckCodeword(const uint8_t* plain, ftx_protocol_t protocol, ftx_message_t* message, ftx_decode_status_t* status) {
+    // Payload and CRC are the first FTX_LDPC_K bits
+    uint8_t a91[FTX_LDPC_K_BYTES];
+    PackBits(plain, FTX_LDPC_K, a91);
+
+    status->crc_extracted = ftx_extract_crc(a91);
+    // The CRC covers the 77-bit message zero-extended to 82 bits
+    a91[9] &= 0xF8;
+    a91[10] &= 0x00;
+    status->crc_calculated = ftx_compute_crc(a91, 96 - 14);
+
+    if (status->crc_extracted != status->crc_calculated) {
+        return false;
+    }
+
+    // ft8_lib reuses the CRC as the message hash
+    message->hash = status->crc_calculated;
+
+    for (int i = 0; i < FTX_PAYLOAD_LENGTH_BYTES; ++i) {
+        // FT4 payloads are scrambled to avoid long runs of zeros
+        message->payload[i] = (protocol == FTX_PROTOCOL_FT4) ? (a91[i] ^ kFT4_XOR_sequence[i]) : a91[i];
+    }
+
+    return true;
+}
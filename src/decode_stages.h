@@ -0,0 +1,169 @@
+#ifndef DECODE_STAGES_H
+#define DECODE_STAGES_H
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <ft8/decode.h>
+#include <ft8/message.h>
+#include <ft8/constants.h>
+}
+
+/**
+ * The stages of ftx_decode_candidate(), split so they can be timed and reused
+ *
+ * These follow ft8_lib's decode.c and ldpc.c step for step; running
+ * ExtractLikelihood, DecodeLdpc and CheckCodeword in sequence gives the same
+ * result as ftx_decode_candidate(), but also reports how many belief
+ * propagation iterations were needed.
+ */
+
+/**
+ * Part of a waterfall to search for candidates, in waterfall bins and symbol blocks
+ */
+struct CandidateRange {
+    int bin_min;
+    int bin_max;
+    int time_min;
+    int time_max;
+};
+
+/**
+ * Search part of a waterfall for sync candidates, strongest first
+ *
+ * Scores exactly like ftx_find_candidates(), but only at lowest-tone bins in
+ * [bin_min, bin_max] and start blocks in [time_min, time_max], so the cost
+ * scales with the size of the region instead of the whole band.
+ *
+ * @param wf Waterfall to search
+ * @param range Region to search (inclusive)
+ * @param min_score Minimum sync score
+ * @param max_candidates Capacity of candidates
+ * @param candidates Receives the candidates
+ * @return Number of candidates found
+ */
+int FindCandidatesInRange(const ftx_waterfall_t* wf, const CandidateRange& range, int min_score,
+                          int max_candidates, ftx_candidate_t* candidates);
+
+/**
+ * Extract normalized log-likelihood ratios of the 174 codeword bits of a candidate
+ * @param wf Waterfall holding the candidate
+ * @param candidate Candidate position
+ * @param log174 Receives FTX_LDPC_N log-likelihood ratios
+ */
+void ExtractLikelihood(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate, float* log174);
+
+/**
+ * Check node update rules of the LDPC decoder
+ */
+enum LdpcEngine {
+    // Sum-product belief propagation with ft8_lib's tanh approximations
+    LDPC_ENGINE_BP,
+    // Normalized min-sum; cheaper per iteration and less sensitive to badly
+    // scaled likelihoods, so it sometimes converges where BP does not
+    LDPC_ENGINE_MIN_SUM
+};
+
+/**
+ * Iterative LDPC decoder
+ * @param codeword Log-likelihood ratios of the codeword bits
+ * @param max_iterations Maximum number of iterations
+ * @param plain Receives FTX_LDPC_N hard-decision bits of the best guess
+ * @param iterations Receives the number of iterations performed
+ * @param engine Check node update rule
+ * @return Number of parity check errors of the best guess (0 on success)
+ */
+int DecodeLdpc(const float* codeword, int max_iterations, uint8_t* plain, int* iterations,
+               LdpcEngine engine = LDPC_ENGINE_BP);
+
+/**
+ * Verify the CRC of a decoded codeword and extract its payload
+ * @param plain FTX_LDPC_N codeword bits
+ * @param protocol Protocol of the transmission
+ * @param message Receives the payload and hash
+ * @param status Receives the extracted and calculated CRC
+ * @return true if the CRC matches
+ */
+bool CheckCodeword(const uint8_t* plain, ftx_protocol_t protocol, ftx_message_t* message, ftx_decode_status_t* status);
+
+/**
+ * Mean noise power of every frequency column of a waterfall
+ *
+ * The median magnitude of each column over all blocks, converted to the mean
+ * of the exponentially distributed noise power. Signals occupy any one bin
+ * for only a fraction of the symbols, so the median is barely affected by
+ * them. Computed once per waterfall and shared by all SNR estimates.
+ *
+ * @param wf Waterfall to measure
+ * @param noise_floor Receives freq_osr * num_bins linear powers, indexed by
+ *        freq_sub * num_bins + bin
+ * @param median Optionally receives the median magnitude of each column
+ */
+void EstimateNoiseFloor(const ftx_waterfall_t* wf, std::vector<float>* noise_floor,
+                        std::vector<WF_ELEM_T>* median = nullptr);
+
+/**
+ * SNR of a decoded transmission in the 2500 Hz reference bandwidth used by WSJT-X
+ *
+ * Compares the power at the transmitted tone of every symbol with the noise
+ * floor of the same bins, then corrects for the analysis window's noise
+ * bandwidth and for the share of each window a symbol fills.
+ *
+ * @param wf Waterfall holding the candidate
+ * @param noise_floor Result of EstimateNoiseFloor for wf
+ * @param candidate Position of the transmission
+ * @param tones Channel symbols of the decoded message (FT8_NN or FT4_NN)
+ * @return SNR in dB, no lower than -24 dB
+ */
+float EstimateSnr(const ftx_waterfall_t* wf, const std::vector<float>& noise_floor,
+                  const ftx_candidate_t* candidate, const uint8_t* tones);
+
+/**
+ * Remove a decoded transmission from a waterfall
+ *
+ * Every symbol's tone is cleared down to the noise floor, together with the
+ * neighbouring frequency subdivisions and time subdivisions its energy leaks
+ * into. Only those cells are written, so the cost is independent of the
+ * size of the waterfall.
+ *
+ * @param wf Waterfall to update in place
+ * @param median Median magnitude of each column, from EstimateNoiseFloor
+ * @param candidate Position of the transmission
+ * @param tones Channel symbols of the decoded message (FT8_NN or FT4_NN)
+ */
+void SubtractTransmission(ftx_waterfall_t* wf, const std::vector<WF_ELEM_T>& median,
+                          const ftx_candidate_t* candidate, const uint8_t* tones);
+
+/**
+ * Per-candidate kernels compiled for one protocol and oversampling
+ *
+ * The free functions above look these up on every call; a decoder whose
+ * waterfall geometry is fixed selects them once and calls them directly.
+ * ExtractLikelihood includes the normalization.
+ */
+struct DecodeKernels {
+    int (*find_candidates_in_range)(const ftx_waterfall_t* wf, const CandidateRange& range, int min_score,
+                                    int max_candidates, ftx_candidate_t* candidates);
+    void (*extract_likelihood)(const ftx_waterfall_t* wf, const ftx_candidate_t* candidate, float* log174);
+    float (*estimate_snr)(const ftx_waterfall_t* wf, const std::vector<float>& noise_floor,
+                          const ftx_candidate_t* candidate, const uint8_t* tones);
+    void (*subtract_transmission)(ftx_waterfall_t* wf, const std::vector<WF_ELEM_T>& median,
+                                  const ftx_candidate_t* candidate, const uint8_t* tones);
+};
+
+/**
+ * Kernels for a protocol and waterfall oversampling
+ *
+ * FT8 and FT4 at 1x1 and 2x2 oversampling get kernels with every loop bound
+ * and stride factor fixed at compile time; other factors get kernels that
+ * read the oversampling from the waterfall.
+ *
+ * @param protocol Protocol of the waterfall
+ * @param time_osr Time oversampling of the waterfall
+ * @param freq_osr Frequency oversampling of the waterfall
+ * @return Kernels with static storage duration
+ */
+const DecodeKernels& SelectDecodeKernels(ftx_protocol_t protocol, int time_osr, int freq_osr);
+
+#endif // DECODE_STAGES_H
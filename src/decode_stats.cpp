@@ -0,0 +1,54 @@
+#include "decode_stats.h"
+#include <chrono>
+#include <cmath>
+
+void Log2Histogram::Add(double value) {
+    int bucket = 0;
+    if (value >= 1.0) {
+        bucket = (int)std::floor(std::log2(value)) + 1;
+        if (bucket >= NUM_BUCKETS) {
+            bucket = NUM_BUCKETS - 1;
+        }
+    }
+    counts[bucket]++;
+}
+
+void Log2Histogram::Merge(const Log2Histogram& other) {
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] += other.counts[i];
+    }
+}
+
+void DecodeStats::Merge(const DecodeStats& other) {
+    decode_calls += other.decode_calls;
+    decode_ns += other.decode_ns;
+    decoded += other.decoded;
+    blocks += other.blocks;
+    monitor_ns += other.monitor_ns;
+    candidate_searches += other.candidate_searches;
+    candidates += other.candidates;
+    find_ns += other.find_ns;
+    likelihood_runs += other.likelihood_runs;
+    likelihood_ns += other.likelihood_ns;
+    likelihood_cache_hits += other.likelihood_cache_hits;
+    ldpc_runs += other.ldpc_runs;
+    ldpc_iterations += other.ldpc_iterations;
+    ldpc_failures += other.ldpc_failures;
+    ldpc_ns += other.ldpc_ns;
+    crc_failures += other.crc_failures;
+    unpack_runs += other.unpack_runs;
+    unpack_failures += other.unpack_failures;
+    unpack_ns += other.unpack_ns;
+    hash_hits += other.hash_hits;
+    hash_misses += other.hash_misses;
+    hash_saves += other.hash_saves;
+    decode_ms_histogram.Merge(other.decode_ms_histogram);
+    candidates_histogram.Merge(other.candidates_histogram);
+    messages_histogram.Merge(other.messages_histogram);
+    ldpc_iterations_histogram.Merge(other.ldpc_iterations_histogram);
+}
+
+uint64_t StatsClockNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
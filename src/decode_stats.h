@@ -0,0 +1,84 @@
+#ifndef DECODE_STATS_H
+#define DECODE_STATS_H
+
+#include <cstdint>
+
+/**
+ * Histogram with power-of-two buckets
+ *
+ * Bucket 0 counts values below 1, bucket i counts values in [2^(i-1), 2^i)
+ * and the last bucket also takes everything larger.
+ */
+struct Log2Histogram {
+    static const int NUM_BUCKETS = 24;
+    uint64_t counts[NUM_BUCKETS] = {};
+
+    void Add(double value);
+    void Merge(const Log2Histogram& other);
+};
+
+/**
+ * Counters and timers of the decode pipeline
+ *
+ * Times are monotonic nanoseconds summed over all calls. A DecoderCore only
+ * fills these while statistics are enabled.
+ */
+struct DecodeStats {
+    // Decode() calls and their results
+    uint64_t decode_calls = 0;
+    uint64_t decode_ns = 0;
+    uint64_t decoded = 0;
+
+    // monitor_process
+    uint64_t blocks = 0;
+    uint64_t monitor_ns = 0;
+
+    // ftx_find_candidates
+    uint64_t candidate_searches = 0;
+    uint64_t candidates = 0;
+    uint64_t find_ns = 0;
+
+    // Log-likelihood extraction
+    uint64_t likelihood_runs = 0;
+    uint64_t likelihood_ns = 0;
+    // Candidates decoded again from their cached log-likelihoods
+    uint64_t likelihood_cache_hits = 0;
+
+    // LDPC decoding
+    uint64_t ldpc_runs = 0;
+    uint64_t ldpc_iterations = 0;
+    uint64_t ldpc_failures = 0;
+    uint64_t ldpc_ns = 0;
+
+    // CRC check of LDPC-decoded codewords
+    uint64_t crc_failures = 0;
+
+    // ftx_message_decode
+    uint64_t unpack_runs = 0;
+    uint64_t unpack_failures = 0;
+    uint64_t unpack_ns = 0;
+
+    // Callsign hash table
+    uint64_t hash_hits = 0;
+    uint64_t hash_misses = 0;
+    uint64_t hash_saves = 0;
+
+    // Per Decode() call, and LDPC iterations per candidate
+    Log2Histogram decode_ms_histogram;
+    Log2Histogram candidates_histogram;
+    Log2Histogram messages_histogram;
+    Log2Histogram ldpc_iterations_histogram;
+
+    /**
+     * Add another set of counters to this one
+     */
+    void Merge(const DecodeStats& other);
+};
+
+/**
+ * Monotonic clock for the stage timers
+ * @return Nanoseconds since an arbitrary epoch
+ */
+uint64_t StatsClockNs();
+
+#endif // DECODE_STATS_H
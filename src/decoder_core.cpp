@@ -0,0 +1,609 @@
+#include "decoder_core.h"
+#include "decode_stages.h"
+#include "monitor_kernels.h"
+#include "trace.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+extern "C" {
+#include <ft8/encode.h>
+}
+
+thread_local DecoderCore* DecoderCore::active_instance_ = nullptr;
+
+const char* MessageTypeName(ftx_message_type_t type) {
+    switch (type) {
+        case FTX_MESSAGE_TYPE_FREE_TEXT: return "FREE_TEXT";
+        case FTX_MESSAGE_TYPE_DXPEDITION: return "DXPEDITION";
+        case FTX_MESSAGE_TYPE_EU_VHF: return "EU_VHF";
+        case FTX_MESSAGE_TYPE_ARRL_FD: return "ARRL_FD";
+        case FTX_MESSAGE_TYPE_TELEMETRY: return "TELEMETRY";
+        case FTX_MESSAGE_TYPE_CONTESTING: return "CONTESTING";
+        case FTX_MESSAGE_TYPE_STANDARD: return "STANDARD";
+        case FTX_MESSAGE_TYPE_ARRL_RTTY: return "ARRL_RTTY";
+        case FTX_MESSAGE_TYPE_NONSTD_CALL: return "NONSTD_CALL";
+        case FTX_MESSAGE_TYPE_WWROF: return "WWROF";
+        default: return "UNKNOWN";
+    }
+}
+
+DecoderCore::DecoderCore() : DecoderCore(DecoderConfig()) {
+}
+
+DecoderCore::DecoderCore(const DecoderConfig& config)
+    : config_(config), kernels_(&SelectDecodeKernels(config.protocol, config.time_osr, config.freq_osr)),
+      stats_enabled_(false), monitor_initialized_(false), monitor_sample_rate_(0),
+      waterfall_generation_(0), noise_floor_valid_(false), hash_misses_(nullptr), hash_saves_(nullptr) {
+    InitializeHashTable();
+}
+
+DecoderCore::~DecoderCore() {
+    if (monitor_initialized_) {
+        ActiveMonitorKernels().free(&monitor_);
+    }
+}
+
+void DecoderCore::SetConfig(const DecoderConfig& config) {
+    // Only the parameters of the monitor invalidate the waterfall
+    bool monitor_changed = config.protocol != config_.protocol ||
+                           config.freq_osr != config_.freq_osr ||
+                           config.time_osr != config_.time_osr ||
+                           config.freq_min != config_.freq_min ||
+                           config.freq_max != config_.freq_max;
+
+    config_ = config;
+    kernels_ = &SelectDecodeKernels(config.protocol, config.time_osr, config.freq_osr);
+    likelihood_cache_.clear();
+    if (monitor_changed && monitor_initialized_) {
+        ActiveMonitorKernels().free(&monitor_);
+        monitor_initialized_ = false;
+        waterfall_generation_++;
+    }
+}
+
+void DecoderCore::InitializeHashTable() {
+    for (int i = 0; i < HASH_TABLE_SIZE; ++i) {
+        hash_table_[i].used = false;
+        hash_table_[i].callsign[0] = '\0';
+        hash_table_[i].hash = 0;
+    }
+}
+
+std::vector<CallsignHash> DecoderCore::HashEntries() const {
+    std::vector<CallsignHash> entries;
+    for (int i = 0; i < HASH_TABLE_SIZE; ++i) {
+        if (hash_table_[i].used) {
+            CallsignHash entry;
+            memcpy(entry.callsign, hash_table_[i].callsign, sizeof(entry.callsign));
+            entry.n22 = hash_table_[i].hash;
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+bool DecoderCore::SaveHash(const char* callsign, uint32_t n22) {
+    uint16_t hash10 = (n22 >> 12) & 0x3FFu;
+    int home = (hash10 * 23) % HASH_TABLE_SIZE;
+    int idx_hash = home;
+
+    for (int probes = 0; hash_table_[idx_hash].used; ++probes) {
+        if (((hash_table_[idx_hash].hash & 0x3FFFFFu) == n22) &&
+            (strcmp(hash_table_[idx_hash].callsign, callsign) == 0)) {
+            return false; // Already exists
+        }
+        if (probes + 1 >= HASH_TABLE_SIZE) {
+            // Table is full; the entry in the home slot makes room
+            idx_hash = home;
+            break;
+        }
+        idx_hash = (idx_hash + 1) % HASH_TABLE_SIZE;
+    }
+
+    // Add new entry
+    if (stats_enabled_) {
+        stats_.hash_saves++;
+    }
+    hash_table_[idx_hash].used = true;
+    strncpy(hash_table_[idx_hash].callsign, callsign, 11);
+    hash_table_[idx_hash].callsign[11] = '\0';
+    hash_table_[idx_hash].hash = n22;
+    return true;
+}
+
+bool DecoderCore::HashTableLookup(ftx_callsign_hash_type_t hash_type, uint32_t hash, char* callsign) {
+    DecoderCore* core = active_instance_;
+    if (!core) {
+        callsign[0] = '\0';
+        return false;
+    }
+
+    if (core->callsign_index_ && core->callsign_index_->Lookup(hash_type, hash, callsign)) {
+        if (core->stats_enabled_) {
+            core->stats_.hash_hits++;
+        }
+        return true;
+    }
+
+    uint8_t hash_shift = (hash_type == FTX_CALLSIGN_HASH_10_BITS) ? 12 :
+                        (hash_type == FTX_CALLSIGN_HASH_12_BITS ? 10 : 0);
+    uint16_t hash10 = (hash >> (12 - hash_shift)) & 0x3FFu;
+    int idx_hash = (hash10 * 23) % HASH_TABLE_SIZE;
+
+    for (int probes = 0; probes < HASH_TABLE_SIZE && core->hash_table_[idx_hash].used; ++probes) {
+        if (((core->hash_table_[idx_hash].hash & 0x3FFFFFu) >> hash_shift) == hash) {
+            strcpy(callsign, core->hash_table_[idx_hash].callsign);
+            if (core->stats_enabled_) {
+                core->stats_.hash_hits++;
+            }
+            return true;
+        }
+        idx_hash = (idx_hash + 1) % HASH_TABLE_SIZE;
+    }
+
+    if (core->stats_enabled_) {
+        core->stats_.hash_misses++;
+    }
+    if (core->hash_misses_) {
+        CallsignHashRequest request = {hash_type, hash};
+        if (std::find(core->hash_misses_->begin(), core->hash_misses_->end(), request) == core->hash_misses_->end()) {
+            core->hash_misses_->push_back(request);
+        }
+    }
+    callsign[0] = '\0';
+    return false;
+}
+
+void DecoderCore::HashTableSave(const char* callsign, uint32_t hash) {
+    DecoderCore* core = active_instance_;
+    if (!core) return;
+
+    if (core->SaveHash(callsign, hash) && core->hash_saves_) {
+        CallsignHash entry;
+        strncpy(entry.callsign, callsign, sizeof(entry.callsign) - 1);
+        entry.callsign[sizeof(entry.callsign) - 1] = '\0';
+        entry.n22 = hash;
+        core->hash_saves_->push_back(entry);
+    }
+}
+
+void DecoderCore::InitializeMonitor(int sample_rate) {
+    if (monitor_initialized_) {
+        ActiveMonitorKernels().free(&monitor_);
+    }
+
+    monitor_config_t config;
+    config.f_min = config_.freq_min;
+    config.f_max = config_.freq_max;
+    config.sample_rate = sample_rate;
+    config.time_osr = config_.time_osr;
+    config.freq_osr = config_.freq_osr;
+    config.protocol = config_.protocol;
+
+    ActiveMonitorKernels().init(&monitor_, &config);
+    monitor_initialized_ = true;
+    monitor_sample_rate_ = sample_rate;
+    waterfall_generation_++;
+}
+
+void DecoderCore::StartSlot(int sample_rate) {
+    if (!monitor_initialized_ || monitor_.wf.max_blocks == 0 || monitor_sample_rate_ != sample_rate) {
+        InitializeMonitor(sample_rate);
+    }
+
+    ActiveMonitorKernels().reset(&monitor_);
+    noise_floor_valid_ = false;
+    likelihood_cache_.clear();
+}
+
+void DecoderCore::ProcessBlock(const float* block) {
+    noise_floor_valid_ = false;
+    likelihood_cache_.clear();
+    if (!stats_enabled_) {
+        ActiveMonitorKernels().process(&monitor_, block);
+        return;
+    }
+
+    uint64_t start = StatsClockNs();
+    ActiveMonitorKernels().process(&monitor_, block);
+    stats_.monitor_ns += StatsClockNs() - start;
+    stats_.blocks++;
+}
+
+void DecoderCore::ProcessAudio(const float* samples, int num_samples, int sample_rate) {
+    TraceScope trace("monitor", "decoder");
+    StartSlot(sample_rate);
+
+    // Process audio in block_size chunks as done in the original demo
+    // Each call to monitor_process expects exactly block_size samples
+    int chunk_size = monitor_.block_size;
+
+    for (int offset = 0; offset < num_samples; offset += chunk_size) {
+        int remaining = std::min(chunk_size, num_samples - offset);
+
+        // If we don't have enough samples for a full chunk, pad with zeros
+        if (remaining < chunk_size) {
+            std::vector<float> padded_chunk(chunk_size, 0.0f);
+            std::copy(samples + offset, samples + offset + remaining, padded_chunk.begin());
+            ProcessBlock(padded_chunk.data());
+        } else {
+            ProcessBlock(samples + offset);
+        }
+    }
+}
+
+const std::vector<float>& DecoderCore::NoiseFloor() {
+    if (!noise_floor_valid_) {
+        EstimateNoiseFloor(&monitor_.wf, &noise_floor_, &noise_median_);
+        noise_floor_valid_ = true;
+    }
+    return noise_floor_;
+}
+
+float DecoderCore::SymbolPeriod() const {
+    return (config_.protocol == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+}
+
+WaterfallLayout DecoderCore::Layout() const {
+    WaterfallLayout layout;
+    if (monitor_initialized_) {
+        layout.num_bins = monitor_.wf.num_bins;
+        layout.time_osr = monitor_.wf.time_osr;
+        layout.freq_osr = monitor_.wf.freq_osr;
+        layout.block_stride = monitor_.wf.block_stride;
+        layout.min_bin = monitor_.min_bin;
+        layout.symbol_period = SymbolPeriod();
+    }
+    return layout;
+}
+
+bool DecoderCore::LoadWaterfall(ftx_protocol_t protocol, int sample_rate, const WaterfallLayout& layout,
+                                const WF_ELEM_T* mag, int num_blocks, std::string* error) {
+    // A range from the middle of the lowest bin to the middle of the highest
+    // makes the monitor pick exactly these bins
+    float symbol_period = (protocol == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+    float slot_time = (protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+    DecoderConfig config = config_;
+    config.protocol = protocol;
+    config.time_osr = layout.time_osr;
+    config.freq_osr = layout.freq_osr;
+    config.freq_min = (layout.min_bin + 0.5f) / symbol_period;
+    config.freq_max = (layout.min_bin + layout.num_bins - 0.5f) / symbol_period;
+
+    // The geometry monitor_init() would give this configuration, worked out
+    // before the current monitor is given up
+    int block_size = (int)(sample_rate * symbol_period);
+    WaterfallLayout expected;
+    expected.min_bin = (int)(config.freq_min * symbol_period);
+    expected.num_bins = (int)(config.freq_max * symbol_period) + 1 - expected.min_bin;
+    expected.time_osr = layout.time_osr;
+    expected.freq_osr = layout.freq_osr;
+    expected.block_stride = layout.time_osr * layout.freq_osr * expected.num_bins;
+    expected.symbol_period = symbol_period;
+
+    if (layout.time_osr < 1 || layout.freq_osr < 1 || layout.min_bin < 0 || layout.num_bins < 1 ||
+        layout.min_bin + layout.num_bins > block_size / 2 || expected != layout) {
+        *error = "Waterfall layout does not match the protocol and sample rate";
+        return false;
+    }
+    if (num_blocks < 0 || num_blocks > (int)(slot_time / symbol_period)) {
+        *error = "Waterfall has more blocks than a slot";
+        return false;
+    }
+
+    DecoderConfig previous = config_;
+    SetConfig(config);
+    StartSlot(sample_rate);
+    if (Layout() != layout || num_blocks > monitor_.wf.max_blocks) {
+        SetConfig(previous);
+        *error = "Waterfall layout does not match the protocol and sample rate";
+        return false;
+    }
+
+    memcpy(monitor_.wf.mag, mag, (size_t)num_blocks * layout.block_stride * sizeof(WF_ELEM_T));
+    monitor_.wf.num_blocks = num_blocks;
+    return true;
+}
+
+float DecoderCore::CandidateFrequency(const ftx_candidate_t& candidate) const {
+    return (monitor_.min_bin + candidate.freq_offset +
+            (float)candidate.freq_sub / monitor_.wf.freq_osr) / SymbolPeriod();
+}
+
+float DecoderCore::CandidateTime(const ftx_candidate_t& candidate) const {
+    return (candidate.time_offset +
+            (float)candidate.time_sub / monitor_.wf.time_osr) * SymbolPeriod();
+}
+
+void DecoderCore::FindCandidates(std::vector<ftx_candidate_t>* candidates) {
+    FindCandidatesIn(&monitor_.wf, candidates);
+}
+
+void DecoderCore::FindCandidatesIn(const ftx_waterfall_t* wf, std::vector<ftx_candidate_t>* candidates) {
+    TraceScope trace("findCandidates", "decoder");
+    uint64_t start = stats_enabled_ ? StatsClockNs() : 0;
+
+    candidates->resize(config_.max_candidates);
+    int num_candidates = ftx_find_candidates(wf, config_.max_candidates, candidates->data(), config_.min_score);
+    candidates->resize(num_candidates);
+    trace.SetArg("candidates", num_candidates);
+
+    if (stats_enabled_) {
+        stats_.find_ns += StatsClockNs() - start;
+        stats_.candidate_searches++;
+        stats_.candidates += num_candidates;
+    }
+}
+
+bool DecoderCore::DecodeCandidate(const ftx_candidate_t& candidate, DecodeResult* result, int max_ldpc_iterations,
+                                  LdpcEngine engine) {
+    return DecodeCandidateIn(&monitor_.wf, candidate, result, max_ldpc_iterations, engine, true);
+}
+
+uint64_t DecoderCore::CandidateKey(const ftx_candidate_t& candidate) {
+    return ((uint64_t)(uint16_t)candidate.time_offset << 32) | ((uint64_t)(uint16_t)candidate.freq_offset << 16) |
+           ((uint64_t)candidate.time_sub << 8) | candidate.freq_sub;
+}
+
+bool DecoderCore::DecodeCandidateIn(const ftx_waterfall_t* wf, const ftx_candidate_t& candidate, DecodeResult* result,
+                                    int max_ldpc_iterations, LdpcEngine engine, bool keep_likelihood) {
+    TraceScope trace("decodeCandidate", "decoder");
+    ActiveScope scope(this);
+
+    // The stages of ftx_decode_candidate(), run separately so each can be measured
+    DecodeStats* stats = stats_enabled_ ? &stats_ : nullptr;
+    uint64_t start = stats ? StatsClockNs() : 0;
+
+    // Only retries of the monitor's own waterfall are cached; residual passes
+    // change under the candidates
+    float scratch[FTX_LDPC_N];
+    float* log174 = scratch;
+    bool cached = false;
+    if (keep_likelihood && wf == &monitor_.wf) {
+        uint64_t key = CandidateKey(candidate);
+        for (CachedLikelihood& entry : likelihood_cache_) {
+            if (entry.key == key) {
+                log174 = entry.log174.data();
+                cached = true;
+                break;
+            }
+        }
+        if (!cached && (int)likelihood_cache_.size() < std::max(config_.max_candidates, 1)) {
+            likelihood_cache_.reserve(std::max(config_.max_candidates, 1));
+            likelihood_cache_.push_back(CachedLikelihood());
+            likelihood_cache_.back().key = key;
+            log174 = likelihood_cache_.back().log174.data();
+        }
+    }
+    if (!cached) {
+        kernels_->extract_likelihood(wf, &candidate, log174);
+    }
+
+    uint64_t extracted = stats ? StatsClockNs() : 0;
+
+    uint8_t plain174[FTX_LDPC_N];
+    int iterations = 0;
+    if (max_ldpc_iterations <= 0) {
+        max_ldpc_iterations = config_.max_ldpc_iterations;
+    }
+    result->status.ldpc_errors = DecodeLdpc(log174, max_ldpc_iterations, plain174, &iterations, engine);
+    trace.SetArg("ldpcIterations", iterations);
+
+    if (stats) {
+        uint64_t now = StatsClockNs();
+        if (cached) {
+            stats->likelihood_cache_hits++;
+        } else {
+            stats->likelihood_runs++;
+            stats->likelihood_ns += extracted - start;
+        }
+        stats->ldpc_runs++;
+        stats->ldpc_iterations += iterations;
+        stats->ldpc_ns += now - extracted;
+        stats->ldpc_iterations_histogram.Add(iterations);
+    }
+
+    if (result->status.ldpc_errors > 0) {
+        if (stats) {
+            stats->ldpc_failures++;
+        }
+        return false;
+    }
+
+    if (!CheckCodeword(plain174, config_.protocol, &result->message, &result->status)) {
+        if (stats) {
+            stats->crc_failures++;
+        }
+        return false;
+    }
+
+    if (!UnpackText(result)) {
+        return false;
+    }
+
+    result->candidate = candidate;
+    result->frequency = CandidateFrequency(candidate);
+    result->time_offset = CandidateTime(candidate);
+    result->status.freq = result->frequency;
+    result->status.time = result->time_offset;
+
+    uint8_t tones[FT4_NN > FT8_NN ? FT4_NN : FT8_NN];
+    if (config_.protocol == FTX_PROTOCOL_FT4) {
+        ft4_encode(result->message.payload, tones);
+    } else {
+        ft8_encode(result->message.payload, tones);
+    }
+    result->snr = kernels_->estimate_snr(wf, NoiseFloor(), &candidate, tones);
+
+    return true;
+}
+
+bool DecoderCore::Unpack(DecodeResult* result) {
+    ActiveScope scope(this);
+    return UnpackText(result);
+}
+
+bool DecoderCore::UnpackText(DecodeResult* result) {
+    ftx_callsign_hash_interface_t hash_if;
+    hash_if.lookup_hash = HashTableLookup;
+    hash_if.save_hash = HashTableSave;
+
+    DecodeStats* stats = stats_enabled_ ? &stats_ : nullptr;
+    char message_text[FTX_MAX_MESSAGE_LENGTH] = {0};
+
+    uint64_t start = stats ? StatsClockNs() : 0;
+    ftx_message_rc_t rc = ftx_message_decode(&result->message, &hash_if, message_text);
+    if (stats) {
+        stats->unpack_ns += StatsClockNs() - start;
+        stats->unpack_runs++;
+        if (rc != FTX_MESSAGE_RC_OK) {
+            stats->unpack_failures++;
+        }
+    }
+
+    if (rc != FTX_MESSAGE_RC_OK) {
+        return false;
+    }
+
+    result->text = message_text;
+    result->type = ftx_message_get_type(&result->message);
+    return true;
+}
+
+void DecoderCore::Decode(std::vector<DecodeResult>* results) {
+    TraceScope trace("decode", "decoder");
+    uint64_t start = stats_enabled_ ? StatsClockNs() : 0;
+    size_t first = results->size();
+
+    std::vector<ftx_candidate_t> candidates;
+    FindCandidates(&candidates);
+
+    DecodeResult decoded;
+    for (size_t i = 0; i < candidates.size() && (int)results->size() < config_.max_decoded_messages; ++i) {
+        if (DecodeCandidateIn(&monitor_.wf, candidates[i], &decoded)) {
+            results->push_back(decoded);
+        }
+    }
+
+    if (config_.passes > 1 && results->size() > first) {
+        DecodeResidual(first, results);
+    }
+
+    size_t count = results->size() - first;
+    trace.SetArg("messages", (double)count);
+
+    if (stats_enabled_) {
+        uint64_t elapsed = StatsClockNs() - start;
+        stats_.decode_calls++;
+        stats_.decode_ns += elapsed;
+        stats_.decoded += count;
+        stats_.decode_ms_histogram.Add(elapsed / 1e6);
+        stats_.candidates_histogram.Add((double)candidates.size());
+        stats_.messages_histogram.Add((double)count);
+    }
+}
+
+void DecoderCore::DecodeFocused(const FocusRegion& region, std::vector<DecodeResult>* results) {
+    TraceScope trace("decodeFocused", "decoder");
+    uint64_t start = stats_enabled_ ? StatsClockNs() : 0;
+
+    // Waterfall bins are one tone spacing, i.e. 1 / symbol period, wide
+    float symbol_period = SymbolPeriod();
+    CandidateRange range;
+    range.bin_min = (int)std::floor(region.freq_min * symbol_period) - monitor_.min_bin;
+    range.bin_max = (int)std::ceil(region.freq_max * symbol_period) - monitor_.min_bin;
+    range.time_min = (int)std::floor(region.time_min / symbol_period);
+    range.time_max = (int)std::ceil(region.time_max / symbol_period);
+
+    std::vector<ftx_candidate_t> candidates(std::max(region.max_candidates, 0));
+    int num_candidates = kernels_->find_candidates_in_range(&monitor_.wf, range, region.min_score,
+                                                            (int)candidates.size(), candidates.data());
+    candidates.resize(num_candidates);
+    trace.SetArg("candidates", num_candidates);
+
+    if (stats_enabled_) {
+        stats_.find_ns += StatsClockNs() - start;
+        stats_.candidate_searches++;
+        stats_.candidates += num_candidates;
+    }
+
+    size_t first = results->size();
+    DecodeResult decoded;
+    for (const ftx_candidate_t& candidate : candidates) {
+        if (!DecodeCandidateIn(&monitor_.wf, candidate, &decoded, region.max_ldpc_iterations)) {
+            continue;
+        }
+
+        // Neighbouring candidates of one strong signal decode to the same message
+        bool duplicate = false;
+        for (size_t i = first; i < results->size(); ++i) {
+            if ((*results)[i].text == decoded.text) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            results->push_back(decoded);
+        }
+    }
+
+    trace.SetArg("messages", (double)(results->size() - first));
+}
+
+void DecoderCore::DecodeResidual(size_t first, std::vector<DecodeResult>* results) {
+    // The residual is a copy, so the waterfall itself stays as the monitor produced it
+    const ftx_waterfall_t& wf = monitor_.wf;
+    residual_.assign(wf.mag, wf.mag + (size_t)wf.num_blocks * wf.block_stride);
+    ftx_waterfall_t residual = wf;
+    residual.mag = residual_.data();
+
+    // The floor of the original waterfall; later passes only clear cells down to it
+    NoiseFloor();
+
+    size_t subtract_from = first;
+    std::vector<ftx_candidate_t> candidates;
+    DecodeResult decoded;
+    uint8_t tones[FT4_NN > FT8_NN ? FT4_NN : FT8_NN];
+
+    for (int pass = 1; pass < config_.passes && (int)results->size() < config_.max_decoded_messages; ++pass) {
+        TraceScope trace("decodePass", "decoder");
+        trace.SetArg("pass", (double)pass);
+
+        // Remove what the previous pass decoded
+        for (size_t i = subtract_from; i < results->size(); ++i) {
+            const DecodeResult& result = (*results)[i];
+            if (config_.protocol == FTX_PROTOCOL_FT4) {
+                ft4_encode(result.message.payload, tones);
+            } else {
+                ft8_encode(result.message.payload, tones);
+            }
+            kernels_->subtract_transmission(&residual, noise_median_, &result.candidate, tones);
+        }
+        subtract_from = results->size();
+
+        FindCandidatesIn(&residual, &candidates);
+        for (size_t i = 0; i < candidates.size() && (int)results->size() < config_.max_decoded_messages; ++i) {
+            if (!DecodeCandidateIn(&residual, candidates[i], &decoded)) {
+                continue;
+            }
+
+            // Remains of a subtracted signal can decode to the same message again
+            bool duplicate = false;
+            for (size_t j = first; j < results->size(); ++j) {
+                if ((*results)[j].text == decoded.text) {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (!duplicate) {
+                results->push_back(decoded);
+            }
+        }
+
+        trace.SetArg("messages", (double)(results->size() - subtract_from));
+        if (results->size() == subtract_from) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,484 @@
+#ifndef DECODER_CORE_H
+#define DECODER_CORE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "callsign_hash.h"
+#include "decode_stages.h"
+#include "decode_stats.h"
+
+extern "C" {
+#include <ft8/decode.h>
+#include <ft8/message.h>
+#include <ft8/constants.h>
+#include <common/monitor.h>
+}
+
+/**
+ * Tuning knobs of the decoder
+ */
+struct DecoderConfig {
+    ftx_protocol_t protocol = FTX_PROTOCOL_FT8;
+    int min_score = 10;
+    int max_candidates = 140;
+    int max_ldpc_iterations = 25;
+    int max_decoded_messages = 50;
+    int freq_osr = 2;
+    int time_osr = 2;
+    float freq_min = 200.0f;
+    float freq_max = 3000.0f;
+    // Decoding passes; each pass after the first searches the waterfall with
+    // the messages decoded so far subtracted
+    int passes = 1;
+};
+
+/**
+ * One successfully decoded message
+ */
+struct DecodeResult {
+    std::string text;
+    ftx_message_t message;
+    ftx_message_type_t type;
+    ftx_candidate_t candidate;
+    ftx_decode_status_t status;
+    float frequency;
+    float time_offset;
+    // SNR in dB in a 2500 Hz bandwidth
+    float snr;
+};
+
+/**
+ * Name of a message type, as reported to JavaScript
+ * @return e.g. "STANDARD", "FREE_TEXT" or "UNKNOWN"
+ */
+const char* MessageTypeName(ftx_message_type_t type);
+
+/**
+ * Memory layout of a waterfall
+ *
+ * Magnitudes are stored block by block; within a block the index of bin b at
+ * time and frequency subdivisions t and f is (t * freq_osr + f) * num_bins + b.
+ * Bin b of subdivision f lies at (min_bin + b + f / freq_osr) / symbol_period Hz.
+ */
+struct WaterfallLayout {
+    int num_bins = 0;
+    int time_osr = 0;
+    int freq_osr = 0;
+    int block_stride = 0;
+    int min_bin = 0;
+    float symbol_period = 0;
+
+    bool operator==(const WaterfallLayout& other) const {
+        return num_bins == other.num_bins && time_osr == other.time_osr && freq_osr == other.freq_osr &&
+               block_stride == other.block_stride && min_bin == other.min_bin &&
+               symbol_period == other.symbol_period;
+    }
+    bool operator!=(const WaterfallLayout& other) const { return !(*this == other); }
+};
+
+/**
+ * Region and effort of a focused decode
+ */
+struct FocusRegion {
+    // Range of the lowest tone in Hz
+    float freq_min;
+    float freq_max;
+    // Range of the start time in seconds from the start of the waterfall
+    float time_min;
+    float time_max;
+    int min_score;
+    int max_candidates;
+    int max_ldpc_iterations;
+};
+
+/**
+ * DecoderCore holds the waterfall, callsign hash table and decode pipeline
+ *
+ * This is the part of MessageDecoder that does not touch JavaScript, so each
+ * worker thread can run its own instance. An instance must only be used by
+ * one thread at a time.
+ */
+class DecoderCore {
+public:
+    DecoderCore();
+    explicit DecoderCore(const DecoderConfig& config);
+    ~DecoderCore();
+
+    DecoderCore(const DecoderCore&) = delete;
+    DecoderCore& operator=(const DecoderCore&) = delete;
+
+    /**
+     * Current configuration
+     */
+    const DecoderConfig& Config() const { return config_; }
+
+    /**
+     * Replace the configuration
+     *
+     * If the protocol, oversampling or frequency range change, the monitor is
+     * rebuilt on the next ProcessAudio. Otherwise the current waterfall stays
+     * valid and can be decoded again with the new decode parameters.
+     *
+     * @param config New configuration
+     */
+    void SetConfig(const DecoderConfig& config);
+
+    /**
+     * Run a slot of audio through the monitor, replacing the previous waterfall
+     * @param samples Audio samples
+     * @param num_samples Number of samples
+     * @param sample_rate Sample rate
+     */
+    void ProcessAudio(const float* samples, int num_samples, int sample_rate);
+
+    /**
+     * Begin a new waterfall for incremental processing with ProcessBlock
+     * @param sample_rate Sample rate of the audio that will follow
+     */
+    void StartSlot(int sample_rate);
+
+    /**
+     * Number of samples ProcessBlock consumes per call (valid after StartSlot)
+     */
+    int BlockSize() const { return monitor_.block_size; }
+
+    /**
+     * Whether the waterfall has room for more blocks
+     */
+    bool WaterfallFull() const { return monitor_.wf.num_blocks >= monitor_.wf.max_blocks; }
+
+    /**
+     * Number of blocks in the current waterfall
+     */
+    int NumBlocks() const { return monitor_initialized_ ? monitor_.wf.num_blocks : 0; }
+
+    /**
+     * Append one block of BlockSize() samples to the current waterfall
+     * @param block Audio samples
+     */
+    void ProcessBlock(const float* block);
+
+    /**
+     * Whether a waterfall is available for the candidate and decode calls
+     */
+    bool HasWaterfall() const { return monitor_initialized_; }
+
+    /**
+     * The current waterfall (valid after StartSlot or ProcessAudio)
+     */
+    const ftx_waterfall_t* Waterfall() const { return &monitor_.wf; }
+
+    /**
+     * Layout of the current waterfall (valid after StartSlot or ProcessAudio)
+     */
+    WaterfallLayout Layout() const;
+
+    /**
+     * Sample rate of the audio in the current waterfall
+     */
+    int SampleRate() const { return monitor_sample_rate_; }
+
+    /**
+     * Replace the waterfall with blocks computed elsewhere
+     *
+     * Protocol, oversampling and frequency range of the configuration are
+     * changed to match the layout and the monitor is rebuilt for the sample
+     * rate, so the candidate and decode calls then run on the given blocks.
+     *
+     * @param protocol Protocol of the blocks
+     * @param sample_rate Sample rate of the audio the blocks came from
+     * @param layout Layout of the blocks
+     * @param mag num_blocks blocks of layout.block_stride magnitudes
+     * @param num_blocks Number of blocks
+     * @param error Receives a description of the problem on failure
+     * @return false if a waterfall of this geometry cannot hold the blocks;
+     *         the configuration is then left as it was
+     */
+    bool LoadWaterfall(ftx_protocol_t protocol, int sample_rate, const WaterfallLayout& layout,
+                       const WF_ELEM_T* mag, int num_blocks, std::string* error);
+
+    /**
+     * Number of times the waterfall memory has been allocated or released
+     *
+     * Pointers into Waterfall()->mag stay valid for as long as this value does
+     * not change.
+     */
+    uint64_t WaterfallGeneration() const { return waterfall_generation_; }
+
+    /**
+     * Find sync candidates in the current waterfall, strongest first
+     * @param candidates Receives the candidates
+     */
+    void FindCandidates(std::vector<ftx_candidate_t>* candidates);
+
+    /**
+     * Decode one candidate against the current waterfall
+     *
+     * The candidate's log-likelihoods are kept until the waterfall or the
+     * configuration changes, so retrying it with a larger LDPC budget or
+     * another engine skips the extraction. Decode() and DecodeFocused() do
+     * not keep them.
+     *
+     * @param candidate Candidate to decode
+     * @param result Receives the decoded message
+     * @param max_ldpc_iterations LDPC iteration limit; 0 uses the configured one
+     * @param engine LDPC check node update rule
+     * @return true if the candidate decoded and unpacked to text
+     */
+    bool DecodeCandidate(const ftx_candidate_t& candidate, DecodeResult* result, int max_ldpc_iterations = 0,
+                         LdpcEngine engine = LDPC_ENGINE_BP);
+
+    /**
+     * Forget the log-likelihoods kept by DecodeCandidate()
+     *
+     * Benchmarks that decode one waterfall repeatedly call this before each
+     * run, so every run pays for the extraction.
+     */
+    void InvalidateLikelihoods() { likelihood_cache_.clear(); }
+
+    /**
+     * Find and decode all candidates of the current waterfall
+     *
+     * With more than one pass configured, decoded messages are subtracted
+     * from a copy of the waterfall and the residual is searched again until
+     * a pass finds nothing new.
+     *
+     * @param results Receives the decoded messages
+     */
+    void Decode(std::vector<DecodeResult>* results);
+
+    /**
+     * Search and decode only a small region of the current waterfall
+     *
+     * Candidates are searched in the region alone, with the region's own score
+     * threshold and LDPC budget; messages decoded from several candidates are
+     * reported once.
+     *
+     * @param region Region and effort of the search
+     * @param results Receives the decoded messages
+     */
+    void DecodeFocused(const FocusRegion& region, std::vector<DecodeResult>* results);
+
+    /**
+     * Frequency of a candidate's lowest tone in Hz
+     */
+    float CandidateFrequency(const ftx_candidate_t& candidate) const;
+
+    /**
+     * Start time of a candidate in seconds from the start of the waterfall
+     */
+    float CandidateTime(const ftx_candidate_t& candidate) const;
+
+    /**
+     * Symbol period of the configured protocol in seconds
+     */
+    float SymbolPeriod() const;
+
+    /**
+     * Unpack the payload of a decoded message again
+     *
+     * Used after callsigns were added to the hash table, so hashed callsigns
+     * that could not be resolved at decode time are filled in.
+     *
+     * @param result Decoded message; text and type are updated
+     * @return true if the payload unpacked to text
+     */
+    bool Unpack(DecodeResult* result);
+
+    /**
+     * Forget all callsigns learned for hash lookups
+     */
+    void ClearHashTable() { InitializeHashTable(); }
+
+    /**
+     * Callsigns learned for hash lookups
+     */
+    std::vector<CallsignHash> HashEntries() const;
+
+    /**
+     * Add a callsign to the hash table
+     *
+     * When the table is full the callsign replaces an older one.
+     *
+     * @param callsign Callsign
+     * @param n22 Its 22-bit hash
+     * @return false if the table already had it
+     */
+    bool SaveHash(const char* callsign, uint32_t n22);
+
+    /**
+     * Set a read-only index of known callsigns, consulted before the hash table
+     * @param index Index, may be shared between decoders; null removes it
+     */
+    void SetCallsignIndex(std::shared_ptr<const CallsignIndex> index) { callsign_index_ = std::move(index); }
+
+    /**
+     * The index set with SetCallsignIndex
+     */
+    const std::shared_ptr<const CallsignIndex>& SeededIndex() const { return callsign_index_; }
+
+    /**
+     * Record the hash table activity of the following decode calls
+     * @param misses Receives every lookup that was not resolved, once per hash; null stops recording
+     * @param saves Receives the callsigns added to the hash table; null stops recording
+     */
+    void RecordHashActivity(std::vector<CallsignHashRequest>* misses, std::vector<CallsignHash>* saves) {
+        hash_misses_ = misses;
+        hash_saves_ = saves;
+    }
+
+    /**
+     * Turn collection of pipeline statistics on or off; counters are kept either way
+     */
+    void EnableStats(bool enabled) { stats_enabled_ = enabled; }
+
+    /**
+     * Whether pipeline statistics are being collected
+     */
+    bool StatsEnabled() const { return stats_enabled_; }
+
+    /**
+     * Pipeline statistics collected so far
+     */
+    const DecodeStats& Stats() const { return stats_; }
+
+    /**
+     * Clear the pipeline statistics
+     */
+    void ResetStats() { stats_ = DecodeStats(); }
+
+    /**
+     * Add statistics collected by another instance
+     */
+    void MergeStats(const DecodeStats& stats) { stats_.Merge(stats); }
+
+private:
+    DecoderConfig config_;
+
+    // Decode kernels for the configured protocol and oversampling
+    const DecodeKernels* kernels_;
+
+    // Pipeline statistics, only updated while stats_enabled_ is set
+    DecodeStats stats_;
+    bool stats_enabled_;
+
+    // Monitor for signal processing
+    monitor_t monitor_;
+    bool monitor_initialized_;
+    int monitor_sample_rate_;
+    uint64_t waterfall_generation_;
+
+    // Noise power and median magnitude per waterfall column, estimated once per waterfall on first use
+    std::vector<float> noise_floor_;
+    std::vector<WF_ELEM_T> noise_median_;
+    bool noise_floor_valid_;
+
+    // Waterfall with decoded messages subtracted, for decoding passes after the first
+    std::vector<WF_ELEM_T> residual_;
+
+    /**
+     * Find candidates in a waterfall with the configured limits
+     */
+    void FindCandidatesIn(const ftx_waterfall_t* wf, std::vector<ftx_candidate_t>* candidates);
+
+    /**
+     * Decode one candidate against a waterfall
+     */
+    bool DecodeCandidateIn(const ftx_waterfall_t* wf, const ftx_candidate_t& candidate, DecodeResult* result,
+                           int max_ldpc_iterations = 0, LdpcEngine engine = LDPC_ENGINE_BP,
+                           bool keep_likelihood = false);
+
+    /**
+     * Log-likelihoods of one candidate position
+     */
+    struct CachedLikelihood {
+        uint64_t key;
+        std::array<float, FTX_LDPC_N> log174;
+    };
+
+    // Log-likelihoods of the candidates passed to DecodeCandidate(), at most
+    // max_candidates of them; cleared whenever the waterfall or configuration changes
+    std::vector<CachedLikelihood> likelihood_cache_;
+
+    /**
+     * Cache key of a candidate position (the score is not part of it)
+     */
+    static uint64_t CandidateKey(const ftx_candidate_t& candidate);
+
+    /**
+     * Decoding passes after the first
+     * @param first Index in results of the first message of this decode
+     * @param results Messages decoded so far; receives the new ones
+     */
+    void DecodeResidual(size_t first, std::vector<DecodeResult>* results);
+
+    /**
+     * Noise floor of the current waterfall
+     */
+    const std::vector<float>& NoiseFloor();
+
+    /**
+     * Unpack a message's payload to text; the instance must be active
+     */
+    bool UnpackText(DecodeResult* result);
+
+    /**
+     * Initialize the monitor with current configuration
+     * @param sample_rate Sample rate of input audio
+     */
+    void InitializeMonitor(int sample_rate);
+
+    /**
+     * Simple callsign hash table
+     */
+    struct CallsignHashEntry {
+        char callsign[12];
+        uint32_t hash;
+        bool used;
+    };
+
+    static const int HASH_TABLE_SIZE = 1024;
+    CallsignHashEntry hash_table_[HASH_TABLE_SIZE];
+
+    // Known callsigns, looked up before the hash table
+    std::shared_ptr<const CallsignIndex> callsign_index_;
+
+    // Hash table activity recorded for the caller, if not null
+    std::vector<CallsignHashRequest>* hash_misses_;
+    std::vector<CallsignHash>* hash_saves_;
+
+    /**
+     * Initialize hash table
+     */
+    void InitializeHashTable();
+
+    /**
+     * Hash table lookup function
+     */
+    static bool HashTableLookup(ftx_callsign_hash_type_t hash_type, uint32_t hash, char* callsign);
+
+    /**
+     * Hash table save function
+     */
+    static void HashTableSave(const char* callsign, uint32_t hash);
+
+    /**
+     * ft8_lib's hash callbacks carry no context pointer, so the instance that is
+     * currently decoding on this thread is published here for the callbacks.
+     */
+    static thread_local DecoderCore* active_instance_;
+
+    /**
+     * Sets active_instance_ for the lifetime of a decode call
+     */
+    struct ActiveScope {
+        DecoderCore* previous;
+        explicit ActiveScope(DecoderCore* core) : previous(active_instance_) { active_instance_ = core; }
+        ~ActiveScope() { active_instance_ = previous; }
+    };
+};
+
+#endif // DECODER_CORE_H
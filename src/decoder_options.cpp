@@ -0,0 +1,74 @@
+#include "decoder_options.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+const char* const DECODER_NUMERIC_OPTIONS[] = {
+    "minScore",
+    "maxCandidates",
+    "maxLdpcIterations",
+    "maxDecodedMessages",
+    "freqOsr",
+    "timeOsr",
+    "frequencyMin",
+    "frequencyMax",
+    "passes"
+};
+const size_t NUM_DECODER_NUMERIC_OPTIONS = sizeof(DECODER_NUMERIC_OPTIONS) / sizeof(DECODER_NUMERIC_OPTIONS[0]);
+
+namespace {
+
+/**
+ * Truncate a value to int, saturating instead of overflowing
+ */
+int ToInt(double value) {
+    return (int)std::max<double>(INT_MIN, std::min<double>(INT_MAX, value));
+}
+
+} // namespace
+
+bool ParseProtocolName(const std::string& name, ftx_protocol_t* protocol) {
+    if (name == "FT8") {
+        *protocol = FTX_PROTOCOL_FT8;
+    } else if (name == "FT4") {
+        *protocol = FTX_PROTOCOL_FT4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SetDecoderOption(DecoderConfig* config, const std::string& name, double value, std::string* error) {
+    if (!std::isfinite(value)) {
+        *error = name + " must be a finite number";
+        return false;
+    }
+
+    if (name == "minScore") {
+        config->min_score = ToInt(value);
+    } else if (name == "maxCandidates") {
+        config->max_candidates = ToInt(value);
+    } else if (name == "maxLdpcIterations") {
+        config->max_ldpc_iterations = ToInt(value);
+    } else if (name == "maxDecodedMessages") {
+        config->max_decoded_messages = ToInt(value);
+    } else if (name == "freqOsr") {
+        config->freq_osr = ToInt(value);
+    } else if (name == "timeOsr") {
+        config->time_osr = ToInt(value);
+    } else if (name == "frequencyMin") {
+        config->freq_min = (float)value;
+    } else if (name == "frequencyMax") {
+        config->freq_max = (float)value;
+    } else if (name == "passes") {
+        if (ToInt(value) < 1) {
+            *error = "passes must be at least 1";
+            return false;
+        }
+        config->passes = ToInt(value);
+    } else {
+        *error = "Unknown decoder option: " + name;
+        return false;
+    }
+    return true;
+}
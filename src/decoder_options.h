@@ -0,0 +1,40 @@
+#ifndef DECODER_OPTIONS_H
+#define DECODER_OPTIONS_H
+
+#include <cstddef>
+#include <string>
+#include "decoder_core.h"
+
+/**
+ * Decoder tuning knobs by name
+ *
+ * The names are the option keys of the JavaScript API (minScore, freqOsr,
+ * ...). MessageDecoder and the native command line decoder both set their
+ * configuration through these, so the knobs and their checks stay the same.
+ */
+
+/**
+ * Names of the numeric options, in documentation order
+ */
+extern const char* const DECODER_NUMERIC_OPTIONS[];
+extern const size_t NUM_DECODER_NUMERIC_OPTIONS;
+
+/**
+ * Parse a protocol name
+ * @param name "FT8" or "FT4"
+ * @param protocol Receives the protocol
+ * @return false for any other name
+ */
+bool ParseProtocolName(const std::string& name, ftx_protocol_t* protocol);
+
+/**
+ * Set a numeric option
+ * @param config Configuration to update
+ * @param name One of DECODER_NUMERIC_OPTIONS
+ * @param value New value; integer options truncate it
+ * @param error Receives a description of the problem on failure
+ * @return false if the name is unknown or the value out of range
+ */
+bool SetDecoderOption(DecoderConfig* config, const std::string& name, double value, std::string* error);
+
+#endif // DECODER_OPTIONS_H
@@ -0,0 +1,514 @@
+#include "decoder_tuner.h"
+#include "decoder_core.h"
+#include "decoder_wrapper.h"
+#include "trace.h"
+#include "wav_file.h"
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Upper bound on the configurations of one sweep
+const size_t TUNER_MAX_CONFIGS = 4096;
+
+namespace {
+
+/**
+ * CPU time consumed by the calling thread, so other load on the host does not skew results
+ */
+uint64_t ThreadCpuNs() {
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (k + u) * 100;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * One slot of the corpus, with the messages it is known to contain
+ */
+struct TuneSlot {
+    std::string path;
+    std::vector<float> samples;
+    int sample_rate = 0;
+    bool has_expected = false;
+    std::set<std::string> expected;
+};
+
+/**
+ * Values swept for each parameter
+ */
+struct TuneGrid {
+    std::vector<int> min_score = {5, 10, 20};
+    std::vector<int> max_candidates = {50, 100, 140, 200};
+    std::vector<int> max_ldpc_iterations = {10, 25, 50};
+    std::vector<int> freq_osr = {1, 2};
+    std::vector<int> time_osr = {1, 2};
+};
+
+/**
+ * Measurements of one configuration over the whole corpus
+ */
+struct TuneResult {
+    DecoderConfig config;
+    std::vector<std::set<std::string>> decoded;
+    std::vector<uint64_t> slot_ns;
+    size_t found = 0;
+    size_t extra = 0;
+    double mean_ms = 0;
+    double max_ms = 0;
+    bool pareto = false;
+};
+
+/**
+ * Runs the sweep on the libuv thread pool
+ */
+class TuneWorker : public Napi::AsyncWorker {
+public:
+    TuneWorker(Napi::Env env, std::vector<TuneSlot>&& slots, const DecoderConfig& base, const TuneGrid& grid,
+               int repeat, double budget_ms)
+        : Napi::AsyncWorker(env, "ft8_lib:tuneDecoder"),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          slots_(std::move(slots)),
+          base_(base),
+          grid_(grid),
+          repeat_(repeat),
+          budget_ms_(budget_ms),
+          reference_messages_(0) {
+    }
+    
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        TraceSetThreadName("tuneDecoder");
+        TraceScope trace("tuneDecoder", "tuner");
+        
+        if (!LoadSlots()) {
+            return;
+        }
+        
+        // The waterfall only depends on the oversampling, so each slot goes
+        // through the monitor once per oversampling pair and is then decoded
+        // with every remaining parameter combination.
+        for (int freq_osr : grid_.freq_osr) {
+            for (int time_osr : grid_.time_osr) {
+                SweepWaterfall(freq_osr, time_osr);
+            }
+        }
+        
+        Score();
+    }
+    
+    void OnOK() override {
+        Napi::Env env = Env();
+        
+        Napi::Array configs = Napi::Array::New(env, results_.size());
+        Napi::Array pareto = Napi::Array::New(env);
+        for (size_t i = 0; i < order_.size(); ++i) {
+            const TuneResult& result = results_[order_[i]];
+            Napi::Object entry = ResultToObject(env, result);
+            configs.Set(i, entry);
+            if (result.pareto) {
+                pareto.Set(pareto.Length(), entry);
+            }
+        }
+        
+        Napi::Object report = Napi::Object::New(env);
+        report.Set("slots", Napi::Number::New(env, (double)slots_.size()));
+        report.Set("referenceMessages", Napi::Number::New(env, (double)reference_messages_));
+        report.Set("budgetMs", budget_ms_ > 0 ? Napi::Number::New(env, budget_ms_) : env.Null());
+        report.Set("configs", configs);
+        report.Set("pareto", pareto);
+        
+        Napi::Value recommended = env.Null();
+        for (size_t i = 0; i < order_.size(); ++i) {
+            if ((int)order_[i] == recommended_) {
+                recommended = configs.Get(i);
+            }
+        }
+        report.Set("recommended", recommended);
+        
+        deferred_.Resolve(report);
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<TuneSlot> slots_;
+    DecoderConfig base_;
+    TuneGrid grid_;
+    int repeat_;
+    double budget_ms_;
+    
+    std::vector<TuneResult> results_;
+    // Indices into results_ from fastest to slowest
+    std::vector<size_t> order_;
+    size_t reference_messages_;
+    int recommended_ = -1;
+    
+    bool LoadSlots() {
+        for (TuneSlot& slot : slots_) {
+            if (slot.path.empty()) {
+                continue;
+            }
+            
+            WavFile wav;
+            std::string error;
+            if (!wav.Open(slot.path, &error)) {
+                SetError(error);
+                return false;
+            }
+            
+            slot.sample_rate = wav.SampleRate();
+            slot.samples.resize((size_t)wav.NumFrames());
+            size_t read = 0;
+            while (read < slot.samples.size()) {
+                size_t n = wav.Read(slot.samples.data() + read, slot.samples.size() - read);
+                if (n == 0) {
+                    break;
+                }
+                read += n;
+            }
+            slot.samples.resize(read);
+        }
+        return true;
+    }
+    
+    void SweepWaterfall(int freq_osr, int time_osr) {
+        DecoderConfig config = base_;
+        config.freq_osr = freq_osr;
+        config.time_osr = time_osr;
+        
+        // Results of this waterfall, in the same order as the loops below
+        size_t first = results_.size();
+        for (int min_score : grid_.min_score) {
+            for (int max_candidates : grid_.max_candidates) {
+                for (int max_ldpc_iterations : grid_.max_ldpc_iterations) {
+                    TuneResult result;
+                    result.config = config;
+                    result.config.min_score = min_score;
+                    result.config.max_candidates = max_candidates;
+                    result.config.max_ldpc_iterations = max_ldpc_iterations;
+                    result.decoded.resize(slots_.size());
+                    result.slot_ns.resize(slots_.size());
+                    results_.push_back(result);
+                }
+            }
+        }
+        
+        DecoderCore core(config);
+        std::vector<DecodeResult> decoded;
+        
+        for (size_t s = 0; s < slots_.size(); ++s) {
+            const TuneSlot& slot = slots_[s];
+            
+            // Best of the repeats filters out preemption and cache warm-up
+            uint64_t monitor_ns = UINT64_MAX;
+            for (int r = 0; r < repeat_; ++r) {
+                uint64_t start = ThreadCpuNs();
+                core.ProcessAudio(slot.samples.data(), (int)slot.samples.size(), slot.sample_rate);
+                monitor_ns = std::min(monitor_ns, ThreadCpuNs() - start);
+            }
+            
+            for (size_t i = first; i < results_.size(); ++i) {
+                TuneResult& result = results_[i];
+                core.SetConfig(result.config);
+                
+                uint64_t decode_ns = UINT64_MAX;
+                for (int r = 0; r < repeat_; ++r) {
+                    // Each slot is decoded as if it were the first one heard
+                    core.ClearHashTable();
+                    core.InvalidateLikelihoods();
+                    decoded.clear();
+                    uint64_t start = ThreadCpuNs();
+                    core.Decode(&decoded);
+                    decode_ns = std::min(decode_ns, ThreadCpuNs() - start);
+                }
+                
+                result.slot_ns[s] = monitor_ns + decode_ns;
+                for (const DecodeResult& message : decoded) {
+                    result.decoded[s].insert(message.text);
+                }
+            }
+        }
+    }
+    
+    void Score() {
+        // Slots without known decodes are scored against everything any configuration found
+        std::vector<std::set<std::string>> reference(slots_.size());
+        for (size_t s = 0; s < slots_.size(); ++s) {
+            if (slots_[s].has_expected) {
+                reference[s] = slots_[s].expected;
+            } else {
+                for (const TuneResult& result : results_) {
+                    reference[s].insert(result.decoded[s].begin(), result.decoded[s].end());
+                }
+            }
+            reference_messages_ += reference[s].size();
+        }
+        
+        for (TuneResult& result : results_) {
+            uint64_t total_ns = 0;
+            uint64_t max_ns = 0;
+            for (size_t s = 0; s < slots_.size(); ++s) {
+                for (const std::string& text : result.decoded[s]) {
+                    if (reference[s].count(text)) {
+                        result.found++;
+                    } else {
+                        result.extra++;
+                    }
+                }
+                total_ns += result.slot_ns[s];
+                max_ns = std::max(max_ns, result.slot_ns[s]);
+            }
+            result.mean_ms = slots_.empty() ? 0 : total_ns / 1e6 / slots_.size();
+            result.max_ms = max_ns / 1e6;
+        }
+        
+        // A configuration is Pareto-optimal if no other finds as many messages in less time
+        for (TuneResult& result : results_) {
+            result.pareto = true;
+            for (const TuneResult& other : results_) {
+                bool no_worse = other.found >= result.found && other.mean_ms <= result.mean_ms;
+                bool better = other.found > result.found || other.mean_ms < result.mean_ms;
+                if (no_worse && better) {
+                    result.pareto = false;
+                    break;
+                }
+            }
+        }
+        
+        order_.resize(results_.size());
+        for (size_t i = 0; i < order_.size(); ++i) {
+            order_[i] = i;
+        }
+        std::stable_sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+            return results_[a].mean_ms < results_[b].mean_ms;
+        });
+        
+        // The recommendation is the Pareto point finding the most whose slowest slot fits the budget
+        for (size_t i : order_) {
+            const TuneResult& result = results_[i];
+            if (!result.pareto || (budget_ms_ > 0 && result.max_ms > budget_ms_)) {
+                continue;
+            }
+            if (recommended_ < 0 || result.found > results_[recommended_].found) {
+                recommended_ = (int)i;
+            }
+        }
+    }
+    
+    Napi::Object ResultToObject(Napi::Env env, const TuneResult& result) const {
+        const DecoderConfig& c = result.config;
+        
+        Napi::Object config = Napi::Object::New(env);
+        config.Set("protocol", Napi::String::New(env, (c.protocol == FTX_PROTOCOL_FT8) ? "FT8" : "FT4"));
+        config.Set("minScore", Napi::Number::New(env, c.min_score));
+        config.Set("maxCandidates", Napi::Number::New(env, c.max_candidates));
+        config.Set("maxLdpcIterations", Napi::Number::New(env, c.max_ldpc_iterations));
+        config.Set("freqOsr", Napi::Number::New(env, c.freq_osr));
+        config.Set("timeOsr", Napi::Number::New(env, c.time_osr));
+        
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("config", config);
+        entry.Set("found", Napi::Number::New(env, (double)result.found));
+        entry.Set("extra", Napi::Number::New(env, (double)result.extra));
+        entry.Set("recall", Napi::Number::New(env, reference_messages_ ? (double)result.found / reference_messages_ : 0));
+        entry.Set("meanMs", Napi::Number::New(env, result.mean_ms));
+        entry.Set("maxMs", Napi::Number::New(env, result.max_ms));
+        entry.Set("pareto", Napi::Boolean::New(env, result.pareto));
+        return entry;
+    }
+};
+
+/**
+ * Read a grid axis given as a number or an array of numbers
+ */
+bool ParseAxis(Napi::Env env, const Napi::Object& grid, const char* name, int min_value, int max_value,
+               std::vector<int>* values) {
+    if (!grid.Has(name)) {
+        return true;
+    }
+    
+    Napi::Value value = grid.Get(name);
+    std::vector<int> parsed;
+    if (value.IsNumber()) {
+        parsed.push_back(value.As<Napi::Number>().Int32Value());
+    } else if (value.IsArray()) {
+        Napi::Array array = value.As<Napi::Array>();
+        for (uint32_t i = 0; i < array.Length(); ++i) {
+            Napi::Value element = array.Get(i);
+            if (!element.IsNumber()) {
+                Napi::TypeError::New(env, std::string("grid.") + name + " must contain numbers").ThrowAsJavaScriptException();
+                return false;
+            }
+            parsed.push_back(element.As<Napi::Number>().Int32Value());
+        }
+    } else {
+        Napi::TypeError::New(env, std::string("grid.") + name + " must be a number or an array").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    if (parsed.empty()) {
+        Napi::RangeError::New(env, std::string("grid.") + name + " must not be empty").ThrowAsJavaScriptException();
+        return false;
+    }
+    for (int v : parsed) {
+        if (v < min_value || v > max_value) {
+            Napi::RangeError::New(env, std::string("grid.") + name + " values must be between " +
+                                  std::to_string(min_value) + " and " + std::to_string(max_value)).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    
+    *values = parsed;
+    return true;
+}
+
+/**
+ * Read one corpus entry: a WAV path, or {path | audio, expected}
+ */
+bool ParseSlot(Napi::Env env, const Napi::Value& item, TuneSlot* slot) {
+    if (item.IsString()) {
+        slot->path = item.As<Napi::String>().Utf8Value();
+        return true;
+    }
+    if (!item.IsObject()) {
+        Napi::TypeError::New(env, "Corpus entries must be WAV paths or objects").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    Napi::Object obj = item.As<Napi::Object>();
+    if (obj.Has("path")) {
+        slot->path = obj.Get("path").As<Napi::String>().Utf8Value();
+    } else if (obj.Has("audio")) {
+        Napi::Value audio = obj.Get("audio");
+        if (!audio.IsObject() || !audio.As<Napi::Object>().Get("samples").IsTypedArray()) {
+            Napi::TypeError::New(env, "Corpus audio must be an AudioBuffer").ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::Object buffer = audio.As<Napi::Object>();
+        Napi::Float32Array samples = buffer.Get("samples").As<Napi::Float32Array>();
+        slot->samples.assign(samples.Data(), samples.Data() + samples.ElementLength());
+        slot->sample_rate = buffer.Get("sampleRate").As<Napi::Number>().Int32Value();
+        if (slot->sample_rate <= 0) {
+            Napi::RangeError::New(env, "Corpus audio needs a positive sampleRate").ThrowAsJavaScriptException();
+            return false;
+        }
+    } else {
+        Napi::TypeError::New(env, "Corpus entries need a 'path' or 'audio' property").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    if (obj.Has("expected")) {
+        Napi::Value expected = obj.Get("expected");
+        if (!expected.IsArray()) {
+            Napi::TypeError::New(env, "'expected' must be an array of message strings").ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::Array texts = expected.As<Napi::Array>();
+        slot->has_expected = true;
+        for (uint32_t i = 0; i < texts.Length(); ++i) {
+            slot->expected.insert(texts.Get(i).As<Napi::String>().Utf8Value());
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Napi::Function DecoderTuner::TuneDecoder(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsArray() || info[0].As<Napi::Array>().Length() == 0) {
+            Napi::TypeError::New(env, "Expected a non-empty array of corpus slots").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        Napi::Array corpus = info[0].As<Napi::Array>();
+        std::vector<TuneSlot> slots(corpus.Length());
+        for (uint32_t i = 0; i < corpus.Length(); ++i) {
+            if (!ParseSlot(env, corpus.Get(i), &slots[i])) {
+                return env.Null();
+            }
+        }
+        
+        DecoderConfig base;
+        TuneGrid grid;
+        int repeat = 1;
+        double budget_ms = 0;
+        
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            
+            // Protocol, frequency range and message limit apply to every configuration
+            if (!MessageDecoder::ParseConfig(env, options, &base)) {
+                return env.Null();
+            }
+            
+            if (options.Has("cpuBudgetMs")) {
+                budget_ms = options.Get("cpuBudgetMs").As<Napi::Number>().DoubleValue();
+                if (!(budget_ms > 0)) {
+                    Napi::RangeError::New(env, "cpuBudgetMs must be positive").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+            if (options.Has("repeat")) {
+                repeat = options.Get("repeat").As<Napi::Number>().Int32Value();
+                if (repeat < 1 || repeat > 100) {
+                    Napi::RangeError::New(env, "repeat must be between 1 and 100").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+            if (options.Has("grid")) {
+                if (!options.Get("grid").IsObject()) {
+                    Napi::TypeError::New(env, "grid must be an object").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                Napi::Object g = options.Get("grid").As<Napi::Object>();
+                if (!ParseAxis(env, g, "minScore", 0, 1000, &grid.min_score) ||
+                    !ParseAxis(env, g, "maxCandidates", 1, 1000, &grid.max_candidates) ||
+                    !ParseAxis(env, g, "maxLdpcIterations", 1, 1000, &grid.max_ldpc_iterations) ||
+                    !ParseAxis(env, g, "freqOsr", 1, 8, &grid.freq_osr) ||
+                    !ParseAxis(env, g, "timeOsr", 1, 8, &grid.time_osr)) {
+                    return env.Null();
+                }
+            }
+        }
+        
+        size_t num_configs = grid.min_score.size() * grid.max_candidates.size() * grid.max_ldpc_iterations.size() *
+                             grid.freq_osr.size() * grid.time_osr.size();
+        if (num_configs > TUNER_MAX_CONFIGS) {
+            Napi::RangeError::New(env, "grid has more than " + std::to_string(TUNER_MAX_CONFIGS) + " configurations").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        TuneWorker* worker = new TuneWorker(env, std::move(slots), base, grid, repeat, budget_ms);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    });
+}
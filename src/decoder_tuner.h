@@ -0,0 +1,23 @@
+#ifndef DECODER_TUNER_H
+#define DECODER_TUNER_H
+
+#include <napi.h>
+
+/**
+ * DecoderTuner sweeps decoder configurations over a corpus of slots
+ *
+ * Every configuration of a parameter grid decodes every slot; decodes found
+ * are weighed against the CPU time per slot and the Pareto-optimal
+ * configurations are reported, along with the best one that fits a budget.
+ */
+class DecoderTuner {
+public:
+    /**
+     * Sweep decoder configurations over a corpus
+     * @param env N-API environment
+     * @return N-API function returning a Promise of the tuning report
+     */
+    static Napi::Function TuneDecoder(Napi::Env env);
+};
+
+#endif // DECODER_TUNER_H
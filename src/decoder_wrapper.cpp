@@ -1,7 +1,15 @@
 #include "decoder_wrapper.h"
+#include "callsign_hash.h"
+#include "decoder_options.h"
+#include "message_pack.h"
+#include "parallel.h"
+#include "slot_pool.h"
+#include "spectrum_file.h"
+#include "trace.h"
 #include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 #include <vector>
 
 extern "C" {
@@ -11,227 +19,395 @@ extern "C" {
 #include <common/monitor.h>
 }
 
-// Default configuration values
-const int DEFAULT_MIN_SCORE = 10;
-const int DEFAULT_MAX_CANDIDATES = 140;
-const int DEFAULT_MAX_LDPC_ITERATIONS = 25;
-const int DEFAULT_MAX_DECODED_MESSAGES = 50;
-const int DEFAULT_FREQ_OSR = 2;
-const int DEFAULT_TIME_OSR = 2;
-const float DEFAULT_FREQ_MIN = 200.0f;
-const float DEFAULT_FREQ_MAX = 3000.0f;
+// Defaults of decodeFocused: span searched around centerHz and candidates decoded
+const float FOCUS_DEFAULT_SPAN_HZ = 100.0f;
+const int FOCUS_DEFAULT_MAX_CANDIDATES = 20;
 
-// Static instance pointer for C callbacks
-MessageDecoder* MessageDecoder::current_instance_ = nullptr;
+// Start blocks searched by ftx_find_candidates(), the default time window of decodeFocused
+const int FOCUS_TIME_MIN_BLOCKS = -10;
+const int FOCUS_TIME_MAX_BLOCKS = 19;
 
-Napi::Function MessageDecoder::Init(Napi::Env env) {
-    Napi::Function func = DefineClass(env, "MessageDecoder", {
-        InstanceMethod("decode", &MessageDecoder::Decode),
-        InstanceMethod("findCandidates", &MessageDecoder::FindCandidates),
-        InstanceMethod("decodeCandidate", &MessageDecoder::DecodeCandidate)
-    });
-    
-    return func;
-}
+namespace {
 
-MessageDecoder::MessageDecoder(const Napi::CallbackInfo& info) : Napi::ObjectWrap<MessageDecoder>(info) {
-    Napi::Env env = info.Env();
-    
-    // Set default values
-    protocol_ = FTX_PROTOCOL_FT8;
-    min_score_ = DEFAULT_MIN_SCORE;
-    max_candidates_ = DEFAULT_MAX_CANDIDATES;
-    max_ldpc_iterations_ = DEFAULT_MAX_LDPC_ITERATIONS;
-    max_decoded_messages_ = DEFAULT_MAX_DECODED_MESSAGES;
-    freq_osr_ = DEFAULT_FREQ_OSR;
-    time_osr_ = DEFAULT_TIME_OSR;
-    freq_min_ = DEFAULT_FREQ_MIN;
-    freq_max_ = DEFAULT_FREQ_MAX;
-    monitor_initialized_ = false;
+/**
+ * Decodes a WAV file on a pool of threads
+ *
+ * The worker's own Execute thread runs DecodeSlotsInOrder and forwards the
+ * slots in time order, so the onSlot callback and the collected messages are
+ * always chronological.
+ */
+class DecodeFileWorker : public Napi::AsyncProgressQueueWorker<DecodedSlot> {
+public:
+    DecodeFileWorker(Napi::Env env, const std::string& path, const DecoderConfig& config,
+                     std::shared_ptr<const CallsignIndex> callsign_index,
+                     unsigned threads, bool has_start_time, double start_time, Napi::Function on_slot,
+                     Napi::Object decoder, DecoderCore* stats_target)
+        : Napi::AsyncProgressQueueWorker<DecodedSlot>(env, "ft8_lib:MessageDecoder.decodeFile"),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(path),
+          config_(config),
+          callsign_index_(std::move(callsign_index)),
+          threads_(threads),
+          has_start_time_(has_start_time),
+          start_time_(start_time),
+          sample_rate_(0),
+          decoded_count_(0),
+          stats_target_(stats_target) {
+        if (!on_slot.IsEmpty()) {
+            on_slot_ = Napi::Persistent(on_slot);
+        }
+        if (stats_target_) {
+            decoder_ref_ = Napi::Persistent(decoder);
+        }
+    }
     
-    // Parse configuration if provided
-    if (info.Length() > 0 && info[0].IsObject()) {
-        Napi::Object config = info[0].As<Napi::Object>();
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        WavSlotSource source;
+        std::string error;
+        float slot_time = (config_.protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+        if (!source.Open(path_, slot_time, has_start_time_, start_time_, &error)) {
+            SetError(error);
+            return;
+        }
         
-        if (config.Has("protocol")) {
-            std::string protocol = config.Get("protocol").As<Napi::String>().Utf8Value();
-            if (protocol == "FT8") {
-                protocol_ = FTX_PROTOCOL_FT8;
-            } else if (protocol == "FT4") {
-                protocol_ = FTX_PROTOCOL_FT4;
+        sample_rate_ = source.SampleRate();
+        layout_ = source.Layout();
+        if (layout_.num_slots == 0) {
+            return;
+        }
+        
+        SlotPoolOptions options;
+        options.config = config_;
+        options.callsign_index = callsign_index_;
+        options.sample_rate = sample_rate_;
+        options.slot_samples = layout_.slot_samples;
+        options.threads = (unsigned)std::min<int64_t>(ResolveThreadCount(threads_), layout_.num_slots);
+        options.thread_name = "decodeFile";
+        options.stats = stats_target_ ? &stats_ : nullptr;
+        
+        bool ok = DecodeSlotsInOrder(&source, options, [&](DecodedSlot& slot) {
+            decoded_count_ += slot.messages.size();
+            if (on_slot_.IsEmpty()) {
+                for (DecodeResult& message : slot.messages) {
+                    collected_.push_back(CollectedMessage{slot.index, slot.start_sample, std::move(message)});
+                }
             } else {
-                Napi::TypeError::New(env, "Invalid protocol. Must be 'FT8' or 'FT4'").ThrowAsJavaScriptException();
-                return;
+                progress.Send(&slot, 1);
             }
+        }, &error);
+        if (!ok) {
+            SetError(error);
         }
+    }
+    
+    void OnProgress(const DecodedSlot* data, size_t count) override {
+        Napi::Env env = Env();
+        Napi::HandleScope scope(env);
         
-        if (config.Has("minScore")) {
-            min_score_ = config.Get("minScore").As<Napi::Number>().Int32Value();
-        }
-        if (config.Has("maxCandidates")) {
-            max_candidates_ = config.Get("maxCandidates").As<Napi::Number>().Int32Value();
-        }
-        if (config.Has("maxLdpcIterations")) {
-            max_ldpc_iterations_ = config.Get("maxLdpcIterations").As<Napi::Number>().Int32Value();
-        }
-        if (config.Has("maxDecodedMessages")) {
-            max_decoded_messages_ = config.Get("maxDecodedMessages").As<Napi::Number>().Int32Value();
-        }
-        if (config.Has("freqOsr")) {
-            freq_osr_ = config.Get("freqOsr").As<Napi::Number>().Int32Value();
+        for (size_t i = 0; i < count; ++i) {
+            const DecodedSlot& slot = data[i];
+            
+            Napi::Array messages = Napi::Array::New(env, slot.messages.size());
+            for (size_t j = 0; j < slot.messages.size(); ++j) {
+                messages.Set(j, CreateMessage(env, slot.index, slot.start_sample, slot.messages[j]));
+            }
+            
+            Napi::Object result = Napi::Object::New(env);
+            result.Set("index", Napi::Number::New(env, (double)slot.index));
+            result.Set("startTime", Napi::Number::New(env, (double)slot.start_sample / sample_rate_));
+            if (has_start_time_) {
+                result.Set("utcStart", Napi::Number::New(env, std::round(UtcTime(slot.start_sample, 0.0f))));
+            }
+            result.Set("validSamples", Napi::Number::New(env, slot.valid_samples));
+            result.Set("messages", messages);
+            
+            on_slot_.Call({result});
         }
-        if (config.Has("timeOsr")) {
-            time_osr_ = config.Get("timeOsr").As<Napi::Number>().Int32Value();
+    }
+    
+    void OnOK() override {
+        Napi::Env env = Env();
+        
+        if (stats_target_) {
+            stats_target_->MergeStats(stats_);
         }
-        if (config.Has("frequencyMin")) {
-            freq_min_ = config.Get("frequencyMin").As<Napi::Number>().FloatValue();
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("slots", Napi::Number::New(env, (double)layout_.num_slots));
+        result.Set("decoded", Napi::Number::New(env, (double)decoded_count_));
+        result.Set("sampleRate", Napi::Number::New(env, sample_rate_));
+        
+        if (on_slot_.IsEmpty()) {
+            Napi::Array messages = Napi::Array::New(env, collected_.size());
+            for (size_t i = 0; i < collected_.size(); ++i) {
+                const CollectedMessage& entry = collected_[i];
+                messages.Set(i, CreateMessage(env, entry.slot, entry.start_sample, entry.result));
+            }
+            result.Set("messages", messages);
         }
-        if (config.Has("frequencyMax")) {
-            freq_max_ = config.Get("frequencyMax").As<Napi::Number>().FloatValue();
+        
+        deferred_.Resolve(result);
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    struct CollectedMessage {
+        int64_t slot;
+        int64_t start_sample;
+        DecodeResult result;
+    };
+    
+    Napi::Promise::Deferred deferred_;
+    Napi::FunctionReference on_slot_;
+    std::string path_;
+    DecoderConfig config_;
+    std::shared_ptr<const CallsignIndex> callsign_index_;
+    unsigned threads_;
+    bool has_start_time_;
+    double start_time_;
+    int sample_rate_;
+    WavSlotLayout layout_;
+    
+    size_t decoded_count_;
+    std::vector<CollectedMessage> collected_;
+    
+    // Decoder whose statistics receive those of the pool threads, kept alive by decoder_ref_
+    DecoderCore* stats_target_;
+    Napi::ObjectReference decoder_ref_;
+    DecodeStats stats_;
+    
+    /**
+     * UTC time in ms of a point within a slot
+     */
+    double UtcTime(int64_t start_sample, float offset) const {
+        return start_time_ + 1000.0 * ((double)start_sample / sample_rate_ + offset);
+    }
+    
+    Napi::Object CreateMessage(Napi::Env env, int64_t slot, int64_t start_sample, const DecodeResult& decoded) const {
+        Napi::Object message = MessageDecoder::CreateDecodedMessageObject(env, decoded);
+        message.Set("score", Napi::Number::New(env, decoded.candidate.score));
+        message.Set("slot", Napi::Number::New(env, (double)slot));
+        message.Set("fileTime", Napi::Number::New(env, (double)start_sample / sample_rate_ + decoded.time_offset));
+        if (has_start_time_) {
+            message.Set("utcTime", Napi::Number::New(env, std::round(UtcTime(start_sample, decoded.time_offset))));
         }
+        return message;
+    }
+};
+
+Napi::Object CreateHistogramObject(Napi::Env env, const Log2Histogram& histogram) {
+    // Trailing empty buckets are left out
+    int used = Log2Histogram::NUM_BUCKETS;
+    while (used > 0 && histogram.counts[used - 1] == 0) {
+        --used;
+    }
+    
+    Napi::Array bounds = Napi::Array::New(env, used);
+    Napi::Array counts = Napi::Array::New(env, used);
+    for (int i = 0; i < used; ++i) {
+        bounds.Set(i, Napi::Number::New(env, std::ldexp(1.0, i)));
+        counts.Set(i, Napi::Number::New(env, (double)histogram.counts[i]));
     }
     
-    InitializeHashTable();
-    current_instance_ = this;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("bounds", bounds);
+    result.Set("counts", counts);
+    return result;
 }
 
-MessageDecoder::~MessageDecoder() {
-    if (monitor_initialized_) {
-        monitor_free(&monitor_);
+/**
+ * Bytes of an ArrayBuffer or typed array argument
+ * @param value Argument
+ * @param data Receives the first byte
+ * @param size Receives the number of bytes
+ * @return false if the value is neither
+ */
+bool GetBytesArgument(const Napi::Value& value, const uint8_t** data, size_t* size) {
+    if (value.IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = value.As<Napi::ArrayBuffer>();
+        *data = static_cast<const uint8_t*>(buffer.Data());
+        *size = buffer.ByteLength();
+        return true;
     }
-    if (current_instance_ == this) {
-        current_instance_ = nullptr;
+    if (value.IsTypedArray()) {
+        Napi::TypedArray array = value.As<Napi::TypedArray>();
+        *data = static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+        *size = array.ByteLength();
+        return true;
     }
+    return false;
 }
 
-void MessageDecoder::InitializeHashTable() {
-    for (int i = 0; i < HASH_TABLE_SIZE; ++i) {
-        hash_table_[i].used = false;
-        hash_table_[i].callsign[0] = '\0';
-        hash_table_[i].hash = 0;
-    }
+/**
+ * Finalizer hint of a getWaterfall view; the view holds a reference to its decoder
+ */
+struct WaterfallViewHint {
+    MessageDecoder* decoder;
+    std::weak_ptr<int> token;
+};
+
+Napi::Object CreateStageObject(Napi::Env env, uint64_t count, uint64_t ns) {
+    Napi::Object stage = Napi::Object::New(env);
+    stage.Set("count", Napi::Number::New(env, (double)count));
+    stage.Set("totalMs", Napi::Number::New(env, ns / 1e6));
+    return stage;
 }
 
-bool MessageDecoder::HashTableLookup(ftx_callsign_hash_type_t hash_type, uint32_t hash, char* callsign) {
-    if (!current_instance_) {
-        callsign[0] = '\0';
-        return false;
-    }
+} // namespace
+
+Napi::Function MessageDecoder::Init(Napi::Env env) {
+    Napi::Function func = DefineClass(env, "MessageDecoder", {
+        InstanceMethod("decode", &MessageDecoder::Decode),
+        InstanceMethod("decodeToBuffer", &MessageDecoder::DecodeToBuffer),
+        InstanceMethod("findCandidates", &MessageDecoder::FindCandidates),
+        InstanceMethod("decodeCandidate", &MessageDecoder::DecodeCandidate),
+        InstanceMethod("decodeFocused", &MessageDecoder::DecodeFocused),
+        InstanceMethod("getWaterfall", &MessageDecoder::GetWaterfall),
+        InstanceMethod("serializeSpectrum", &MessageDecoder::SerializeSpectrum),
+        InstanceMethod("loadSpectrum", &MessageDecoder::LoadSpectrum),
+        InstanceMethod("decodeFile", &MessageDecoder::DecodeFile),
+        InstanceMethod("exportHashes", &MessageDecoder::ExportHashes),
+        InstanceMethod("importHashes", &MessageDecoder::ImportHashes),
+        InstanceMethod("seedHashes", &MessageDecoder::SeedHashes),
+        InstanceMethod("getStats", &MessageDecoder::GetStats),
+        InstanceMethod("resetStats", &MessageDecoder::ResetStats),
+        InstanceMethod("setStatsEnabled", &MessageDecoder::SetStatsEnabled),
+        StaticMethod("unpackMessages", &MessageDecoder::UnpackMessages)
+    });
     
-    uint8_t hash_shift = (hash_type == FTX_CALLSIGN_HASH_10_BITS) ? 12 : 
-                        (hash_type == FTX_CALLSIGN_HASH_12_BITS ? 10 : 0);
-    uint16_t hash10 = (hash >> (12 - hash_shift)) & 0x3FFu;
-    int idx_hash = (hash10 * 23) % HASH_TABLE_SIZE;
+    return func;
+}
+
+MessageDecoder::MessageDecoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<MessageDecoder>(info),
+      waterfall_view_generation_(0),
+      view_token_(std::make_shared<int>(0)),
+      profile_level_(-1) {
+    Napi::Env env = info.Env();
     
-    while (current_instance_->hash_table_[idx_hash].used) {
-        if (((current_instance_->hash_table_[idx_hash].hash & 0x3FFFFFu) >> hash_shift) == hash) {
-            strcpy(callsign, current_instance_->hash_table_[idx_hash].callsign);
-            return true;
+    // Parse configuration if provided
+    if (info.Length() > 0 && info[0].IsObject()) {
+        DecoderConfig config;
+        if (!ParseConfig(env, info[0].As<Napi::Object>(), &config)) {
+            return;
+        }
+        core_.SetConfig(config);
+        base_config_ = config;
+        
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Has("collectStats")) {
+            core_.EnableStats(options.Get("collectStats").ToBoolean().Value());
+        }
+        if (options.Has("loadController") && !options.Get("loadController").IsUndefined()) {
+            if (!LoadController::FromValue(env, options.Get("loadController"), &governor_)) {
+                return;
+            }
         }
-        idx_hash = (idx_hash + 1) % HASH_TABLE_SIZE;
     }
-    
-    callsign[0] = '\0';
-    return false;
 }
 
-void MessageDecoder::HashTableSave(const char* callsign, uint32_t hash) {
-    if (!current_instance_) return;
-    
-    uint16_t hash10 = (hash >> 12) & 0x3FFu;
-    int idx_hash = (hash10 * 23) % HASH_TABLE_SIZE;
+bool MessageDecoder::ParseConfig(Napi::Env env, const Napi::Object& obj, DecoderConfig* config) {
+    if (obj.Has("protocol")) {
+        std::string protocol = obj.Get("protocol").As<Napi::String>().Utf8Value();
+        if (!ParseProtocolName(protocol, &config->protocol)) {
+            Napi::TypeError::New(env, "Invalid protocol. Must be 'FT8' or 'FT4'").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
     
-    while (current_instance_->hash_table_[idx_hash].used) {
-        if (((current_instance_->hash_table_[idx_hash].hash & 0x3FFFFFu) == hash) && 
-            (strcmp(current_instance_->hash_table_[idx_hash].callsign, callsign) == 0)) {
-            return; // Already exists
+    // The numeric knobs are shared with the native command line decoder
+    for (size_t i = 0; i < NUM_DECODER_NUMERIC_OPTIONS; ++i) {
+        const char* name = DECODER_NUMERIC_OPTIONS[i];
+        if (!obj.Has(name) || obj.Get(name).IsUndefined()) {
+            continue;
+        }
+        std::string error;
+        if (!SetDecoderOption(config, name, obj.Get(name).As<Napi::Number>().DoubleValue(), &error)) {
+            Napi::RangeError::New(env, error).ThrowAsJavaScriptException();
+            return false;
         }
-        idx_hash = (idx_hash + 1) % HASH_TABLE_SIZE;
     }
     
-    // Add new entry
-    current_instance_->hash_table_[idx_hash].used = true;
-    strncpy(current_instance_->hash_table_[idx_hash].callsign, callsign, 11);
-    current_instance_->hash_table_[idx_hash].callsign[11] = '\0';
-    current_instance_->hash_table_[idx_hash].hash = hash;
+    return true;
 }
 
-void MessageDecoder::InitializeMonitor(int sample_rate) {
-    if (monitor_initialized_) {
-        monitor_free(&monitor_);
+bool MessageDecoder::ProcessAudioArgument(Napi::Env env, const Napi::Value& value, DecoderCore* core) {
+    Napi::Object audioBuffer = value.As<Napi::Object>();
+    
+    if (!audioBuffer.Has("samples") || !audioBuffer.Has("sampleRate")) {
+        Napi::TypeError::New(env, "AudioBuffer must have 'samples' and 'sampleRate' properties").ThrowAsJavaScriptException();
+        return false;
     }
     
-    monitor_config_t config;
-    config.f_min = freq_min_;
-    config.f_max = freq_max_;
-    config.sample_rate = sample_rate;
-    config.time_osr = time_osr_;
-    config.freq_osr = freq_osr_;
-    config.protocol = protocol_;
+    Napi::Float32Array samples = audioBuffer.Get("samples").As<Napi::Float32Array>();
+    int sample_rate = audioBuffer.Get("sampleRate").As<Napi::Number>().Int32Value();
     
-    monitor_init(&monitor_, &config);
-    monitor_initialized_ = true;
+    core->ProcessAudio(samples.Data(), samples.ElementLength(), sample_rate);
+    if (core == &core_) {
+        SyncWaterfallView();
+    }
+    return true;
 }
 
-void MessageDecoder::ProcessAudio(const float* samples, int num_samples, int sample_rate) {
-    if (!monitor_initialized_ || monitor_.wf.max_blocks == 0) {
-        InitializeMonitor(sample_rate);
+void MessageDecoder::SyncWaterfallView() {
+    if (waterfall_view_.IsEmpty() || waterfall_view_generation_ == core_.WaterfallGeneration()) {
+        return;
     }
     
-    monitor_reset(&monitor_);
-    
-    // Process audio in block_size chunks as done in the original demo
-    // Each call to monitor_process expects exactly block_size samples
-    int chunk_size = monitor_.block_size;
-    
-    for (int offset = 0; offset < num_samples; offset += chunk_size) {
-        int remaining = std::min(chunk_size, num_samples - offset);
-        
-        // If we don't have enough samples for a full chunk, pad with zeros
-        if (remaining < chunk_size) {
-            std::vector<float> padded_chunk(chunk_size, 0.0f);
-            std::copy(samples + offset, samples + offset + remaining, padded_chunk.begin());
-            monitor_process(&monitor_, padded_chunk.data());
-        } else {
-            monitor_process(&monitor_, samples + offset);
-        }
+    // Views into the old memory become zero-length instead of dangling
+    Napi::ArrayBuffer buffer = waterfall_view_.Value();
+    if (!buffer.IsEmpty()) {
+        buffer.Detach();
     }
+    waterfall_view_.Reset();
 }
 
-Napi::Object MessageDecoder::CreateDecodedMessageObject(Napi::Env env, const ftx_message_t* message,
-                                                       const ftx_decode_status_t* status, const char* message_text) {
+Napi::Object MessageDecoder::CreateDecodedMessageObject(Napi::Env env, const DecodeResult& decoded) {
     Napi::Object result = Napi::Object::New(env);
     
-    result.Set("text", Napi::String::New(env, message_text));
-    result.Set("hash", Napi::Number::New(env, message->hash));
+    result.Set("text", Napi::String::New(env, decoded.text));
+    result.Set("hash", Napi::Number::New(env, decoded.message.hash));
     
     // Copy payload
     Napi::Uint8Array payload = Napi::Uint8Array::New(env, FTX_PAYLOAD_LENGTH_BYTES);
-    memcpy(payload.Data(), message->payload, FTX_PAYLOAD_LENGTH_BYTES);
+    memcpy(payload.Data(), decoded.message.payload, FTX_PAYLOAD_LENGTH_BYTES);
     result.Set("payload", payload);
     
-    // Determine message type
-    ftx_message_type_t type = ftx_message_get_type(message);
-    const char* type_str;
-    switch (type) {
-        case FTX_MESSAGE_TYPE_FREE_TEXT: type_str = "FREE_TEXT"; break;
-        case FTX_MESSAGE_TYPE_DXPEDITION: type_str = "DXPEDITION"; break;
-        case FTX_MESSAGE_TYPE_EU_VHF: type_str = "EU_VHF"; break;
-        case FTX_MESSAGE_TYPE_ARRL_FD: type_str = "ARRL_FD"; break;
-        case FTX_MESSAGE_TYPE_TELEMETRY: type_str = "TELEMETRY"; break;
-        case FTX_MESSAGE_TYPE_CONTESTING: type_str = "CONTESTING"; break;
-        case FTX_MESSAGE_TYPE_STANDARD: type_str = "STANDARD"; break;
-        case FTX_MESSAGE_TYPE_ARRL_RTTY: type_str = "ARRL_RTTY"; break;
-        case FTX_MESSAGE_TYPE_NONSTD_CALL: type_str = "NONSTD_CALL"; break;
-        case FTX_MESSAGE_TYPE_WWROF: type_str = "WWROF"; break;
-        default: type_str = "UNKNOWN"; break;
-    }
-    result.Set("type", Napi::String::New(env, type_str));
-    
-    if (status) {
-        result.Set("frequency", Napi::Number::New(env, status->freq));
-        result.Set("timeOffset", Napi::Number::New(env, status->time));
-    }
+    result.Set("type", Napi::String::New(env, MessageTypeName(decoded.type)));
+    
+    result.Set("frequency", Napi::Number::New(env, decoded.status.freq));
+    result.Set("timeOffset", Napi::Number::New(env, decoded.status.time));
+    // Whole dB, as WSJT-X reports it
+    result.Set("snr", Napi::Number::New(env, std::round(decoded.snr)));
+    
+    return result;
+}
+
+Napi::Object MessageDecoder::CreateWaterfallObject(Napi::Env env, const WaterfallLayout& layout, Napi::Uint8Array mag, int num_blocks) {
+    static_assert(sizeof(WF_ELEM_T) == 1, "Waterfall magnitudes are exported as bytes");
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("mag", mag);
+    result.Set("numBlocks", Napi::Number::New(env, num_blocks));
+    result.Set("numBins", Napi::Number::New(env, layout.num_bins));
+    result.Set("timeOsr", Napi::Number::New(env, layout.time_osr));
+    result.Set("freqOsr", Napi::Number::New(env, layout.freq_osr));
+    result.Set("blockStride", Napi::Number::New(env, layout.block_stride));
+    
+    // Bins are one tone spacing wide and blocks one symbol long
+    result.Set("minFrequency", Napi::Number::New(env, layout.min_bin / layout.symbol_period));
+    result.Set("binHz", Napi::Number::New(env, 1.0 / layout.symbol_period));
+    result.Set("blockTime", Napi::Number::New(env, layout.symbol_period));
+    
+    // dB = mag * magScale + magOffset
+    result.Set("magScale", Napi::Number::New(env, WF_ELEM_MAG(1) - WF_ELEM_MAG(0)));
+    result.Set("magOffset", Napi::Number::New(env, WF_ELEM_MAG(0)));
     
     return result;
 }
@@ -248,129 +424,164 @@ Napi::Object MessageDecoder::CreateCandidateObject(Napi::Env env, const ftx_cand
     return result;
 }
 
-Napi::Value MessageDecoder::Decode(const Napi::CallbackInfo& info) {
+bool MessageDecoder::DecodeArgument(const Napi::CallbackInfo& info, std::vector<DecodeResult>* decoded_messages) {
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsObject()) {
-        Napi::TypeError::New(env, "Expected AudioBuffer object").ThrowAsJavaScriptException();
-        return env.Null();
+    if (info.Length() < 1 || !(info[0].IsObject() || info[0].IsNull())) {
+        Napi::TypeError::New(env, "Expected AudioBuffer object or null").ThrowAsJavaScriptException();
+        return false;
     }
-    
-    Napi::Object audioBuffer = info[0].As<Napi::Object>();
-    
-    if (!audioBuffer.Has("samples") || !audioBuffer.Has("sampleRate")) {
-        Napi::TypeError::New(env, "AudioBuffer must have 'samples' and 'sampleRate' properties").ThrowAsJavaScriptException();
-        return env.Null();
+    bool has_audio = info[0].IsObject();
+    if (!has_audio && !core_.HasWaterfall()) {
+        Napi::Error::New(env, "No waterfall to reuse; pass an AudioBuffer or call loadSpectrum() first").ThrowAsJavaScriptException();
+        return false;
     }
     
-    Napi::Float32Array samples = audioBuffer.Get("samples").As<Napi::Float32Array>();
-    int sample_rate = audioBuffer.Get("sampleRate").As<Napi::Number>().Int32Value();
+    // Switch to the load controller's current profile; a reused waterfall
+    // keeps the geometry it was built with
+    int level = -1;
+    if (governor_ && has_audio) {
+        level = governor_->Level();
+        if (level != profile_level_) {
+            core_.SetConfig(governor_->Profiles()[level].Apply(base_config_));
+            SyncWaterfallView();
+            profile_level_ = level;
+        }
+    }
+    auto started = std::chrono::steady_clock::now();
     
     // Process audio
-    ProcessAudio(samples.Data(), samples.ElementLength(), sample_rate);
-    
-    // Find candidates
-    ftx_candidate_t* candidates = new ftx_candidate_t[max_candidates_];
-    int num_candidates = ftx_find_candidates(&monitor_.wf, max_candidates_, candidates, min_score_);
+    if (has_audio && !ProcessAudioArgument(env, info[0], &core_)) {
+        return false;
+    }
     
-    // Setup hash interface
-    ftx_callsign_hash_interface_t hash_if;
-    hash_if.lookup_hash = HashTableLookup;
-    hash_if.save_hash = HashTableSave;
+    // Decode messages, noting what the hash interface has to see
+    bool use_interface = info.Length() >= 2 && info[1].IsObject();
+    std::vector<CallsignHashRequest> misses;
+    std::vector<CallsignHash> saves;
+    if (use_interface) {
+        core_.RecordHashActivity(&misses, &saves);
+    }
+    core_.Decode(decoded_messages);
+    core_.RecordHashActivity(nullptr, nullptr);
     
-    // Decode messages
-    std::vector<Napi::Object> decoded_messages;
+    if (governor_ && has_audio) {
+        double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        double slot_ms = 1000.0 * ((base_config_.protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME);
+        governor_->Report(level, elapsed_ms, slot_ms);
+    }
     
-    for (int i = 0; i < num_candidates && decoded_messages.size() < max_decoded_messages_; ++i) {
-        ftx_message_t message;
-        ftx_decode_status_t status;
-        
-        if (ftx_decode_candidate(&monitor_.wf, &candidates[i], max_ldpc_iterations_, &message, &status)) {
-            char message_text[FTX_MAX_MESSAGE_LENGTH] = {0};
-            
-            if (ftx_message_decode(&message, &hash_if, message_text) == FTX_MESSAGE_RC_OK) {
-                float freq_hz = (monitor_.min_bin + candidates[i].freq_offset + 
-                               (float)candidates[i].freq_sub / monitor_.wf.freq_osr) / 
-                               ((protocol_ == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD);
-                float time_sec = (candidates[i].time_offset + 
-                                (float)candidates[i].time_sub / monitor_.wf.time_osr) * 
-                                ((protocol_ == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD);
-                
-                status.freq = freq_hz;
-                status.time = time_sec;
-                
-                Napi::Object decoded = CreateDecodedMessageObject(env, &message, &status, message_text);
-                decoded.Set("score", Napi::Number::New(env, candidates[i].score));
-                decoded_messages.push_back(decoded);
-            }
-        }
+    if (use_interface) {
+        return ApplyHashInterface(env, info[1].As<Napi::Object>(), misses, saves, decoded_messages);
     }
+    return true;
+}
+
+Napi::Value MessageDecoder::Decode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
     
-    delete[] candidates;
+    std::vector<DecodeResult> decoded_messages;
+    if (!DecodeArgument(info, &decoded_messages)) {
+        return env.Null();
+    }
     
     // Create result array
     Napi::Array result = Napi::Array::New(env, decoded_messages.size());
     for (size_t i = 0; i < decoded_messages.size(); ++i) {
-        result.Set(i, decoded_messages[i]);
+        Napi::Object decoded = CreateDecodedMessageObject(env, decoded_messages[i]);
+        decoded.Set("score", Napi::Number::New(env, decoded_messages[i].candidate.score));
+        result.Set(i, decoded);
     }
     
     return result;
 }
 
-Napi::Value MessageDecoder::FindCandidates(const Napi::CallbackInfo& info) {
+Napi::Value MessageDecoder::DecodeToBuffer(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsObject()) {
-        Napi::TypeError::New(env, "Expected AudioBuffer object").ThrowAsJavaScriptException();
+    std::vector<DecodeResult> decoded_messages;
+    if (!DecodeArgument(info, &decoded_messages)) {
         return env.Null();
     }
     
-    Napi::Object audioBuffer = info[0].As<Napi::Object>();
+    // A plain ArrayBuffer owned by V8, so it can be transferred
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, PackedMessagesSize(decoded_messages.size()));
+    PackMessages(decoded_messages, static_cast<uint8_t*>(buffer.Data()));
+    return buffer;
+}
+
+Napi::Value MessageDecoder::UnpackMessages(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
     
-    if (!audioBuffer.Has("samples") || !audioBuffer.Has("sampleRate")) {
-        Napi::TypeError::New(env, "AudioBuffer must have 'samples' and 'sampleRate' properties").ThrowAsJavaScriptException();
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (info.Length() < 1 || !GetBytesArgument(info[0], &data, &size)) {
+        Napi::TypeError::New(env, "Expected ArrayBuffer from decodeToBuffer").ThrowAsJavaScriptException();
         return env.Null();
     }
     
-    Napi::Float32Array samples = audioBuffer.Get("samples").As<Napi::Float32Array>();
-    int sample_rate = audioBuffer.Get("sampleRate").As<Napi::Number>().Int32Value();
+    std::vector<DecodeResult> decoded_messages;
+    std::string error;
+    if (!::UnpackMessages(data, size, &decoded_messages, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Array result = Napi::Array::New(env, decoded_messages.size());
+    for (size_t i = 0; i < decoded_messages.size(); ++i) {
+        Napi::Object decoded = CreateDecodedMessageObject(env, decoded_messages[i]);
+        decoded.Set("score", Napi::Number::New(env, decoded_messages[i].candidate.score));
+        result.Set(i, decoded);
+    }
+    
+    return result;
+}
+
+Napi::Value MessageDecoder::FindCandidates(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !(info[0].IsObject() || info[0].IsNull())) {
+        Napi::TypeError::New(env, "Expected AudioBuffer object or null").ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
     // Process audio
-    ProcessAudio(samples.Data(), samples.ElementLength(), sample_rate);
+    if (info[0].IsObject()) {
+        if (!ProcessAudioArgument(env, info[0], &core_)) {
+            return env.Null();
+        }
+    } else if (!core_.HasWaterfall()) {
+        Napi::Error::New(env, "No waterfall to reuse; pass an AudioBuffer or call loadSpectrum() first").ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
     // Find candidates
-    ftx_candidate_t* candidates = new ftx_candidate_t[max_candidates_];
-    int num_candidates = ftx_find_candidates(&monitor_.wf, max_candidates_, candidates, min_score_);
+    std::vector<ftx_candidate_t> candidates;
+    core_.FindCandidates(&candidates);
     
     // Create result array
-    Napi::Array result = Napi::Array::New(env, num_candidates);
-    for (int i = 0; i < num_candidates; ++i) {
+    Napi::Array result = Napi::Array::New(env, candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
         result.Set(i, CreateCandidateObject(env, &candidates[i]));
     }
     
-    delete[] candidates;
-    
     return result;
 }
 
 Napi::Value MessageDecoder::DecodeCandidate(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
-        Napi::TypeError::New(env, "Expected AudioBuffer and candidate objects").ThrowAsJavaScriptException();
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected AudioBuffer or null, and candidate objects").ThrowAsJavaScriptException();
         return env.Null();
     }
-    
-    Napi::Object audioBuffer = info[0].As<Napi::Object>();
-    Napi::Object candidateObj = info[1].As<Napi::Object>();
-    
-    if (!audioBuffer.Has("samples") || !audioBuffer.Has("sampleRate")) {
-        Napi::TypeError::New(env, "AudioBuffer must have 'samples' and 'sampleRate' properties").ThrowAsJavaScriptException();
+    bool has_audio = !info[0].IsNull() && !info[0].IsUndefined();
+    if (has_audio && !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected AudioBuffer object or null").ThrowAsJavaScriptException();
         return env.Null();
     }
     
-    Napi::Float32Array samples = audioBuffer.Get("samples").As<Napi::Float32Array>();
-    int sample_rate = audioBuffer.Get("sampleRate").As<Napi::Number>().Int32Value();
+    Napi::Object candidateObj = info[1].As<Napi::Object>();
     
     // Parse candidate
     ftx_candidate_t candidate;
@@ -380,50 +591,562 @@ Napi::Value MessageDecoder::DecodeCandidate(const Napi::CallbackInfo& info) {
     candidate.time_sub = candidateObj.Get("timeSub").As<Napi::Number>().Uint32Value();
     candidate.freq_sub = candidateObj.Get("freqSub").As<Napi::Number>().Uint32Value();
     
-    // Process audio
-    ProcessAudio(samples.Data(), samples.ElementLength(), sample_rate);
+    // Retry options; any other object in this position is the old, unused hash interface
+    int iterations = 0;
+    LdpcEngine engine = LDPC_ENGINE_BP;
+    if (info.Length() > 2 && info[2].IsObject()) {
+        Napi::Object options = info[2].As<Napi::Object>();
+        if (options.Has("iterations")) {
+            iterations = options.Get("iterations").As<Napi::Number>().Int32Value();
+            if (iterations < 1) {
+                Napi::RangeError::New(env, "iterations must be at least 1").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+        if (options.Has("engine")) {
+            std::string name = options.Get("engine").ToString().Utf8Value();
+            if (name == "bp") {
+                engine = LDPC_ENGINE_BP;
+            } else if (name == "min-sum") {
+                engine = LDPC_ENGINE_MIN_SUM;
+            } else {
+                Napi::RangeError::New(env, "engine must be 'bp' or 'min-sum'").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+    }
     
-    // Setup hash interface
-    ftx_callsign_hash_interface_t hash_if;
-    hash_if.lookup_hash = HashTableLookup;
-    hash_if.save_hash = HashTableSave;
+    // Process audio; without it the candidate is decoded against the cached
+    // waterfall and, if it was tried before, its cached likelihoods
+    if (has_audio) {
+        if (!ProcessAudioArgument(env, info[0], &core_)) {
+            return env.Null();
+        }
+    } else if (!core_.HasWaterfall()) {
+        Napi::Error::New(env, "No waterfall to reuse; pass an AudioBuffer or call decode() first").ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
     // Decode the specific candidate
-    ftx_message_t message;
-    ftx_decode_status_t status;
+    DecodeResult decoded;
+    if (!core_.DecodeCandidate(candidate, &decoded, iterations, engine)) {
+        return env.Null();
+    }
+    
+    // Create result object
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("message", CreateDecodedMessageObject(env, decoded));
+    
+    Napi::Object statusObj = Napi::Object::New(env);
+    statusObj.Set("frequency", Napi::Number::New(env, decoded.status.freq));
+    statusObj.Set("time", Napi::Number::New(env, decoded.status.time));
+    statusObj.Set("ldpcErrors", Napi::Number::New(env, decoded.status.ldpc_errors));
+    statusObj.Set("crcExtracted", Napi::Number::New(env, decoded.status.crc_extracted));
+    statusObj.Set("crcCalculated", Napi::Number::New(env, decoded.status.crc_calculated));
+    result.Set("status", statusObj);
+    
+    return result;
+}
+
+Napi::Value MessageDecoder::GetWaterfall(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (!core_.HasWaterfall()) {
+        return env.Null();
+    }
+    
+    SyncWaterfallView();
+    const ftx_waterfall_t* wf = core_.Waterfall();
+    
+    // One external buffer spans the whole allocation and is reused until the core reallocates it
+    Napi::ArrayBuffer buffer;
+    if (!waterfall_view_.IsEmpty()) {
+        buffer = waterfall_view_.Value();
+    }
+    if (buffer.IsEmpty()) {
+        size_t length = (size_t)wf->max_blocks * wf->block_stride * sizeof(WF_ELEM_T);
+        
+        // The view keeps this decoder, and with it the waterfall memory, alive
+        Ref();
+        WaterfallViewHint* hint = new WaterfallViewHint{this, view_token_};
+        buffer = Napi::ArrayBuffer::New(env, wf->mag, length, [](Napi::Env, void*, WaterfallViewHint* hint) {
+            if (!hint->token.expired()) {
+                hint->decoder->Unref();
+            }
+            delete hint;
+        }, hint);
+        
+        waterfall_view_ = Napi::Weak(buffer);
+        waterfall_view_generation_ = core_.WaterfallGeneration();
+    }
     
-    if (!ftx_decode_candidate(&monitor_.wf, &candidate, max_ldpc_iterations_, &message, &status)) {
+    Napi::Uint8Array mag = Napi::Uint8Array::New(env, (size_t)wf->num_blocks * wf->block_stride, buffer, 0);
+    return CreateWaterfallObject(env, core_.Layout(), mag, wf->num_blocks);
+}
+
+Napi::Value MessageDecoder::SerializeSpectrum(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (!core_.HasWaterfall()) {
         return env.Null();
     }
     
-    char message_text[FTX_MAX_MESSAGE_LENGTH] = {0};
+    const ftx_waterfall_t* wf = core_.Waterfall();
+    SpectrumInfo spectrum;
+    spectrum.protocol = core_.Config().protocol;
+    spectrum.sample_rate = core_.SampleRate();
+    spectrum.block_size = core_.BlockSize();
+    spectrum.num_blocks = wf->num_blocks;
+    spectrum.layout = core_.Layout();
+    
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, SpectrumFileSize(spectrum));
+    WriteSpectrum(spectrum, wf->mag, buffer.Data());
+    return buffer;
+}
+
+Napi::Value MessageDecoder::LoadSpectrum(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
     
-    if (ftx_message_decode(&message, &hash_if, message_text) != FTX_MESSAGE_RC_OK) {
+    // Any view of the bytes, e.g. a Buffer over a memory-mapped file
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (info.Length() < 1 || !GetBytesArgument(info[0], &data, &size)) {
+        Napi::TypeError::New(env, "Expected Buffer, typed array or ArrayBuffer").ThrowAsJavaScriptException();
         return env.Null();
     }
     
-    // Calculate frequency and time
-    float freq_hz = (monitor_.min_bin + candidate.freq_offset + 
-                    (float)candidate.freq_sub / monitor_.wf.freq_osr) / 
-                    ((protocol_ == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD);
-    float time_sec = (candidate.time_offset + 
-                     (float)candidate.time_sub / monitor_.wf.time_osr) * 
-                     ((protocol_ == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD);
+    SpectrumInfo spectrum;
+    std::string error;
+    if (!ReadSpectrumHeader(data, size, &spectrum, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!core_.LoadWaterfall(spectrum.protocol, spectrum.sample_rate, spectrum.layout,
+                             data + SPECTRUM_HEADER_SIZE, spectrum.num_blocks, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    SyncWaterfallView();
     
-    status.freq = freq_hz;
-    status.time = time_sec;
+    // Later decodes with audio keep the snapshot's geometry
+    const DecoderConfig& config = core_.Config();
+    base_config_.protocol = config.protocol;
+    base_config_.time_osr = config.time_osr;
+    base_config_.freq_osr = config.freq_osr;
+    base_config_.freq_min = config.freq_min;
+    base_config_.freq_max = config.freq_max;
+    profile_level_ = -1;
+    
+    return GetWaterfall(info);
+}
+
+bool MessageDecoder::ApplyHashInterface(Napi::Env env, const Napi::Object& hash_interface,
+                                        const std::vector<CallsignHashRequest>& misses,
+                                        const std::vector<CallsignHash>& saves,
+                                        std::vector<DecodeResult>* decoded_messages) {
+    Napi::Value save = hash_interface.Get("saveHash");
+    if (save.IsFunction()) {
+        for (const CallsignHash& entry : saves) {
+            save.As<Napi::Function>().Call(hash_interface, {
+                Napi::String::New(env, entry.callsign),
+                Napi::Number::New(env, entry.n22)
+            });
+            if (env.IsExceptionPending()) {
+                return false;
+            }
+        }
+    }
+    
+    Napi::Value lookup = hash_interface.Get("lookupHash");
+    if (misses.empty() || !lookup.IsFunction()) {
+        return true;
+    }
+    
+    bool learned = false;
+    for (const CallsignHashRequest& request : misses) {
+        Napi::Value result = lookup.As<Napi::Function>().Call(hash_interface, {
+            Napi::String::New(env, CallsignHashTypeName(request.type)),
+            Napi::Number::New(env, request.hash)
+        });
+        if (env.IsExceptionPending()) {
+            return false;
+        }
+        if (!result.IsString()) {
+            continue;
+        }
+        
+        // Only callsigns that really have the hash are learned
+        std::string callsign = result.As<Napi::String>().Utf8Value();
+        uint32_t n22;
+        if (ComputeCallsignHash(callsign.c_str(), &n22) && (n22 >> CallsignHashShift(request.type)) == request.hash) {
+            learned |= core_.SaveHash(callsign.c_str(), n22);
+        }
+    }
+    
+    // Fill in the callsigns that were learned
+    if (learned) {
+        for (DecodeResult& decoded : *decoded_messages) {
+            if (decoded.text.find("<...>") != std::string::npos) {
+                core_.Unpack(&decoded);
+            }
+        }
+    }
+    return true;
+}
+
+Napi::Value MessageDecoder::ExportHashes(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    std::vector<CallsignHash> entries = core_.HashEntries();
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, CallsignHashesSize(entries.size()));
+    WriteCallsignHashes(entries, buffer.Data());
+    return buffer;
+}
+
+Napi::Value MessageDecoder::ImportHashes(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (info.Length() < 1 || !GetBytesArgument(info[0], &data, &size)) {
+        Napi::TypeError::New(env, "Expected Buffer, typed array or ArrayBuffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    std::vector<CallsignHash> entries;
+    std::string error;
+    if (!ReadCallsignHashes(data, size, &entries, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int added = 0;
+    for (const CallsignHash& entry : entries) {
+        if (core_.SaveHash(entry.callsign, entry.n22)) {
+            added++;
+        }
+    }
+    return Napi::Number::New(env, added);
+}
+
+Napi::Value MessageDecoder::SeedHashes(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    // An array of callsigns, or a list as text, e.g. the contents of a file
+    std::vector<std::string> callsigns;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (info.Length() >= 1 && info[0].IsArray()) {
+        Napi::Array array = info[0].As<Napi::Array>();
+        callsigns.reserve(array.Length());
+        for (uint32_t i = 0; i < array.Length(); ++i) {
+            Napi::Value callsign = array.Get(i);
+            if (!callsign.IsString()) {
+                Napi::TypeError::New(env, "Callsigns must be strings").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            callsigns.push_back(callsign.As<Napi::String>().Utf8Value());
+        }
+    } else if (info.Length() >= 1 && info[0].IsString()) {
+        std::string text = info[0].As<Napi::String>().Utf8Value();
+        SplitCallsignList(text.data(), text.size(), &callsigns);
+    } else if (info.Length() >= 1 && GetBytesArgument(info[0], &data, &size)) {
+        SplitCallsignList(reinterpret_cast<const char*>(data), size, &callsigns);
+    } else {
+        Napi::TypeError::New(env, "Expected an array of callsigns, a string or a Buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    unsigned threads = 0;
+    if (info.Length() >= 2 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("threads")) {
+            int value = options.Get("threads").As<Napi::Number>().Int32Value();
+            threads = value > 0 ? (unsigned)value : 0;
+        }
+    }
+    
+    size_t rejected = 0;
+    std::shared_ptr<const CallsignIndex> index = CallsignIndex::Build(callsigns, threads, &rejected);
+    core_.SetCallsignIndex(index->Size() > 0 ? index : nullptr);
     
-    // Create result object
     Napi::Object result = Napi::Object::New(env);
-    result.Set("message", CreateDecodedMessageObject(env, &message, &status, message_text));
+    result.Set("callsigns", Napi::Number::New(env, (double)index->Size()));
+    result.Set("rejected", Napi::Number::New(env, (double)rejected));
+    return result;
+}
+
+Napi::Value MessageDecoder::DecodeFocused(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
     
-    Napi::Object statusObj = Napi::Object::New(env);
-    statusObj.Set("frequency", Napi::Number::New(env, status.freq));
-    statusObj.Set("time", Napi::Number::New(env, status.time));
-    statusObj.Set("ldpcErrors", Napi::Number::New(env, status.ldpc_errors));
-    statusObj.Set("crcExtracted", Napi::Number::New(env, status.crc_extracted));
-    statusObj.Set("crcCalculated", Napi::Number::New(env, status.crc_calculated));
-    result.Set("status", statusObj);
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected AudioBuffer or null, and options object").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    bool has_audio = !info[0].IsNull() && !info[0].IsUndefined();
+    if (has_audio && !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected AudioBuffer object or null").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (!options.Has("centerHz") || !options.Get("centerHz").IsNumber()) {
+        Napi::TypeError::New(env, "centerHz must be a number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    float center = options.Get("centerHz").As<Napi::Number>().FloatValue();
+    if (!std::isfinite(center)) {
+        Napi::RangeError::New(env, "centerHz must be a finite number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    float span = FOCUS_DEFAULT_SPAN_HZ;
+    if (options.Has("spanHz")) {
+        if (!options.Get("spanHz").IsNumber()) {
+            Napi::TypeError::New(env, "spanHz must be a number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        span = options.Get("spanHz").As<Napi::Number>().FloatValue();
+        if (!(span > 0) || !std::isfinite(span)) {
+            Napi::RangeError::New(env, "spanHz must be a positive finite number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+    
+    // Relaxed threshold and a larger LDPC budget than a full decode can afford
+    const DecoderConfig& config = core_.Config();
+    float symbol_period = core_.SymbolPeriod();
+    FocusRegion region;
+    
+    // The region can only cover bins the decoder's waterfall has
+    region.freq_min = std::max(center - span / 2, config.freq_min);
+    region.freq_max = std::min(center + span / 2, config.freq_max);
+    if (region.freq_min > region.freq_max) {
+        Napi::RangeError::New(env, "centerHz and spanHz select no frequencies within [frequencyMin, frequencyMax]").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    region.time_min = FOCUS_TIME_MIN_BLOCKS * symbol_period;
+    region.time_max = FOCUS_TIME_MAX_BLOCKS * symbol_period;
+    region.min_score = config.min_score / 2;
+    region.max_candidates = FOCUS_DEFAULT_MAX_CANDIDATES;
+    region.max_ldpc_iterations = config.max_ldpc_iterations * 2;
+    
+    if (options.Has("timeWindow")) {
+        Napi::Value window = options.Get("timeWindow");
+        if (!window.IsArray() || window.As<Napi::Array>().Length() != 2 ||
+            !window.As<Napi::Array>().Get((uint32_t)0).IsNumber() || !window.As<Napi::Array>().Get(1).IsNumber()) {
+            Napi::TypeError::New(env, "timeWindow must be an array of two numbers").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        float time_min = window.As<Napi::Array>().Get((uint32_t)0).As<Napi::Number>().FloatValue();
+        float time_max = window.As<Napi::Array>().Get(1).As<Napi::Number>().FloatValue();
+        if (!std::isfinite(time_min) || !std::isfinite(time_max) || time_max < time_min) {
+            Napi::RangeError::New(env, "timeWindow must be [start, end] with finite start <= end").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        // Start times before the earliest ftx_find_candidates() searches or after the slot are dropped
+        float slot_time = (config.protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+        region.time_min = std::max(time_min, region.time_min);
+        region.time_max = std::min(time_max, slot_time);
+        if (region.time_min > region.time_max) {
+            Napi::RangeError::New(env, "timeWindow lies outside the slot").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+    if (options.Has("minScore")) {
+        region.min_score = options.Get("minScore").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("maxCandidates")) {
+        region.max_candidates = options.Get("maxCandidates").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("maxLdpcIterations")) {
+        region.max_ldpc_iterations = options.Get("maxLdpcIterations").As<Napi::Number>().Int32Value();
+    }
+    
+    std::vector<DecodeResult> decoded_messages;
+    if (has_audio) {
+        // Only the bins of the region, plus the tones above its highest start
+        // frequency, go into a waterfall of its own; the monitor is kept while
+        // the region stays put, and the cached full-band waterfall is untouched
+        int num_tones = (config.protocol == FTX_PROTOCOL_FT8) ? 8 : 4;
+        DecoderConfig focus_config = config;
+        focus_config.freq_min = std::max(region.freq_min - 1 / symbol_period, config.freq_min);
+        focus_config.freq_max = std::min(region.freq_max + (num_tones + 1) / symbol_period, config.freq_max);
+        if (!focus_core_) {
+            focus_core_.reset(new DecoderCore(focus_config));
+        } else {
+            focus_core_->SetConfig(focus_config);
+        }
+        focus_core_->SetCallsignIndex(core_.SeededIndex());
+        
+        // Hashed callsigns resolve from this decoder's table: the focus core
+        // decodes with a copy of it, and what it learns is saved back
+        focus_core_->ClearHashTable();
+        for (const CallsignHash& entry : core_.HashEntries()) {
+            focus_core_->SaveHash(entry.callsign, entry.n22);
+        }
+        focus_core_->ResetStats();
+        focus_core_->EnableStats(core_.StatsEnabled());
+        
+        if (!ProcessAudioArgument(env, info[0], focus_core_.get())) {
+            return env.Null();
+        }
+        std::vector<CallsignHash> saves;
+        focus_core_->RecordHashActivity(nullptr, &saves);
+        focus_core_->DecodeFocused(region, &decoded_messages);
+        focus_core_->RecordHashActivity(nullptr, nullptr);
+        
+        for (const CallsignHash& entry : saves) {
+            core_.SaveHash(entry.callsign, entry.n22);
+        }
+        
+        // Saves were counted again as they reached this decoder's table
+        DecodeStats focus_stats = focus_core_->Stats();
+        focus_stats.hash_saves = 0;
+        core_.MergeStats(focus_stats);
+        focus_core_->ResetStats();
+    } else {
+        if (!core_.HasWaterfall()) {
+            Napi::Error::New(env, "No waterfall to reuse; pass an AudioBuffer or call decode() first").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        core_.DecodeFocused(region, &decoded_messages);
+    }
+    
+    Napi::Array result = Napi::Array::New(env, decoded_messages.size());
+    for (size_t i = 0; i < decoded_messages.size(); ++i) {
+        Napi::Object decoded = CreateDecodedMessageObject(env, decoded_messages[i]);
+        decoded.Set("score", Napi::Number::New(env, decoded_messages[i].candidate.score));
+        result.Set(i, decoded);
+    }
     
     return result;
 }
+
+Napi::Value MessageDecoder::DecodeFile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    DecoderConfig config = core_.Config();
+    unsigned threads = 0;
+    bool has_start_time = false;
+    double start_time = 0;
+    Napi::Function on_slot;
+    
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        
+        // Decoder settings default to this decoder's and can be overridden per call
+        if (!ParseConfig(env, options, &config)) {
+            return env.Null();
+        }
+        
+        if (options.Has("startTime")) {
+            Napi::Value start = options.Get("startTime");
+            if (start.IsDate()) {
+                start_time = start.As<Napi::Date>().ValueOf();
+                has_start_time = true;
+            } else if (start.IsNumber()) {
+                start_time = start.As<Napi::Number>().DoubleValue();
+                has_start_time = true;
+            }
+        }
+        
+        if (options.Has("threads")) {
+            int value = options.Get("threads").As<Napi::Number>().Int32Value();
+            threads = value > 0 ? (unsigned)value : 0;
+        }
+        
+        if (options.Has("onSlot")) {
+            Napi::Value callback = options.Get("onSlot");
+            if (!callback.IsFunction()) {
+                Napi::TypeError::New(env, "onSlot must be a function").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            on_slot = callback.As<Napi::Function>();
+        }
+    }
+    
+    DecodeFileWorker* worker = new DecodeFileWorker(env, path, config, core_.SeededIndex(), threads, has_start_time,
+                                                    start_time, on_slot, Value(),
+                                                    core_.StatsEnabled() ? &core_ : nullptr);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value MessageDecoder::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const DecodeStats& stats = core_.Stats();
+    
+    Napi::Object monitor = CreateStageObject(env, stats.blocks, stats.monitor_ns);
+    
+    Napi::Object find = CreateStageObject(env, stats.candidate_searches, stats.find_ns);
+    find.Set("candidates", Napi::Number::New(env, (double)stats.candidates));
+    
+    Napi::Object likelihood = CreateStageObject(env, stats.likelihood_runs, stats.likelihood_ns);
+    likelihood.Set("cached", Napi::Number::New(env, (double)stats.likelihood_cache_hits));
+    
+    Napi::Object ldpc = CreateStageObject(env, stats.ldpc_runs, stats.ldpc_ns);
+    ldpc.Set("iterations", Napi::Number::New(env, (double)stats.ldpc_iterations));
+    ldpc.Set("failures", Napi::Number::New(env, (double)stats.ldpc_failures));
+    
+    Napi::Object crc = Napi::Object::New(env);
+    crc.Set("failures", Napi::Number::New(env, (double)stats.crc_failures));
+    
+    Napi::Object unpack = CreateStageObject(env, stats.unpack_runs, stats.unpack_ns);
+    unpack.Set("failures", Napi::Number::New(env, (double)stats.unpack_failures));
+    
+    Napi::Object stages = Napi::Object::New(env);
+    stages.Set("monitor", monitor);
+    stages.Set("findCandidates", find);
+    stages.Set("likelihood", likelihood);
+    stages.Set("ldpc", ldpc);
+    stages.Set("crc", crc);
+    stages.Set("unpack", unpack);
+    
+    Napi::Object hash = Napi::Object::New(env);
+    hash.Set("hits", Napi::Number::New(env, (double)stats.hash_hits));
+    hash.Set("misses", Napi::Number::New(env, (double)stats.hash_misses));
+    hash.Set("saves", Napi::Number::New(env, (double)stats.hash_saves));
+    
+    Napi::Object histograms = Napi::Object::New(env);
+    histograms.Set("decodeMs", CreateHistogramObject(env, stats.decode_ms_histogram));
+    histograms.Set("candidates", CreateHistogramObject(env, stats.candidates_histogram));
+    histograms.Set("messages", CreateHistogramObject(env, stats.messages_histogram));
+    histograms.Set("ldpcIterations", CreateHistogramObject(env, stats.ldpc_iterations_histogram));
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("enabled", Napi::Boolean::New(env, core_.StatsEnabled()));
+    result.Set("calls", Napi::Number::New(env, (double)stats.decode_calls));
+    result.Set("decoded", Napi::Number::New(env, (double)stats.decoded));
+    result.Set("totalMs", Napi::Number::New(env, stats.decode_ns / 1e6));
+    result.Set("stages", stages);
+    result.Set("hash", hash);
+    result.Set("histograms", histograms);
+    result.Set("profile", (governor_ && profile_level_ >= 0)
+        ? LoadController::ProfileToObject(env, governor_->Profiles()[profile_level_], profile_level_)
+        : env.Null());
+    
+    return result;
+}
+
+void MessageDecoder::ResetStats(const Napi::CallbackInfo& info) {
+    core_.ResetStats();
+}
+
+void MessageDecoder::SetStatsEnabled(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Expected boolean").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    core_.EnableStats(info[0].As<Napi::Boolean>().Value());
+}
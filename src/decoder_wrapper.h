@@ -2,6 +2,11 @@
 #define DECODER_WRAPPER_H
 
 #include <napi.h>
+#include <memory>
+#include <vector>
+#include "callsign_hash.h"
+#include "decoder_core.h"
+#include "load_controller.h"
 
 extern "C" {
 #include <ft8/decode.h>
@@ -12,9 +17,10 @@ extern "C" {
 
 /**
  * MessageDecoder class for decoding FT8/FT4 messages
- * 
+ *
  * This class provides a JavaScript interface to decode FT8/FT4 signals
- * from audio buffers and extract transmitted messages.
+ * from audio buffers and extract transmitted messages. The signal processing
+ * itself lives in DecoderCore.
  */
 class MessageDecoder : public Napi::ObjectWrap<MessageDecoder> {
 public:
@@ -32,9 +38,31 @@ public:
     MessageDecoder(const Napi::CallbackInfo& info);
     
     /**
-     * Destructor - cleanup monitor resources
+     * Read decoder configuration keys from a JavaScript object
+     * @param env N-API environment
+     * @param obj Object with DecoderConfig keys
+     * @param config Configuration to update; keys that are absent are left alone
+     * @return false if a JavaScript exception was thrown
+     */
+    static bool ParseConfig(Napi::Env env, const Napi::Object& obj, DecoderConfig* config);
+    
+    /**
+     * Create a JavaScript object from a decoded message
+     * @param env N-API environment
+     * @param decoded The decoded message
+     * @return JavaScript object representing the decoded message
      */
-    ~MessageDecoder();
+    static Napi::Object CreateDecodedMessageObject(Napi::Env env, const DecodeResult& decoded);
+    
+    /**
+     * Create a JavaScript object describing waterfall magnitudes
+     * @param env N-API environment
+     * @param layout Layout of the blocks in mag
+     * @param mag Magnitudes, num_blocks blocks of layout.block_stride bytes
+     * @param num_blocks Number of blocks in mag
+     * @return JavaScript object with the magnitudes and their layout
+     */
+    static Napi::Object CreateWaterfallObject(Napi::Env env, const WaterfallLayout& layout, Napi::Uint8Array mag, int num_blocks);
 
 private:
     /**
@@ -44,6 +72,28 @@ private:
      */
     Napi::Value Decode(const Napi::CallbackInfo& info);
     
+    /**
+     * Decode messages into a transferable buffer
+     * @param info Callback info containing an AudioBuffer or null
+     * @return ArrayBuffer in the packed message format
+     */
+    Napi::Value DecodeToBuffer(const Napi::CallbackInfo& info);
+    
+    /**
+     * Turn a buffer from DecodeToBuffer back into message objects
+     * @param info Callback info containing the buffer
+     * @return Array of decoded messages
+     */
+    static Napi::Value UnpackMessages(const Napi::CallbackInfo& info);
+    
+    /**
+     * Decode the audio argument, or the current waterfall for null
+     * @param info Callback info containing an AudioBuffer or null
+     * @param decoded_messages Receives the decoded messages
+     * @return false if a JavaScript exception was thrown
+     */
+    bool DecodeArgument(const Napi::CallbackInfo& info, std::vector<DecodeResult>* decoded_messages);
+    
     /**
      * Find message candidates in audio
      * @param info Callback info containing audio buffer
@@ -57,84 +107,140 @@ private:
      * @return Decoded message object or null
      */
     Napi::Value DecodeCandidate(const Napi::CallbackInfo& info);
-
-    // Configuration
-    ftx_protocol_t protocol_;
-    int min_score_;
-    int max_candidates_;
-    int max_ldpc_iterations_;
-    int max_decoded_messages_;
-    int freq_osr_;
-    int time_osr_;
-    float freq_min_;
-    float freq_max_;
     
-    // Monitor for signal processing
-    monitor_t monitor_;
-    bool monitor_initialized_;
+    /**
+     * Zero-copy view of the current waterfall
+     * @param info Callback info
+     * @return Waterfall object, or null before the first audio was processed
+     */
+    Napi::Value GetWaterfall(const Napi::CallbackInfo& info);
     
     /**
-     * Initialize the monitor with current configuration
-     * @param sample_rate Sample rate of input audio
+     * Snapshot of the current waterfall in the spectrum file format
+     * @param info Callback info
+     * @return Buffer, or null before the first audio was processed
      */
-    void InitializeMonitor(int sample_rate);
+    Napi::Value SerializeSpectrum(const Napi::CallbackInfo& info);
     
     /**
-     * Process audio buffer through the monitor
-     * @param samples Audio samples
-     * @param num_samples Number of samples
-     * @param sample_rate Sample rate
+     * Replace the waterfall with a snapshot from SerializeSpectrum
+     * @param info Callback info containing the snapshot bytes
+     * @return Waterfall view of the loaded blocks, as from GetWaterfall
      */
-    void ProcessAudio(const float* samples, int num_samples, int sample_rate);
+    Napi::Value LoadSpectrum(const Napi::CallbackInfo& info);
     
     /**
-     * Create a JavaScript object from a decoded message
-     * @param env N-API environment
-     * @param message The decoded message
-     * @param status Decoding status
-     * @param message_text Decoded message text
-     * @return JavaScript object representing the decoded message
+     * Snapshot of the callsign hash table
+     * @param info Callback info
+     * @return Buffer in the callsign hash snapshot format
      */
-    Napi::Object CreateDecodedMessageObject(Napi::Env env, const ftx_message_t* message,
-                                           const ftx_decode_status_t* status, const char* message_text);
+    Napi::Value ExportHashes(const Napi::CallbackInfo& info);
     
     /**
-     * Create a JavaScript object from a message candidate
+     * Add the entries of a snapshot from ExportHashes to the hash table
+     * @param info Callback info containing the snapshot bytes
+     * @return Number of callsigns that were new to the table
+     */
+    Napi::Value ImportHashes(const Napi::CallbackInfo& info);
+    
+    /**
+     * Replace the read-only index of known callsigns
+     * @param info Callback info containing the callsigns and options
+     * @return Object with the number of indexed and rejected callsigns
+     */
+    Napi::Value SeedHashes(const Napi::CallbackInfo& info);
+    
+    /**
+     * Pass the hash table activity of a decode to a JavaScript CallsignHashInterface
+     *
+     * The interface is called after the decode, once per distinct hash,
+     * rather than from inside the unpacker. Callsigns it resolves are added to
+     * the hash table and the affected messages are unpacked again.
+     *
      * @param env N-API environment
-     * @param candidate The message candidate
-     * @return JavaScript object representing the candidate
+     * @param hash_interface Object with lookupHash and saveHash methods
+     * @param misses Lookups the decode could not resolve
+     * @param saves Callsigns the decode added to the hash table
+     * @param decoded_messages Decoded messages; updated with resolved callsigns
+     * @return false if a JavaScript exception was thrown
      */
-    Napi::Object CreateCandidateObject(Napi::Env env, const ftx_candidate_t* candidate);
+    bool ApplyHashInterface(Napi::Env env, const Napi::Object& hash_interface,
+                            const std::vector<CallsignHashRequest>& misses,
+                            const std::vector<CallsignHash>& saves,
+                            std::vector<DecodeResult>* decoded_messages);
     
     /**
-     * Simple callsign hash table for testing
+     * Decode a narrow region around a known frequency
+     * @param info Callback info containing an AudioBuffer or null, and the region options
+     * @return Array of decoded messages
      */
-    struct CallsignHashEntry {
-        char callsign[12];
-        uint32_t hash;
-        bool used;
-    };
+    Napi::Value DecodeFocused(const Napi::CallbackInfo& info);
     
-    static const int HASH_TABLE_SIZE = 256;
-    CallsignHashEntry hash_table_[HASH_TABLE_SIZE];
+    /**
+     * Decode a whole WAV recording slot by slot on a thread pool
+     * @param info Callback info containing file path and options
+     * @return Promise resolving when the file has been decoded
+     */
+    Napi::Value DecodeFile(const Napi::CallbackInfo& info);
     
     /**
-     * Hash table lookup function
+     * Pipeline counters, timers and histograms
+     * @param info Callback info
+     * @return Statistics object
      */
-    static bool HashTableLookup(ftx_callsign_hash_type_t hash_type, uint32_t hash, char* callsign);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
     
     /**
-     * Hash table save function
+     * Clear the pipeline statistics
+     * @param info Callback info
      */
-    static void HashTableSave(const char* callsign, uint32_t hash);
+    void ResetStats(const Napi::CallbackInfo& info);
+    
+    /**
+     * Turn collection of pipeline statistics on or off
+     * @param info Callback info containing a boolean
+     */
+    void SetStatsEnabled(const Napi::CallbackInfo& info);
+    
+    // Signal processing, configuration and hash table
+    DecoderCore core_;
     
-    // Static pointer to current instance for C callbacks
-    static MessageDecoder* current_instance_;
+    // External ArrayBuffer over the core's waterfall handed out by getWaterfall.
+    // Held weakly and detached as soon as the core reallocates the waterfall.
+    Napi::Reference<Napi::ArrayBuffer> waterfall_view_;
+    uint64_t waterfall_view_generation_;
+    // Expires with this decoder, so a late finalizer of the view does not touch it
+    std::shared_ptr<int> view_token_;
     
     /**
-     * Initialize hash table
+     * Detach the getWaterfall view if the memory under it has been released
      */
-    void InitializeHashTable();
+    void SyncWaterfallView();
+    
+    // Narrow-band waterfall for decodeFocused calls that bring their own audio
+    std::unique_ptr<DecoderCore> focus_core_;
+    
+    // Optional shared load controller; its profiles are overlaid on base_config_
+    std::shared_ptr<LoadGovernor> governor_;
+    DecoderConfig base_config_;
+    int profile_level_;
+    
+    /**
+     * Run the samples of an AudioBuffer argument through a core
+     * @param env N-API environment
+     * @param value AudioBuffer argument
+     * @param core Core whose waterfall receives the audio
+     * @return false if a JavaScript exception was thrown
+     */
+    bool ProcessAudioArgument(Napi::Env env, const Napi::Value& value, DecoderCore* core);
+    
+    /**
+     * Create a JavaScript object from a message candidate
+     * @param env N-API environment
+     * @param candidate The message candidate
+     * @return JavaScript object representing the candidate
+     */
+    Napi::Object CreateCandidateObject(Napi::Env env, const ftx_candidate_t* candidate);
 };
 
 #endif // DECODER_WRAPPER_H
@@ -1,7 +1,12 @@
 #include "encoder_wrapper.h"
+#include "gfsk.h"
+#include "parallel.h"
+#include "trace.h"
 #include <cmath>
 #include <cstring>
 #include <algorithm>
+#include <string>
+#include <vector>
 
 extern "C" {
 #include <ft8/message.h>
@@ -9,21 +14,17 @@ extern "C" {
 #include <ft8/constants.h>
 }
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-#define GFSK_CONST_K 5.336446f  // == pi * sqrt(2 / log(2))
-
 // Default configuration values
 const float DEFAULT_FREQUENCY = 1000.0f;
 const int DEFAULT_SAMPLE_RATE = 12000;
-const float FT8_SYMBOL_BT = 2.0f;
-const float FT4_SYMBOL_BT = 1.0f;
+
+// Messages handed to a single thread by encodeBatch
+const size_t BATCH_MIN_PER_THREAD = 512;
 
 Napi::Function MessageEncoder::Init(Napi::Env env) {
     Napi::Function func = DefineClass(env, "MessageEncoder", {
         InstanceMethod("encode", &MessageEncoder::Encode),
+        InstanceMethod("encodeBatch", &MessageEncoder::EncodeBatch),
         InstanceMethod("generateAudio", &MessageEncoder::GenerateAudio),
         InstanceMethod("encodeToAudio", &MessageEncoder::EncodeToAudio)
     });
@@ -74,6 +75,7 @@ MessageEncoder::MessageEncoder(const Napi::CallbackInfo& info) : Napi::ObjectWra
 
 Napi::Value MessageEncoder::Encode(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
+    TraceScope trace("encode", "encoder");
     
     if (info.Length() < 1 || !info[0].IsString()) {
         Napi::TypeError::New(env, "Expected message string").ThrowAsJavaScriptException();
@@ -125,67 +127,105 @@ Napi::Value MessageEncoder::Encode(const Napi::CallbackInfo& info) {
     return result;
 }
 
-void MessageEncoder::GenerateGfskPulse(int n_spsym, float symbol_bt, float* pulse) {
-    for (int i = 0; i < 3 * n_spsym; ++i) {
-        float t = i / (float)n_spsym - 1.5f;
-        float arg1 = GFSK_CONST_K * symbol_bt * (t + 0.5f);
-        float arg2 = GFSK_CONST_K * symbol_bt * (t - 0.5f);
-        pulse[i] = (erff(arg1) - erff(arg2)) / 2;
-    }
-}
-
-void MessageEncoder::GenerateGfskSignal(const uint8_t* tones, int num_tones, float frequency,
-                                       float symbol_bt, float symbol_period, int sample_rate, float* signal) {
-    int n_spsym = (int)(0.5f + sample_rate * symbol_period);
-    int n_wave = num_tones * n_spsym;
-    float hmod = 1.0f;
-    
-    // Compute the smoothed frequency waveform
-    float dphi_peak = 2 * M_PI * hmod / n_spsym;
-    float* dphi = new float[n_wave + 2 * n_spsym];
-    
-    // Shift frequency up by base frequency
-    for (int i = 0; i < n_wave + 2 * n_spsym; ++i) {
-        dphi[i] = 2 * M_PI * frequency / sample_rate;
+Napi::Value MessageEncoder::EncodeBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    TraceScope trace("encodeBatch", "encoder");
+    
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected array of message strings").ThrowAsJavaScriptException();
+        return env.Null();
     }
     
-    float* pulse = new float[3 * n_spsym];
-    GenerateGfskPulse(n_spsym, symbol_bt, pulse);
+    Napi::Array messages = info[0].As<Napi::Array>();
     
-    for (int i = 0; i < num_tones; ++i) {
-        int ib = i * n_spsym;
-        for (int j = 0; j < 3 * n_spsym; ++j) {
-            dphi[j + ib] += dphi_peak * tones[i] * pulse[j];
+    ftx_protocol_t protocol = protocol_;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object config = info[1].As<Napi::Object>();
+        
+        if (config.Has("protocol")) {
+            std::string protocolStr = config.Get("protocol").As<Napi::String>().Utf8Value();
+            if (protocolStr == "FT8") {
+                protocol = FTX_PROTOCOL_FT8;
+            } else if (protocolStr == "FT4") {
+                protocol = FTX_PROTOCOL_FT4;
+            } else {
+                Napi::TypeError::New(env, "Invalid protocol. Must be 'FT8' or 'FT4'").ThrowAsJavaScriptException();
+                return env.Null();
+            }
         }
     }
     
-    // Add dummy symbols at beginning and end
-    for (int j = 0; j < 2 * n_spsym; ++j) {
-        dphi[j] += dphi_peak * pulse[j + n_spsym] * tones[0];
-        dphi[j + num_tones * n_spsym] += dphi_peak * pulse[j] * tones[num_tones - 1];
+    // Strings have to be read on the JS thread before the work is split up
+    size_t count = messages.Length();
+    std::vector<std::string> texts(count);
+    for (size_t i = 0; i < count; ++i) {
+        Napi::Value value = messages.Get(static_cast<uint32_t>(i));
+        if (!value.IsString()) {
+            Napi::TypeError::New(env, "Expected array of message strings").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        texts[i] = value.As<Napi::String>().Utf8Value();
     }
     
-    // Calculate and insert the audio waveform
-    float phi = 0;
-    for (int k = 0; k < n_wave; ++k) {
-        signal[k] = sinf(phi);
-        phi = fmodf(phi + dphi[k + n_spsym], 2 * M_PI);
-    }
+    int num_tones = (protocol == FTX_PROTOCOL_FT8) ? FT8_NN : FT4_NN;
     
-    // Apply envelope shaping to the first and last symbols
-    int n_ramp = n_spsym / 8;
-    for (int i = 0; i < n_ramp; ++i) {
-        float env = (1 - cosf(2 * M_PI * i / (2 * n_ramp))) / 2;
-        signal[i] *= env;
-        signal[n_wave - 1 - i] *= env;
-    }
+    // Structure-of-arrays output, written in place by the worker threads
+    Napi::Uint8Array payloads = Napi::Uint8Array::New(env, count * FTX_PAYLOAD_LENGTH_BYTES);
+    Napi::Uint8Array tones = Napi::Uint8Array::New(env, count * num_tones);
+    Napi::Uint32Array hashes = Napi::Uint32Array::New(env, count);
+    Napi::Uint8Array status = Napi::Uint8Array::New(env, count);
+    
+    uint8_t* payload_data = payloads.Data();
+    uint8_t* tone_data = tones.Data();
+    uint32_t* hash_data = hashes.Data();
+    uint8_t* status_data = status.Data();
+    
+    ParallelFor(count, BATCH_MIN_PER_THREAD, [&](size_t begin, size_t end) {
+        TraceScope trace("encodeBatchChunk", "encoder");
+        trace.SetArg("messages", (double)(end - begin));
+        for (size_t i = begin; i < end; ++i) {
+            uint8_t* payload = payload_data + i * FTX_PAYLOAD_LENGTH_BYTES;
+            uint8_t* msg_tones = tone_data + i * num_tones;
+            
+            ftx_message_t msg;
+            ftx_message_init(&msg);
+            
+            ftx_message_rc_t rc = ftx_message_encode(&msg, nullptr, texts[i].c_str());
+            status_data[i] = static_cast<uint8_t>(rc);
+            
+            if (rc != FTX_MESSAGE_RC_OK) {
+                memset(payload, 0, FTX_PAYLOAD_LENGTH_BYTES);
+                memset(msg_tones, 0, num_tones);
+                hash_data[i] = 0;
+                continue;
+            }
+            
+            memcpy(payload, msg.payload, FTX_PAYLOAD_LENGTH_BYTES);
+            if (protocol == FTX_PROTOCOL_FT8) {
+                ft8_encode(msg.payload, msg_tones);
+            } else {
+                ft4_encode(msg.payload, msg_tones);
+            }
+            hash_data[i] = msg.hash;
+        }
+    });
     
-    delete[] dphi;
-    delete[] pulse;
+    // Create result object
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+    result.Set("protocol", Napi::String::New(env, (protocol == FTX_PROTOCOL_FT8) ? "FT8" : "FT4"));
+    result.Set("tonesPerMessage", Napi::Number::New(env, num_tones));
+    result.Set("payloads", payloads);
+    result.Set("tones", tones);
+    result.Set("hashes", hashes);
+    result.Set("status", status);
+    
+    return result;
 }
 
 Napi::Value MessageEncoder::GenerateAudio(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
+    TraceScope trace("generateAudio", "encoder");
     
     if (info.Length() < 1 || !info[0].IsTypedArray()) {
         Napi::TypeError::New(env, "Expected Uint8Array of tones").ThrowAsJavaScriptException();
@@ -227,7 +267,7 @@ Napi::Value MessageEncoder::GenerateAudio(const Napi::CallbackInfo& info) {
     int num_tones = tonesArray.ElementLength();
     
     // Calculate sample counts
-    int num_samples = (int)(0.5f + num_tones * symbol_period * sample_rate);
+    int num_samples = GfskSignalLength(num_tones, symbol_period, sample_rate);
     int num_silence = (slot_time * sample_rate - num_samples) / 2;
     int num_total_samples = num_silence + num_samples + num_silence;
     
@@ -262,6 +302,7 @@ Napi::Value MessageEncoder::GenerateAudio(const Napi::CallbackInfo& info) {
 
 Napi::Value MessageEncoder::EncodeToAudio(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
+    TraceScope trace("encodeToAudio", "encoder");
     
     if (info.Length() < 1 || !info[0].IsString()) {
         Napi::TypeError::New(env, "Expected message string").ThrowAsJavaScriptException();
@@ -323,7 +364,7 @@ Napi::Value MessageEncoder::EncodeToAudio(const Napi::CallbackInfo& info) {
     float slot_time = (protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
     
     // Calculate sample counts
-    int num_samples = (int)(0.5f + num_tones * symbol_period * sample_rate);
+    int num_samples = GfskSignalLength(num_tones, symbol_period, sample_rate);
     int num_silence = (slot_time * sample_rate - num_samples) / 2;
     int num_total_samples = num_silence + num_samples + num_silence;
     
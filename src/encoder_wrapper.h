@@ -2,6 +2,7 @@
 #define ENCODER_WRAPPER_H
 
 #include <napi.h>
+#include "gfsk.h"
 
 extern "C" {
 #include <ft8/message.h>
@@ -38,6 +39,13 @@ private:
      */
     Napi::Value Encode(const Napi::CallbackInfo& info);
     
+    /**
+     * Encode many text messages at once into contiguous output arrays
+     * @param info Callback info containing an array of message strings and optional config
+     * @return Batch result object with payloads, tones, hashes and status arrays
+     */
+    Napi::Value EncodeBatch(const Napi::CallbackInfo& info);
+    
     /**
      * Generate audio samples from tone sequence
      * @param info Callback info containing tones and optional config
@@ -57,27 +65,6 @@ private:
     float frequency_;
     int sample_rate_;
     float symbol_bt_;
-    
-    /**
-     * Generate GFSK modulated signal from tones
-     * @param tones Array of tone symbols
-     * @param num_tones Number of tones
-     * @param frequency Base frequency in Hz
-     * @param symbol_bt Symbol smoothing bandwidth factor
-     * @param symbol_period Symbol duration in seconds
-     * @param sample_rate Sample rate in Hz
-     * @param signal Output buffer for signal samples
-     */
-    void GenerateGfskSignal(const uint8_t* tones, int num_tones, float frequency,
-                           float symbol_bt, float symbol_period, int sample_rate, float* signal);
-    
-    /**
-     * Generate GFSK pulse for symbol smoothing
-     * @param n_spsym Samples per symbol
-     * @param symbol_bt Bandwidth factor
-     * @param pulse Output pulse buffer (3*n_spsym samples)
-     */
-    void GenerateGfskPulse(int n_spsym, float symbol_bt, float* pulse);
 };
 
 #endif // ENCODER_WRAPPER_H
@@ -3,6 +3,16 @@
 #include "encoder_wrapper.h"
 #include "decoder_wrapper.h"
 #include "audio_utils.h"
+#include "wav_reader.h"
+#include "ring_receiver.h"
+#include "slot_scheduler.h"
+#include "trace_utils.h"
+#include "decoder_tuner.h"
+#include "load_controller.h"
+#include "addon_data.h"
+#include "cpu_features.h"
+#include "monitor_kernels.h"
+#include "pcm_convert.h"
 
 extern "C" {
 #include <ft8/constants.h>
@@ -12,6 +22,17 @@ extern "C" {
 #include <common/wave.h>
 }
 
+/**
+ * Environment cleanup hook: join the threads still running for the environment
+ */
+static void StopNativeThreads(AddonData* data) {
+    // StopThread unregisters the owner, so work on a copy
+    std::set<NativeThreadOwner*> owners = data->thread_owners;
+    for (NativeThreadOwner* owner : owners) {
+        owner->StopThread();
+    }
+}
+
 /**
  * Initialize the FT8/FT4 Library Node.js addon
  * 
@@ -23,9 +44,25 @@ extern "C" {
  * @return The populated exports object
  */
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    // Per-environment state, freed by N-API when the environment is torn down
+    AddonData* data = new AddonData();
+    data->wav_reader_constructor = Napi::Persistent(WavReader::Init(env));
+    Napi::Function loadController = LoadController::Init(env);
+    data->load_controller_constructor = Napi::Persistent(loadController);
+    env.SetInstanceData(data);
+    
+    // Native threads must not outlive their environment, e.g. a terminated worker
+    env.AddCleanupHook(StopNativeThreads, data);
+    
+    // Pick the kernel variants for this CPU while loading rather than on the first decode
+    ActiveKernelIsa();
+    
     // Export the main encoder and decoder classes
     exports.Set("MessageEncoder", MessageEncoder::Init(env));
     exports.Set("MessageDecoder", MessageDecoder::Init(env));
+    exports.Set("RingReceiver", RingReceiver::Init(env));
+    exports.Set("SlotScheduler", SlotScheduler::Init(env));
+    exports.Set("LoadController", loadController);
     
     // Create Utils namespace object
     Napi::Object utils = Napi::Object::New(env);
@@ -68,6 +105,45 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
         return constants;
     });
     utils.Set("getProtocolConstants", getProtocolConstants);
+    utils.Set("tuneDecoder", DecoderTuner::TuneDecoder(env));
+    
+    // CPU features and the kernel variants selected for them
+    auto getCpuFeatures = Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        const CpuFeatures& cpu = GetCpuFeatures();
+        
+        Napi::Object features = Napi::Object::New(env);
+        features.Set("sse2", Napi::Boolean::New(env, cpu.sse2));
+        features.Set("sse42", Napi::Boolean::New(env, cpu.sse42));
+        features.Set("avx", Napi::Boolean::New(env, cpu.avx));
+        features.Set("avx2", Napi::Boolean::New(env, cpu.avx2));
+        features.Set("fma", Napi::Boolean::New(env, cpu.fma));
+        features.Set("avx512f", Napi::Boolean::New(env, cpu.avx512f));
+        features.Set("avx512bw", Napi::Boolean::New(env, cpu.avx512bw));
+        features.Set("avx512vl", Napi::Boolean::New(env, cpu.avx512vl));
+        features.Set("neon", Napi::Boolean::New(env, cpu.neon));
+        
+        // Variants compiled into this binary, lowest first
+        Napi::Array variants = Napi::Array::New(env);
+#if defined(KERNEL_HAVE_X86_VARIANTS)
+        variants.Set(0u, Napi::String::New(env, KernelIsaName(KERNEL_ISA_BASELINE)));
+        variants.Set(1u, Napi::String::New(env, KernelIsaName(KERNEL_ISA_AVX2)));
+        variants.Set(2u, Napi::String::New(env, KernelIsaName(KERNEL_ISA_AVX512)));
+#elif defined(__aarch64__) || defined(_M_ARM64)
+        variants.Set(0u, Napi::String::New(env, KernelIsaName(KERNEL_ISA_NEON)));
+#else
+        variants.Set(0u, Napi::String::New(env, KernelIsaName(KERNEL_ISA_BASELINE)));
+#endif
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("features", features);
+        result.Set("kernels", Napi::String::New(env, KernelIsaName(ActiveKernelIsa())));
+        result.Set("availableKernels", variants);
+        result.Set("monitorKernels", Napi::String::New(env, KernelIsaName(ActiveMonitorIsa())));
+        result.Set("pcmKernels", Napi::String::New(env, PcmKernelName()));
+        return result;
+    });
+    utils.Set("getCpuFeatures", getCpuFeatures);
     
     // Audio utilities namespace
     Napi::Object audioUtils = Napi::Object::New(env);
@@ -75,6 +151,8 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     audioUtils.Set("float32ToPcm16", AudioUtils::Float32ToPcm16(env));
     audioUtils.Set("loadWav", AudioUtils::LoadWav(env));
     audioUtils.Set("saveWav", AudioUtils::SaveWav(env));
+    audioUtils.Set("synthesizeBand", AudioUtils::SynthesizeBand(env));
+    audioUtils.Set("openWav", AudioUtils::OpenWav(env));
     utils.Set("Audio", audioUtils);
     
     // Message utilities namespace
@@ -82,6 +160,8 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     messageUtils.Set("isValidMessage", MessageWrapper::IsValidMessage(env));
     messageUtils.Set("getMessageType", MessageWrapper::GetMessageType(env));
     messageUtils.Set("parseStandardMessage", MessageWrapper::ParseStandardMessage(env));
+    messageUtils.Set("analyze", MessageWrapper::AnalyzeMessage(env));
+    messageUtils.Set("analyzeBatch", MessageWrapper::AnalyzeBatch(env));
     utils.Set("Message", messageUtils);
     
     // CRC utilities namespace
@@ -90,6 +170,13 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     crcUtils.Set("verifyCrc14", MessageWrapper::VerifyCrc14(env));
     utils.Set("CRC", crcUtils);
     
+    // Tracing namespace
+    Napi::Object traceUtils = Napi::Object::New(env);
+    traceUtils.Set("start", TraceUtils::Start(env));
+    traceUtils.Set("stop", TraceUtils::Stop(env));
+    traceUtils.Set("isEnabled", TraceUtils::IsEnabled(env));
+    utils.Set("Trace", traceUtils);
+    
     exports.Set("Utils", utils);
     
     return exports;
@@ -0,0 +1,120 @@
+#include "gfsk.h"
+#include "cpu_features.h"
+#include <cmath>
+
+// The AVX-512 variants must round like the baseline, so no fused multiply-adds;
+// GCC builds get -ffp-contract=off from binding.gyp instead
+#ifdef __clang__
+#pragma clang fp contract(off)
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define GFSK_CONST_K 5.336446f  // == pi * sqrt(2 / log(2))
+
+void GenerateGfskPulse(int n_spsym, float symbol_bt, float* pulse) {
+    for (int i = 0; i < 3 * n_spsym; ++i) {
+        float t = i / (float)n_spsym - 1.5f;
+        float arg1 = GFSK_CONST_K * symbol_bt * (t + 0.5f);
+        float arg2 = GFSK_CONST_K * symbol_bt * (t - 0.5f);
+        pulse[i] = (erff(arg1) - erff(arg2)) / 2;
+    }
+}
+
+namespace {
+
+void GenerateGfskSignalKernel(const uint8_t* tones, int num_tones, float frequency,
+                              float symbol_bt, float symbol_period, int sample_rate, float* signal,
+                              float drift) {
+    int n_spsym = (int)(0.5f + sample_rate * symbol_period);
+    int n_wave = num_tones * n_spsym;
+    float hmod = 1.0f;
+
+    // Compute the smoothed frequency waveform
+    float dphi_peak = 2 * M_PI * hmod / n_spsym;
+    float* dphi = new float[n_wave + 2 * n_spsym];
+
+    // Shift frequency up by base frequency (plus linear drift, relative to the first real symbol)
+    for (int i = 0; i < n_wave + 2 * n_spsym; ++i) {
+        float f = frequency + drift * (float)(i - n_spsym) / sample_rate;
+        dphi[i] = 2 * M_PI * f / sample_rate;
+    }
+
+    float* pulse = new float[3 * n_spsym];
+    GenerateGfskPulse(n_spsym, symbol_bt, pulse);
+
+    for (int i = 0; i < num_tones; ++i) {
+        int ib = i * n_spsym;
+        for (int j = 0; j < 3 * n_spsym; ++j) {
+            dphi[j + ib] += dphi_peak * tones[i] * pulse[j];
+        }
+    }
+
+    // Add dummy symbols at beginning and end
+    for (int j = 0; j < 2 * n_spsym; ++j) {
+        dphi[j] += dphi_peak * pulse[j + n_spsym] * tones[0];
+        dphi[j + num_tones * n_spsym] += dphi_peak * pulse[j] * tones[num_tones - 1];
+    }
+
+    // Calculate and insert the audio waveform
+    float phi = 0;
+    for (int k = 0; k < n_wave; ++k) {
+        signal[k] = sinf(phi);
+        phi = fmodf(phi + dphi[k + n_spsym], 2 * M_PI);
+    }
+
+    // Apply envelope shaping to the first and last symbols
+    int n_ramp = n_spsym / 8;
+    for (int i = 0; i < n_ramp; ++i) {
+        float env = (1 - cosf(2 * M_PI * i / (2 * n_ramp))) / 2;
+        signal[i] *= env;
+        signal[n_wave - 1 - i] *= env;
+    }
+
+    delete[] dphi;
+    delete[] pulse;
+}
+
+#ifdef KERNEL_HAVE_X86_VARIANTS
+KERNEL_TARGET_AVX2
+void GenerateGfskSignalAvx2(const uint8_t* tones, int num_tones, float frequency,
+                            float symbol_bt, float symbol_period, int sample_rate, float* signal,
+                            float drift) {
+    GenerateGfskSignalKernel(tones, num_tones, frequency, symbol_bt, symbol_period, sample_rate, signal, drift);
+}
+
+KERNEL_TARGET_AVX512
+void GenerateGfskSignalAvx512(const uint8_t* tones, int num_tones, float frequency,
+                              float symbol_bt, float symbol_period, int sample_rate, float* signal,
+                              float drift) {
+    GenerateGfskSignalKernel(tones, num_tones, frequency, symbol_bt, symbol_period, sample_rate, signal, drift);
+}
+#endif
+
+typedef void (*GfskSignalFn)(const uint8_t*, int, float, float, float, int, float*, float);
+
+GfskSignalFn SelectGfskSignal() {
+#ifdef KERNEL_HAVE_X86_VARIANTS
+    switch (ActiveKernelIsa()) {
+        case KERNEL_ISA_AVX512: return GenerateGfskSignalAvx512;
+        case KERNEL_ISA_AVX2: return GenerateGfskSignalAvx2;
+        default: break;
+    }
+#endif
+    return GenerateGfskSignalKernel;
+}
+
+} // namespace
+
+int GfskSignalLength(int num_tones, float symbol_period, int sample_rate) {
+    return num_tones * (int)(0.5f + sample_rate * symbol_period);
+}
+
+void GenerateGfskSignal(const uint8_t* tones, int num_tones, float frequency,
+                        float symbol_bt, float symbol_period, int sample_rate, float* signal,
+                        float drift) {
+    static const GfskSignalFn generate = SelectGfskSignal();
+    generate(tones, num_tones, frequency, symbol_bt, symbol_period, sample_rate, signal, drift);
+}
@@ -0,0 +1,42 @@
+#ifndef GFSK_H
+#define GFSK_H
+
+#include <cstdint>
+
+// Default GFSK smoothing bandwidth factors
+const float FT8_SYMBOL_BT = 2.0f;
+const float FT4_SYMBOL_BT = 1.0f;
+
+/**
+ * Generate GFSK modulated signal from tones
+ * @param tones Array of tone symbols
+ * @param num_tones Number of tones
+ * @param frequency Base frequency in Hz
+ * @param symbol_bt Symbol smoothing bandwidth factor
+ * @param symbol_period Symbol duration in seconds
+ * @param sample_rate Sample rate in Hz
+ * @param signal Output buffer for signal samples (num_tones * samples per symbol)
+ * @param drift Linear frequency drift in Hz per second (default: 0)
+ */
+void GenerateGfskSignal(const uint8_t* tones, int num_tones, float frequency,
+                        float symbol_bt, float symbol_period, int sample_rate, float* signal,
+                        float drift = 0.0f);
+
+/**
+ * Number of samples GenerateGfskSignal writes for a tone sequence
+ * @param num_tones Number of tones
+ * @param symbol_period Symbol duration in seconds
+ * @param sample_rate Sample rate in Hz
+ * @return num_tones * samples per symbol
+ */
+int GfskSignalLength(int num_tones, float symbol_period, int sample_rate);
+
+/**
+ * Generate GFSK pulse for symbol smoothing
+ * @param n_spsym Samples per symbol
+ * @param symbol_bt Bandwidth factor
+ * @param pulse Output pulse buffer (3*n_spsym samples)
+ */
+void GenerateGfskPulse(int n_spsym, float symbol_bt, float* pulse);
+
+#endif // GFSK_H
@@ -0,0 +1,305 @@
+#include "load_controller.h"
+#include "addon_data.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * Built-in profiles: the receiver's own configuration first, then cheaper steps
+ */
+std::vector<LoadProfile> DefaultProfiles() {
+    std::vector<LoadProfile> profiles(4);
+    
+    profiles[0].name = "full";
+    
+    profiles[1].name = "reduced";
+    profiles[1].max_candidates = 100;
+    profiles[1].max_ldpc_iterations = 20;
+    
+    profiles[2].name = "light";
+    profiles[2].max_candidates = 70;
+    profiles[2].max_ldpc_iterations = 15;
+    profiles[2].time_osr = 1;
+    
+    profiles[3].name = "minimal";
+    profiles[3].max_candidates = 40;
+    profiles[3].max_ldpc_iterations = 10;
+    profiles[3].freq_osr = 1;
+    profiles[3].time_osr = 1;
+    
+    return profiles;
+}
+
+/**
+ * Read an optional integer profile field
+ */
+bool ParseProfileField(Napi::Env env, const Napi::Object& obj, const char* name, int min_value, int max_value, int* field) {
+    if (!obj.Has(name) || obj.Get(name).IsUndefined()) {
+        return true;
+    }
+    Napi::Value value = obj.Get(name);
+    if (!value.IsNumber()) {
+        Napi::TypeError::New(env, std::string("Profile ") + name + " must be a number").ThrowAsJavaScriptException();
+        return false;
+    }
+    int v = value.As<Napi::Number>().Int32Value();
+    if (v < min_value || v > max_value) {
+        Napi::RangeError::New(env, std::string("Profile ") + name + " must be between " +
+                              std::to_string(min_value) + " and " + std::to_string(max_value)).ThrowAsJavaScriptException();
+        return false;
+    }
+    *field = v;
+    return true;
+}
+
+} // namespace
+
+DecoderConfig LoadProfile::Apply(const DecoderConfig& base) const {
+    // A profile only ever sheds load, so a receiver set up lighter keeps its own values
+    DecoderConfig config = base;
+    if (min_score >= 0) {
+        config.min_score = std::max(base.min_score, min_score);
+    }
+    if (max_candidates >= 0) {
+        config.max_candidates = std::min(base.max_candidates, max_candidates);
+    }
+    if (max_ldpc_iterations >= 0) {
+        config.max_ldpc_iterations = std::min(base.max_ldpc_iterations, max_ldpc_iterations);
+    }
+    if (freq_osr >= 0) {
+        config.freq_osr = std::min(base.freq_osr, freq_osr);
+    }
+    if (time_osr >= 0) {
+        config.time_osr = std::min(base.time_osr, time_osr);
+    }
+    return config;
+}
+
+LoadGovernor::LoadGovernor(const std::vector<LoadProfile>& profiles, const LoadGovernorOptions& options)
+    : profiles_(profiles),
+      options_(options),
+      level_(0),
+      pinned_(false),
+      high_count_(0),
+      low_count_(0),
+      reports_(0),
+      steps_down_(0),
+      steps_up_(0),
+      last_load_(0),
+      peak_load_(0) {
+}
+
+int LoadGovernor::Level() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return level_;
+}
+
+void LoadGovernor::Report(int level, double latency_ms, double slot_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    double load = (slot_ms > 0) ? latency_ms / slot_ms : 0;
+    reports_++;
+    last_load_ = load;
+    peak_load_ = std::max(peak_load_, load);
+    
+    // Decodes that ran before the last step say nothing about the current profile
+    if (pinned_ || level != level_) {
+        return;
+    }
+    
+    high_count_ = (load > options_.high_load) ? high_count_ + 1 : 0;
+    low_count_ = (load < options_.low_load) ? low_count_ + 1 : 0;
+    
+    if (high_count_ >= options_.down_reports && level_ + 1 < (int)profiles_.size()) {
+        level_++;
+        steps_down_++;
+        high_count_ = 0;
+        low_count_ = 0;
+    } else if (low_count_ >= options_.up_reports && level_ > 0) {
+        level_--;
+        steps_up_++;
+        high_count_ = 0;
+        low_count_ = 0;
+    }
+}
+
+void LoadGovernor::SetLevel(int level, bool pinned) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pinned) {
+        level_ = std::max(0, std::min(level, (int)profiles_.size() - 1));
+    }
+    pinned_ = pinned;
+    high_count_ = 0;
+    low_count_ = 0;
+}
+
+LoadGovernor::Snapshot LoadGovernor::GetSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snapshot;
+    snapshot.level = level_;
+    snapshot.pinned = pinned_;
+    snapshot.reports = reports_;
+    snapshot.steps_down = steps_down_;
+    snapshot.steps_up = steps_up_;
+    snapshot.last_load = last_load_;
+    snapshot.peak_load = peak_load_;
+    return snapshot;
+}
+
+Napi::Function LoadController::Init(Napi::Env env) {
+    Napi::Function func = DefineClass(env, "LoadController", {
+        InstanceMethod("getStats", &LoadController::GetStats),
+        InstanceMethod("setLevel", &LoadController::SetLevel),
+        InstanceMethod("getProfiles", &LoadController::GetProfiles)
+    });
+    
+    return func;
+}
+
+LoadController::LoadController(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<LoadController>(info) {
+    Napi::Env env = info.Env();
+    
+    std::vector<LoadProfile> profiles = DefaultProfiles();
+    LoadGovernorOptions options;
+    
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object obj = info[0].As<Napi::Object>();
+        
+        if (obj.Has("profiles")) {
+            Napi::Value value = obj.Get("profiles");
+            if (!value.IsArray() || value.As<Napi::Array>().Length() == 0) {
+                Napi::TypeError::New(env, "profiles must be a non-empty array").ThrowAsJavaScriptException();
+                return;
+            }
+            
+            Napi::Array array = value.As<Napi::Array>();
+            profiles.clear();
+            for (uint32_t i = 0; i < array.Length(); ++i) {
+                if (!array.Get(i).IsObject()) {
+                    Napi::TypeError::New(env, "Each profile must be an object").ThrowAsJavaScriptException();
+                    return;
+                }
+                Napi::Object p = array.Get(i).As<Napi::Object>();
+                LoadProfile profile;
+                profile.name = p.Has("name") ? p.Get("name").ToString().Utf8Value() : "level" + std::to_string(i);
+                if (!ParseProfileField(env, p, "minScore", 0, 1000, &profile.min_score) ||
+                    !ParseProfileField(env, p, "maxCandidates", 1, 1000, &profile.max_candidates) ||
+                    !ParseProfileField(env, p, "maxLdpcIterations", 1, 1000, &profile.max_ldpc_iterations) ||
+                    !ParseProfileField(env, p, "freqOsr", 1, 8, &profile.freq_osr) ||
+                    !ParseProfileField(env, p, "timeOsr", 1, 8, &profile.time_osr)) {
+                    return;
+                }
+                profiles.push_back(profile);
+            }
+        }
+        
+        if (obj.Has("highLoad")) {
+            options.high_load = obj.Get("highLoad").As<Napi::Number>().DoubleValue();
+        }
+        if (obj.Has("lowLoad")) {
+            options.low_load = obj.Get("lowLoad").As<Napi::Number>().DoubleValue();
+        }
+        if (!(options.low_load >= 0 && options.low_load < options.high_load)) {
+            Napi::RangeError::New(env, "lowLoad must be non-negative and below highLoad").ThrowAsJavaScriptException();
+            return;
+        }
+        
+        if (obj.Has("downReports")) {
+            options.down_reports = obj.Get("downReports").As<Napi::Number>().Int32Value();
+        }
+        if (obj.Has("upReports")) {
+            options.up_reports = obj.Get("upReports").As<Napi::Number>().Int32Value();
+        }
+        if (options.down_reports < 1 || options.up_reports < 1) {
+            Napi::RangeError::New(env, "downReports and upReports must be at least 1").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    
+    governor_ = std::make_shared<LoadGovernor>(profiles, options);
+}
+
+bool LoadController::FromValue(Napi::Env env, const Napi::Value& value, std::shared_ptr<LoadGovernor>* governor) {
+    AddonData* data = env.GetInstanceData<AddonData>();
+    if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(data->load_controller_constructor.Value())) {
+        Napi::TypeError::New(env, "loadController must be a LoadController").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    *governor = Unwrap(value.As<Napi::Object>())->governor_;
+    return true;
+}
+
+Napi::Object LoadController::ProfileToObject(Napi::Env env, const LoadProfile& profile, int level) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("level", Napi::Number::New(env, level));
+    obj.Set("name", Napi::String::New(env, profile.name));
+    if (profile.min_score >= 0) {
+        obj.Set("minScore", Napi::Number::New(env, profile.min_score));
+    }
+    if (profile.max_candidates >= 0) {
+        obj.Set("maxCandidates", Napi::Number::New(env, profile.max_candidates));
+    }
+    if (profile.max_ldpc_iterations >= 0) {
+        obj.Set("maxLdpcIterations", Napi::Number::New(env, profile.max_ldpc_iterations));
+    }
+    if (profile.freq_osr >= 0) {
+        obj.Set("freqOsr", Napi::Number::New(env, profile.freq_osr));
+    }
+    if (profile.time_osr >= 0) {
+        obj.Set("timeOsr", Napi::Number::New(env, profile.time_osr));
+    }
+    return obj;
+}
+
+Napi::Value LoadController::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    LoadGovernor::Snapshot snapshot = governor_->GetSnapshot();
+    
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("level", Napi::Number::New(env, snapshot.level));
+    stats.Set("profile", ProfileToObject(env, governor_->Profiles()[snapshot.level], snapshot.level));
+    stats.Set("pinned", Napi::Boolean::New(env, snapshot.pinned));
+    stats.Set("reports", Napi::Number::New(env, (double)snapshot.reports));
+    stats.Set("stepsDown", Napi::Number::New(env, (double)snapshot.steps_down));
+    stats.Set("stepsUp", Napi::Number::New(env, (double)snapshot.steps_up));
+    stats.Set("lastLoad", Napi::Number::New(env, snapshot.last_load));
+    stats.Set("peakLoad", Napi::Number::New(env, snapshot.peak_load));
+    
+    return stats;
+}
+
+void LoadController::SetLevel(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined()) {
+        governor_->SetLevel(0, false);
+        return;
+    }
+    
+    if (!info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected profile level or null").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    int level = info[0].As<Napi::Number>().Int32Value();
+    if (level < 0 || level >= (int)governor_->Profiles().size()) {
+        Napi::RangeError::New(env, "Profile level out of range").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    governor_->SetLevel(level, true);
+}
+
+Napi::Value LoadController::GetProfiles(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const std::vector<LoadProfile>& profiles = governor_->Profiles();
+    
+    Napi::Array result = Napi::Array::New(env, profiles.size());
+    for (size_t i = 0; i < profiles.size(); ++i) {
+        result.Set(i, ProfileToObject(env, profiles[i], (int)i));
+    }
+    
+    return result;
+}
@@ -0,0 +1,166 @@
+#ifndef LOAD_CONTROLLER_H
+#define LOAD_CONTROLLER_H
+
+#include <napi.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "decoder_core.h"
+
+/**
+ * One step of decoder effort; negative fields keep the receiver's own setting
+ */
+struct LoadProfile {
+    std::string name;
+    int min_score = -1;
+    int max_candidates = -1;
+    int max_ldpc_iterations = -1;
+    int freq_osr = -1;
+    int time_osr = -1;
+
+    /**
+     * Overlay this profile on a receiver's configuration
+     *
+     * Fields are limits: each can only lower the receiver's effort (a higher
+     * min_score, fewer candidates, iterations or oversampling), never raise it.
+     */
+    DecoderConfig Apply(const DecoderConfig& base) const;
+};
+
+/**
+ * Tuning of the load controller; loads are decode latency divided by the slot period
+ */
+struct LoadGovernorOptions {
+    double high_load = 0.25;
+    double low_load = 0.1;
+    // Consecutive reports above high_load before stepping down
+    int down_reports = 2;
+    // Consecutive reports below low_load before stepping back up
+    int up_reports = 8;
+};
+
+/**
+ * Shared state that steps all attached receivers through decoder profiles
+ *
+ * Receivers report the latency of every slot they decode together with the
+ * profile they decoded it with. Reports made with an older profile are
+ * ignored, so each step is judged only by decodes that ran after it. Safe to
+ * use from any thread.
+ */
+class LoadGovernor {
+public:
+    LoadGovernor(const std::vector<LoadProfile>& profiles, const LoadGovernorOptions& options);
+
+    /**
+     * Profiles from most to least effort
+     */
+    const std::vector<LoadProfile>& Profiles() const { return profiles_; }
+
+    /**
+     * Index of the profile receivers should use now
+     */
+    int Level() const;
+
+    /**
+     * Report a decoded slot
+     * @param level Profile the slot was decoded with
+     * @param latency_ms Time from the end of the slot's audio to the finished decode
+     * @param slot_ms Slot period
+     */
+    void Report(int level, double latency_ms, double slot_ms);
+
+    /**
+     * Pin the level, or hand control back to the governor with pinned = false
+     */
+    void SetLevel(int level, bool pinned);
+
+    /**
+     * Counters for getStats()
+     */
+    struct Snapshot {
+        int level;
+        bool pinned;
+        uint64_t reports;
+        uint64_t steps_down;
+        uint64_t steps_up;
+        double last_load;
+        double peak_load;
+    };
+
+    Snapshot GetSnapshot() const;
+
+private:
+    const std::vector<LoadProfile> profiles_;
+    const LoadGovernorOptions options_;
+
+    mutable std::mutex mutex_;
+    int level_;
+    bool pinned_;
+    int high_count_;
+    int low_count_;
+    uint64_t reports_;
+    uint64_t steps_down_;
+    uint64_t steps_up_;
+    double last_load_;
+    double peak_load_;
+};
+
+/**
+ * LoadController exposes a LoadGovernor to JavaScript
+ *
+ * One controller is shared by any number of RingReceivers and MessageDecoders
+ * through their loadController option. When decodes fall behind real time
+ * the controller steps all of them down to cheaper profiles, and back up once
+ * there is headroom again.
+ */
+class LoadController : public Napi::ObjectWrap<LoadController> {
+public:
+    /**
+     * Initialize the LoadController class for Node.js
+     * @param env N-API environment
+     * @return Constructor function
+     */
+    static Napi::Function Init(Napi::Env env);
+
+    /**
+     * Constructor
+     * @param info Callback info containing an optional options object
+     */
+    LoadController(const Napi::CallbackInfo& info);
+
+    /**
+     * Read the loadController option of a receiver
+     * @param env N-API environment
+     * @param value Option value; must be a LoadController
+     * @param governor Receives the controller's shared state
+     * @return false with a pending exception if value is not a LoadController
+     */
+    static bool FromValue(Napi::Env env, const Napi::Value& value, std::shared_ptr<LoadGovernor>* governor);
+
+    /**
+     * Describe one profile for JavaScript
+     */
+    static Napi::Object ProfileToObject(Napi::Env env, const LoadProfile& profile, int level);
+
+private:
+    /**
+     * Current level, profile and step counters
+     */
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    /**
+     * Pin a level, or resume automatic control with null
+     */
+    void SetLevel(const Napi::CallbackInfo& info);
+
+    /**
+     * The profiles from most to least effort
+     */
+    Napi::Value GetProfiles(const Napi::CallbackInfo& info);
+
+    std::shared_ptr<LoadGovernor> governor_;
+};
+
+#endif // LOAD_CONTROLLER_H
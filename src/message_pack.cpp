@@ -0,0 +1,92 @@
+#include "message_pack.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char PACKED_MESSAGES_MAGIC[4] = {'F', 'T', 'X', 'M'};
+
+// Longest text a record holds, without the terminating NUL
+const size_t PACKED_TEXT_MAX = 47;
+
+template <typename T>
+void Put(uint8_t* p, T value) {
+    memcpy(p, &value, sizeof(T));
+}
+
+template <typename T>
+T Get(const uint8_t* p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+size_t PackedMessagesSize(size_t count) {
+    return PACKED_MESSAGES_HEADER_SIZE + count * PACKED_MESSAGE_SIZE;
+}
+
+void PackMessages(const std::vector<DecodeResult>& messages, uint8_t* out) {
+    memset(out, 0, PackedMessagesSize(messages.size()));
+    memcpy(out, PACKED_MESSAGES_MAGIC, sizeof(PACKED_MESSAGES_MAGIC));
+    Put<uint16_t>(out + 4, PACKED_MESSAGES_VERSION);
+    Put<uint16_t>(out + 6, (uint16_t)PACKED_MESSAGE_SIZE);
+    Put<uint32_t>(out + 8, (uint32_t)messages.size());
+
+    uint8_t* record = out + PACKED_MESSAGES_HEADER_SIZE;
+    for (const DecodeResult& decoded : messages) {
+        size_t length = std::min(decoded.text.size(), PACKED_TEXT_MAX);
+        Put<float>(record, decoded.status.freq);
+        Put<float>(record + 4, decoded.status.time);
+        Put<float>(record + 8, decoded.snr);
+        Put<int16_t>(record + 12, decoded.candidate.score);
+        record[14] = (uint8_t)decoded.type;
+        record[15] = (uint8_t)length;
+        memcpy(record + 16, decoded.message.payload, FTX_PAYLOAD_LENGTH_BYTES);
+        Put<uint16_t>(record + 26, decoded.message.hash);
+        memcpy(record + 32, decoded.text.data(), length);
+        record += PACKED_MESSAGE_SIZE;
+    }
+}
+
+bool UnpackMessages(const uint8_t* data, size_t size, std::vector<DecodeResult>* messages, std::string* error) {
+    if (size < PACKED_MESSAGES_HEADER_SIZE || memcmp(data, PACKED_MESSAGES_MAGIC, sizeof(PACKED_MESSAGES_MAGIC)) != 0) {
+        *error = "Not a packed message buffer";
+        return false;
+    }
+    if (Get<uint16_t>(data + 4) != PACKED_MESSAGES_VERSION || Get<uint16_t>(data + 6) != PACKED_MESSAGE_SIZE) {
+        *error = "Unsupported packed message buffer version";
+        return false;
+    }
+    uint32_t count = Get<uint32_t>(data + 8);
+    if ((size - PACKED_MESSAGES_HEADER_SIZE) / PACKED_MESSAGE_SIZE < count) {
+        *error = "Packed message buffer is truncated";
+        return false;
+    }
+
+    messages->clear();
+    messages->reserve(count);
+    const uint8_t* record = data + PACKED_MESSAGES_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; ++i) {
+        DecodeResult decoded;
+        memset(&decoded.message, 0, sizeof(decoded.message));
+        memset(&decoded.candidate, 0, sizeof(decoded.candidate));
+        memset(&decoded.status, 0, sizeof(decoded.status));
+
+        decoded.status.freq = Get<float>(record);
+        decoded.status.time = Get<float>(record + 4);
+        decoded.frequency = decoded.status.freq;
+        decoded.time_offset = decoded.status.time;
+        decoded.snr = Get<float>(record + 8);
+        decoded.candidate.score = Get<int16_t>(record + 12);
+        decoded.type = (ftx_message_type_t)record[14];
+        memcpy(decoded.message.payload, record + 16, FTX_PAYLOAD_LENGTH_BYTES);
+        decoded.message.hash = Get<uint16_t>(record + 26);
+        decoded.text.assign((const char*)record + 32, std::min<size_t>(record[15], PACKED_TEXT_MAX));
+
+        messages->push_back(decoded);
+        record += PACKED_MESSAGE_SIZE;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef MESSAGE_PACK_H
+#define MESSAGE_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "decoder_core.h"
+
+/**
+ * Decoded messages packed into one flat buffer
+ *
+ * A worker thread can transfer the buffer to another thread instead of
+ * having an array of objects structured-cloned. A 16-byte header is followed
+ * by one fixed-size record per message; all numbers are in host byte order,
+ * since the buffer never leaves the process.
+ *
+ * Header:  0 "FTXM"  4 u16 version  6 u16 record size  8 u32 count  12 reserved
+ * Record:  0 f32 frequency  4 f32 time offset  8 f32 SNR  12 i16 score
+ *         14 u8 message type  15 u8 text length  16 u8[10] payload
+ *         26 u16 hash  28 reserved  32 char[48] text, NUL-terminated
+ */
+
+const uint16_t PACKED_MESSAGES_VERSION = 1;
+const size_t PACKED_MESSAGES_HEADER_SIZE = 16;
+const size_t PACKED_MESSAGE_SIZE = 80;
+
+/**
+ * Size in bytes of a buffer holding count messages
+ */
+size_t PackedMessagesSize(size_t count);
+
+/**
+ * Pack decoded messages
+ * @param messages Messages to pack
+ * @param out Receives PackedMessagesSize(messages.size()) bytes
+ */
+void PackMessages(const std::vector<DecodeResult>& messages, uint8_t* out);
+
+/**
+ * Unpack a buffer written by PackMessages
+ *
+ * Fields that are not part of the record (candidate, LDPC status) are left
+ * zero, apart from the candidate score.
+ *
+ * @param data Buffer bytes
+ * @param size Number of bytes available
+ * @param messages Receives the messages
+ * @param error Receives a description of the problem on failure
+ * @return true on success
+ */
+bool UnpackMessages(const uint8_t* data, size_t size, std::vector<DecodeResult>* messages, std::string* error);
+
+#endif // MESSAGE_PACK_H
@@ -1,12 +1,46 @@
 #include "message_wrapper.h"
+#include "parallel.h"
+#include "trace.h"
+#include <algorithm>
 #include <string>
 #include <cstring>
+#include <vector>
 
 extern "C" {
 #include <ft8/message.h>
 #include <ft8/crc.h>
 }
 
+namespace {
+
+// Messages analyzed per JS round trip of analyzeBatch, which bounds its scratch memory
+const size_t ANALYZE_BATCH_CHUNK = 65536;
+
+// Minimum messages handed to one thread by analyzeBatch; smaller batches run inline
+const size_t ANALYZE_MIN_PER_THREAD = 2048;
+
+} // namespace
+
+void MessageWrapper::Analyze(const char* text, MessageAnalysis* analysis) {
+    ftx_message_init(&analysis->message);
+    analysis->rc = ftx_message_encode(&analysis->message, nullptr, text);
+    analysis->type = FTX_MESSAGE_TYPE_UNKNOWN;
+    analysis->standard = false;
+    if (analysis->rc != FTX_MESSAGE_RC_OK) {
+        return;
+    }
+    
+    analysis->type = ftx_message_get_type(&analysis->message);
+    if (analysis->type == FTX_MESSAGE_TYPE_STANDARD) {
+        // Decode back to get components
+        memset(analysis->call_to, 0, sizeof(analysis->call_to));
+        memset(analysis->call_de, 0, sizeof(analysis->call_de));
+        memset(analysis->extra, 0, sizeof(analysis->extra));
+        analysis->standard = ftx_message_decode_std(&analysis->message, nullptr, analysis->call_to,
+                                                    analysis->call_de, analysis->extra) == FTX_MESSAGE_RC_OK;
+    }
+}
+
 const char* MessageWrapper::MessageTypeToString(ftx_message_type_t type) {
     switch (type) {
         case FTX_MESSAGE_TYPE_FREE_TEXT: return "FREE_TEXT";
@@ -52,13 +86,12 @@ Napi::Function MessageWrapper::IsValidMessage(Napi::Env env) {
             return env.Null();
         }
         
-        // Try to encode the message to check if it's valid
-        ftx_message_t msg;
-        ftx_message_init(&msg);
+        // FT8 and FT4 carry the same 77-bit payloads, so a message that
+        // encodes is valid for both
+        MessageAnalysis analysis;
+        Analyze(message.c_str(), &analysis);
         
-        ftx_message_rc_t rc = ftx_message_encode(&msg, nullptr, message.c_str());
-        
-        return Napi::Boolean::New(env, rc == FTX_MESSAGE_RC_OK);
+        return Napi::Boolean::New(env, analysis.rc == FTX_MESSAGE_RC_OK);
     });
 }
 
@@ -73,18 +106,11 @@ Napi::Function MessageWrapper::GetMessageType(Napi::Env env) {
         
         std::string message = info[0].As<Napi::String>().Utf8Value();
         
-        // Encode the message to determine its type
-        ftx_message_t msg;
-        ftx_message_init(&msg);
-        
-        ftx_message_rc_t rc = ftx_message_encode(&msg, nullptr, message.c_str());
+        // Encode the message to determine its type; UNKNOWN if it does not encode
+        MessageAnalysis analysis;
+        Analyze(message.c_str(), &analysis);
         
-        if (rc != FTX_MESSAGE_RC_OK) {
-            return Napi::String::New(env, "UNKNOWN");
-        }
-        
-        ftx_message_type_t type = ftx_message_get_type(&msg);
-        return Napi::String::New(env, MessageTypeToString(type));
+        return Napi::String::New(env, MessageTypeToString(analysis.type));
     });
 }
 
@@ -100,36 +126,154 @@ Napi::Function MessageWrapper::ParseStandardMessage(Napi::Env env) {
         std::string message = info[0].As<Napi::String>().Utf8Value();
         
         // Try to parse as standard message
-        ftx_message_t msg;
-        ftx_message_init(&msg);
-        
-        ftx_message_rc_t rc = ftx_message_encode(&msg, nullptr, message.c_str());
+        MessageAnalysis analysis;
+        Analyze(message.c_str(), &analysis);
         
-        if (rc != FTX_MESSAGE_RC_OK) {
+        if (!analysis.standard) {
             return env.Null();
         }
+        return CreateStandardObject(env, analysis);
+    });
+}
+
+Napi::Object MessageWrapper::CreateStandardObject(Napi::Env env, const MessageAnalysis& analysis) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("callTo", Napi::String::New(env, analysis.call_to));
+    result.Set("callDe", Napi::String::New(env, analysis.call_de));
+    result.Set("extra", Napi::String::New(env, analysis.extra));
+    return result;
+}
+
+Napi::Function MessageWrapper::AnalyzeMessage(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
         
-        // Check if it's a standard message type
-        ftx_message_type_t type = ftx_message_get_type(&msg);
-        if (type != FTX_MESSAGE_TYPE_STANDARD) {
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected message string").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        // Decode back to get components
-        char call_to[32] = {0};
-        char call_de[32] = {0};
-        char extra[32] = {0};
+        std::string message = info[0].As<Napi::String>().Utf8Value();
         
-        rc = ftx_message_decode_std(&msg, nullptr, call_to, call_de, extra);
+        MessageAnalysis analysis;
+        Analyze(message.c_str(), &analysis);
+        bool valid = analysis.rc == FTX_MESSAGE_RC_OK;
         
-        if (rc != FTX_MESSAGE_RC_OK) {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("valid", Napi::Boolean::New(env, valid));
+        result.Set("status", Napi::Number::New(env, analysis.rc));
+        result.Set("error", valid ? env.Null() : Napi::String::New(env, MessageRcToString(analysis.rc)));
+        result.Set("type", Napi::String::New(env, MessageTypeToString(analysis.type)));
+        if (valid) {
+            Napi::Uint8Array payload = Napi::Uint8Array::New(env, FTX_PAYLOAD_LENGTH_BYTES);
+            memcpy(payload.Data(), analysis.message.payload, FTX_PAYLOAD_LENGTH_BYTES);
+            result.Set("payload", payload);
+        } else {
+            result.Set("payload", env.Null());
+        }
+        result.Set("standard", analysis.standard ? CreateStandardObject(env, analysis) : env.Null());
+        
+        return result;
+    });
+}
+
+Napi::Function MessageWrapper::AnalyzeBatch(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        TraceScope trace("analyzeBatch", "message");
+        
+        if (info.Length() < 1 || !info[0].IsArray()) {
+            Napi::TypeError::New(env, "Expected array of message strings").ThrowAsJavaScriptException();
             return env.Null();
         }
         
+        Napi::Array messages = info[0].As<Napi::Array>();
+        size_t count = messages.Length();
+        
+        // Structure-of-arrays output; the fixed-size columns are written in
+        // place by the worker threads
+        Napi::Uint8Array valid = Napi::Uint8Array::New(env, count);
+        Napi::Uint8Array status = Napi::Uint8Array::New(env, count);
+        Napi::Uint8Array types = Napi::Uint8Array::New(env, count);
+        Napi::Uint8Array payloads = Napi::Uint8Array::New(env, count * FTX_PAYLOAD_LENGTH_BYTES);
+        Napi::Array call_to = Napi::Array::New(env, count);
+        Napi::Array call_de = Napi::Array::New(env, count);
+        Napi::Array extra = Napi::Array::New(env, count);
+        
+        uint8_t* valid_data = valid.Data();
+        uint8_t* status_data = status.Data();
+        uint8_t* type_data = types.Data();
+        uint8_t* payload_data = payloads.Data();
+        
+        // Strings are read and written on the JS thread, so the batch goes
+        // through in chunks that the threads analyze in between
+        std::vector<std::string> texts;
+        std::vector<MessageAnalysis> analyses;
+        for (size_t first = 0; first < count; first += ANALYZE_BATCH_CHUNK) {
+            size_t chunk = std::min(ANALYZE_BATCH_CHUNK, count - first);
+            texts.resize(chunk);
+            analyses.resize(chunk);
+            
+            for (size_t i = 0; i < chunk; ++i) {
+                Napi::Value value = messages.Get(static_cast<uint32_t>(first + i));
+                if (!value.IsString()) {
+                    Napi::TypeError::New(env, "Expected array of message strings").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                texts[i] = value.As<Napi::String>().Utf8Value();
+            }
+            
+            ParallelFor(chunk, ANALYZE_MIN_PER_THREAD, [&](size_t begin, size_t end) {
+                TraceScope trace("analyzeBatchChunk", "message");
+                trace.SetArg("messages", (double)(end - begin));
+                for (size_t i = begin; i < end; ++i) {
+                    MessageAnalysis& analysis = analyses[i];
+                    Analyze(texts[i].c_str(), &analysis);
+                    
+                    size_t index = first + i;
+                    valid_data[index] = analysis.rc == FTX_MESSAGE_RC_OK;
+                    status_data[index] = static_cast<uint8_t>(analysis.rc);
+                    type_data[index] = static_cast<uint8_t>(analysis.type);
+                    uint8_t* payload = payload_data + index * FTX_PAYLOAD_LENGTH_BYTES;
+                    if (analysis.rc == FTX_MESSAGE_RC_OK) {
+                        memcpy(payload, analysis.message.payload, FTX_PAYLOAD_LENGTH_BYTES);
+                    } else {
+                        memset(payload, 0, FTX_PAYLOAD_LENGTH_BYTES);
+                    }
+                }
+            });
+            
+            for (size_t i = 0; i < chunk; ++i) {
+                const MessageAnalysis& analysis = analyses[i];
+                uint32_t index = static_cast<uint32_t>(first + i);
+                if (analysis.standard) {
+                    call_to.Set(index, Napi::String::New(env, analysis.call_to));
+                    call_de.Set(index, Napi::String::New(env, analysis.call_de));
+                    extra.Set(index, Napi::String::New(env, analysis.extra));
+                } else {
+                    call_to.Set(index, env.Null());
+                    call_de.Set(index, env.Null());
+                    extra.Set(index, env.Null());
+                }
+            }
+        }
+        
+        // Names of the type codes, in MessageType order
+        Napi::Array type_names = Napi::Array::New(env, FTX_MESSAGE_TYPE_UNKNOWN + 1);
+        for (int type = 0; type <= FTX_MESSAGE_TYPE_UNKNOWN; ++type) {
+            type_names.Set(type, Napi::String::New(env, MessageTypeToString(static_cast<ftx_message_type_t>(type))));
+        }
+        
         Napi::Object result = Napi::Object::New(env);
-        result.Set("callTo", Napi::String::New(env, call_to));
-        result.Set("callDe", Napi::String::New(env, call_de));
-        result.Set("extra", Napi::String::New(env, extra));
+        result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+        result.Set("valid", valid);
+        result.Set("status", status);
+        result.Set("types", types);
+        result.Set("typeNames", type_names);
+        result.Set("payloads", payloads);
+        result.Set("callTo", call_to);
+        result.Set("callDe", call_de);
+        result.Set("extra", extra);
         
         return result;
     });
@@ -37,6 +37,20 @@ public:
      */
     static Napi::Function ParseStandardMessage(Napi::Env env);
     
+    /**
+     * Validity, return code, type, payload and standard fields of a message from one encode
+     * @param env N-API environment
+     * @return N-API function that analyzes a message
+     */
+    static Napi::Function AnalyzeMessage(Napi::Env env);
+    
+    /**
+     * Analyze an array of messages on a thread pool, with columnar results
+     * @param env N-API environment
+     * @return N-API function that analyzes messages
+     */
+    static Napi::Function AnalyzeBatch(Napi::Env env);
+    
     /**
      * Calculate CRC-14 checksum
      * @param env N-API environment
@@ -52,6 +66,35 @@ public:
     static Napi::Function VerifyCrc14(Napi::Env env);
 
 private:
+    /**
+     * Everything known about a message text after encoding it once
+     */
+    struct MessageAnalysis {
+        ftx_message_rc_t rc;
+        ftx_message_type_t type;
+        ftx_message_t message;
+        // Whether the message is standard; the fields below are only set then
+        bool standard;
+        char call_to[32];
+        char call_de[32];
+        char extra[32];
+    };
+    
+    /**
+     * Encode a message text and derive its type and standard fields
+     * @param text Message text
+     * @param analysis Receives the results; UNKNOWN type if the text does not encode
+     */
+    static void Analyze(const char* text, MessageAnalysis* analysis);
+    
+    /**
+     * Create the callTo/callDe/extra object of a standard message
+     * @param env N-API environment
+     * @param analysis Analysis of a standard message
+     * @return JavaScript object with the fields
+     */
+    static Napi::Object CreateStandardObject(Napi::Env env, const MessageAnalysis& analysis);
+    
     /**
      * Convert ftx_message_type_t enum to string
      * @param type The message type enum value
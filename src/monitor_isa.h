@@ -0,0 +1,44 @@
+#ifndef MONITOR_ISA_H
+#define MONITOR_ISA_H
+
+/*
+ * Renames the entry points of ft8_lib's monitor and FFT for a build of those
+ * sources for one instruction set
+ *
+ * The monitor_isa_*.c files include the ft8_lib sources after this header and
+ * are compiled once per variant with FT8_ISA_SUFFIX set, e.g. to _avx2, and
+ * the matching -m flags. Every function the sources define gets the suffix,
+ * so the variants link next to the baseline build; monitor_kernels.cpp picks
+ * one at run time.
+ */
+
+#ifndef FT8_ISA_SUFFIX
+#error "FT8_ISA_SUFFIX must name the instruction set variant, e.g. -DFT8_ISA_SUFFIX=_avx2"
+#endif
+
+#define FT8_ISA_PASTE2(name, suffix) name##suffix
+#define FT8_ISA_PASTE(name, suffix) FT8_ISA_PASTE2(name, suffix)
+#define FT8_ISA_SYMBOL(name) FT8_ISA_PASTE(name, FT8_ISA_SUFFIX)
+
+// common/monitor.c
+#define monitor_init FT8_ISA_SYMBOL(monitor_init)
+#define monitor_free FT8_ISA_SYMBOL(monitor_free)
+#define monitor_reset FT8_ISA_SYMBOL(monitor_reset)
+#define monitor_process FT8_ISA_SYMBOL(monitor_process)
+#define monitor_resynth FT8_ISA_SYMBOL(monitor_resynth)
+#define waterfall_init FT8_ISA_SYMBOL(waterfall_init)
+#define waterfall_free FT8_ISA_SYMBOL(waterfall_free)
+
+// fft/kiss_fft.c
+#define kiss_fft_alloc FT8_ISA_SYMBOL(kiss_fft_alloc)
+#define kiss_fft FT8_ISA_SYMBOL(kiss_fft)
+#define kiss_fft_stride FT8_ISA_SYMBOL(kiss_fft_stride)
+#define kiss_fft_cleanup FT8_ISA_SYMBOL(kiss_fft_cleanup)
+#define kiss_fft_next_fast_size FT8_ISA_SYMBOL(kiss_fft_next_fast_size)
+
+// fft/kiss_fftr.c
+#define kiss_fftr_alloc FT8_ISA_SYMBOL(kiss_fftr_alloc)
+#define kiss_fftr FT8_ISA_SYMBOL(kiss_fftr)
+#define kiss_fftri FT8_ISA_SYMBOL(kiss_fftri)
+
+#endif // MONITOR_ISA_H
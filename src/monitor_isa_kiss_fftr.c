@@ -0,0 +1,3 @@
+/* ft8_lib's fft/kiss_fftr.c for one instruction set variant; see monitor_isa.h */
+#include "monitor_isa.h"
+#include "fft/kiss_fftr.c"
@@ -0,0 +1,3 @@
+/* ft8_lib's common/monitor.c for one instruction set variant; see monitor_isa.h */
+#include "monitor_isa.h"
+#include "common/monitor.c"
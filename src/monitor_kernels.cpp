@@ -0,0 +1,54 @@
+#include "monitor_kernels.h"
+
+extern "C" {
+#ifdef FT8_LIB_MONITOR_VARIANTS
+void monitor_init_avx2(monitor_t* me, const monitor_config_t* cfg);
+void monitor_reset_avx2(monitor_t* me);
+void monitor_process_avx2(monitor_t* me, const float* frame);
+void monitor_free_avx2(monitor_t* me);
+
+void monitor_init_avx512(monitor_t* me, const monitor_config_t* cfg);
+void monitor_reset_avx512(monitor_t* me);
+void monitor_process_avx512(monitor_t* me, const float* frame);
+void monitor_free_avx512(monitor_t* me);
+#endif
+}
+
+namespace {
+
+KernelIsa SelectMonitorIsa() {
+    KernelIsa isa = ActiveKernelIsa();
+#ifdef FT8_LIB_MONITOR_VARIANTS
+    return isa;
+#else
+    // Only the baseline build is linked; on arm64 that includes NEON
+    return (isa == KERNEL_ISA_NEON) ? KERNEL_ISA_NEON : KERNEL_ISA_BASELINE;
+#endif
+}
+
+MonitorKernels SelectMonitorKernels() {
+#ifdef FT8_LIB_MONITOR_VARIANTS
+    switch (ActiveMonitorIsa()) {
+        case KERNEL_ISA_AVX512:
+            return MonitorKernels{monitor_init_avx512, monitor_reset_avx512, monitor_process_avx512,
+                                  monitor_free_avx512};
+        case KERNEL_ISA_AVX2:
+            return MonitorKernels{monitor_init_avx2, monitor_reset_avx2, monitor_process_avx2, monitor_free_avx2};
+        default:
+            break;
+    }
+#endif
+    return MonitorKernels{monitor_init, monitor_reset, monitor_process, monitor_free};
+}
+
+} // namespace
+
+const MonitorKernels& ActiveMonitorKernels() {
+    static const MonitorKernels kernels = SelectMonitorKernels();
+    return kernels;
+}
+
+KernelIsa ActiveMonitorIsa() {
+    static const KernelIsa isa = SelectMonitorIsa();
+    return isa;
+}
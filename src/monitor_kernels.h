@@ -0,0 +1,35 @@
+#ifndef MONITOR_KERNELS_H
+#define MONITOR_KERNELS_H
+
+#include "cpu_features.h"
+
+extern "C" {
+#include <common/monitor.h>
+}
+
+/**
+ * ft8_lib's monitor, including its FFT, compiled for one instruction set
+ *
+ * The monitor's windowing and FFT take most of the CPU time of a decode. On
+ * x64 with GCC or Clang the ft8_lib sources are also built for AVX2 and
+ * AVX-512 (see monitor_isa.h); elsewhere only the baseline build exists. A
+ * monitor must be reset, processed and freed by the variant that set it up.
+ */
+struct MonitorKernels {
+    void (*init)(monitor_t* me, const monitor_config_t* cfg);
+    void (*reset)(monitor_t* me);
+    void (*process)(monitor_t* me, const float* frame);
+    void (*free)(monitor_t* me);
+};
+
+/**
+ * Monitor variant matching ActiveKernelIsa(), selected on first use
+ */
+const MonitorKernels& ActiveMonitorKernels();
+
+/**
+ * Instruction set of the monitor variant in use
+ */
+KernelIsa ActiveMonitorIsa();
+
+#endif // MONITOR_KERNELS_H
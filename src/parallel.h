@@ -0,0 +1,69 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * Number of worker threads to use for a parallel job
+ * @param requested Requested thread count (0 = hardware concurrency)
+ * @return Thread count, at least 1
+ */
+inline unsigned ResolveThreadCount(unsigned requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+/**
+ * Split the index range [0, count) into contiguous chunks and process them in parallel
+ *
+ * The calling thread processes the last chunk itself. Jobs that are too small to
+ * give every thread at least min_per_thread items use fewer threads, and run
+ * inline when only one thread would be used.
+ *
+ * @param count Number of items to process
+ * @param min_per_thread Minimum number of items handed to a single thread
+ * @param fn Callable invoked as fn(begin, end) for each chunk
+ * @param max_threads Upper bound on the number of threads (0 = hardware concurrency)
+ */
+template <typename Fn>
+void ParallelFor(size_t count, size_t min_per_thread, Fn&& fn, unsigned max_threads = 0) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t num_threads = ResolveThreadCount(max_threads);
+    size_t by_size = count / std::max<size_t>(min_per_thread, 1);
+    num_threads = std::max<size_t>(1, std::min(num_threads, by_size));
+
+    if (num_threads == 1) {
+        fn(size_t(0), count);
+        return;
+    }
+
+    size_t chunk = (count + num_threads - 1) / num_threads;
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+
+    size_t begin = 0;
+    for (size_t t = 0; t + 1 < num_threads && begin < count; ++t) {
+        size_t end = std::min(count, begin + chunk);
+        workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+        begin = end;
+    }
+
+    if (begin < count) {
+        fn(begin, count);
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,382 @@
+#include "pcm_convert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// SIMD kernels assume a little-endian host; anything else takes the scalar path
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define PCM_HAVE_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define PCM_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#define PCM_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const float PCM16_TO_FLOAT = 1.0f / 32768.0f;
+const float PCM16_STEREO_TO_FLOAT = 1.0f / 65536.0f;
+const float FLOAT_TO_PCM16 = 32767.0f;
+
+/**
+ * Bulk kernels convert a prefix of the input and return how many frames they
+ * handled; the scalar code below finishes the tail.
+ */
+typedef size_t (*ToFloatKernel)(const uint8_t* in, size_t num_frames, int channels, bool swap, float* out);
+typedef size_t (*ToPcmKernel)(const float* in, size_t num_samples, bool swap, const float* dither, uint8_t* out);
+
+struct PcmKernelSet {
+    const char* name;
+    ToFloatKernel to_float;
+    ToPcmKernel to_pcm;
+};
+
+inline int16_t LoadPcm16(const uint8_t* p, PcmByteOrder order) {
+    return (order == PCM_LITTLE_ENDIAN) ? (int16_t)(p[0] | (p[1] << 8)) : (int16_t)(p[1] | (p[0] << 8));
+}
+
+inline void StorePcm16(uint8_t* p, int16_t value, PcmByteOrder order) {
+    uint16_t v = (uint16_t)value;
+    if (order == PCM_LITTLE_ENDIAN) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+    } else {
+        p[0] = (uint8_t)(v >> 8);
+        p[1] = (uint8_t)v;
+    }
+}
+
+#if !defined(PCM_HAVE_SSE2) && !defined(PCM_HAVE_NEON)
+size_t ToFloatScalar(const uint8_t*, size_t, int, bool, float*) {
+    return 0;
+}
+
+size_t ToPcmScalar(const float*, size_t, bool, const float*, uint8_t*) {
+    return 0;
+}
+#endif
+
+#ifdef PCM_HAVE_SSE2
+
+inline __m128i ByteSwap16Sse2(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+template <bool Swap, bool Stereo>
+size_t ToFloatSse2Impl(const uint8_t* in, size_t num_frames, float* out) {
+    const __m128 scale = _mm_set1_ps(Stereo ? PCM16_STEREO_TO_FLOAT : PCM16_TO_FLOAT);
+    const __m128i ones = _mm_set1_epi16(1);
+    size_t i = 0;
+
+    for (; i + 8 <= num_frames; i += 8) {
+        if (Stereo) {
+            const uint8_t* p = in + i * 4;
+            __m128i a = _mm_loadu_si128((const __m128i*)p);
+            __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+            if (Swap) {
+                a = ByteSwap16Sse2(a);
+                b = ByteSwap16Sse2(b);
+            }
+            // madd against ones sums each left/right pair into one 32-bit lane
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_madd_epi16(a, ones)), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_madd_epi16(b, ones)), scale));
+        } else {
+            __m128i x = _mm_loadu_si128((const __m128i*)(in + i * 2));
+            if (Swap) {
+                x = ByteSwap16Sse2(x);
+            }
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    }
+
+    return i;
+}
+
+template <bool Swap, bool Dither>
+size_t ToPcmSse2Impl(const float* in, size_t num_samples, const float* dither, uint8_t* out) {
+    const __m128 lo_limit = _mm_set1_ps(-1.0f);
+    const __m128 hi_limit = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(FLOAT_TO_PCM16);
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo_limit), hi_limit), scale);
+        __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo_limit), hi_limit), scale);
+        if (Dither) {
+            a = _mm_add_ps(a, _mm_loadu_ps(dither + i));
+            b = _mm_add_ps(b, _mm_loadu_ps(dither + i + 4));
+        }
+        // packs saturates whatever the dither pushed past full scale
+        __m128i x = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        if (Swap) {
+            x = ByteSwap16Sse2(x);
+        }
+        _mm_storeu_si128((__m128i*)(out + i * 2), x);
+    }
+
+    return i;
+}
+
+size_t ToFloatSse2(const uint8_t* in, size_t num_frames, int channels, bool swap, float* out) {
+    if (channels == 2) {
+        return swap ? ToFloatSse2Impl<true, true>(in, num_frames, out) : ToFloatSse2Impl<false, true>(in, num_frames, out);
+    }
+    return swap ? ToFloatSse2Impl<true, false>(in, num_frames, out) : ToFloatSse2Impl<false, false>(in, num_frames, out);
+}
+
+size_t ToPcmSse2(const float* in, size_t num_samples, bool swap, const float* dither, uint8_t* out) {
+    if (dither) {
+        return swap ? ToPcmSse2Impl<true, true>(in, num_samples, dither, out) : ToPcmSse2Impl<false, true>(in, num_samples, dither, out);
+    }
+    return swap ? ToPcmSse2Impl<true, false>(in, num_samples, dither, out) : ToPcmSse2Impl<false, false>(in, num_samples, dither, out);
+}
+
+#endif // PCM_HAVE_SSE2
+
+#ifdef PCM_HAVE_AVX2
+
+__attribute__((target("avx2")))
+inline __m256i ByteSwap16Avx2(__m256i x) {
+    return _mm256_or_si256(_mm256_slli_epi16(x, 8), _mm256_srli_epi16(x, 8));
+}
+
+template <bool Swap, bool Stereo>
+__attribute__((target("avx2")))
+size_t ToFloatAvx2Impl(const uint8_t* in, size_t num_frames, float* out) {
+    const __m256 scale = _mm256_set1_ps(Stereo ? PCM16_STEREO_TO_FLOAT : PCM16_TO_FLOAT);
+    const __m256i ones = _mm256_set1_epi16(1);
+    size_t i = 0;
+
+    for (; i + 16 <= num_frames; i += 16) {
+        if (Stereo) {
+            const uint8_t* p = in + i * 4;
+            __m256i a = _mm256_loadu_si256((const __m256i*)p);
+            __m256i b = _mm256_loadu_si256((const __m256i*)(p + 32));
+            if (Swap) {
+                a = ByteSwap16Avx2(a);
+                b = ByteSwap16Avx2(b);
+            }
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(a, ones)), scale));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(b, ones)), scale));
+        } else {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(in + i * 2));
+            if (Swap) {
+                x = ByteSwap16Avx2(x);
+            }
+            __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x));
+            __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+        }
+    }
+
+    return i;
+}
+
+template <bool Swap, bool Dither>
+__attribute__((target("avx2")))
+size_t ToPcmAvx2Impl(const float* in, size_t num_samples, const float* dither, uint8_t* out) {
+    const __m256 lo_limit = _mm256_set1_ps(-1.0f);
+    const __m256 hi_limit = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(FLOAT_TO_PCM16);
+    size_t i = 0;
+
+    for (; i + 16 <= num_samples; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), lo_limit), hi_limit), scale);
+        __m256 b = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 8), lo_limit), hi_limit), scale);
+        if (Dither) {
+            a = _mm256_add_ps(a, _mm256_loadu_ps(dither + i));
+            b = _mm256_add_ps(b, _mm256_loadu_ps(dither + i + 8));
+        }
+        // packs works within 128-bit lanes; the permute restores sample order
+        __m256i x = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        x = _mm256_permute4x64_epi64(x, 0xD8);
+        if (Swap) {
+            x = ByteSwap16Avx2(x);
+        }
+        _mm256_storeu_si256((__m256i*)(out + i * 2), x);
+    }
+
+    return i;
+}
+
+size_t ToFloatAvx2(const uint8_t* in, size_t num_frames, int channels, bool swap, float* out) {
+    if (channels == 2) {
+        return swap ? ToFloatAvx2Impl<true, true>(in, num_frames, out) : ToFloatAvx2Impl<false, true>(in, num_frames, out);
+    }
+    return swap ? ToFloatAvx2Impl<true, false>(in, num_frames, out) : ToFloatAvx2Impl<false, false>(in, num_frames, out);
+}
+
+size_t ToPcmAvx2(const float* in, size_t num_samples, bool swap, const float* dither, uint8_t* out) {
+    if (dither) {
+        return swap ? ToPcmAvx2Impl<true, true>(in, num_samples, dither, out) : ToPcmAvx2Impl<false, true>(in, num_samples, dither, out);
+    }
+    return swap ? ToPcmAvx2Impl<true, false>(in, num_samples, dither, out) : ToPcmAvx2Impl<false, false>(in, num_samples, dither, out);
+}
+
+#endif // PCM_HAVE_AVX2
+
+#ifdef PCM_HAVE_NEON
+
+template <bool Swap, bool Stereo>
+size_t ToFloatNeonImpl(const uint8_t* in, size_t num_frames, float* out) {
+    const float scale = Stereo ? PCM16_STEREO_TO_FLOAT : PCM16_TO_FLOAT;
+    size_t i = 0;
+
+    for (; i + 8 <= num_frames; i += 8) {
+        if (Stereo) {
+            const uint8_t* p = in + i * 4;
+            uint8x16_t a = vld1q_u8(p);
+            uint8x16_t b = vld1q_u8(p + 16);
+            if (Swap) {
+                a = vrev16q_u8(a);
+                b = vrev16q_u8(b);
+            }
+            // Pairwise widening add sums each left/right pair
+            int32x4_t sa = vpaddlq_s16(vreinterpretq_s16_u8(a));
+            int32x4_t sb = vpaddlq_s16(vreinterpretq_s16_u8(b));
+            vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(sa), scale));
+            vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(sb), scale));
+        } else {
+            uint8x16_t raw = vld1q_u8(in + i * 2);
+            if (Swap) {
+                raw = vrev16q_u8(raw);
+            }
+            int16x8_t x = vreinterpretq_s16_u8(raw);
+            vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+            vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(x)), scale));
+        }
+    }
+
+    return i;
+}
+
+template <bool Swap, bool Dither>
+size_t ToPcmNeonImpl(const float* in, size_t num_samples, const float* dither, uint8_t* out) {
+    const float32x4_t lo_limit = vdupq_n_f32(-1.0f);
+    const float32x4_t hi_limit = vdupq_n_f32(1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= num_samples; i += 8) {
+        float32x4_t a = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(in + i), lo_limit), hi_limit), FLOAT_TO_PCM16);
+        float32x4_t b = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(in + i + 4), lo_limit), hi_limit), FLOAT_TO_PCM16);
+        if (Dither) {
+            a = vaddq_f32(a, vld1q_f32(dither + i));
+            b = vaddq_f32(b, vld1q_f32(dither + i + 4));
+        }
+        int16x8_t x = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b)));
+        uint8x16_t bytes = vreinterpretq_u8_s16(x);
+        if (Swap) {
+            bytes = vrev16q_u8(bytes);
+        }
+        vst1q_u8(out + i * 2, bytes);
+    }
+
+    return i;
+}
+
+size_t ToFloatNeon(const uint8_t* in, size_t num_frames, int channels, bool swap, float* out) {
+    if (channels == 2) {
+        return swap ? ToFloatNeonImpl<true, true>(in, num_frames, out) : ToFloatNeonImpl<false, true>(in, num_frames, out);
+    }
+    return swap ? ToFloatNeonImpl<true, false>(in, num_frames, out) : ToFloatNeonImpl<false, false>(in, num_frames, out);
+}
+
+size_t ToPcmNeon(const float* in, size_t num_samples, bool swap, const float* dither, uint8_t* out) {
+    if (dither) {
+        return swap ? ToPcmNeonImpl<true, true>(in, num_samples, dither, out) : ToPcmNeonImpl<false, true>(in, num_samples, dither, out);
+    }
+    return swap ? ToPcmNeonImpl<true, false>(in, num_samples, dither, out) : ToPcmNeonImpl<false, false>(in, num_samples, dither, out);
+}
+
+#endif // PCM_HAVE_NEON
+
+PcmKernelSet SelectKernels() {
+#ifdef PCM_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return PcmKernelSet{"avx2", ToFloatAvx2, ToPcmAvx2};
+    }
+#endif
+#ifdef PCM_HAVE_SSE2
+    return PcmKernelSet{"sse2", ToFloatSse2, ToPcmSse2};
+#elif defined(PCM_HAVE_NEON)
+    return PcmKernelSet{"neon", ToFloatNeon, ToPcmNeon};
+#else
+    return PcmKernelSet{"scalar", ToFloatScalar, ToPcmScalar};
+#endif
+}
+
+const PcmKernelSet& ActiveKernels() {
+    static const PcmKernelSet kernels = SelectKernels();
+    return kernels;
+}
+
+} // namespace
+
+PcmByteOrder PcmNativeByteOrder() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    memcpy(&first, &probe, 1);
+    return first ? PCM_LITTLE_ENDIAN : PCM_BIG_ENDIAN;
+}
+
+void ConvertPcm16ToFloat(const void* in, size_t num_frames, int channels, PcmByteOrder order, float* out) {
+    const uint8_t* bytes = (const uint8_t*)in;
+    size_t i = ActiveKernels().to_float(bytes, num_frames, channels, order == PCM_BIG_ENDIAN, out);
+
+    if (channels == 2) {
+        for (; i < num_frames; ++i) {
+            int sum = LoadPcm16(bytes + i * 4, order) + LoadPcm16(bytes + i * 4 + 2, order);
+            out[i] = sum * PCM16_STEREO_TO_FLOAT;
+        }
+    } else {
+        for (; i < num_frames; ++i) {
+            out[i] = LoadPcm16(bytes + i * 2, order) * PCM16_TO_FLOAT;
+        }
+    }
+}
+
+void ConvertFloatToPcm16(const float* in, size_t num_samples, PcmByteOrder order, const float* dither, void* out) {
+    uint8_t* bytes = (uint8_t*)out;
+    size_t i = ActiveKernels().to_pcm(in, num_samples, order == PCM_BIG_ENDIAN, dither, bytes);
+
+    for (; i < num_samples; ++i) {
+        float x = std::max(-1.0f, std::min(1.0f, in[i])) * FLOAT_TO_PCM16;
+        if (dither) {
+            x += dither[i];
+        }
+        long value = std::lrint(x);
+        value = std::max(-32768L, std::min(32767L, value));
+        StorePcm16(bytes + i * 2, (int16_t)value, order);
+    }
+}
+
+void FillTpdfDither(uint32_t* state, float* out, size_t count, float amplitude) {
+    const float unit = 1.0f / 16777216.0f;
+    uint32_t x = *state;
+
+    for (size_t i = 0; i < count; ++i) {
+        // xorshift32; two uniform draws give a triangular distribution
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        float u1 = (x >> 8) * unit;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        float u2 = (x >> 8) * unit;
+        out[i] = (u1 - u2) * amplitude;
+    }
+
+    *state = x;
+}
+
+const char* PcmKernelName() {
+    return ActiveKernels().name;
+}
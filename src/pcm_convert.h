@@ -0,0 +1,59 @@
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Byte order of 16-bit PCM data in memory
+ */
+enum PcmByteOrder {
+    PCM_LITTLE_ENDIAN,
+    PCM_BIG_ENDIAN
+};
+
+/**
+ * Byte order of the host
+ */
+PcmByteOrder PcmNativeByteOrder();
+
+/**
+ * Convert 16-bit PCM to float samples in [-1.0, 1.0)
+ *
+ * The input does not need to be 2-byte aligned, so Node.js Buffers at any
+ * offset can be passed directly. Interleaved stereo is averaged to mono.
+ *
+ * @param in PCM data, num_frames * channels samples
+ * @param num_frames Number of frames to convert
+ * @param channels 1 for mono, 2 for interleaved stereo
+ * @param order Byte order of the input
+ * @param out Output buffer for num_frames mono samples
+ */
+void ConvertPcm16ToFloat(const void* in, size_t num_frames, int channels, PcmByteOrder order, float* out);
+
+/**
+ * Convert float samples to 16-bit PCM, clipping to [-1.0, 1.0] and rounding to nearest
+ * @param in Float samples
+ * @param num_samples Number of samples
+ * @param order Byte order of the output
+ * @param dither Optional per-sample offsets in LSB added before rounding (nullptr for none)
+ * @param out Output buffer for num_samples 16-bit samples, need not be aligned
+ */
+void ConvertFloatToPcm16(const float* in, size_t num_samples, PcmByteOrder order, const float* dither, void* out);
+
+/**
+ * Fill a buffer with triangular (TPDF) dither
+ * @param state Generator state, updated in place; must not be 0
+ * @param out Output buffer
+ * @param count Number of values
+ * @param amplitude Peak dither in LSB
+ */
+void FillTpdfDither(uint32_t* state, float* out, size_t count, float amplitude);
+
+/**
+ * Name of the instruction set the conversion kernels use on this CPU
+ * @return "avx2", "sse2", "neon" or "scalar"
+ */
+const char* PcmKernelName();
+
+#endif // PCM_CONVERT_H
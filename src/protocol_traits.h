@@ -0,0 +1,84 @@
+#ifndef PROTOCOL_TRAITS_H
+#define PROTOCOL_TRAITS_H
+
+#include <cstdint>
+
+extern "C" {
+#include <ft8/constants.h>
+}
+
+/**
+ * Compile-time constants of a protocol
+ *
+ * Kernels templated on these see tone counts, symbol counts and sync layout as
+ * constants, so their loops have fixed bounds and scratch arrays a fixed size.
+ */
+template <ftx_protocol_t Protocol>
+struct ProtocolTraits;
+
+template <>
+struct ProtocolTraits<FTX_PROTOCOL_FT8> {
+    static constexpr ftx_protocol_t protocol = FTX_PROTOCOL_FT8;
+    static constexpr int num_tones = 8;
+    static constexpr int bits_per_symbol = 3;
+    static constexpr int num_symbols = FT8_NN;
+    static constexpr int num_data_symbols = FT8_ND;
+    static constexpr int num_sync = FT8_NUM_SYNC;
+    static constexpr int length_sync = FT8_LENGTH_SYNC;
+    static constexpr int sync_offset = FT8_SYNC_OFFSET;
+    // Symbol of the first sync tone
+    static constexpr int first_sync_symbol = 0;
+    // Symbols sent at full power (FT4 ramps its first and last symbol)
+    static constexpr int first_full_symbol = 0;
+    static constexpr int end_full_symbol = FT8_NN;
+    static constexpr float symbol_period = FT8_SYMBOL_PERIOD;
+
+    /**
+     * Channel symbol carrying data symbol k, skipping the three Costas arrays
+     */
+    static constexpr int DataSymbol(int k) { return k + ((k < 29) ? 7 : 14); }
+
+    /**
+     * Tone of sync symbol k of sync block m
+     */
+    static int SyncTone(int, int k) { return kFT8_Costas_pattern[k]; }
+
+    static const uint8_t* GrayMap() { return kFT8_Gray_map; }
+};
+
+template <>
+struct ProtocolTraits<FTX_PROTOCOL_FT4> {
+    static constexpr ftx_protocol_t protocol = FTX_PROTOCOL_FT4;
+    static constexpr int num_tones = 4;
+    static constexpr int bits_per_symbol = 2;
+    static constexpr int num_symbols = FT4_NN;
+    static constexpr int num_data_symbols = FT4_ND;
+    static constexpr int num_sync = FT4_NUM_SYNC;
+    static constexpr int length_sync = FT4_LENGTH_SYNC;
+    static constexpr int sync_offset = FT4_SYNC_OFFSET;
+    static constexpr int first_sync_symbol = 1;
+    static constexpr int first_full_symbol = 1;
+    static constexpr int end_full_symbol = FT4_NN - 1;
+    static constexpr float symbol_period = FT4_SYMBOL_PERIOD;
+
+    /**
+     * Channel symbol carrying data symbol k, skipping the ramp and the four sync blocks
+     */
+    static constexpr int DataSymbol(int k) { return k + ((k < 29) ? 5 : ((k < 58) ? 9 : 13)); }
+
+    static int SyncTone(int m, int k) { return kFT4_Costas_pattern[m][k]; }
+
+    static const uint8_t* GrayMap() { return kFT4_Gray_map; }
+};
+
+/**
+ * Waterfall oversampling fixed at compile time, or read from the waterfall
+ * when a factor is 0
+ */
+template <int TimeOsr, int FreqOsr>
+struct Oversampling {
+    static int Time(int runtime) { return (TimeOsr > 0) ? TimeOsr : runtime; }
+    static int Freq(int runtime) { return (FreqOsr > 0) ? FreqOsr : runtime; }
+};
+
+#endif // PROTOCOL_TRAITS_H
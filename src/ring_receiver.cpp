@@ -0,0 +1,470 @@
+#include "ring_receiver.h"
+#include "decoder_wrapper.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// Indices into the control array
+const int RING_WRITE_INDEX = 0;
+const int RING_READ_INDEX = 1;
+const int RING_FLAGS = 2;
+const int RING_OVERRUNS = 3;
+const int RING_CONTROL_LENGTH = 4;
+
+// Producer flag: no more samples will be written
+const int32_t RING_FLAG_END_OF_STREAM = 1;
+
+// How long the consumer sleeps when the ring is empty
+const int RING_POLL_INTERVAL_MS = 5;
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t) && std::atomic<int32_t>::is_always_lock_free,
+              "Shared control words must be plain lock-free 32-bit integers");
+
+namespace {
+
+/**
+ * Decode results of one slot, handed from the consumer thread to JavaScript
+ */
+struct RingSlotResult {
+    int64_t index;
+    double utc_start;
+    int num_blocks;
+    double decode_ms;
+    std::vector<DecodeResult> messages;
+};
+
+double NowMs() {
+    return (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void CallOnDecode(Napi::Env env, Napi::Function callback, RingSlotResult* slot) {
+    if (env != nullptr && !callback.IsEmpty()) {
+        Napi::Array messages = Napi::Array::New(env, slot->messages.size());
+        for (size_t i = 0; i < slot->messages.size(); ++i) {
+            const DecodeResult& decoded = slot->messages[i];
+            Napi::Object message = MessageDecoder::CreateDecodedMessageObject(env, decoded);
+            message.Set("score", Napi::Number::New(env, decoded.candidate.score));
+            message.Set("utcTime", Napi::Number::New(env, std::round(slot->utc_start + 1000.0 * decoded.time_offset)));
+            messages.Set(i, message);
+        }
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("index", Napi::Number::New(env, (double)slot->index));
+        result.Set("utcStart", Napi::Number::New(env, std::round(slot->utc_start)));
+        result.Set("blocks", Napi::Number::New(env, slot->num_blocks));
+        result.Set("decodeMs", Napi::Number::New(env, slot->decode_ms));
+        result.Set("messages", messages);
+        
+        callback.Call({result});
+    }
+    delete slot;
+}
+
+} // namespace
+
+Napi::Function RingReceiver::Init(Napi::Env env) {
+    Napi::Function func = DefineClass(env, "RingReceiver", {
+        InstanceMethod("start", &RingReceiver::Start),
+        InstanceMethod("stop", &RingReceiver::Stop),
+        InstanceMethod("getStats", &RingReceiver::GetStats),
+        InstanceMethod("readWaterfall", &RingReceiver::ReadWaterfall)
+    });
+    
+    return func;
+}
+
+RingReceiver::RingReceiver(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<RingReceiver>(info),
+      control_(nullptr),
+      ring_(nullptr),
+      capacity_(0),
+      sample_rate_(12000),
+      start_time_(0),
+      has_start_time_(false),
+      slot_time_(FT8_SLOT_TIME),
+      start_read_index_(0),
+      first_slot_sample_(0),
+      first_slot_utc_(0),
+      running_(false),
+      stop_requested_(false),
+      samples_consumed_(0),
+      slots_decoded_(0),
+      messages_decoded_(0),
+      overruns_(0),
+      last_decode_ms_(0),
+      current_slot_(-1),
+      profile_level_(-1),
+      last_latency_ms_(0),
+      addon_data_(info.Env().GetInstanceData<AddonData>()) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    
+    Napi::Value control = options.Get("control");
+    if (!control.IsTypedArray() || control.As<Napi::TypedArray>().TypedArrayType() != napi_int32_array ||
+        control.As<Napi::Int32Array>().ElementLength() < (size_t)RING_CONTROL_LENGTH) {
+        Napi::TypeError::New(env, "control must be an Int32Array of at least 4 elements").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    Napi::Value samples = options.Get("samples");
+    if (!samples.IsTypedArray() || samples.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "samples must be a Float32Array").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    size_t capacity = samples.As<Napi::Float32Array>().ElementLength();
+    if (capacity < 2 || capacity > 0x80000000u || (capacity & (capacity - 1)) != 0) {
+        Napi::RangeError::New(env, "samples length must be a power of two").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    Napi::Value on_decode = options.Get("onDecode");
+    if (!on_decode.IsFunction()) {
+        Napi::TypeError::New(env, "onDecode must be a function").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    if (!MessageDecoder::ParseConfig(env, options, &config_)) {
+        return;
+    }
+    
+    if (options.Has("loadController") && !options.Get("loadController").IsUndefined()) {
+        if (!LoadController::FromValue(env, options.Get("loadController"), &governor_)) {
+            return;
+        }
+    }
+    
+    if (options.Has("sampleRate")) {
+        sample_rate_ = options.Get("sampleRate").As<Napi::Number>().Int32Value();
+        if (sample_rate_ <= 0) {
+            Napi::RangeError::New(env, "sampleRate must be positive").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    
+    if (options.Has("waterfallRows")) {
+        int rows = options.Get("waterfallRows").As<Napi::Number>().Int32Value();
+        if (rows < 0) {
+            Napi::RangeError::New(env, "waterfallRows must not be negative").ThrowAsJavaScriptException();
+            return;
+        }
+        if (rows > 0) {
+            history_.reset(new WaterfallHistory(rows));
+        }
+    }
+    
+    if (options.Has("startTime")) {
+        Napi::Value start = options.Get("startTime");
+        if (start.IsDate()) {
+            start_time_ = start.As<Napi::Date>().ValueOf();
+            has_start_time_ = true;
+        } else if (start.IsNumber()) {
+            start_time_ = start.As<Napi::Number>().DoubleValue();
+            has_start_time_ = true;
+        }
+    }
+    
+    // Typed array data pointers stay valid for SharedArrayBuffers, unlike ArrayBuffer::Data()
+    control_ref_ = Napi::Persistent(control.As<Napi::Object>());
+    samples_ref_ = Napi::Persistent(samples.As<Napi::Object>());
+    control_ = reinterpret_cast<std::atomic<int32_t>*>(control.As<Napi::Int32Array>().Data());
+    ring_ = samples.As<Napi::Float32Array>().Data();
+    capacity_ = (uint32_t)capacity;
+    slot_time_ = (config_.protocol == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+    on_decode_ref_ = Napi::Persistent(on_decode.As<Napi::Function>());
+}
+
+RingReceiver::~RingReceiver() {
+    StopThread();
+}
+
+void RingReceiver::Start(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (running_ || !control_) {
+        return;
+    }
+    
+    // A thread that ended at end of stream still needs joining
+    StopThread();
+    
+    on_decode_ = Napi::ThreadSafeFunction::New(env, on_decode_ref_.Value(), "ft8_lib:RingReceiver", 0, 1);
+    
+    // Samples already in the ring are older than now, unless the caller said when they start
+    start_read_index_ = (uint32_t)control_[RING_READ_INDEX].load(std::memory_order_acquire);
+    uint32_t buffered = (uint32_t)control_[RING_WRITE_INDEX].load(std::memory_order_acquire) - start_read_index_;
+    double start = has_start_time_ ? start_time_ : NowMs() - 1000.0 * buffered / sample_rate_;
+    
+    // Decoding begins at the first UTC slot boundary at or after the first sample
+    double slot_ms = slot_time_ * 1000.0;
+    first_slot_utc_ = std::ceil(start / slot_ms) * slot_ms;
+    first_slot_sample_ = std::llround((first_slot_utc_ - start) * sample_rate_ / 1000.0);
+    
+    samples_consumed_ = 0;
+    slots_decoded_ = 0;
+    messages_decoded_ = 0;
+    overruns_ = 0;
+    current_slot_ = -1;
+    profile_level_ = -1;
+    stop_requested_ = false;
+    running_ = true;
+    thread_ = std::thread(&RingReceiver::Run, this);
+    addon_data_->thread_owners.insert(this);
+}
+
+void RingReceiver::Stop(const Napi::CallbackInfo& info) {
+    StopThread();
+}
+
+void RingReceiver::StopThread() {
+    stop_requested_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    addon_data_->thread_owners.erase(this);
+}
+
+int64_t RingReceiver::SlotStartSample(int64_t slot_index) const {
+    return first_slot_sample_ + std::llround(slot_index * slot_time_ * sample_rate_);
+}
+
+void RingReceiver::StartSlot(DecoderCore* core) {
+    if (governor_) {
+        int level = governor_->Level();
+        if (level != profile_level_) {
+            // Only an oversampling change rebuilds the monitor
+            core->SetConfig(governor_->Profiles()[level].Apply(config_));
+            profile_level_ = level;
+        }
+    }
+    
+    core->StartSlot(sample_rate_);
+}
+
+void RingReceiver::ProcessBlock(DecoderCore* core, const float* block, int64_t slot_index) {
+    core->ProcessBlock(block);
+    
+    if (history_) {
+        const ftx_waterfall_t* wf = core->Waterfall();
+        double utc = first_slot_utc_ + slot_index * slot_time_ * 1000.0 +
+                     (wf->num_blocks - 1) * core->SymbolPeriod() * 1000.0;
+        history_->Append(core->Layout(), wf->mag + (size_t)(wf->num_blocks - 1) * wf->block_stride, utc);
+    }
+}
+
+void RingReceiver::DeliverSlot(DecoderCore* core, int64_t slot_index, uint32_t backlog) {
+    auto started = std::chrono::steady_clock::now();
+    
+    RingSlotResult* result = new RingSlotResult();
+    result->index = slot_index;
+    result->utc_start = first_slot_utc_ + slot_index * slot_time_ * 1000.0;
+    result->num_blocks = core->NumBlocks();
+    core->Decode(&result->messages);
+    result->decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    
+    last_decode_ms_ = result->decode_ms;
+    
+    // Samples still waiting in the ring arrived while this slot was being processed
+    double latency_ms = result->decode_ms + 1000.0 * backlog / sample_rate_;
+    last_latency_ms_ = latency_ms;
+    if (governor_) {
+        governor_->Report(profile_level_, latency_ms, slot_time_ * 1000.0);
+    }
+    
+    slots_decoded_++;
+    messages_decoded_ += result->messages.size();
+    
+    if (on_decode_.NonBlockingCall(result, CallOnDecode) != napi_ok) {
+        delete result;
+    }
+}
+
+void RingReceiver::Run() {
+    TraceSetThreadName("RingReceiver");
+    
+    DecoderCore core(config_);
+    StartSlot(&core);
+    
+    uint32_t block_size = (uint32_t)core.BlockSize();
+    const uint32_t mask = capacity_ - 1;
+    std::vector<float> block(block_size);
+    uint32_t block_fill = 0;
+    
+    uint32_t read = start_read_index_;
+    int64_t consumed = 0;
+    int64_t slot = 0;
+    int64_t slot_start = SlotStartSample(0);
+    int64_t slot_end = SlotStartSample(1);
+    bool decoded = false;
+    
+    while (!stop_requested_) {
+        uint32_t write = (uint32_t)control_[RING_WRITE_INDEX].load(std::memory_order_acquire);
+        uint32_t available = write - read;
+        
+        if (available > capacity_) {
+            // The producer overwrote unread samples; drop them along with the slot they belong to
+            overruns_++;
+            control_[RING_OVERRUNS].fetch_add(1, std::memory_order_relaxed);
+            consumed += available;
+            read = write;
+            block_fill = 0;
+            decoded = true;
+            control_[RING_READ_INDEX].store((int32_t)read, std::memory_order_release);
+            continue;
+        }
+        
+        if (available == 0) {
+            if (control_[RING_FLAGS].load(std::memory_order_acquire) & RING_FLAG_END_OF_STREAM) {
+                if (!decoded && consumed >= slot_start && core.NumBlocks() > 0) {
+                    DeliverSlot(&core, slot, 0);
+                }
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(RING_POLL_INTERVAL_MS));
+            continue;
+        }
+        
+        while (available > 0 && !stop_requested_) {
+            if (consumed >= slot_end) {
+                if (!decoded && core.NumBlocks() > 0) {
+                    DeliverSlot(&core, slot, available);
+                }
+                ++slot;
+                slot_start = slot_end;
+                slot_end = SlotStartSample(slot + 1);
+                StartSlot(&core);
+                block_size = (uint32_t)core.BlockSize();
+                block.resize(block_size);
+                block_fill = 0;
+                // After an overrun the new slot may already be under way; it is skipped
+                decoded = consumed > slot_start;
+                continue;
+            }
+            
+            uint32_t n;
+            if (consumed < slot_start || decoded) {
+                // Outside a waterfall: skip to the next slot boundary
+                int64_t target = (consumed < slot_start) ? slot_start : slot_end;
+                n = (uint32_t)std::min<int64_t>(available, target - consumed);
+            } else {
+                current_slot_ = slot;
+                uint32_t offset = read & mask;
+                uint32_t contiguous = capacity_ - offset;
+                
+                if (block_fill == 0 && available >= block_size && contiguous >= block_size) {
+                    // Whole block in place: feed the monitor straight from shared memory
+                    ProcessBlock(&core, ring_ + offset, slot);
+                    n = block_size;
+                } else {
+                    // Block wraps around the ring end or is still arriving
+                    n = std::min(std::min(available, block_size - block_fill), contiguous);
+                    memcpy(block.data() + block_fill, ring_ + offset, n * sizeof(float));
+                    block_fill += n;
+                    if (block_fill == block_size) {
+                        ProcessBlock(&core, block.data(), slot);
+                        block_fill = 0;
+                    }
+                }
+                
+                if (core.WaterfallFull()) {
+                    DeliverSlot(&core, slot, available - n);
+                    decoded = true;
+                }
+            }
+            
+            read += n;
+            consumed += n;
+            available -= n;
+            control_[RING_READ_INDEX].store((int32_t)read, std::memory_order_release);
+            samples_consumed_ = (uint64_t)consumed;
+        }
+    }
+    
+    running_ = false;
+    on_decode_.Release();
+}
+
+Napi::Value RingReceiver::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("running", Napi::Boolean::New(env, running_));
+    stats.Set("samplesConsumed", Napi::Number::New(env, (double)samples_consumed_));
+    stats.Set("slotsDecoded", Napi::Number::New(env, (double)slots_decoded_));
+    stats.Set("messagesDecoded", Napi::Number::New(env, (double)messages_decoded_));
+    stats.Set("overruns", Napi::Number::New(env, overruns_));
+    stats.Set("lastDecodeMs", Napi::Number::New(env, last_decode_ms_));
+    stats.Set("currentSlot", Napi::Number::New(env, (double)current_slot_));
+    stats.Set("firstSlotUtc", Napi::Number::New(env, first_slot_utc_));
+    stats.Set("capacity", Napi::Number::New(env, capacity_));
+    stats.Set("lastLatencyMs", Napi::Number::New(env, last_latency_ms_));
+    
+    // Profile the current slot is decoded with, when a load controller is attached
+    int level = profile_level_;
+    stats.Set("profile", (governor_ && level >= 0)
+        ? LoadController::ProfileToObject(env, governor_->Profiles()[level], level)
+        : env.Null());
+    
+    return stats;
+}
+
+Napi::Value RingReceiver::ReadWaterfall(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (!history_) {
+        Napi::Error::New(env, "readWaterfall needs the waterfallRows option").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    double since = 0;
+    if (info.Length() > 0 && !info[0].IsUndefined()) {
+        if (!info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected block number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        since = std::max(0.0, info[0].As<Napi::Number>().DoubleValue());
+    }
+    
+    WaterfallHistory::Rows* rows = new WaterfallHistory::Rows();
+    history_->Read((uint64_t)since, rows);
+    if (rows->layout.symbol_period == 0) {
+        // No block has arrived yet
+        rows->layout.symbol_period = (config_.protocol == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+    }
+    
+    int num_blocks = (int)(rows->next - rows->first);
+    uint64_t first = rows->first;
+    uint64_t next = rows->next;
+    WaterfallLayout layout = rows->layout;
+    
+    Napi::Float64Array times = Napi::Float64Array::New(env, rows->times.size());
+    std::copy(rows->times.begin(), rows->times.end(), times.Data());
+    
+    // The copy is handed to JavaScript as it is, without a second copy
+    Napi::Uint8Array mag;
+    size_t mag_length = rows->mag.size();
+    if (mag_length > 0) {
+        Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, rows->mag.data(), mag_length,
+            [](Napi::Env, void*, WaterfallHistory::Rows* rows) { delete rows; }, rows);
+        mag = Napi::Uint8Array::New(env, mag_length, buffer, 0);
+    } else {
+        delete rows;
+        mag = Napi::Uint8Array::New(env, 0);
+    }
+    
+    Napi::Object result = MessageDecoder::CreateWaterfallObject(env, layout, mag, num_blocks);
+    result.Set("first", Napi::Number::New(env, (double)first));
+    result.Set("next", Napi::Number::New(env, (double)next));
+    result.Set("times", times);
+    
+    return result;
+}
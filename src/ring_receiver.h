@@ -0,0 +1,155 @@
+#ifndef RING_RECEIVER_H
+#define RING_RECEIVER_H
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "addon_data.h"
+#include "decoder_core.h"
+#include "load_controller.h"
+#include "waterfall_history.h"
+
+/**
+ * RingReceiver decodes audio that a JavaScript producer writes into a
+ * SharedArrayBuffer ring, without involving the main thread
+ *
+ * The ring is a single-producer/single-consumer queue made of two views over
+ * shared memory:
+ *
+ *   control: Int32Array of at least 4 elements
+ *     [0] write index - total samples written, wrapping at 2^32 (producer)
+ *     [1] read index  - total samples consumed, wrapping at 2^32 (receiver)
+ *     [2] flags       - bit 0: end of stream (producer)
+ *     [3] overruns    - number of times the receiver found the ring overfilled
+ *   samples: Float32Array whose length is a power of two
+ *
+ * The sample at index i lives at samples[i & (samples.length - 1)]. The
+ * producer may write while (write - read) < samples.length and publishes
+ * samples by storing the new write index with Atomics.store.
+ *
+ * A native thread consumes the ring, feeds complete blocks to the monitor
+ * straight from shared memory, and decodes whenever a UTC slot's waterfall is
+ * complete. Results are delivered to the onDecode callback through a
+ * Napi::ThreadSafeFunction. With the waterfallRows option, the most recent
+ * waterfall blocks are also kept for readWaterfall().
+ */
+class RingReceiver : public Napi::ObjectWrap<RingReceiver>, public NativeThreadOwner {
+public:
+    /**
+     * Initialize the RingReceiver class for Node.js
+     * @param env N-API environment
+     * @return Constructor function
+     */
+    static Napi::Function Init(Napi::Env env);
+    
+    /**
+     * Constructor
+     * @param info Callback info containing the options object
+     */
+    RingReceiver(const Napi::CallbackInfo& info);
+    
+    ~RingReceiver();
+
+private:
+    /**
+     * Start the consumer thread
+     */
+    void Start(const Napi::CallbackInfo& info);
+    
+    /**
+     * Stop the consumer thread and release the callback
+     */
+    void Stop(const Napi::CallbackInfo& info);
+    
+    /**
+     * Counters of the consumer thread
+     */
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    
+    /**
+     * Waterfall blocks added since a given block number
+     */
+    Napi::Value ReadWaterfall(const Napi::CallbackInfo& info);
+    
+    /**
+     * Consumer thread body
+     */
+    void Run();
+    
+    /**
+     * Decode the current waterfall and queue the result for JavaScript
+     * @param core Decoder holding the slot's waterfall
+     * @param slot_index Slot to deliver
+     * @param backlog Samples waiting in the ring, i.e. how far the consumer is behind real time
+     */
+    void DeliverSlot(DecoderCore* core, int64_t slot_index, uint32_t backlog);
+    
+    /**
+     * Begin the next waterfall, switching to the controller's current profile first
+     */
+    void StartSlot(DecoderCore* core);
+    
+    /**
+     * Feed one block to the monitor and keep its waterfall row
+     * @param core Decoder of the current slot
+     * @param block BlockSize() samples
+     * @param slot_index Slot the block belongs to
+     */
+    void ProcessBlock(DecoderCore* core, const float* block, int64_t slot_index);
+    
+    /**
+     * Join the consumer thread and release the thread-safe function
+     */
+    void StopThread() override;
+    
+    /**
+     * File sample index at which a slot starts
+     */
+    int64_t SlotStartSample(int64_t slot_index) const;
+    
+    // Shared memory, kept alive by the references below
+    Napi::ObjectReference control_ref_;
+    Napi::ObjectReference samples_ref_;
+    std::atomic<int32_t>* control_;
+    const float* ring_;
+    uint32_t capacity_;
+    
+    DecoderConfig config_;
+    std::shared_ptr<LoadGovernor> governor_;
+    int sample_rate_;
+    double start_time_;
+    bool has_start_time_;
+    
+    // Recent waterfall blocks, only kept with the waterfallRows option
+    std::unique_ptr<WaterfallHistory> history_;
+    
+    // Slot grid: first slot boundary, in samples after the read index at start
+    double slot_time_;
+    uint32_t start_read_index_;
+    int64_t first_slot_sample_;
+    double first_slot_utc_;
+    
+    Napi::ThreadSafeFunction on_decode_;
+    Napi::FunctionReference on_decode_ref_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_requested_;
+    
+    // Statistics, written by the consumer thread
+    std::atomic<uint64_t> samples_consumed_;
+    std::atomic<uint64_t> slots_decoded_;
+    std::atomic<uint64_t> messages_decoded_;
+    std::atomic<uint32_t> overruns_;
+    std::atomic<double> last_decode_ms_;
+    std::atomic<int64_t> current_slot_;
+    std::atomic<int> profile_level_;
+    std::atomic<double> last_latency_ms_;
+    
+    // Instance data of the environment that created this receiver
+    AddonData* addon_data_;
+};
+
+#endif // RING_RECEIVER_H
@@ -0,0 +1,246 @@
+#include "slot_pool.h"
+#include "parallel.h"
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Slots a pool thread may run ahead of the oldest slot not yet delivered, per thread
+const int SLOT_POOL_SLOTS_AHEAD = 4;
+
+bool WavSlotSource::Open(const std::string& path, float slot_time, bool has_start_time, double start_time_ms,
+                         std::string* error) {
+    if (!file_.Open(path, error)) {
+        return false;
+    }
+    path_ = path;
+    layout_ = ComputeSlotLayout(file_.SampleRate(), file_.NumFrames(), slot_time, has_start_time, start_time_ms);
+    next_ = 0;
+    return true;
+}
+
+int WavSlotSource::Read(DecodedSlot* slot, float* samples, std::string* error) {
+    if (next_ >= layout_.num_slots) {
+        return 0;
+    }
+
+    TraceScope trace("readSlot", "audio");
+    trace.SetArg("slot", (double)next_);
+    if (!ReadWavSlot(&file_, layout_, next_, samples, &slot->valid_samples)) {
+        *error = "Failed to read WAV file: " + path_;
+        return -1;
+    }
+    slot->start_sample = next_ * layout_.slot_samples - layout_.lead_samples;
+    ++next_;
+    return 1;
+}
+
+PcmStreamSlotSource::PcmStreamSlotSource(FILE* file, PcmStreamFormat format, int channels, int slot_samples,
+                                         int64_t lead_samples)
+    : file_(file), format_(format), channels_(channels), slot_samples_(slot_samples),
+      lead_samples_(lead_samples) {
+}
+
+int PcmStreamSlotSource::Read(DecodedSlot* slot, float* samples, std::string* error) {
+    std::fill(samples, samples + slot_samples_, 0.0f);
+
+    // Only the first slot is padded
+    int offset = (position_ == 0) ? (int)lead_samples_ : 0;
+    size_t wanted = (size_t)(slot_samples_ - offset);
+    size_t sample_bytes = (format_ == PCM_STREAM_F32LE) ? 4 : 2;
+    size_t frame_bytes = sample_bytes * channels_;
+    raw_.resize(wanted * frame_bytes);
+
+    size_t frames = fread(raw_.data(), frame_bytes, wanted, file_);
+    if (frames < wanted && ferror(file_)) {
+        *error = std::string("Failed to read PCM stream: ") + strerror(errno);
+        return -1;
+    }
+    if (frames == 0) {
+        return 0;
+    }
+
+    float* out = samples + offset;
+    if (format_ == PCM_STREAM_F32LE) {
+        bool swap = PcmNativeByteOrder() != PCM_LITTLE_ENDIAN;
+        for (size_t i = 0; i < frames; ++i) {
+            float sum = 0;
+            for (int c = 0; c < channels_; ++c) {
+                uint8_t bytes[4];
+                memcpy(bytes, raw_.data() + (i * channels_ + c) * 4, 4);
+                if (swap) {
+                    std::swap(bytes[0], bytes[3]);
+                    std::swap(bytes[1], bytes[2]);
+                }
+                float value;
+                memcpy(&value, bytes, 4);
+                sum += value;
+            }
+            out[i] = sum / channels_;
+        }
+    } else {
+        PcmByteOrder order = (format_ == PCM_STREAM_S16BE) ? PCM_BIG_ENDIAN : PCM_LITTLE_ENDIAN;
+        ConvertPcm16ToFloat(raw_.data(), frames, channels_, order, out);
+    }
+
+    slot->start_sample = position_ - offset;
+    slot->valid_samples = (int)frames;
+    position_ += (int64_t)frames;
+    return 1;
+}
+
+namespace {
+
+/**
+ * Shared state of one DecodeSlotsInOrder call
+ */
+class SlotPool {
+public:
+    SlotPool(SlotSource* source, const SlotPoolOptions& options, unsigned threads)
+        : source_(source), options_(options), threads_(threads) {
+    }
+
+    bool Run(const std::function<void(DecodedSlot& slot)>& on_slot, std::string* error) {
+        std::vector<std::thread> pool;
+        pool.reserve(threads_);
+        for (unsigned t = 0; t < threads_; ++t) {
+            pool.emplace_back([this]() { DecodeSlots(); });
+        }
+
+        // Forward finished slots in order
+        while (true) {
+            DecodedSlot slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_cv_.wait(lock, [this]() { return failed_ || Finished() || done_.count(next_emit_) > 0; });
+                if (failed_ || Finished()) {
+                    break;
+                }
+                slot = std::move(done_[next_emit_]);
+                done_.erase(next_emit_);
+                ++next_emit_;
+            }
+            space_cv_.notify_all();
+            on_slot(slot);
+        }
+
+        for (std::thread& worker : pool) {
+            worker.join();
+        }
+
+        if (failed_) {
+            *error = error_;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    SlotSource* source_;
+    const SlotPoolOptions& options_;
+    unsigned threads_;
+
+    // Serializes the source; slots are numbered in the order they are read
+    std::mutex read_mutex_;
+    int64_t num_read_ = 0;
+    bool end_of_input_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    std::condition_variable space_cv_;
+    std::map<int64_t, DecodedSlot> done_;
+    int64_t next_emit_ = 0;
+    // Number of slots in the input, once the end has been read
+    int64_t num_slots_ = -1;
+    bool failed_ = false;
+    std::string error_;
+
+    bool Finished() const { return num_slots_ >= 0 && next_emit_ >= num_slots_; }
+
+    /**
+     * Pool thread body: decode slots until the input is exhausted
+     */
+    void DecodeSlots() {
+        TraceSetThreadName(options_.thread_name);
+
+        DecoderCore core(options_.config);
+        core.SetCallsignIndex(options_.callsign_index);
+        core.EnableStats(options_.stats != nullptr);
+        std::vector<float> samples(options_.slot_samples);
+        int64_t window = (int64_t)threads_ * SLOT_POOL_SLOTS_AHEAD;
+
+        while (true) {
+            DecodedSlot slot;
+            {
+                std::lock_guard<std::mutex> read_lock(read_mutex_);
+                if (end_of_input_) {
+                    break;
+                }
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    space_cv_.wait(lock, [&]() { return failed_ || num_read_ < next_emit_ + window; });
+                    if (failed_) {
+                        break;
+                    }
+                }
+
+                std::string error;
+                int status = source_->Read(&slot, samples.data(), &error);
+                if (status < 0) {
+                    Fail(error);
+                    break;
+                }
+                if (status == 0) {
+                    end_of_input_ = true;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        num_slots_ = num_read_;
+                    }
+                    ready_cv_.notify_all();
+                    break;
+                }
+                slot.index = num_read_++;
+            }
+
+            if (slot.valid_samples > 0) {
+                core.ProcessAudio(samples.data(), options_.slot_samples, options_.sample_rate);
+                core.Decode(&slot.messages);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_[slot.index] = std::move(slot);
+            }
+            ready_cv_.notify_one();
+        }
+
+        if (options_.stats) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            options_.stats->Merge(core.Stats());
+        }
+    }
+
+    void Fail(const std::string& error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!failed_) {
+                failed_ = true;
+                error_ = error;
+            }
+        }
+        ready_cv_.notify_all();
+        space_cv_.notify_all();
+    }
+};
+
+} // namespace
+
+bool DecodeSlotsInOrder(SlotSource* source, const SlotPoolOptions& options,
+                        const std::function<void(DecodedSlot& slot)>& on_slot, std::string* error) {
+    SlotPool pool(source, options, ResolveThreadCount(options.threads));
+    return pool.Run(on_slot, error);
+}
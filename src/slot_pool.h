@@ -0,0 +1,142 @@
+#ifndef SLOT_POOL_H
+#define SLOT_POOL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "decoder_core.h"
+#include "pcm_convert.h"
+#include "wav_file.h"
+
+/**
+ * Messages decoded from one slot of a recording or stream
+ */
+struct DecodedSlot {
+    int64_t index = 0;
+    // Position of the slot's first sample in the input; negative for a padded first slot
+    int64_t start_sample = 0;
+    int valid_samples = 0;
+    std::vector<DecodeResult> messages;
+};
+
+/**
+ * Consecutive slots of audio for DecodeSlotsInOrder
+ *
+ * Read is called by one pool thread at a time, so sources need no locking.
+ */
+class SlotSource {
+public:
+    virtual ~SlotSource() = default;
+
+    /**
+     * Read the next slot
+     * @param slot Receives start_sample and valid_samples; the pool numbers the slots
+     * @param samples Receives one slot of samples, zero padded where there is no input
+     * @param error Receives a description of the problem on failure
+     * @return 1 if a slot was read, 0 at the end of the input, -1 on error
+     */
+    virtual int Read(DecodedSlot* slot, float* samples, std::string* error) = 0;
+};
+
+/**
+ * Slots of a WAV file, aligned to the UTC slot grid when the start time is known
+ */
+class WavSlotSource : public SlotSource {
+public:
+    /**
+     * Open a file and compute its slot layout
+     * @param path File path
+     * @param slot_time Slot length in seconds
+     * @param has_start_time Whether start_time_ms is known
+     * @param start_time_ms UTC time of the first sample in ms since the epoch
+     * @param error Receives a description of the problem on failure
+     * @return true on success
+     */
+    bool Open(const std::string& path, float slot_time, bool has_start_time, double start_time_ms,
+              std::string* error);
+
+    int SampleRate() const { return file_.SampleRate(); }
+    const WavSlotLayout& Layout() const { return layout_; }
+
+    int Read(DecodedSlot* slot, float* samples, std::string* error) override;
+
+private:
+    WavFile file_;
+    std::string path_;
+    WavSlotLayout layout_;
+    int64_t next_ = 0;
+};
+
+/**
+ * Sample formats of raw PCM streams
+ */
+enum PcmStreamFormat {
+    PCM_STREAM_S16LE,
+    PCM_STREAM_S16BE,
+    PCM_STREAM_F32LE
+};
+
+/**
+ * Slots of a raw PCM stream such as stdin, read until the stream ends
+ */
+class PcmStreamSlotSource : public SlotSource {
+public:
+    /**
+     * @param file Stream to read; not closed
+     * @param format Sample format
+     * @param channels 1 for mono, 2 for interleaved stereo (averaged to mono)
+     * @param slot_samples Samples per slot
+     * @param lead_samples Zero padding in front of the first slot
+     */
+    PcmStreamSlotSource(FILE* file, PcmStreamFormat format, int channels, int slot_samples, int64_t lead_samples);
+
+    int Read(DecodedSlot* slot, float* samples, std::string* error) override;
+
+private:
+    FILE* file_;
+    PcmStreamFormat format_;
+    int channels_;
+    int slot_samples_;
+    int64_t lead_samples_;
+    int64_t position_ = 0;
+    std::vector<uint8_t> raw_;
+};
+
+/**
+ * Settings of DecodeSlotsInOrder
+ */
+struct SlotPoolOptions {
+    DecoderConfig config;
+    // Known callsigns for hash lookups, shared by the pool threads
+    std::shared_ptr<const CallsignIndex> callsign_index;
+    int sample_rate = 0;
+    int slot_samples = 0;
+    // Pool threads (0 = hardware concurrency)
+    unsigned threads = 0;
+    // Name of the pool threads in traces
+    const char* thread_name = "slotPool";
+    // Receives the pipeline statistics of all pool threads if not null
+    DecodeStats* stats = nullptr;
+};
+
+/**
+ * Decode the slots of a source on a pool of threads
+ *
+ * Every pool thread owns a DecoderCore and takes the next slot from the
+ * source. The calling thread waits for slots to finish and hands them to
+ * on_slot in time order; pool threads block when they get too far ahead of
+ * the oldest slot not yet delivered. Slots without input are not decoded.
+ *
+ * @param source Slots to decode
+ * @param options Decoder configuration and pool settings
+ * @param on_slot Called on the calling thread for every slot, in order
+ * @param error Receives a description of the problem on failure
+ * @return false if the source failed
+ */
+bool DecodeSlotsInOrder(SlotSource* source, const SlotPoolOptions& options,
+                        const std::function<void(DecodedSlot& slot)>& on_slot, std::string* error);
+
+#endif // SLOT_POOL_H
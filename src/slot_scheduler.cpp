@@ -0,0 +1,559 @@
+#include "slot_scheduler.h"
+#include "gfsk.h"
+#include "audio_utils.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+extern "C" {
+#include <ft8/message.h>
+#include <ft8/encode.h>
+}
+
+// Default configuration values
+const float SCHEDULER_DEFAULT_FREQUENCY = 1000.0f;
+const int SCHEDULER_DEFAULT_SAMPLE_RATE = 12000;
+const double SCHEDULER_DEFAULT_TX_LEAD = 1.0;    // seconds before the slot
+const double SCHEDULER_DEFAULT_TX_DELAY = 0.5;   // seconds into the slot
+const double SCHEDULER_MAX_TX_LEAD = 60.0;
+
+// The thread sleeps until this long before a trigger, then spins on the clock
+const double SCHEDULER_SPIN_MS = 2.0;
+
+// Lateness samples kept for percentiles
+const size_t JITTER_WINDOW = 1024;
+
+enum SchedulerEventType {
+    SCHEDULER_EVENT_SLOT,
+    SCHEDULER_EVENT_DECODE,
+    SCHEDULER_EVENT_TX
+};
+
+namespace {
+
+/**
+ * One event, handed from the scheduler thread to JavaScript
+ */
+struct SchedulerEvent {
+    int type;
+    int64_t slot;
+    double slot_ms;
+    int offset_index;
+    double offset;
+    double scheduled_ms;
+    double fired_ms;
+    std::chrono::steady_clock::time_point queued;
+    std::shared_ptr<SchedulerStats> stats;
+    
+    // TX only
+    std::string text;
+    float frequency;
+    double play_at_ms;
+    int sample_rate;
+    std::vector<float>* audio;
+};
+
+/**
+ * A recurring trigger: slot boundary, decode offset or TX render time
+ */
+struct SchedulerTrigger {
+    int type;
+    int offset_index;
+    double offset_ms;
+    int64_t slot;
+};
+
+void DeleteEvent(SchedulerEvent* event) {
+    delete event->audio;
+    delete event;
+}
+
+void CallOnEvent(Napi::Env env, Napi::Function callback, SchedulerEvent* event) {
+    double queue_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - event->queued).count();
+    double delivery_late_ms = event->fired_ms - event->scheduled_ms + queue_ms;
+    {
+        std::lock_guard<std::mutex> lock(event->stats->mutex);
+        event->stats->delivery.Add(delivery_late_ms);
+    }
+    
+    if (env != nullptr && !callback.IsEmpty()) {
+        static const char* const type_names[] = { "slot", "decode", "tx" };
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("type", Napi::String::New(env, type_names[event->type]));
+        result.Set("slot", Napi::Number::New(env, (double)event->slot));
+        result.Set("parity", Napi::String::New(env, (event->slot % 2 == 0) ? "even" : "odd"));
+        result.Set("slotStart", Napi::Number::New(env, event->slot * event->slot_ms));
+        result.Set("scheduledTime", Napi::Number::New(env, event->scheduled_ms));
+        result.Set("firedTime", Napi::Number::New(env, event->fired_ms));
+        result.Set("lateMs", Napi::Number::New(env, event->fired_ms - event->scheduled_ms));
+        result.Set("deliveryLateMs", Napi::Number::New(env, delivery_late_ms));
+        
+        if (event->type == SCHEDULER_EVENT_DECODE) {
+            result.Set("offsetIndex", Napi::Number::New(env, event->offset_index));
+            result.Set("offset", Napi::Number::New(env, event->offset));
+        } else if (event->type == SCHEDULER_EVENT_TX) {
+            result.Set("text", Napi::String::New(env, event->text));
+            result.Set("frequency", Napi::Number::New(env, event->frequency));
+            result.Set("playAt", Napi::Number::New(env, event->play_at_ms));
+            result.Set("sampleRate", Napi::Number::New(env, event->sample_rate));
+            result.Set("audio", AudioUtils::WrapSamples(env, event->audio));
+            event->audio = nullptr;
+        }
+        
+        callback.Call({result});
+    }
+    DeleteEvent(event);
+}
+
+/**
+ * Count an event's lateness and queue it for the main thread
+ */
+void EmitEvent(Napi::ThreadSafeFunction& on_event, const std::shared_ptr<SchedulerStats>& stats, SchedulerEvent* event) {
+    event->stats = stats;
+    {
+        std::lock_guard<std::mutex> lock(stats->mutex);
+        stats->trigger.Add(event->fired_ms - event->scheduled_ms);
+        stats->fired++;
+    }
+    
+    event->queued = std::chrono::steady_clock::now();
+    if (on_event.NonBlockingCall(event, CallOnEvent) != napi_ok) {
+        DeleteEvent(event);
+    }
+}
+
+} // namespace
+
+JitterStats::JitterStats() : next_(0), count_(0), sum_(0), max_(0), last_(0) {
+}
+
+void JitterStats::Add(double late_ms) {
+    if (window_.size() < JITTER_WINDOW) {
+        window_.push_back(late_ms);
+    } else {
+        window_[next_] = late_ms;
+        next_ = (next_ + 1) % JITTER_WINDOW;
+    }
+    ++count_;
+    sum_ += late_ms;
+    max_ = (count_ == 1) ? late_ms : std::max(max_, late_ms);
+    last_ = late_ms;
+}
+
+Napi::Object JitterStats::ToObject(Napi::Env env) const {
+    std::vector<double> sorted(window_);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        return sorted.empty() ? 0.0 : sorted[(size_t)std::floor(p * (sorted.size() - 1) + 0.5)];
+    };
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, (double)count_));
+    result.Set("meanMs", Napi::Number::New(env, count_ ? sum_ / count_ : 0.0));
+    result.Set("maxMs", Napi::Number::New(env, max_));
+    result.Set("p50Ms", Napi::Number::New(env, percentile(0.50)));
+    result.Set("p99Ms", Napi::Number::New(env, percentile(0.99)));
+    result.Set("lastMs", Napi::Number::New(env, last_));
+    return result;
+}
+
+Napi::Function SlotScheduler::Init(Napi::Env env) {
+    Napi::Function func = DefineClass(env, "SlotScheduler", {
+        InstanceMethod("start", &SlotScheduler::Start),
+        InstanceMethod("stop", &SlotScheduler::Stop),
+        InstanceMethod("queueTx", &SlotScheduler::QueueTx),
+        InstanceMethod("cancelTx", &SlotScheduler::CancelTx),
+        InstanceMethod("now", &SlotScheduler::Now),
+        InstanceMethod("getStats", &SlotScheduler::GetStats)
+    });
+    
+    return func;
+}
+
+SlotScheduler::SlotScheduler(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SlotScheduler>(info),
+      protocol_(FTX_PROTOCOL_FT8),
+      slot_ms_(FT8_SLOT_TIME * 1000.0),
+      tx_lead_(SCHEDULER_DEFAULT_TX_LEAD),
+      tx_delay_(SCHEDULER_DEFAULT_TX_DELAY),
+      sample_rate_(SCHEDULER_DEFAULT_SAMPLE_RATE),
+      frequency_(SCHEDULER_DEFAULT_FREQUENCY),
+      clock_offset_ms_(0),
+      stats_(std::make_shared<SchedulerStats>()),
+      running_(false),
+      stop_requested_(false),
+      addon_data_(info.Env().GetInstanceData<AddonData>()) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    
+    Napi::Value on_event = options.Get("onEvent");
+    if (!on_event.IsFunction()) {
+        Napi::TypeError::New(env, "onEvent must be a function").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    if (options.Has("protocol")) {
+        std::string protocol = options.Get("protocol").As<Napi::String>().Utf8Value();
+        if (protocol == "FT8") {
+            protocol_ = FTX_PROTOCOL_FT8;
+        } else if (protocol == "FT4") {
+            protocol_ = FTX_PROTOCOL_FT4;
+        } else {
+            Napi::TypeError::New(env, "Invalid protocol. Must be 'FT8' or 'FT4'").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    
+    float slot_time = (protocol_ == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+    slot_ms_ = slot_time * 1000.0;
+    
+    if (options.Has("decodeOffsets")) {
+        Napi::Value offsets = options.Get("decodeOffsets");
+        if (!offsets.IsArray()) {
+            Napi::TypeError::New(env, "decodeOffsets must be an array of seconds").ThrowAsJavaScriptException();
+            return;
+        }
+        Napi::Array array = offsets.As<Napi::Array>();
+        for (uint32_t i = 0; i < array.Length(); ++i) {
+            Napi::Value value = array.Get(i);
+            double offset = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+            if (!(offset >= 0.0 && offset < slot_time)) {
+                Napi::RangeError::New(env, "decodeOffsets must lie within the slot").ThrowAsJavaScriptException();
+                return;
+            }
+            decode_offsets_.push_back(offset);
+        }
+    } else {
+        // One pass a second before the next slot, after the last symbol has arrived
+        decode_offsets_.push_back(slot_time - 1.0);
+    }
+    
+    if (options.Has("txLead")) {
+        tx_lead_ = options.Get("txLead").As<Napi::Number>().DoubleValue();
+        if (!(tx_lead_ >= 0.0 && tx_lead_ <= SCHEDULER_MAX_TX_LEAD)) {
+            Napi::RangeError::New(env, "txLead must be between 0 and 60 seconds").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    if (options.Has("txDelay")) {
+        tx_delay_ = options.Get("txDelay").As<Napi::Number>().DoubleValue();
+    }
+    if (options.Has("sampleRate")) {
+        sample_rate_ = options.Get("sampleRate").As<Napi::Number>().Int32Value();
+        if (sample_rate_ <= 0) {
+            Napi::RangeError::New(env, "sampleRate must be positive").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    if (options.Has("frequency")) {
+        frequency_ = options.Get("frequency").As<Napi::Number>().FloatValue();
+    }
+    if (options.Has("clockOffset")) {
+        clock_offset_ms_ = options.Get("clockOffset").As<Napi::Number>().DoubleValue();
+    }
+    
+    on_event_ref_ = Napi::Persistent(on_event.As<Napi::Function>());
+}
+
+SlotScheduler::~SlotScheduler() {
+    StopThread();
+}
+
+double SlotScheduler::ClockMs() const {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::system_clock::now().time_since_epoch()).count() + clock_offset_ms_;
+}
+
+void SlotScheduler::Start(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (running_ || on_event_ref_.IsEmpty()) {
+        return;
+    }
+    
+    on_event_ = Napi::ThreadSafeFunction::New(env, on_event_ref_.Value(), "ft8_lib:SlotScheduler", 0, 1);
+    
+    // Events of a previous run may still be queued and keep the old counters alive
+    stats_ = std::make_shared<SchedulerStats>();
+    stop_requested_ = false;
+    running_ = true;
+    
+    // Like a timer, a running scheduler keeps itself alive
+    Ref();
+    thread_ = std::thread(&SlotScheduler::Run, this);
+    addon_data_->thread_owners.insert(this);
+}
+
+void SlotScheduler::Stop(const Napi::CallbackInfo& info) {
+    if (!running_) {
+        return;
+    }
+    StopThread();
+    Unref();
+}
+
+void SlotScheduler::StopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    running_ = false;
+    addon_data_->thread_owners.erase(this);
+}
+
+void SlotScheduler::Run() {
+    TraceSetThreadName("SlotScheduler");
+    
+    std::vector<SchedulerTrigger> triggers;
+    triggers.push_back({SCHEDULER_EVENT_SLOT, -1, 0.0, 0});
+    for (size_t i = 0; i < decode_offsets_.size(); ++i) {
+        triggers.push_back({SCHEDULER_EVENT_DECODE, (int)i, decode_offsets_[i] * 1000.0, 0});
+    }
+    triggers.push_back({SCHEDULER_EVENT_TX, -1, -tx_lead_ * 1000.0, 0});
+    
+    auto trigger_time = [this](const SchedulerTrigger& trigger) {
+        return trigger.slot * slot_ms_ + trigger.offset_ms;
+    };
+    
+    // Each trigger first fires at its next occurrence
+    auto schedule_after = [&](SchedulerTrigger& trigger, double now) {
+        trigger.slot = (int64_t)std::ceil((now - trigger.offset_ms) / slot_ms_);
+        if (trigger_time(trigger) < now) {
+            ++trigger.slot;
+        }
+    };
+    double now = ClockMs();
+    for (SchedulerTrigger& trigger : triggers) {
+        schedule_after(trigger, now);
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_requested_) {
+        SchedulerTrigger& trigger = *std::min_element(triggers.begin(), triggers.end(),
+            [&](const SchedulerTrigger& a, const SchedulerTrigger& b) { return trigger_time(a) < trigger_time(b); });
+        double target = trigger_time(trigger);
+        
+        // Sleep until just before the trigger, then re-evaluate in case of stop or a clock step
+        double remaining = target - ClockMs();
+        if (remaining > SCHEDULER_SPIN_MS) {
+            wake_.wait_for(lock, std::chrono::duration<double, std::milli>(remaining - SCHEDULER_SPIN_MS));
+            continue;
+        }
+        lock.unlock();
+        
+        double fired = ClockMs();
+        while (fired < target) {
+            std::this_thread::yield();
+            fired = ClockMs();
+        }
+        
+        if (fired - target > slot_ms_) {
+            // Suspended or the clock jumped: skip what was missed rather than fire a burst
+            {
+                std::lock_guard<std::mutex> stats_lock(stats_->mutex);
+                stats_->missed += (uint64_t)((fired - target) / slot_ms_);
+            }
+            schedule_after(trigger, fired);
+            lock.lock();
+            continue;
+        }
+        
+        if (trigger.type == SCHEDULER_EVENT_SLOT) {
+            TraceInstant("slotBoundary", "scheduler");
+        }
+        
+        if (trigger.type == SCHEDULER_EVENT_TX) {
+            FireTx(trigger.slot, target, fired);
+        } else {
+            SchedulerEvent* event = new SchedulerEvent();
+            event->type = trigger.type;
+            event->slot = trigger.slot;
+            event->slot_ms = slot_ms_;
+            event->offset_index = trigger.offset_index;
+            event->offset = trigger.offset_ms / 1000.0;
+            event->scheduled_ms = target;
+            event->fired_ms = fired;
+            event->audio = nullptr;
+            EmitEvent(on_event_, stats_, event);
+        }
+        
+        ++trigger.slot;
+        lock.lock();
+    }
+    lock.unlock();
+    
+    on_event_.Release();
+}
+
+void SlotScheduler::FireTx(int64_t slot, double scheduled_ms, double fired_ms) {
+    // Take the transmissions of this slot; ones whose slot has already begun are dropped
+    std::vector<TxRequest> due;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tx_queue_.begin();
+        while (it != tx_queue_.end()) {
+            if (it->slot <= slot) {
+                if (it->slot == slot) {
+                    due.push_back(std::move(*it));
+                } else {
+                    ++dropped;
+                }
+                it = tx_queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (dropped > 0) {
+        std::lock_guard<std::mutex> lock(stats_->mutex);
+        stats_->missed += dropped;
+    }
+    
+    float symbol_bt = (protocol_ == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_BT : FT4_SYMBOL_BT;
+    float symbol_period = (protocol_ == FTX_PROTOCOL_FT8) ? FT8_SYMBOL_PERIOD : FT4_SYMBOL_PERIOD;
+    
+    for (TxRequest& request : due) {
+        TraceScope trace("renderTx", "scheduler");
+        
+        int num_tones = (int)request.tones.size();
+        int num_samples = GfskSignalLength(num_tones, symbol_period, sample_rate_);
+        std::vector<float>* audio = new std::vector<float>(num_samples);
+        GenerateGfskSignal(request.tones.data(), num_tones, request.frequency, symbol_bt,
+                           symbol_period, sample_rate_, audio->data());
+        
+        SchedulerEvent* event = new SchedulerEvent();
+        event->type = SCHEDULER_EVENT_TX;
+        event->slot = slot;
+        event->slot_ms = slot_ms_;
+        event->offset_index = -1;
+        event->offset = -tx_lead_;
+        event->scheduled_ms = scheduled_ms;
+        event->fired_ms = fired_ms;
+        event->text = std::move(request.text);
+        event->frequency = request.frequency;
+        event->play_at_ms = slot * slot_ms_ + tx_delay_ * 1000.0;
+        event->sample_rate = sample_rate_;
+        event->audio = audio;
+        EmitEvent(on_event_, stats_, event);
+    }
+}
+
+Napi::Value SlotScheduler::QueueTx(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected message string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    TxRequest request;
+    request.text = info[0].As<Napi::String>().Utf8Value();
+    request.frequency = frequency_;
+    
+    ftx_message_t msg;
+    ftx_message_init(&msg);
+    if (ftx_message_encode(&msg, nullptr, request.text.c_str()) != FTX_MESSAGE_RC_OK) {
+        Napi::Error::New(env, "Failed to encode message").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (protocol_ == FTX_PROTOCOL_FT8) {
+        request.tones.resize(FT8_NN);
+        ft8_encode(msg.payload, request.tones.data());
+    } else {
+        request.tones.resize(FT4_NN);
+        ft4_encode(msg.payload, request.tones.data());
+    }
+    
+    // Earliest slot whose render time is still ahead
+    double now = ClockMs();
+    int64_t slot = (int64_t)std::floor((now + tx_lead_ * 1000.0) / slot_ms_) + 1;
+    
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        
+        if (options.Has("frequency")) {
+            request.frequency = options.Get("frequency").As<Napi::Number>().FloatValue();
+        }
+        if (options.Has("slot")) {
+            Napi::Value target = options.Get("slot");
+            if (target.IsNumber()) {
+                int64_t requested = target.As<Napi::Number>().Int64Value();
+                if (requested * slot_ms_ - tx_lead_ * 1000.0 <= now) {
+                    Napi::RangeError::New(env, "Slot is too close to render in time").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                slot = requested;
+            } else if (target.IsString()) {
+                std::string parity = target.As<Napi::String>().Utf8Value();
+                if (parity == "even") {
+                    slot += slot & 1;
+                } else if (parity == "odd") {
+                    slot += 1 - (slot & 1);
+                } else if (parity != "next") {
+                    Napi::TypeError::New(env, "slot must be a number, 'next', 'even' or 'odd'").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+        }
+    }
+    
+    request.slot = slot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tx_queue_.push_back(std::move(request));
+    }
+    
+    return Napi::Number::New(env, (double)slot);
+}
+
+Napi::Value SlotScheduler::CancelTx(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    size_t count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count = tx_queue_.size();
+        tx_queue_.clear();
+    }
+    
+    return Napi::Number::New(env, (double)count);
+}
+
+Napi::Value SlotScheduler::Now(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), ClockMs());
+}
+
+Napi::Value SlotScheduler::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued = tx_queue_.size();
+    }
+    
+    Napi::Object stats = Napi::Object::New(env);
+    std::lock_guard<std::mutex> lock(stats_->mutex);
+    stats.Set("running", Napi::Boolean::New(env, running_));
+    stats.Set("fired", Napi::Number::New(env, (double)stats_->fired));
+    stats.Set("missed", Napi::Number::New(env, (double)stats_->missed));
+    stats.Set("queuedTx", Napi::Number::New(env, (double)queued));
+    stats.Set("trigger", stats_->trigger.ToObject(env));
+    stats.Set("delivery", stats_->delivery.ToObject(env));
+    
+    return stats;
+}
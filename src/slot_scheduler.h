@@ -0,0 +1,184 @@
+#ifndef SLOT_SCHEDULER_H
+#define SLOT_SCHEDULER_H
+
+#include <napi.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "addon_data.h"
+
+extern "C" {
+#include <ft8/constants.h>
+}
+
+/**
+ * Rolling statistics of how late scheduled events ran
+ *
+ * Keeps the totals of every sample and a window of the most recent ones for
+ * percentiles. Not thread-safe; SchedulerStats guards it with its mutex.
+ */
+class JitterStats {
+public:
+    JitterStats();
+    
+    /**
+     * Record one lateness sample
+     * @param late_ms Milliseconds between the scheduled and the actual time
+     */
+    void Add(double late_ms);
+    
+    /**
+     * Summary as {count, meanMs, maxMs, p50Ms, p99Ms, lastMs}
+     */
+    Napi::Object ToObject(Napi::Env env) const;
+
+private:
+    std::vector<double> window_;
+    size_t next_;
+    uint64_t count_;
+    double sum_;
+    double max_;
+    double last_;
+};
+
+/**
+ * Counters of a SlotScheduler, shared between its thread and queued events
+ */
+struct SchedulerStats {
+    std::mutex mutex;
+    JitterStats trigger;
+    JitterStats delivery;
+    uint64_t fired = 0;
+    uint64_t missed = 0;
+};
+
+/**
+ * SlotScheduler fires FT8/FT4 slot events on a native thread aligned to UTC
+ *
+ * Slots are numbered from the Unix epoch, so slot n starts at
+ * n * FT8_SLOT_TIME (or FT4_SLOT_TIME) seconds UTC and even slots are the
+ * ones starting at :00/:30 (FT8). The scheduler thread sleeps until each
+ * trigger and emits, through a Napi::ThreadSafeFunction:
+ *
+ *   slot   - at every slot boundary
+ *   decode - at each configured offset into every slot
+ *   tx     - txLead seconds before a slot with queued transmissions, carrying
+ *            the GFSK audio rendered on the scheduler thread
+ *
+ * Every event records how late the thread woke up and how late the
+ * JavaScript callback ran, both summarized by getStats().
+ */
+class SlotScheduler : public Napi::ObjectWrap<SlotScheduler>, public NativeThreadOwner {
+public:
+    /**
+     * Initialize the SlotScheduler class for Node.js
+     * @param env N-API environment
+     * @return Constructor function
+     */
+    static Napi::Function Init(Napi::Env env);
+    
+    /**
+     * Constructor
+     * @param info Callback info containing the options object
+     */
+    SlotScheduler(const Napi::CallbackInfo& info);
+    
+    ~SlotScheduler();
+
+private:
+    /**
+     * Start the scheduler thread
+     */
+    void Start(const Napi::CallbackInfo& info);
+    
+    /**
+     * Stop the scheduler thread and release the callback
+     */
+    void Stop(const Napi::CallbackInfo& info);
+    
+    /**
+     * Queue a message for transmission in a future slot
+     * @param info Callback info containing the message text and options
+     * @return Target slot number
+     */
+    Napi::Value QueueTx(const Napi::CallbackInfo& info);
+    
+    /**
+     * Drop all queued transmissions that have not been rendered yet
+     * @return Number of dropped transmissions
+     */
+    Napi::Value CancelTx(const Napi::CallbackInfo& info);
+    
+    /**
+     * Current UTC time in ms according to the scheduler clock
+     */
+    Napi::Value Now(const Napi::CallbackInfo& info);
+    
+    /**
+     * Trigger counters and jitter statistics
+     */
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    
+    /**
+     * A transmission waiting for its slot
+     */
+    struct TxRequest {
+        std::string text;
+        std::vector<uint8_t> tones;
+        float frequency;
+        int64_t slot;
+    };
+    
+    /**
+     * Scheduler thread body
+     */
+    void Run();
+    
+    /**
+     * Render and queue the transmissions of a slot
+     */
+    void FireTx(int64_t slot, double scheduled_ms, double fired_ms);
+    
+    /**
+     * Join the scheduler thread
+     */
+    void StopThread() override;
+    
+    /**
+     * System clock plus the configured offset, in ms since the epoch
+     */
+    double ClockMs() const;
+    
+    // Configuration
+    ftx_protocol_t protocol_;
+    double slot_ms_;
+    std::vector<double> decode_offsets_;
+    double tx_lead_;
+    double tx_delay_;
+    int sample_rate_;
+    float frequency_;
+    double clock_offset_ms_;
+    
+    std::vector<TxRequest> tx_queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    
+    // Shared with events still queued for the main thread
+    std::shared_ptr<SchedulerStats> stats_;
+    
+    Napi::ThreadSafeFunction on_event_;
+    Napi::FunctionReference on_event_ref_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    bool stop_requested_;
+    
+    // Instance data of the environment that created this scheduler
+    AddonData* addon_data_;
+};
+
+#endif // SLOT_SCHEDULER_H
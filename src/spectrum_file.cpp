@@ -0,0 +1,128 @@
+#include "spectrum_file.h"
+#include <cstring>
+
+namespace {
+
+const char SPECTRUM_MAGIC[4] = {'F', 'T', 'X', 'S'};
+
+// Limits of the header fields a monitor can be rebuilt from
+const uint32_t SPECTRUM_MIN_SAMPLE_RATE = 1000;
+const uint32_t SPECTRUM_MAX_SAMPLE_RATE = 384000;
+const int SPECTRUM_MAX_OSR = 8;
+
+void PutU16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+void PutU32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+uint16_t GetU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+} // namespace
+
+size_t SpectrumFileSize(const SpectrumInfo& info) {
+    return SPECTRUM_HEADER_SIZE + (size_t)info.num_blocks * info.layout.block_stride * sizeof(WF_ELEM_T);
+}
+
+void WriteSpectrum(const SpectrumInfo& info, const WF_ELEM_T* mag, uint8_t* out) {
+    memset(out, 0, SPECTRUM_HEADER_SIZE);
+    memcpy(out, SPECTRUM_MAGIC, sizeof(SPECTRUM_MAGIC));
+    PutU16(out + 4, SPECTRUM_FORMAT_VERSION);
+    PutU16(out + 6, (uint16_t)SPECTRUM_HEADER_SIZE);
+    out[8] = (info.protocol == FTX_PROTOCOL_FT4) ? 1 : 0;
+    out[9] = (uint8_t)info.layout.time_osr;
+    out[10] = (uint8_t)info.layout.freq_osr;
+    PutU32(out + 12, (uint32_t)info.sample_rate);
+    PutU32(out + 16, (uint32_t)info.block_size);
+    PutU32(out + 20, (uint32_t)info.layout.min_bin);
+    PutU32(out + 24, (uint32_t)info.layout.num_bins);
+    PutU32(out + 28, (uint32_t)info.num_blocks);
+    PutU32(out + 32, (uint32_t)info.layout.block_stride);
+
+    uint32_t symbol_period;
+    memcpy(&symbol_period, &info.layout.symbol_period, sizeof(symbol_period));
+    PutU32(out + 36, symbol_period);
+
+    memcpy(out + SPECTRUM_HEADER_SIZE, mag, (size_t)info.num_blocks * info.layout.block_stride * sizeof(WF_ELEM_T));
+}
+
+bool ReadSpectrumHeader(const uint8_t* data, size_t size, SpectrumInfo* info, std::string* error) {
+    if (size < SPECTRUM_HEADER_SIZE || memcmp(data, SPECTRUM_MAGIC, sizeof(SPECTRUM_MAGIC)) != 0) {
+        *error = "Not a spectrum snapshot";
+        return false;
+    }
+    uint16_t version = GetU16(data + 4);
+    if (version == 0 || version > SPECTRUM_FORMAT_VERSION) {
+        *error = "Unsupported spectrum snapshot version " + std::to_string(version);
+        return false;
+    }
+    if (GetU16(data + 6) != SPECTRUM_HEADER_SIZE) {
+        *error = "Unexpected spectrum snapshot header size";
+        return false;
+    }
+
+    if (data[8] > 1) {
+        *error = "Unknown protocol in spectrum snapshot";
+        return false;
+    }
+    info->protocol = (data[8] == 1) ? FTX_PROTOCOL_FT4 : FTX_PROTOCOL_FT8;
+    uint32_t sample_rate = GetU32(data + 12);
+    uint32_t block_size = GetU32(data + 16);
+    uint32_t min_bin = GetU32(data + 20);
+    uint32_t num_bins = GetU32(data + 24);
+    uint32_t num_blocks = GetU32(data + 28);
+    uint32_t block_stride = GetU32(data + 32);
+    float symbol_period;
+    uint32_t symbol_period_bits = GetU32(data + 36);
+    memcpy(&symbol_period, &symbol_period_bits, sizeof(symbol_period));
+
+    if (sample_rate < SPECTRUM_MIN_SAMPLE_RATE || sample_rate > SPECTRUM_MAX_SAMPLE_RATE) {
+        *error = "Unsupported sample rate in spectrum snapshot";
+        return false;
+    }
+    if (data[9] < 1 || data[9] > SPECTRUM_MAX_OSR || data[10] < 1 || data[10] > SPECTRUM_MAX_OSR) {
+        *error = "Unsupported oversampling in spectrum snapshot";
+        return false;
+    }
+
+    // Block size and symbol period are fixed by the protocol and sample rate,
+    // computed as monitor_init() does
+    float protocol_period = (info->protocol == FTX_PROTOCOL_FT4) ? FT4_SYMBOL_PERIOD : FT8_SYMBOL_PERIOD;
+    if (symbol_period != protocol_period || block_size != (uint32_t)(int)(sample_rate * protocol_period)) {
+        *error = "Spectrum snapshot block size does not match the protocol and sample rate";
+        return false;
+    }
+
+    // Bins above Nyquist do not exist in the monitor's FFT output
+    if (num_bins < 1 || (uint64_t)min_bin + num_bins > block_size / 2 || num_blocks > (uint32_t)INT32_MAX ||
+        (uint64_t)block_stride != (uint64_t)data[9] * data[10] * num_bins) {
+        *error = "Inconsistent spectrum snapshot geometry";
+        return false;
+    }
+
+    info->sample_rate = (int)sample_rate;
+    info->block_size = (int)block_size;
+    info->num_blocks = (int)num_blocks;
+    info->layout.time_osr = data[9];
+    info->layout.freq_osr = data[10];
+    info->layout.min_bin = (int)min_bin;
+    info->layout.num_bins = (int)num_bins;
+    info->layout.block_stride = (int)block_stride;
+    info->layout.symbol_period = symbol_period;
+    if (size < SpectrumFileSize(*info)) {
+        *error = "Spectrum snapshot is truncated";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SPECTRUM_FILE_H
+#define SPECTRUM_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "decoder_core.h"
+
+/**
+ * Binary snapshot of a decoder's waterfall
+ *
+ * A fixed 64-byte little-endian header describes the monitor geometry; the
+ * magnitudes follow unchanged, num_blocks blocks of block_stride bytes in the
+ * waterfall's own layout. Since the magnitudes sit at a fixed offset, a file
+ * can be memory-mapped and handed to a decoder without parsing more than the
+ * header.
+ *
+ *   0  "FTXS"            4  u16 version        6  u16 header size
+ *   8  u8 protocol       9  u8 time_osr       10  u8 freq_osr   11  u8 reserved
+ *  12  u32 sample_rate  16  u32 block_size    20  u32 min_bin
+ *  24  u32 num_bins     28  u32 num_blocks    32  u32 block_stride
+ *  36  f32 symbol_period; the rest of the header is zero
+ *
+ * Protocol is 0 for FT8 and 1 for FT4. Magnitudes use the waterfall's
+ * encoding of 0.5 dB steps from -120 dB.
+ */
+
+// Current format version; readers reject newer versions
+const uint16_t SPECTRUM_FORMAT_VERSION = 1;
+const size_t SPECTRUM_HEADER_SIZE = 64;
+
+/**
+ * Everything a snapshot header records
+ */
+struct SpectrumInfo {
+    ftx_protocol_t protocol = FTX_PROTOCOL_FT8;
+    int sample_rate = 0;
+    // Audio samples per waterfall block
+    int block_size = 0;
+    int num_blocks = 0;
+    WaterfallLayout layout;
+};
+
+/**
+ * Size in bytes of a snapshot
+ */
+size_t SpectrumFileSize(const SpectrumInfo& info);
+
+/**
+ * Write a snapshot
+ * @param info Geometry of the waterfall
+ * @param mag info.num_blocks blocks of info.layout.block_stride magnitudes
+ * @param out Receives SpectrumFileSize(info) bytes
+ */
+void WriteSpectrum(const SpectrumInfo& info, const WF_ELEM_T* mag, uint8_t* out);
+
+/**
+ * Parse and validate a snapshot header
+ * @param data Snapshot bytes
+ * @param size Number of bytes available
+ * @param info Receives the geometry; the magnitudes start at data + SPECTRUM_HEADER_SIZE
+ * @param error Receives a description of the problem on failure
+ * @return true if the header is valid and the magnitudes are complete; a valid
+ *         header has block size and symbol period of its protocol and sample
+ *         rate and no bins above Nyquist
+ */
+bool ReadSpectrumHeader(const uint8_t* data, size_t size, SpectrumInfo* info, std::string* error);
+
+#endif // SPECTRUM_FILE_H
@@ -0,0 +1,243 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+std::atomic<bool> g_trace_enabled(false);
+
+namespace {
+
+/**
+ * One recorded event; strings are literals owned by the caller
+ */
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    const char* arg_name;
+    double arg;
+    uint64_t ts_ns;
+    char phase;
+};
+
+/**
+ * Events of one thread in one session, written only by that thread
+ */
+struct TraceBuffer {
+    uint64_t session = 0;
+    uint64_t tid = 0;
+    std::atomic<const char*> thread_name{nullptr};
+    std::vector<TraceEvent> events;
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+};
+
+// Buffers of the current session, guarded by g_registry_mutex
+std::mutex g_registry_mutex;
+std::vector<std::shared_ptr<TraceBuffer>> g_buffers;
+size_t g_capacity = 0;
+
+std::atomic<uint64_t> g_session(0);
+std::atomic<uint64_t> g_start_ns(0);
+
+// The calling thread's buffer; it keeps the buffer alive after the session ends
+thread_local std::shared_ptr<TraceBuffer> t_buffer;
+thread_local const char* t_thread_name = nullptr;
+
+uint64_t NowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Kernel thread ID where available, so traces line up with perf and top
+ */
+uint64_t CurrentThreadId() {
+#if defined(_WIN32)
+    return (uint64_t)GetCurrentThreadId();
+#elif defined(__linux__)
+    return (uint64_t)syscall(SYS_gettid);
+#elif defined(__APPLE__)
+    uint64_t tid = 0;
+    pthread_threadid_np(nullptr, &tid);
+    return tid;
+#else
+    return (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+}
+
+uint64_t CurrentProcessId() {
+#if defined(_WIN32)
+    return (uint64_t)GetCurrentProcessId();
+#else
+    return (uint64_t)getpid();
+#endif
+}
+
+TraceBuffer* ThreadBuffer() {
+    TraceBuffer* buffer = t_buffer.get();
+    if (buffer && buffer->session == g_session.load(std::memory_order_acquire)) {
+        return buffer;
+    }
+
+    // First event of this thread in the session: register a buffer
+    std::shared_ptr<TraceBuffer> fresh = std::make_shared<TraceBuffer>();
+    fresh->tid = CurrentThreadId();
+    fresh->thread_name = t_thread_name;
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        fresh->session = g_session.load(std::memory_order_relaxed);
+        fresh->events.resize(g_capacity);
+        g_buffers.push_back(fresh);
+    }
+    t_buffer = fresh;
+    return fresh.get();
+}
+
+void Record(char phase, const char* name, const char* category, const char* arg_name, double arg) {
+    uint64_t now = NowNs();
+    TraceBuffer* buffer = ThreadBuffer();
+
+    size_t n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= buffer->events.size()) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent& event = buffer->events[n];
+    event.name = name;
+    event.category = category;
+    event.arg_name = arg_name;
+    event.arg = arg;
+    event.ts_ns = now - g_start_ns.load(std::memory_order_relaxed);
+    event.phase = phase;
+
+    // Publish the event to TraceRender
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+void AppendJsonString(std::string* out, const char* text) {
+    out->push_back('"');
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            out->push_back('\\');
+        }
+        out->push_back(*p);
+    }
+    out->push_back('"');
+}
+
+} // namespace
+
+void TraceStart(size_t events_per_thread) {
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        g_buffers.clear();
+        g_capacity = events_per_thread;
+        g_start_ns = NowNs();
+        g_session.fetch_add(1, std::memory_order_release);
+    }
+    g_trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceStop() {
+    g_trace_enabled.store(false, std::memory_order_relaxed);
+}
+
+TraceSummary TraceRender(std::string* json) {
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        buffers = g_buffers;
+    }
+
+    TraceSummary summary;
+    summary.threads = buffers.size();
+
+    std::string pid = std::to_string(CurrentProcessId());
+    char number[64];
+
+    json->clear();
+    json->append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    json->append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":0,\"args\":{\"name\":\"ft8_lib\"}}");
+
+    for (const std::shared_ptr<TraceBuffer>& buffer : buffers) {
+        std::string ids = ",\"pid\":" + pid + ",\"tid\":" + std::to_string(buffer->tid);
+
+        const char* thread_name = buffer->thread_name.load();
+        if (thread_name) {
+            json->append(",\n{\"name\":\"thread_name\",\"ph\":\"M\"" + ids + ",\"args\":{\"name\":");
+            AppendJsonString(json, thread_name);
+            json->append("}}");
+        }
+
+        // Only events published before this point are read
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        summary.events += count;
+        summary.dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            json->append(",\n{\"name\":");
+            AppendJsonString(json, event.name);
+            json->append(",\"cat\":");
+            AppendJsonString(json, event.category);
+            snprintf(number, sizeof(number), ",\"ph\":\"%c\",\"ts\":%.3f", event.phase, event.ts_ns / 1000.0);
+            json->append(number);
+            json->append(ids);
+            if (event.phase == 'i') {
+                // Instant events are drawn across all threads
+                json->append(",\"s\":\"g\"");
+            }
+            if (event.arg_name) {
+                json->append(",\"args\":{");
+                AppendJsonString(json, event.arg_name);
+                snprintf(number, sizeof(number), ":%.17g}", event.arg);
+                json->append(number);
+            }
+            json->push_back('}');
+        }
+    }
+
+    json->append("\n]}\n");
+    return summary;
+}
+
+void TraceBegin(const char* name, const char* category) {
+    Record('B', name, category, nullptr, 0);
+}
+
+void TraceEnd(const char* name, const char* category, const char* arg_name, double arg) {
+    Record('E', name, category, arg_name, arg);
+}
+
+void TraceInstant(const char* name, const char* category) {
+    if (TraceEnabled()) {
+        Record('i', name, category, nullptr, 0);
+    }
+}
+
+void TraceSetThreadName(const char* name) {
+    t_thread_name = name;
+    if (t_buffer) {
+        t_buffer->thread_name = name;
+    }
+}
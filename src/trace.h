@@ -0,0 +1,121 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Opt-in timeline tracing in Chrome Trace Event format
+ *
+ * Every thread records into its own fixed-size buffer, so recording takes no
+ * lock: the owning thread writes an event and then publishes it by bumping the
+ * buffer's count. Buffers are registered once per thread and session. Event
+ * names and categories must be string literals; they are stored as pointers.
+ *
+ * While tracing is off a TraceScope costs one relaxed atomic load.
+ */
+
+/**
+ * Whether a trace session is recording
+ */
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool TraceEnabled() {
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Start a trace session, discarding any previous one
+ * @param events_per_thread Capacity of each thread's buffer; later events are dropped
+ */
+void TraceStart(size_t events_per_thread);
+
+/**
+ * Stop recording; spans already open still record their end
+ */
+void TraceStop();
+
+/**
+ * Totals of a rendered session
+ */
+struct TraceSummary {
+    size_t events = 0;
+    size_t dropped = 0;
+    size_t threads = 0;
+};
+
+/**
+ * Render the events of the last session as Chrome Trace Event JSON
+ *
+ * Safe to call from any thread, including while threads are still recording.
+ *
+ * @param json Receives the JSON document
+ * @return Event, drop and thread counts
+ */
+TraceSummary TraceRender(std::string* json);
+
+/**
+ * Record the beginning of a span on the calling thread
+ */
+void TraceBegin(const char* name, const char* category);
+
+/**
+ * Record the end of the innermost span on the calling thread
+ * @param arg_name Name of an optional numeric argument (nullptr for none)
+ * @param arg Argument value
+ */
+void TraceEnd(const char* name, const char* category, const char* arg_name = nullptr, double arg = 0);
+
+/**
+ * Record an instant event on the calling thread
+ */
+void TraceInstant(const char* name, const char* category);
+
+/**
+ * Name the calling thread in traces; applies to sessions started later too
+ * @param name Thread name, a string literal
+ */
+void TraceSetThreadName(const char* name);
+
+/**
+ * Records a span from construction to destruction
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category)
+        : name_(name), category_(category), active_(TraceEnabled()), arg_name_(nullptr), arg_(0) {
+        if (active_) {
+            TraceBegin(name_, category_);
+        }
+    }
+
+    ~TraceScope() {
+        if (active_) {
+            TraceEnd(name_, category_, arg_name_, arg_);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    /**
+     * Attach a numeric argument to the end event
+     * @param name Argument name, a string literal
+     * @param value Argument value
+     */
+    void SetArg(const char* name, double value) {
+        arg_name_ = name;
+        arg_ = value;
+    }
+
+private:
+    const char* name_;
+    const char* category_;
+    bool active_;
+    const char* arg_name_;
+    double arg_;
+};
+
+#endif // TRACE_H
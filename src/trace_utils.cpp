@@ -0,0 +1,111 @@
+#include "trace_utils.h"
+#include "trace.h"
+#include <cstdio>
+#include <string>
+
+// Events each thread can record in one session unless bufferSize says otherwise
+const size_t TRACE_DEFAULT_EVENTS_PER_THREAD = 1 << 16;
+
+namespace {
+
+/**
+ * Renders the finished session and writes it to a file on the libuv thread pool
+ */
+class TraceWriteWorker : public Napi::AsyncWorker {
+public:
+    TraceWriteWorker(Napi::Env env, const std::string& path)
+        : Napi::AsyncWorker(env, "ft8_lib:Trace.stop"),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(path) {
+    }
+    
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        std::string json;
+        summary_ = TraceRender(&json);
+        
+        FILE* file = fopen(path_.c_str(), "wb");
+        if (!file) {
+            SetError("Failed to open trace file: " + path_);
+            return;
+        }
+        
+        size_t written = fwrite(json.data(), 1, json.size(), file);
+        if (fclose(file) != 0 || written != json.size()) {
+            SetError("Failed to write trace file: " + path_);
+        }
+    }
+    
+    void OnOK() override {
+        Napi::Env env = Env();
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("path", Napi::String::New(env, path_));
+        result.Set("events", Napi::Number::New(env, (double)summary_.events));
+        result.Set("dropped", Napi::Number::New(env, (double)summary_.dropped));
+        result.Set("threads", Napi::Number::New(env, (double)summary_.threads));
+        
+        deferred_.Resolve(result);
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    TraceSummary summary_;
+};
+
+} // namespace
+
+Napi::Function TraceUtils::Start(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        
+        size_t capacity = TRACE_DEFAULT_EVENTS_PER_THREAD;
+        if (info.Length() > 0 && info[0].IsObject()) {
+            Napi::Object options = info[0].As<Napi::Object>();
+            if (options.Has("bufferSize")) {
+                int64_t value = options.Get("bufferSize").As<Napi::Number>().Int64Value();
+                if (value <= 0) {
+                    Napi::RangeError::New(env, "bufferSize must be positive").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                capacity = (size_t)value;
+            }
+        }
+        
+        TraceSetThreadName("main");
+        TraceStart(capacity);
+        return env.Undefined();
+    });
+}
+
+Napi::Function TraceUtils::Stop(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        // Recording ends now; rendering and writing happen off the main thread
+        TraceStop();
+        
+        TraceWriteWorker* worker = new TraceWriteWorker(env, info[0].As<Napi::String>().Utf8Value());
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    });
+}
+
+Napi::Function TraceUtils::IsEnabled(Napi::Env env) {
+    return Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        return Napi::Boolean::New(info.Env(), TraceEnabled());
+    });
+}
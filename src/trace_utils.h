@@ -0,0 +1,33 @@
+#ifndef TRACE_UTILS_H
+#define TRACE_UTILS_H
+
+#include <napi.h>
+
+/**
+ * TraceUtils exposes timeline tracing to JavaScript as Utils.Trace
+ */
+class TraceUtils {
+public:
+    /**
+     * Start a trace session
+     * @param env N-API environment
+     * @return N-API function that starts recording
+     */
+    static Napi::Function Start(Napi::Env env);
+    
+    /**
+     * Stop the trace session and write it as Chrome Trace Event JSON
+     * @param env N-API environment
+     * @return N-API function returning a Promise that resolves once the file is written
+     */
+    static Napi::Function Stop(Napi::Env env);
+    
+    /**
+     * Whether a trace session is recording
+     * @param env N-API environment
+     * @return N-API function returning a boolean
+     */
+    static Napi::Function IsEnabled(Napi::Env env);
+};
+
+#endif // TRACE_UTILS_H
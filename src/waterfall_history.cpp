@@ -0,0 +1,45 @@
+#include "waterfall_history.h"
+#include <algorithm>
+#include <cstring>
+
+WaterfallHistory::WaterfallHistory(int capacity)
+    : capacity_(std::max(capacity, 1)), times_(capacity_), oldest_(0), next_(0) {
+}
+
+void WaterfallHistory::Append(const WaterfallLayout& layout, const WF_ELEM_T* block, double utc_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Blocks of different layouts cannot share one array
+    if (layout != layout_) {
+        layout_ = layout;
+        mag_.assign((size_t)capacity_ * layout.block_stride, 0);
+        oldest_ = next_;
+    }
+
+    size_t slot = (size_t)(next_ % capacity_);
+    memcpy(mag_.data() + slot * layout_.block_stride, block, layout_.block_stride * sizeof(WF_ELEM_T));
+    times_[slot] = utc_time;
+    next_++;
+    if (next_ - oldest_ > (uint64_t)capacity_) {
+        oldest_ = next_ - capacity_;
+    }
+}
+
+void WaterfallHistory::Read(uint64_t since, Rows* rows) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    rows->first = std::min(std::max(since, oldest_), next_);
+    rows->next = next_;
+    rows->layout = layout_;
+
+    size_t count = (size_t)(rows->next - rows->first);
+    size_t stride = layout_.block_stride;
+    rows->mag.resize(count * stride);
+    rows->times.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t slot = (size_t)((rows->first + i) % capacity_);
+        memcpy(rows->mag.data() + i * stride, mag_.data() + slot * stride, stride * sizeof(WF_ELEM_T));
+        rows->times[i] = times_[slot];
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef WATERFALL_HISTORY_H
+#define WATERFALL_HISTORY_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "decoder_core.h"
+
+/**
+ * The most recent waterfall blocks of a stream, for display
+ *
+ * A receiver thread appends each block as the monitor produces it; readers
+ * fetch the blocks added since the last one they saw. Blocks are numbered
+ * from 0 in order of arrival, and the oldest are dropped once the capacity
+ * is reached. Safe to use from any thread.
+ */
+class WaterfallHistory {
+public:
+    /**
+     * @param capacity Number of blocks kept
+     */
+    explicit WaterfallHistory(int capacity);
+
+    /**
+     * Blocks copied out of the history
+     */
+    struct Rows {
+        // Number of the first block in mag, and of the next block to be appended
+        uint64_t first = 0;
+        uint64_t next = 0;
+        WaterfallLayout layout;
+        // (next - first) blocks of layout.block_stride magnitudes
+        std::vector<WF_ELEM_T> mag;
+        // UTC start time in ms of each block
+        std::vector<double> times;
+    };
+
+    /**
+     * Append one block; a change of layout drops the blocks kept so far
+     * @param layout Layout of the block
+     * @param block layout.block_stride magnitudes
+     * @param utc_time UTC start time of the block in ms
+     */
+    void Append(const WaterfallLayout& layout, const WF_ELEM_T* block, double utc_time);
+
+    /**
+     * Copy the blocks appended since a given block number
+     * @param since First block wanted; older blocks that were dropped are skipped
+     * @param rows Receives the blocks
+     */
+    void Read(uint64_t since, Rows* rows) const;
+
+private:
+    const int capacity_;
+
+    mutable std::mutex mutex_;
+    WaterfallLayout layout_;
+    std::vector<WF_ELEM_T> mag_;
+    std::vector<double> times_;
+    uint64_t oldest_;
+    uint64_t next_;
+};
+
+#endif // WATERFALL_HISTORY_H
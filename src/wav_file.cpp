@@ -0,0 +1,337 @@
+#include "wav_file.h"
+#include "pcm_convert.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// Frames converted per fread; bounds the raw buffer to a few hundred KB
+const size_t WAV_READ_CHUNK_FRAMES = 16384;
+
+// WAVE format tags
+const uint16_t WAVE_FORMAT_PCM = 0x0001;
+const uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+namespace {
+
+uint16_t ReadLe16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool SeekFile(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+void WriteLe16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void WriteLe32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint64_t FileSize(FILE* file) {
+#ifdef _WIN32
+    _fseeki64(file, 0, SEEK_END);
+    uint64_t size = (uint64_t)_ftelli64(file);
+#else
+    fseeko(file, 0, SEEK_END);
+    uint64_t size = (uint64_t)ftello(file);
+#endif
+    return size;
+}
+
+} // namespace
+
+WavFile::WavFile()
+    : file_(nullptr), sample_rate_(0), channels_(0), bits_per_sample_(0), is_float_(false),
+      frame_bytes_(0), data_offset_(0), num_frames_(0), position_(0) {
+}
+
+WavFile::~WavFile() {
+    Close();
+}
+
+void WavFile::Close() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool WavFile::Open(const std::string& path, std::string* error) {
+    Close();
+
+    file_ = fopen(path.c_str(), "rb");
+    if (!file_) {
+        if (error) *error = "Failed to open WAV file: " + path;
+        return false;
+    }
+
+    uint64_t file_size = FileSize(file_);
+    SeekFile(file_, 0);
+
+    uint8_t riff[12];
+    if (fread(riff, 1, sizeof(riff), file_) != sizeof(riff) ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        if (error) *error = "Not a RIFF/WAVE file: " + path;
+        Close();
+        return false;
+    }
+
+    bool have_format = false;
+    uint16_t format_tag = 0;
+    uint64_t offset = sizeof(riff);
+
+    // Walk the chunk list until the data chunk; fmt must come first
+    while (true) {
+        uint8_t header[8];
+        if (!SeekFile(file_, offset) || fread(header, 1, sizeof(header), file_) != sizeof(header)) {
+            if (error) *error = "WAV file has no data chunk: " + path;
+            Close();
+            return false;
+        }
+
+        uint32_t chunk_size = ReadLe32(header + 4);
+        offset += sizeof(header);
+
+        if (memcmp(header, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {0};
+            size_t fmt_size = std::min<size_t>(chunk_size, sizeof(fmt));
+            if (chunk_size < 16 || fread(fmt, 1, fmt_size, file_) != fmt_size) {
+                if (error) *error = "Invalid WAV format chunk: " + path;
+                Close();
+                return false;
+            }
+
+            format_tag = ReadLe16(fmt);
+            channels_ = ReadLe16(fmt + 2);
+            sample_rate_ = (int)ReadLe32(fmt + 4);
+            bits_per_sample_ = ReadLe16(fmt + 14);
+
+            // The real format of an extensible header is in the first bytes of its sub-format GUID
+            if (format_tag == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 40) {
+                format_tag = ReadLe16(fmt + 24);
+            }
+            have_format = true;
+        } else if (memcmp(header, "data", 4) == 0) {
+            if (!have_format) {
+                if (error) *error = "WAV data chunk before format chunk: " + path;
+                Close();
+                return false;
+            }
+            data_offset_ = offset;
+
+            // Recorders that were interrupted leave a bogus size; trust the file length instead
+            uint64_t data_size = chunk_size;
+            if (data_size == 0 || data_size == 0xFFFFFFFFu || data_offset_ + data_size > file_size) {
+                data_size = file_size - data_offset_;
+            }
+
+            is_float_ = (format_tag == WAVE_FORMAT_IEEE_FLOAT);
+            bool supported = (format_tag == WAVE_FORMAT_PCM &&
+                              (bits_per_sample_ == 8 || bits_per_sample_ == 16 ||
+                               bits_per_sample_ == 24 || bits_per_sample_ == 32)) ||
+                             (is_float_ && (bits_per_sample_ == 32 || bits_per_sample_ == 64));
+            if (!supported || channels_ < 1 || sample_rate_ <= 0) {
+                if (error) *error = "Unsupported WAV sample format (" + std::to_string(bits_per_sample_) +
+                                    "-bit, format tag " + std::to_string(format_tag) + "): " + path;
+                Close();
+                return false;
+            }
+
+            frame_bytes_ = channels_ * (bits_per_sample_ / 8);
+            num_frames_ = data_size / frame_bytes_;
+            position_ = 0;
+            return SeekFile(file_, data_offset_);
+        }
+
+        // Chunks are word aligned
+        offset += chunk_size + (chunk_size & 1);
+    }
+}
+
+bool WavFile::Seek(uint64_t frame) {
+    if (!file_) {
+        return false;
+    }
+    position_ = std::min(frame, num_frames_);
+    return SeekFile(file_, data_offset_ + position_ * frame_bytes_);
+}
+
+size_t WavFile::Read(float* out, size_t max_frames) {
+    if (!file_) {
+        return 0;
+    }
+
+    size_t total = 0;
+    max_frames = (size_t)std::min<uint64_t>(max_frames, num_frames_ - position_);
+
+    while (total < max_frames) {
+        size_t want = std::min(WAV_READ_CHUNK_FRAMES, max_frames - total);
+        raw_.resize(want * frame_bytes_);
+
+        size_t got = fread(raw_.data(), frame_bytes_, want, file_);
+        if (got == 0) {
+            break;
+        }
+
+        ConvertFrames(raw_.data(), got, out + total);
+        total += got;
+        position_ += got;
+
+        if (got < want) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+void WavFile::ConvertFrames(const uint8_t* raw, size_t num_frames, float* out) const {
+    const int bytes = bits_per_sample_ / 8;
+    const float channel_scale = 1.0f / channels_;
+
+    // The common 16-bit mono/stereo layouts go through the vectorized converter
+    if (!is_float_ && bytes == 2 && channels_ <= 2) {
+        ConvertPcm16ToFloat(raw, num_frames, channels_, PCM_LITTLE_ENDIAN, out);
+        return;
+    }
+
+    for (size_t i = 0; i < num_frames; ++i) {
+        const uint8_t* frame = raw + i * frame_bytes_;
+        float sum = 0.0f;
+
+        for (int ch = 0; ch < channels_; ++ch) {
+            const uint8_t* p = frame + ch * bytes;
+            float value;
+
+            if (is_float_) {
+                if (bytes == 4) {
+                    uint32_t bits = ReadLe32(p);
+                    memcpy(&value, &bits, sizeof(value));
+                } else {
+                    uint64_t bits = (uint64_t)ReadLe32(p) | ((uint64_t)ReadLe32(p + 4) << 32);
+                    double d;
+                    memcpy(&d, &bits, sizeof(d));
+                    value = (float)d;
+                }
+            } else if (bytes == 1) {
+                value = ((int)p[0] - 128) / 128.0f;
+            } else if (bytes == 2) {
+                value = (int16_t)ReadLe16(p) / 32768.0f;
+            } else if (bytes == 3) {
+                int32_t v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+                value = v / 8388608.0f;
+            } else {
+                value = (int32_t)ReadLe32(p) / 2147483648.0f;
+            }
+
+            sum += value;
+        }
+
+        out[i] = (channels_ == 1) ? sum : sum * channel_scale;
+    }
+}
+
+WavSlotLayout ComputeSlotLayout(int sample_rate, uint64_t num_frames, float slot_time,
+                                bool has_start_time, double start_time_ms) {
+    WavSlotLayout layout;
+    layout.slot_samples = (int)std::lround(slot_time * sample_rate);
+    if (layout.slot_samples <= 0) {
+        return layout;
+    }
+
+    // With a known start time, slots follow the UTC slot grid and the first one is padded
+    if (has_start_time) {
+        double slot_ms = slot_time * 1000.0;
+        double offset_ms = std::fmod(start_time_ms, slot_ms);
+        if (offset_ms < 0) {
+            offset_ms += slot_ms;
+        }
+        layout.lead_samples = (int64_t)std::llround(offset_ms * sample_rate / 1000.0) % layout.slot_samples;
+    }
+
+    int64_t total = (int64_t)num_frames + layout.lead_samples;
+    layout.num_slots = (total + layout.slot_samples - 1) / layout.slot_samples;
+    return layout;
+}
+
+bool ReadWavSlot(WavFile* file, const WavSlotLayout& layout, int64_t slot_index,
+                 float* out, int* valid_samples) {
+    std::fill(out, out + layout.slot_samples, 0.0f);
+    *valid_samples = 0;
+
+    if (!file->IsOpen()) {
+        return true;
+    }
+
+    int64_t file_start = slot_index * layout.slot_samples - layout.lead_samples;
+    int64_t skip = std::max<int64_t>(0, -file_start);
+    uint64_t first_frame = (uint64_t)std::max<int64_t>(0, file_start);
+
+    if (!file->Seek(first_frame)) {
+        return false;
+    }
+
+    *valid_samples = (int)file->Read(out + skip, (size_t)(layout.slot_samples - skip));
+    return true;
+}
+
+bool WriteWav16(const std::string& path, const float* samples, size_t num_samples,
+                int sample_rate, std::string* error) {
+    const uint32_t data_size = (uint32_t)(num_samples * sizeof(int16_t));
+    if (num_samples > (0xFFFFFFFFu - 36) / sizeof(int16_t)) {
+        if (error) *error = "Audio too long for a WAV file: " + path;
+        return false;
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "Failed to create WAV file: " + path;
+        return false;
+    }
+
+    uint8_t header[44];
+    memcpy(header, "RIFF", 4);
+    WriteLe32(header + 4, 36 + data_size);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    WriteLe32(header + 16, 16);
+    WriteLe16(header + 20, WAVE_FORMAT_PCM);
+    WriteLe16(header + 22, 1);
+    WriteLe32(header + 24, (uint32_t)sample_rate);
+    WriteLe32(header + 28, (uint32_t)sample_rate * sizeof(int16_t));
+    WriteLe16(header + 32, sizeof(int16_t));
+    WriteLe16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    WriteLe32(header + 40, data_size);
+
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    uint8_t raw[WAV_READ_CHUNK_FRAMES * sizeof(int16_t)];
+    for (size_t offset = 0; ok && offset < num_samples; offset += WAV_READ_CHUNK_FRAMES) {
+        size_t count = std::min(WAV_READ_CHUNK_FRAMES, num_samples - offset);
+        ConvertFloatToPcm16(samples + offset, count, PCM_LITTLE_ENDIAN, nullptr, raw);
+        ok = fwrite(raw, sizeof(int16_t), count, file) == count;
+    }
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok && error) {
+        *error = "Failed to write WAV file: " + path;
+    }
+    return ok;
+}
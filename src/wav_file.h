@@ -0,0 +1,147 @@
+#ifndef WAV_FILE_H
+#define WAV_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * WavFile streams samples out of a RIFF/WAVE file
+ *
+ * Unlike ft8_lib's load_wav this reader never holds the whole file in memory:
+ * samples are read in bounded chunks, converted to float and downmixed to mono
+ * on the fly. Supports 8/16/24/32-bit integer PCM and 32/64-bit IEEE float,
+ * including WAVE_FORMAT_EXTENSIBLE headers, and files larger than 2 GB.
+ *
+ * This class has no Node.js dependencies so it can be used from worker threads
+ * and from native tools.
+ */
+class WavFile {
+public:
+    WavFile();
+    ~WavFile();
+
+    WavFile(const WavFile&) = delete;
+    WavFile& operator=(const WavFile&) = delete;
+
+    /**
+     * Open a WAV file and parse its header
+     * @param path File path
+     * @param error Receives a description of the problem on failure
+     * @return true on success
+     */
+    bool Open(const std::string& path, std::string* error);
+
+    /**
+     * Close the file (also done by the destructor)
+     */
+    void Close();
+
+    bool IsOpen() const { return file_ != nullptr; }
+    int SampleRate() const { return sample_rate_; }
+    int Channels() const { return channels_; }
+    int BitsPerSample() const { return bits_per_sample_; }
+    bool IsFloat() const { return is_float_; }
+
+    /**
+     * Number of sample frames (samples per channel) in the file
+     */
+    uint64_t NumFrames() const { return num_frames_; }
+
+    /**
+     * Current read position in frames
+     */
+    uint64_t Position() const { return position_; }
+
+    /**
+     * Move the read position
+     * @param frame Frame index to continue reading from (clamped to the end of data)
+     * @return true on success
+     */
+    bool Seek(uint64_t frame);
+
+    /**
+     * Read frames as mono float samples in [-1.0, 1.0], averaging all channels
+     * @param out Output buffer for at least max_frames samples
+     * @param max_frames Maximum number of frames to read
+     * @return Number of frames actually read (0 at end of data or on error)
+     */
+    size_t Read(float* out, size_t max_frames);
+
+private:
+    FILE* file_;
+    int sample_rate_;
+    int channels_;
+    int bits_per_sample_;
+    bool is_float_;
+    int frame_bytes_;
+    uint64_t data_offset_;
+    uint64_t num_frames_;
+    uint64_t position_;
+
+    // Raw bytes of the chunk being converted
+    std::vector<uint8_t> raw_;
+
+    /**
+     * Convert raw interleaved frames to mono float
+     * @param raw Raw frame bytes
+     * @param num_frames Number of frames in raw
+     * @param out Output mono samples
+     */
+    void ConvertFrames(const uint8_t* raw, size_t num_frames, float* out) const;
+};
+
+/**
+ * Position of fixed-length slots within a recording
+ */
+struct WavSlotLayout {
+    // Samples per slot
+    int slot_samples = 0;
+    // Zero padding in front of the first slot, so slots follow the UTC slot grid
+    int64_t lead_samples = 0;
+    // Number of slots needed to cover the whole file
+    int64_t num_slots = 0;
+};
+
+/**
+ * Compute the slot layout of a recording
+ * @param sample_rate Sample rate of the recording
+ * @param num_frames Length of the recording in frames
+ * @param slot_time Slot length in seconds
+ * @param has_start_time Whether start_time_ms is known
+ * @param start_time_ms UTC time of the first sample in ms since the epoch
+ * @return Slot layout
+ */
+WavSlotLayout ComputeSlotLayout(int sample_rate, uint64_t num_frames, float slot_time,
+                                bool has_start_time, double start_time_ms);
+
+/**
+ * Read one slot of a recording, zero padding whatever lies outside the file
+ * @param file Open WAV file
+ * @param layout Slot layout of the file
+ * @param slot_index Slot to read
+ * @param out Output buffer for layout.slot_samples samples
+ * @param valid_samples Receives the number of samples that came from the file
+ * @return false on seek error
+ */
+bool ReadWavSlot(WavFile* file, const WavSlotLayout& layout, int64_t slot_index,
+                 float* out, int* valid_samples);
+
+/**
+ * Write mono float samples as a 16-bit PCM WAV file
+ *
+ * Samples are clipped to [-1.0, 1.0] and converted in bounded chunks straight
+ * from the caller's buffer, so no copy of the whole signal is made.
+ *
+ * @param path File path
+ * @param samples Mono samples
+ * @param num_samples Number of samples
+ * @param sample_rate Sample rate in Hz
+ * @param error Receives a description of the problem on failure
+ * @return true on success
+ */
+bool WriteWav16(const std::string& path, const float* samples, size_t num_samples,
+                int sample_rate, std::string* error);
+
+#endif // WAV_FILE_H
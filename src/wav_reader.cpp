@@ -0,0 +1,211 @@
+#include "wav_reader.h"
+#include "audio_utils.h"
+#include "trace.h"
+#include <cmath>
+
+namespace {
+
+/**
+ * Reads one slot on a worker thread and settles the promise returned by next()
+ */
+class ReadSlotWorker : public Napi::AsyncWorker {
+public:
+    ReadSlotWorker(Napi::Env env, WavReader* reader, int64_t slot_index)
+        : Napi::AsyncWorker(env, "ft8_lib:WavReader.next"),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          reader_(reader),
+          reader_ref_(Napi::Persistent(reader->Value())),
+          slot_index_(slot_index),
+          samples_(new std::vector<float>()),
+          valid_samples_(0) {
+    }
+
+    ~ReadSlotWorker() {
+        delete samples_;
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        TraceScope trace("readSlot", "audio");
+        if (!reader_->ReadSlot(slot_index_, samples_, &valid_samples_)) {
+            SetError("Failed to read WAV file");
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+
+        int64_t start_sample = slot_index_ * reader_->SlotSamples() - reader_->LeadSamples();
+
+        Napi::Object slot = Napi::Object::New(env);
+        slot.Set("samples", AudioUtils::WrapSamples(env, samples_));
+        samples_ = nullptr;
+        slot.Set("sampleRate", Napi::Number::New(env, reader_->SampleRate()));
+        slot.Set("channels", Napi::Number::New(env, 1));
+        slot.Set("index", Napi::Number::New(env, (double)slot_index_));
+        slot.Set("startSample", Napi::Number::New(env, (double)start_sample));
+        slot.Set("startTime", Napi::Number::New(env, (double)start_sample / reader_->SampleRate()));
+        slot.Set("validSamples", Napi::Number::New(env, valid_samples_));
+        if (reader_->HasStartTime()) {
+            double utc = reader_->StartTime() + 1000.0 * start_sample / reader_->SampleRate();
+            slot.Set("utcStart", Napi::Number::New(env, std::round(utc)));
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("value", slot);
+        result.Set("done", Napi::Boolean::New(env, false));
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    WavReader* reader_;
+    Napi::ObjectReference reader_ref_;
+    int64_t slot_index_;
+    std::vector<float>* samples_;
+    int valid_samples_;
+};
+
+Napi::Object DoneResult(Napi::Env env) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("value", env.Undefined());
+    result.Set("done", Napi::Boolean::New(env, true));
+    return result;
+}
+
+} // namespace
+
+Napi::Function WavReader::Init(Napi::Env env) {
+    Napi::Function func = DefineClass(env, "WavReader", {
+        InstanceMethod("next", &WavReader::Next),
+        InstanceMethod("return", &WavReader::Return),
+        InstanceMethod("close", &WavReader::Close),
+        InstanceMethod("getInfo", &WavReader::GetInfo),
+        InstanceMethod(Napi::Symbol::WellKnown(env, "asyncIterator"), &WavReader::AsyncIterator)
+    });
+
+    return func;
+}
+
+WavReader::WavReader(const Napi::CallbackInfo& info) : Napi::ObjectWrap<WavReader>(info) {
+    Napi::Env env = info.Env();
+
+    closed_ = true;
+    protocol_ = FTX_PROTOCOL_FT8;
+    sample_rate_ = 0;
+    next_slot_ = 0;
+    start_time_ = 0;
+    has_start_time_ = false;
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string filePath = info[0].As<Napi::String>().Utf8Value();
+
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+
+        if (options.Has("protocol")) {
+            std::string protocol = options.Get("protocol").As<Napi::String>().Utf8Value();
+            if (protocol == "FT8") {
+                protocol_ = FTX_PROTOCOL_FT8;
+            } else if (protocol == "FT4") {
+                protocol_ = FTX_PROTOCOL_FT4;
+            } else {
+                Napi::TypeError::New(env, "Invalid protocol. Must be 'FT8' or 'FT4'").ThrowAsJavaScriptException();
+                return;
+            }
+        }
+
+        if (options.Has("startTime")) {
+            Napi::Value start = options.Get("startTime");
+            if (start.IsDate()) {
+                start_time_ = start.As<Napi::Date>().ValueOf();
+                has_start_time_ = true;
+            } else if (start.IsNumber()) {
+                start_time_ = start.As<Napi::Number>().DoubleValue();
+                has_start_time_ = true;
+            }
+        }
+    }
+
+    std::string error;
+    if (!file_.Open(filePath, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return;
+    }
+    closed_ = false;
+
+    float slot_time = (protocol_ == FTX_PROTOCOL_FT8) ? FT8_SLOT_TIME : FT4_SLOT_TIME;
+    sample_rate_ = file_.SampleRate();
+    layout_ = ComputeSlotLayout(sample_rate_, file_.NumFrames(), slot_time, has_start_time_, start_time_);
+}
+
+bool WavReader::ReadSlot(int64_t slot_index, std::vector<float>* samples, int* valid_samples) {
+    samples->resize(layout_.slot_samples);
+
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    return ReadWavSlot(&file_, layout_, slot_index, samples->data(), valid_samples);
+}
+
+Napi::Value WavReader::Next(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (closed_ || next_slot_ >= layout_.num_slots) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(DoneResult(env));
+        return deferred.Promise();
+    }
+
+    // Slot indices are handed out here, so reads that overlap still come back in order
+    ReadSlotWorker* worker = new ReadSlotWorker(env, this, next_slot_++);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value WavReader::Return(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Close(info);
+
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(DoneResult(env));
+    return deferred.Promise();
+}
+
+Napi::Value WavReader::AsyncIterator(const Napi::CallbackInfo& info) {
+    return info.This();
+}
+
+void WavReader::Close(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    file_.Close();
+    closed_ = true;
+}
+
+Napi::Value WavReader::GetInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("sampleRate", Napi::Number::New(env, sample_rate_));
+    result.Set("channels", Napi::Number::New(env, file_.Channels()));
+    result.Set("bitsPerSample", Napi::Number::New(env, file_.BitsPerSample()));
+    result.Set("format", Napi::String::New(env, file_.IsFloat() ? "float" : "int"));
+    result.Set("totalSamples", Napi::Number::New(env, (double)file_.NumFrames()));
+    result.Set("duration", Napi::Number::New(env, sample_rate_ > 0 ? (double)file_.NumFrames() / sample_rate_ : 0.0));
+    result.Set("protocol", Napi::String::New(env, (protocol_ == FTX_PROTOCOL_FT8) ? "FT8" : "FT4"));
+    result.Set("slotSamples", Napi::Number::New(env, layout_.slot_samples));
+    result.Set("leadSamples", Napi::Number::New(env, (double)layout_.lead_samples));
+    result.Set("numSlots", Napi::Number::New(env, (double)layout_.num_slots));
+
+    return result;
+}
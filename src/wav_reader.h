@@ -0,0 +1,104 @@
+#ifndef WAV_READER_H
+#define WAV_READER_H
+
+#include <napi.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "wav_file.h"
+
+extern "C" {
+#include <ft8/constants.h>
+}
+
+/**
+ * WavReader class iterates over a WAV file one FT8/FT4 slot at a time
+ *
+ * Objects are created by Utils.Audio.openWav() and implement the async
+ * iterator protocol, so recordings of any length can be processed with
+ * `for await (const slot of Utils.Audio.openWav(path))`. Each slot is read
+ * and converted on a worker thread; only the slots still referenced from
+ * JavaScript stay in memory.
+ */
+class WavReader : public Napi::ObjectWrap<WavReader> {
+public:
+    /**
+     * Initialize the WavReader class for Node.js
+     * @param env N-API environment
+     * @return Constructor function
+     */
+    static Napi::Function Init(Napi::Env env);
+    
+    /**
+     * Constructor
+     * @param info Callback info containing file path and optional options
+     */
+    WavReader(const Napi::CallbackInfo& info);
+    
+    /**
+     * Read one slot from the file (called from worker threads)
+     * @param slot_index Index of the slot
+     * @param samples Output buffer, resized to a whole slot and zero padded
+     * @param valid_samples Receives the number of samples that came from the file
+     * @return false on read error
+     */
+    bool ReadSlot(int64_t slot_index, std::vector<float>* samples, int* valid_samples);
+    
+    int SampleRate() const { return sample_rate_; }
+    int SlotSamples() const { return layout_.slot_samples; }
+    int64_t LeadSamples() const { return layout_.lead_samples; }
+    double StartTime() const { return start_time_; }
+    bool HasStartTime() const { return has_start_time_; }
+
+private:
+    /**
+     * Read the next slot
+     * @param info Callback info (unused)
+     * @return Promise resolving to an iterator result { value, done }
+     */
+    Napi::Value Next(const Napi::CallbackInfo& info);
+    
+    /**
+     * Stop iterating and close the file
+     * @param info Callback info (unused)
+     * @return Promise resolving to { value: undefined, done: true }
+     */
+    Napi::Value Return(const Napi::CallbackInfo& info);
+    
+    /**
+     * Return this object, making the reader usable with for await
+     * @param info Callback info (unused)
+     * @return This reader
+     */
+    Napi::Value AsyncIterator(const Napi::CallbackInfo& info);
+    
+    /**
+     * Close the file; pending reads complete, later reads report done
+     * @param info Callback info (unused)
+     */
+    void Close(const Napi::CallbackInfo& info);
+    
+    /**
+     * Describe the file and slot layout
+     * @param info Callback info (unused)
+     * @return Object with sample rate, format and slot counts
+     */
+    Napi::Value GetInfo(const Napi::CallbackInfo& info);
+    
+    // File being read; guarded by file_mutex_ since reads run on worker threads
+    WavFile file_;
+    std::mutex file_mutex_;
+    bool closed_;
+    
+    // Slot layout
+    ftx_protocol_t protocol_;
+    int sample_rate_;
+    WavSlotLayout layout_;
+    int64_t next_slot_;
+    
+    // UTC time of the first sample in milliseconds since the epoch, if known
+    double start_time_;
+    bool has_start_time_;
+};
+
+#endif // WAV_READER_H
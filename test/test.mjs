@@ -1,10 +1,13 @@
 // Node.js comprehensive test program corresponding to ft8_lib/test/test.c
 // Tests message encoding/decoding and WAV file decoding
 
-import { MessageEncoder, MessageDecoder, Utils } from '../index.mjs';
+import { MessageEncoder, MessageDecoder, RingReceiver, SlotScheduler, LoadController, Utils } from '../index.mjs';
+import { spawnSync } from 'child_process';
 import fs from 'fs';
+import os from 'os';
 import path from 'path';
 import { fileURLToPath } from 'url';
+import { Worker } from 'worker_threads';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -87,6 +90,1329 @@ class FT8ComprehensiveTest {
         }
     }
 
+    // Test batch encoding against single-message encoding
+    testEncodeBatch() {
+        try {
+            this.totalTests++;
+            console.log('Testing: encodeBatch');
+            
+            const messages = [];
+            for (const callsign1 of CALLSIGNS) {
+                for (const grid of GRIDS.slice(0, 4)) {
+                    messages.push(`CQ ${callsign1} ${grid}`);
+                }
+            }
+            messages.push("NOT A VALID MESSAGE AT ALL");
+            
+            const batch = this.encoder.encodeBatch(messages);
+            CHECK(batch.count === messages.length, "Batch count mismatch");
+            CHECK(batch.payloads.length === messages.length * 10, "Payload array size mismatch");
+            CHECK(batch.tones.length === messages.length * batch.tonesPerMessage, "Tone array size mismatch");
+            
+            messages.forEach((text, i) => {
+                if (batch.status[i] !== 0) {
+                    return;
+                }
+                const single = this.encoder.encode(text);
+                const tones = batch.tones.subarray(i * batch.tonesPerMessage, (i + 1) * batch.tonesPerMessage);
+                CHECK(tones.every((tone, j) => tone === single.tones[j]), `Batch tones differ for "${text}"`);
+                CHECK(batch.hashes[i] === single.hash, `Batch hash differs for "${text}"`);
+            });
+            CHECK(batch.status[messages.length - 1] !== 0, "Invalid message should report a non-zero status");
+            
+            this.passedTests++;
+            TEST_END('Batch encoding');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Batch encoding test failed: ${error.message}`);
+        }
+    }
+
+    // Test single-pass and batch message analysis
+    testMessageAnalysis() {
+        try {
+            this.totalTests++;
+            console.log('Testing: message analysis');
+            
+            const texts = [
+                "K1ABC W9XYZ -15",
+                "CQ W1ABC FN42",
+                "HELLO WORLD",
+                "NOT A VALID MESSAGE AT ALL",
+                ""
+            ];
+            for (const callsign of CALLSIGNS) {
+                texts.push(`CQ ${callsign} ${GRIDS[0]}`, `${callsign} K1ABC RR73`);
+            }
+            
+            // analyze() agrees with the single-purpose helpers and the encoder
+            for (const text of texts) {
+                const info = Utils.Message.analyze(text);
+                CHECK(info.valid === Utils.Message.isValidMessage(text, 'FT8'), `Validity differs for "${text}"`);
+                CHECK(info.type === Utils.Message.getMessageType(text), `Type differs for "${text}"`);
+                CHECK(JSON.stringify(info.standard) === JSON.stringify(Utils.Message.parseStandardMessage(text)), `Fields differ for "${text}"`);
+                CHECK(info.valid === (info.status === 0) && info.valid === (info.error === null), `Status differs for "${text}"`);
+                if (info.valid) {
+                    const encoded = this.encoder.encode(text);
+                    CHECK(info.payload.every((b, i) => b === encoded.payload[i]), `Payload differs for "${text}"`);
+                } else {
+                    CHECK(info.payload === null && info.type === 'UNKNOWN', `Invalid message "${text}" has a payload or type`);
+                }
+            }
+            
+            const standard = Utils.Message.analyze("K1ABC W9XYZ -15");
+            CHECK(standard.type === 'STANDARD' && standard.standard.callDe === 'W9XYZ', "Standard fields not parsed");
+            
+            // The batch matches analyze() entry by entry, also when split across threads and chunks
+            const many = [];
+            for (let i = 0; i < 70000; i++) {
+                many.push(texts[i % texts.length]);
+            }
+            const batch = Utils.Message.analyzeBatch(many);
+            CHECK(batch.count === many.length && batch.payloads.length === many.length * 10, "Batch size mismatch");
+            for (let i = 0; i < many.length; i += 997) {
+                const info = Utils.Message.analyze(many[i]);
+                CHECK(!!batch.valid[i] === info.valid && batch.status[i] === info.status, `Batch status differs at ${i}`);
+                CHECK(batch.typeNames[batch.types[i]] === info.type, `Batch type differs at ${i}`);
+                CHECK(batch.callDe[i] === (info.standard ? info.standard.callDe : null), `Batch fields differ at ${i}`);
+                const payload = batch.payloads.subarray(i * 10, i * 10 + 10);
+                CHECK(info.valid ? payload.every((b, j) => b === info.payload[j]) : payload.every(b => b === 0), `Batch payload differs at ${i}`);
+            }
+            CHECK(Utils.Message.analyzeBatch([]).count === 0, "Empty batch");
+            
+            let threw = false;
+            try {
+                Utils.Message.analyzeBatch(["CQ W1ABC FN42", 42]);
+            } catch (error) {
+                threw = true;
+            }
+            CHECK(threw, "Non-string accepted");
+            
+            this.passedTests++;
+            TEST_END('message analysis');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Message analysis test failed: ${error.message}`);
+        }
+    }
+
+    // Test synthetic band generation: determinism and decodability
+    testSynthesizeBand() {
+        try {
+            this.totalTests++;
+            console.log('Testing: synthesizeBand');
+            
+            const options = {
+                protocol: 'FT8',
+                sampleRate: 12000,
+                signals: 8,
+                noiseDb: -30,
+                snrMin: -5,
+                snrMax: 5,
+                seed: 1234
+            };
+            const band = Utils.Audio.synthesizeBand(options);
+            const again = Utils.Audio.synthesizeBand(options);
+            CHECK(band.signals.length === 8, "Ground truth length mismatch");
+            CHECK(band.audio.samples.length === 15 * 12000, "Unexpected band length");
+            CHECK(band.audio.samples.every((v, i) => v === again.audio.samples[i]), "Same seed produced different audio");
+            
+            const decoded = this.decoder.decode(band.audio).map(msg => msg.text);
+            const found = band.signals.filter(sig => decoded.includes(sig.text)).length;
+            console.log(`  Decoded ${found}/${band.signals.length} synthesized signals`);
+            CHECK(found > band.signals.length / 2, "Too few synthesized signals decoded");
+            
+            for (const duration of [-1, 0, NaN, Infinity]) {
+                let threw = false;
+                try {
+                    Utils.Audio.synthesizeBand({ signals: 1, duration });
+                } catch (error) {
+                    threw = error instanceof RangeError;
+                }
+                CHECK(threw, `duration ${duration} accepted`);
+            }
+            
+            this.passedTests++;
+            TEST_END('Synthetic band');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Synthetic band test failed: ${error.message}`);
+        }
+    }
+
+    // Test CPU feature reporting and that the baseline kernels decode the same as the selected ones
+    testCpuFeatures() {
+        try {
+            this.totalTests++;
+            console.log('Testing: getCpuFeatures');
+            
+            const cpu = Utils.getCpuFeatures();
+            const names = ['baseline', 'avx2', 'avx512', 'neon'];
+            CHECK(typeof cpu.features.avx2 === 'boolean' && typeof cpu.features.neon === 'boolean', "Missing feature flags");
+            CHECK(names.includes(cpu.kernels), `Unknown kernel variant ${cpu.kernels}`);
+            CHECK(cpu.availableKernels.includes(cpu.kernels), "Selected kernels are not compiled in");
+            CHECK(cpu.monitorKernels === cpu.kernels || cpu.monitorKernels === 'baseline', `Monitor variant ${cpu.monitorKernels} does not follow ${cpu.kernels}`);
+            CHECK(cpu.kernels !== 'avx2' || cpu.features.avx2, "AVX2 kernels selected without AVX2");
+            CHECK(cpu.kernels !== 'avx512' || cpu.features.avx512f, "AVX-512 kernels selected without AVX-512");
+            console.log(`  Kernels: ${cpu.kernels} (compiled: ${cpu.availableKernels.join(', ')}), PCM: ${cpu.pcmKernels}`);
+            
+            // Decode the same band in a process forced onto the baseline kernels
+            const options = { protocol: 'FT8', signals: 6, snrMin: -15, snrMax: 0, seed: 777 };
+            const summarize = (messages) => messages.map(msg => `${msg.text}@${msg.frequency.toFixed(2)}/${msg.snr.toFixed(1)}`).sort();
+            const checksum = (mag) => mag.reduce((hash, value) => (hash * 31 + value) >>> 0, 0);
+            const band = Utils.Audio.synthesizeBand(options);
+            const selected = new MessageDecoder();
+            const expected = summarize(selected.decode(band.audio));
+            const waterfall = checksum(selected.getWaterfall().mag);
+            
+            const script = `
+                import { MessageDecoder, Utils } from ${JSON.stringify(path.join(__dirname, '..', 'index.mjs'))};
+                const band = Utils.Audio.synthesizeBand(${JSON.stringify(options)});
+                const decoder = new MessageDecoder();
+                const messages = decoder.decode(band.audio);
+                const waterfall = decoder.getWaterfall().mag.reduce((hash, value) => (hash * 31 + value) >>> 0, 0);
+                const { kernels, monitorKernels } = Utils.getCpuFeatures();
+                console.log(JSON.stringify({ kernels, monitorKernels, waterfall, messages }));
+            `;
+            const child = spawnSync(process.execPath, ['--input-type=module', '-e', script], {
+                env: { ...process.env, FT8_LIB_KERNELS: 'baseline' },
+                encoding: 'utf8'
+            });
+            CHECK(child.status === 0, `Baseline process failed: ${child.stderr}`);
+            const baseline = JSON.parse(child.stdout);
+            CHECK(cpu.availableKernels.includes('neon') || baseline.kernels === 'baseline', "FT8_LIB_KERNELS=baseline was ignored");
+            CHECK(cpu.availableKernels.includes('neon') || baseline.monitorKernels === 'baseline', "FT8_LIB_KERNELS=baseline did not apply to the monitor");
+            CHECK(baseline.waterfall === waterfall, `Baseline monitor computed a different waterfall than ${cpu.monitorKernels}`);
+            CHECK(JSON.stringify(summarize(baseline.messages)) === JSON.stringify(expected), "Baseline kernels decoded differently");
+            console.log(`  Baseline and ${cpu.kernels} kernels agree on ${expected.length} messages`);
+            
+            this.passedTests++;
+            TEST_END('CPU features');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ CPU features test failed: ${error.message}`);
+        }
+    }
+
+    // Test PCM conversion against a scalar reference, including odd lengths and byte inputs
+    testPcmConversion() {
+        try {
+            this.totalTests++;
+            console.log('Testing: pcm16ToFloat32/float32ToPcm16');
+            
+            const n = 1003;
+            const pcm = new Int16Array(n);
+            for (let i = 0; i < n; i++) {
+                pcm[i] = ((i * 7919) % 65536) - 32768;
+            }
+            
+            const floats = Utils.Audio.pcm16ToFloat32(pcm);
+            CHECK(floats.every((v, i) => v === pcm[i] / 32768), "Int16Array conversion mismatch");
+            
+            const back = Utils.Audio.float32ToPcm16(floats);
+            CHECK(back instanceof Int16Array, "Default output should be an Int16Array");
+            CHECK(back.every((v, i) => Math.abs(v - pcm[i]) <= 1), "Float round trip mismatch");
+            
+            const clipped = Utils.Audio.float32ToPcm16(new Float32Array([2, -2, 0.5]));
+            CHECK(clipped[0] === 32767 && clipped[1] === -32767 && clipped[2] === 16384, "Clipping/rounding mismatch");
+            
+            // Big-endian interleaved stereo from a Buffer at an odd offset
+            const frames = 517;
+            const raw = Buffer.alloc(frames * 4 + 1);
+            const bytes = raw.subarray(1);
+            for (let i = 0; i < frames; i++) {
+                bytes.writeInt16BE(pcm[i], i * 4);
+                bytes.writeInt16BE(pcm[n - 1 - i], i * 4 + 2);
+            }
+            const out = new Float32Array(frames + 10);
+            const mono = Utils.Audio.pcm16ToFloat32(bytes, { byteOrder: 'BE', channels: 2, out });
+            CHECK(mono.length === frames && mono.buffer === out.buffer, "Output should be a view over out");
+            CHECK(mono.every((v, i) => v === (pcm[i] + pcm[n - 1 - i]) / 65536), "Stereo BE conversion mismatch");
+            
+            const le = Utils.Audio.float32ToPcm16(floats, { byteOrder: 'LE' });
+            CHECK(Buffer.isBuffer(le) && le.length === n * 2, "byteOrder without out should return a Buffer");
+            CHECK(back.every((v, i) => le.readInt16LE(i * 2) === v), "LE byte output mismatch");
+            
+            const d1 = Utils.Audio.float32ToPcm16(floats, { dither: true, seed: 42 });
+            const d2 = Utils.Audio.float32ToPcm16(floats, { dither: true, seed: 42 });
+            CHECK(d1.every((v, i) => v === d2[i]), "Seeded dither is not reproducible");
+            CHECK(d1.every((v, i) => Math.abs(v - back[i]) <= 1), "Dither exceeds 1 LSB");
+            CHECK(d1.some((v, i) => v !== back[i]), "Dither had no effect");
+            
+            this.passedTests++;
+            TEST_END('PCM conversion');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ PCM conversion test failed: ${error.message}`);
+        }
+    }
+
+    // Test asynchronous WAV save/load round trip
+    async testWavRoundTrip() {
+        const wavPath = path.join(os.tmpdir(), `ft8_lib_roundtrip_${process.pid}.wav`);
+        try {
+            this.totalTests++;
+            console.log('Testing: saveWav/loadWav');
+            
+            const samples = new Float32Array(12000 * 20);
+            for (let i = 0; i < samples.length; i++) {
+                samples[i] = 0.5 * Math.sin(2 * Math.PI * 1000 * i / 12000);
+            }
+            
+            const saving = Utils.Audio.saveWav(wavPath, { samples, sampleRate: 12000 });
+            CHECK(saving instanceof Promise, "saveWav should return a Promise");
+            await saving;
+            
+            const loading = Utils.Audio.loadWav(wavPath);
+            CHECK(loading instanceof Promise, "loadWav should return a Promise");
+            const loaded = await loading;
+            CHECK(loaded.sampleRate === 12000, "Sample rate not preserved");
+            CHECK(loaded.samples.length === samples.length, `Expected ${samples.length} samples, got ${loaded.samples.length}`);
+            CHECK(loaded.samples.every((v, i) => Math.abs(v - samples[i]) < 1e-4), "Samples not preserved");
+            
+            let rejected = false;
+            await Utils.Audio.loadWav(path.join(os.tmpdir(), 'ft8_lib_missing.wav')).catch(() => { rejected = true; });
+            CHECK(rejected, "Loading a missing file should reject");
+            
+            this.passedTests++;
+            TEST_END('WAV round trip');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ WAV round trip test failed: ${error.message}`);
+        } finally {
+            fs.rmSync(wavPath, { force: true });
+        }
+    }
+
+    // Test slot-by-slot WAV streaming over a multi-slot recording
+    async testOpenWav() {
+        const wavPath = path.join(os.tmpdir(), `ft8_lib_openwav_${process.pid}.wav`);
+        try {
+            this.totalTests++;
+            console.log('Testing: openWav');
+            
+            const band = Utils.Audio.synthesizeBand({ signals: [{ text: "CQ W1ABC FN42", snr: 0 }], duration: 40, seed: 7 });
+            await Utils.Audio.saveWav(wavPath, band.audio);
+            
+            const reader = Utils.Audio.openWav(wavPath, { protocol: 'FT8' });
+            const info = reader.getInfo();
+            CHECK(info.numSlots === 3, `Expected 3 slots, got ${info.numSlots}`);
+            
+            let count = 0;
+            for await (const slot of reader) {
+                CHECK(slot.index === count, "Slots out of order");
+                CHECK(slot.samples.length === info.slotSamples, "Slot not padded to full length");
+                count++;
+            }
+            CHECK(count === 3, `Iterated ${count} slots`);
+            
+            this.passedTests++;
+            TEST_END('WAV streaming');
+            
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ WAV streaming test failed: ${error.message}`);
+        } finally {
+            fs.rmSync(wavPath, { force: true });
+        }
+    }
+
+    // Test parallel file decoding
+    async testDecodeFile() {
+        const wavPath = path.join(os.tmpdir(), `ft8_lib_decodefile_${process.pid}.wav`);
+        try {
+            this.totalTests++;
+            console.log('Testing: decodeFile');
+            
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12", "CQ N3QRS FN20", "CQ AA4BB EL98"];
+            const band = Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 1000, timeOffset: i * 15 + 0.5, snr: 0 })),
+                duration: 60,
+                seed: 11
+            });
+            await Utils.Audio.saveWav(wavPath, band.audio);
+            
+            const startTime = Date.UTC(2025, 4, 24, 12, 0, 0);
+            const streamed = [];
+            const result = await this.decoder.decodeFile(wavPath, {
+                protocol: 'FT8',
+                startTime,
+                threads: 3,
+                onSlot: (slot) => streamed.push(slot)
+            });
+            
+            CHECK(result.slots === 4, `Expected 4 slots, got ${result.slots}`);
+            CHECK(streamed.length === 4, `Expected 4 slot callbacks, got ${streamed.length}`);
+            streamed.forEach((slot, i) => {
+                CHECK(slot.index === i, "Slots delivered out of order");
+                CHECK(slot.utcStart === startTime + i * 15000, "Wrong slot UTC start");
+                const msg = slot.messages.find(m => m.text === texts[i]);
+                CHECK(msg, `Slot ${i} missing "${texts[i]}"`);
+                CHECK(Math.abs(msg.utcTime - (startTime + i * 15000 + 500)) < 200, "Wrong message UTC time");
+            });
+            
+            const collected = await this.decoder.decodeFile(wavPath, { threads: 2 });
+            CHECK(collected.decoded === result.decoded, "Decode count depends on callback mode");
+            const order = collected.messages.map(m => m.slot);
+            CHECK(order.every((slot, i) => i === 0 || slot >= order[i - 1]), "Messages not in slot order");
+            CHECK(texts.every(text => collected.messages.some(m => m.text === text)), "Missing messages");
+            
+            this.passedTests++;
+            TEST_END('Parallel file decoding');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Parallel file decoding test failed: ${error.message}`);
+        } finally {
+            fs.rmSync(wavPath, { force: true });
+        }
+    }
+
+    // Test the zero-copy waterfall view
+    testWaterfall() {
+        try {
+            this.totalTests++;
+            console.log('Testing: waterfall view');
+            
+            const band = Utils.Audio.synthesizeBand({
+                signals: [{ text: "CQ W1ABC FN42", frequency: 1000, timeOffset: 0.5, snr: 10 }],
+                duration: 15,
+                seed: 9
+            });
+            
+            const decoder = new MessageDecoder({ protocol: 'FT8' });
+            CHECK(decoder.getWaterfall() === null, "Waterfall before any audio");
+            
+            decoder.decode(band.audio);
+            const wf = decoder.getWaterfall();
+            CHECK(wf.numBlocks > 0 && wf.mag.length === wf.numBlocks * wf.blockStride, "Wrong waterfall size");
+            CHECK(wf.blockStride === wf.timeOsr * wf.freqOsr * wf.numBins, "Wrong block stride");
+            CHECK(Math.abs(wf.binHz - 6.25) < 1e-6 && Math.abs(wf.blockTime - 0.16) < 1e-6, "Wrong FT8 bin or block size");
+            
+            // The loudest bin, averaged over time, lies within the signal's tones
+            const power = new Float64Array(wf.numBins);
+            for (let block = 0; block < wf.numBlocks; block++) {
+                for (let b = 0; b < wf.numBins; b++) {
+                    power[b] += wf.mag[block * wf.blockStride + b];
+                }
+            }
+            const peak = power.indexOf(Math.max(...power));
+            const peakHz = wf.minFrequency + peak * wf.binHz;
+            CHECK(peakHz >= 990 && peakHz <= 1000 + 8 * wf.binHz, `Peak at ${peakHz} Hz`);
+            
+            // Later decodes reuse the same memory
+            decoder.decode(band.audio);
+            CHECK(decoder.getWaterfall().mag.buffer === wf.mag.buffer, "Waterfall memory not reused");
+            
+            // A new sample rate reallocates the waterfall and empties old views
+            decoder.decode({ samples: band.audio.samples, sampleRate: 24000 });
+            CHECK(wf.mag.length === 0, "Stale view was not detached");
+            CHECK(decoder.getWaterfall().mag.length > 0, "No view after reallocation");
+            
+            this.passedTests++;
+            TEST_END('Waterfall view');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Waterfall view test failed: ${error.message}`);
+        }
+    }
+
+    // Test SNR estimates against synthesized signals of known SNR
+    testSnr() {
+        try {
+            this.totalTests++;
+            console.log('Testing: SNR estimation');
+            
+            for (const protocol of ['FT8', 'FT4']) {
+                const specs = [
+                    { text: "CQ W1ABC FN42", frequency: 700, snr: -14 },
+                    { text: "CQ K2XYZ EM12", frequency: 1300, snr: -6 },
+                    { text: "CQ N3QRS FN20", frequency: 1900, snr: 2 }
+                ];
+                const band = Utils.Audio.synthesizeBand({
+                    signals: specs.map(spec => ({ ...spec, timeOffset: 0.5 })),
+                    duration: protocol === 'FT8' ? 15 : 7.5,
+                    seed: 21,
+                    protocol
+                });
+                
+                const decoder = new MessageDecoder({ protocol });
+                const messages = decoder.decode(band.audio);
+                for (const spec of specs) {
+                    const message = messages.find(m => m.text === spec.text);
+                    CHECK(message, `${protocol}: "${spec.text}" not decoded`);
+                    CHECK(Number.isInteger(message.snr), `${protocol}: SNR is not whole dB`);
+                    CHECK(Math.abs(message.snr - spec.snr) <= 4, `${protocol}: SNR ${message.snr} dB for a ${spec.snr} dB signal`);
+                }
+                
+                const snrs = specs.map(spec => messages.find(m => m.text === spec.text).snr);
+                CHECK(snrs[0] < snrs[1] && snrs[1] < snrs[2], `${protocol}: SNRs out of order`);
+            }
+            
+            this.passedTests++;
+            TEST_END('SNR estimation');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ SNR estimation test failed: ${error.message}`);
+        }
+    }
+
+    // Test multi-pass decoding with signal subtraction
+    testMultiPass() {
+        try {
+            this.totalTests++;
+            console.log('Testing: multi-pass decoding');
+            
+            // A weak signal partly under a strong one, a little later in the slot
+            const band = Utils.Audio.synthesizeBand({
+                signals: [
+                    { text: "CQ W1ABC FN42", frequency: 1000, timeOffset: 0.5, snr: 6 },
+                    { text: "CQ K2XYZ EM12", frequency: 1025, timeOffset: 1.3, snr: -12 },
+                    { text: "CQ N3QRS FN20", frequency: 1800, timeOffset: 0.5, snr: -8 }
+                ],
+                duration: 15,
+                seed: 42
+            });
+            
+            const single = new MessageDecoder({ protocol: 'FT8' }).decode(band.audio);
+            const multi = new MessageDecoder({ protocol: 'FT8', passes: 2 }).decode(band.audio);
+            const texts = multi.map(m => m.text);
+            
+            CHECK(texts.includes("CQ W1ABC FN42"), "Strong signal not decoded");
+            CHECK(!single.some(m => m.text === "CQ K2XYZ EM12"), "Masked signal already decoded in a single pass");
+            CHECK(texts.includes("CQ K2XYZ EM12"), "Second pass did not decode the masked signal");
+            CHECK(multi.length > single.length, `passes: 2 decoded ${multi.length} messages, a single pass ${single.length}`);
+            CHECK(new Set(texts).size === texts.length, "Duplicate messages across passes");
+            for (const message of single) {
+                CHECK(texts.includes(message.text), `"${message.text}" lost with more passes`);
+            }
+            
+            let threw = false;
+            try {
+                new MessageDecoder({ protocol: 'FT8', passes: 0 });
+            } catch (error) {
+                threw = true;
+            }
+            CHECK(threw, "passes: 0 accepted");
+            
+            this.passedTests++;
+            TEST_END('multi-pass decoding');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Multi-pass decoding test failed: ${error.message}`);
+        }
+    }
+
+    // Test candidate retries against cached log-likelihoods
+    testCandidateRetry() {
+        try {
+            this.totalTests++;
+            console.log('Testing: candidate retry from cached likelihoods');
+            
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12"];
+            const band = Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 900 + 600 * i, timeOffset: 0.5, snr: 0 })),
+                duration: 15,
+                seed: 11
+            });
+            
+            const decoder = new MessageDecoder({ protocol: 'FT8', collectStats: true });
+            const candidates = decoder.findCandidates(band.audio);
+            const decoded = candidates.map(c => decoder.decodeCandidate(null, c));
+            const first = decoded.findIndex(result => result && texts.includes(result.message.text));
+            CHECK(first >= 0, "No candidate decoded from the cached waterfall");
+            
+            const extracted = decoder.getStats().stages.likelihood.count;
+            CHECK(extracted === candidates.length, "Likelihoods not extracted once per candidate");
+            
+            const text = decoded[first].message.text;
+            const retried = decoder.decodeCandidate(null, candidates[first], { iterations: 50 });
+            const minSum = decoder.decodeCandidate(null, candidates[first], { iterations: 50, engine: 'min-sum' });
+            CHECK(retried && retried.message.text === text, "Retry with more iterations lost the message");
+            CHECK(minSum && minSum.message.text === text, "Min-sum engine did not decode a strong candidate");
+            
+            const stats = decoder.getStats().stages;
+            CHECK(stats.likelihood.count === extracted, "Retries extracted likelihoods again");
+            CHECK(stats.likelihood.cached === 2, `Expected 2 cache hits, got ${stats.likelihood.cached}`);
+            CHECK(stats.ldpc.count === candidates.length + 2, "LDPC runs do not add up");
+            
+            // New audio invalidates the cache
+            decoder.decodeCandidate(band.audio, candidates[first]);
+            CHECK(decoder.getStats().stages.likelihood.count === extracted + 1, "Cache survived new audio");
+            
+            // A full decode keeps nothing, so repeated decodes each pay for extraction
+            const full = new MessageDecoder({ protocol: 'FT8', collectStats: true });
+            full.decode(band.audio);
+            full.decode(null);
+            const fullStats = full.getStats().stages.likelihood;
+            CHECK(fullStats.cached === 0 && fullStats.count === 2 * candidates.length,
+                  `decode() used cached likelihoods (${fullStats.count} extracted, ${fullStats.cached} cached)`);
+            
+            let threw = false;
+            try {
+                decoder.decodeCandidate(null, candidates[first], { engine: 'viterbi' });
+            } catch (error) {
+                threw = true;
+            }
+            CHECK(threw, "Unknown engine accepted");
+            
+            this.passedTests++;
+            TEST_END('candidate retry from cached likelihoods');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Candidate retry test failed: ${error.message}`);
+        }
+    }
+
+    // Test spectrum snapshots
+    testSpectrumSnapshot() {
+        try {
+            this.totalTests++;
+            console.log('Testing: spectrum snapshots');
+            
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12"];
+            const band = Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 900 + 600 * i, timeOffset: 0.5, snr: -5 })),
+                duration: 7.5,
+                seed: 17,
+                protocol: 'FT4'
+            });
+            
+            const decoder = new MessageDecoder({ protocol: 'FT4' });
+            CHECK(decoder.serializeSpectrum() === null, "Snapshot before any audio");
+            const original = decoder.decode(band.audio).map(m => m.text).sort();
+            const snapshot = decoder.serializeSpectrum();
+            const wf = decoder.getWaterfall();
+            
+            CHECK(snapshot.toString('latin1', 0, 4) === 'FTXS', "Bad magic");
+            CHECK(snapshot.readUInt16LE(4) === 1 && snapshot.readUInt16LE(6) === 64, "Bad version or header size");
+            CHECK(snapshot.length === 64 + wf.numBlocks * wf.blockStride, "Bad snapshot size");
+            
+            // A decoder configured for another protocol adopts the snapshot's geometry
+            const replay = new MessageDecoder({ protocol: 'FT8' });
+            const loaded = replay.loadSpectrum(new Uint8Array(snapshot.buffer, snapshot.byteOffset, snapshot.length));
+            CHECK(loaded.numBlocks === wf.numBlocks && loaded.numBins === wf.numBins, "Loaded geometry differs");
+            CHECK(Buffer.compare(Buffer.from(loaded.mag), Buffer.from(wf.mag)) === 0, "Loaded magnitudes differ");
+            
+            const replayed = replay.decode(null).map(m => m.text).sort();
+            CHECK(JSON.stringify(replayed) === JSON.stringify(original), "Replayed decode differs");
+            CHECK(Buffer.compare(replay.serializeSpectrum(), snapshot) === 0, "Round trip is not byte-identical");
+            
+            const rejects = (bytes) => {
+                try {
+                    replay.loadSpectrum(bytes);
+                    return false;
+                } catch (error) {
+                    return true;
+                }
+            };
+            const future = Buffer.from(snapshot);
+            future.writeUInt16LE(99, 4);
+            CHECK(rejects(future), "Newer version accepted");
+            CHECK(rejects(snapshot.subarray(0, snapshot.length - 1)), "Truncated snapshot accepted");
+            CHECK(rejects(Buffer.from('not a snapshot')), "Garbage accepted");
+            
+            // Header fields a monitor cannot be rebuilt from
+            const tampered = (write) => {
+                const bytes = Buffer.from(snapshot);
+                write(bytes);
+                return bytes;
+            };
+            CHECK(rejects(tampered(b => b.writeUInt32LE(0, 12))), "Zero sample rate accepted");
+            CHECK(rejects(tampered(b => b.writeUInt32LE(0xFFFFFFFF, 12))), "Huge sample rate accepted");
+            CHECK(rejects(tampered(b => b.writeUInt8(9, 9))), "Time oversampling above 8 accepted");
+            CHECK(rejects(tampered(b => b.writeUInt8(0, 10))), "Zero frequency oversampling accepted");
+            CHECK(rejects(tampered(b => b.writeUInt32LE(0xFFFFFFFF, 20))), "Negative min bin accepted");
+            CHECK(rejects(tampered(b => b.writeUInt32LE(b.readUInt32LE(16) / 2, 20))), "Bins above Nyquist accepted");
+            CHECK(rejects(tampered(b => b.writeUInt32LE(b.readUInt32LE(16) + 1, 16))), "Wrong block size accepted");
+            CHECK(rejects(tampered(b => b.writeFloatLE(0.16, 36))), "Wrong symbol period accepted");
+            
+            // Rejected snapshots leave the loaded waterfall as it was
+            const after = replay.decode(null).map(m => m.text).sort();
+            CHECK(JSON.stringify(after) === JSON.stringify(original), "Rejected snapshot changed the decoder");
+            
+            let threw = false;
+            try {
+                new MessageDecoder({ protocol: 'FT8' }).decode(null);
+            } catch (error) {
+                threw = true;
+            }
+            CHECK(threw, "decode(null) without a waterfall");
+            
+            this.passedTests++;
+            TEST_END('spectrum snapshots');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Spectrum snapshot test failed: ${error.message}`);
+        }
+    }
+
+    // Test callsign hash snapshots, seeding and the hash interface
+    testCallsignHashes() {
+        try {
+            this.totalTests++;
+            console.log('Testing: callsign hashes');
+            
+            // K1ABC is only sent as a 22-bit hash
+            const band = Utils.Audio.synthesizeBand({
+                signals: [{ text: "W9XYZ <K1ABC> -10", frequency: 1200, timeOffset: 0.5, snr: -5 }],
+                seed: 23
+            });
+            const resolved = (messages) => messages.length === 1 && messages[0].text.includes('K1ABC');
+            
+            const decoder = new MessageDecoder({ protocol: 'FT8' });
+            const unknown = decoder.decode(band.audio);
+            CHECK(unknown.length === 1 && unknown[0].text.includes('<...>'), "Hash resolved without knowing the callsign");
+            
+            // The interface is asked once per hash after the decode
+            const lookups = [];
+            const saves = [];
+            const messages = decoder.decode(band.audio, {
+                lookupHash: (hashType, hash) => {
+                    lookups.push(`${hashType}:${hash}`);
+                    return hashType === '22_BITS' ? 'K1ABC' : null;
+                },
+                saveHash: (callsign, hash) => saves.push({ callsign, hash })
+            });
+            CHECK(lookups.length >= 1 && new Set(lookups).size === lookups.length, "Hash looked up more than once");
+            CHECK(resolved(messages), "Callsign from the hash interface not used");
+            CHECK(saves.every(s => typeof s.callsign === 'string' && s.hash >= 0 && s.hash < (1 << 22)), "Bad saveHash arguments");
+            
+            // A wrong answer is not learned
+            const strict = new MessageDecoder({ protocol: 'FT8' });
+            CHECK(!resolved(strict.decode(band.audio, { lookupHash: () => 'N0CALL', saveHash: () => {} })), "Callsign with another hash accepted");
+            
+            // The learned table survives a restart
+            const snapshot = decoder.exportHashes();
+            CHECK(snapshot.toString('latin1', 0, 4) === 'FTXH', "Bad magic");
+            CHECK(snapshot.readUInt16LE(4) === 1 && snapshot.readUInt16LE(6) === 16, "Bad version or header size");
+            CHECK(snapshot.length === 16 + 16 * snapshot.readUInt32LE(8), "Bad snapshot size");
+            
+            const restarted = new MessageDecoder({ protocol: 'FT8' });
+            CHECK(restarted.importHashes(snapshot) === snapshot.readUInt32LE(8), "Not every entry imported");
+            CHECK(restarted.importHashes(snapshot) === 0, "Entries imported twice");
+            CHECK(resolved(restarted.decode(band.audio)), "Imported callsign not used");
+            
+            const corrupt = Buffer.from(snapshot);
+            corrupt.writeUInt32LE(corrupt.readUInt32LE(16) ^ 1, 16);
+            let threw = false;
+            try {
+                restarted.importHashes(corrupt);
+            } catch (error) {
+                threw = true;
+            }
+            CHECK(threw, "Entry with a wrong hash accepted");
+            
+            // Seeding from an array or from a list file
+            const seeded = new MessageDecoder({ protocol: 'FT8' });
+            const seed = seeded.seedHashes(['k1abc', 'W1AW', 'K1ABC', 'NOT A CALL!']);
+            CHECK(seed.callsigns === 2 && seed.rejected === 1, `Seeded ${seed.callsigns}, rejected ${seed.rejected}`);
+            CHECK(resolved(seeded.decode(band.audio)), "Seeded callsign not used");
+            
+            const listed = new MessageDecoder({ protocol: 'FT8' });
+            CHECK(listed.seedHashes(Buffer.from('W1AW\nK1ABC\r\nN0CALL\n'), { threads: 2 }).callsigns === 3, "List not split");
+            CHECK(resolved(listed.decode(band.audio)), "Callsign from a list not used");
+            CHECK(listed.seedHashes([]).callsigns === 0 && !resolved(listed.decode(band.audio)), "Empty list did not remove the index");
+            
+            this.passedTests++;
+            TEST_END('callsign hashes');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Callsign hash test failed: ${error.message}`);
+        }
+    }
+
+    // Test decoding in several worker threads at once
+    async testWorkerThreads() {
+        try {
+            this.totalTests++;
+            console.log('Testing: worker threads');
+            
+            // Each worker decodes its own band repeatedly and transfers the packed results;
+            // a running SlotScheduler makes terminate() exercise the cleanup hook
+            const workerSource = `
+                const { parentPort, workerData } = require('worker_threads');
+                const { MessageDecoder, SlotScheduler, Utils } = require(workerData.modulePath);
+                const band = Utils.Audio.synthesizeBand(workerData.band);
+                const decoder = new MessageDecoder({ protocol: 'FT8' });
+                const scheduler = new SlotScheduler({ protocol: 'FT4', onEvent: () => {} });
+                scheduler.start();
+                for (let i = 0; i < workerData.rounds; i++) {
+                    const packed = decoder.decodeToBuffer(band.audio);
+                    parentPort.postMessage(packed, [packed]);
+                }
+            `;
+            const modulePath = path.join(__dirname, '..', 'index.js');
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12", "CQ N3QRS FN20"];
+            const bandOptions = (seed) => ({
+                signals: texts.map((text, i) => ({ text, frequency: 700 + 500 * i, timeOffset: 0.5, snr: -6 })),
+                duration: 15,
+                seed
+            });
+            const numWorkers = Math.max(2, Math.min(4, os.cpus().length));
+            const rounds = 3;
+            
+            const runs = [];
+            for (let w = 0; w < numWorkers; w++) {
+                const worker = new Worker(workerSource, {
+                    eval: true,
+                    workerData: { modulePath, band: bandOptions(100 + w), rounds }
+                });
+                runs.push(new Promise((resolve, reject) => {
+                    const received = [];
+                    worker.on('error', reject);
+                    worker.on('message', (packed) => {
+                        received.push(packed);
+                        if (received.length === rounds) {
+                            worker.terminate().then(() => resolve(received), reject);
+                        }
+                    });
+                }));
+            }
+            const results = await Promise.all(runs);
+            
+            for (let w = 0; w < numWorkers; w++) {
+                const expected = this.decoder.decode(Utils.Audio.synthesizeBand(bandOptions(100 + w)).audio)
+                    .map(m => m.text).sort();
+                CHECK(expected.length > 0, "Reference decode found nothing");
+                for (const packed of results[w]) {
+                    CHECK(packed instanceof ArrayBuffer, "Results are not an ArrayBuffer");
+                    const messages = MessageDecoder.unpackMessages(packed);
+                    CHECK(JSON.stringify(messages.map(m => m.text).sort()) === JSON.stringify(expected),
+                          `Worker ${w} decoded different messages`);
+                    CHECK(messages.every(m => Number.isFinite(m.frequency) && Number.isInteger(m.snr) &&
+                                              m.payload.length === 10 && typeof m.type === 'string'),
+                          "Unpacked message fields incomplete");
+                }
+            }
+            
+            // The packed form carries the same fields as decode()
+            const band = Utils.Audio.synthesizeBand(bandOptions(100));
+            const direct = this.decoder.decode(band.audio);
+            const unpacked = MessageDecoder.unpackMessages(this.decoder.decodeToBuffer(band.audio));
+            CHECK(unpacked.length === direct.length, "Packed message count differs");
+            for (let i = 0; i < direct.length; i++) {
+                const a = direct[i], b = unpacked[i];
+                CHECK(a.text === b.text && a.hash === b.hash && a.type === b.type && a.score === b.score &&
+                      a.snr === b.snr && Math.abs(a.frequency - b.frequency) < 1e-3 &&
+                      Buffer.compare(Buffer.from(a.payload), Buffer.from(b.payload)) === 0,
+                      `Packed message ${i} differs`);
+            }
+            
+            let threw = false;
+            try {
+                MessageDecoder.unpackMessages(new ArrayBuffer(8));
+            } catch (error) {
+                threw = true;
+            }
+            CHECK(threw, "Garbage buffer accepted");
+            
+            this.passedTests++;
+            TEST_END('worker threads');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Worker threads test failed: ${error.message}`);
+        }
+    }
+
+    // Test decode pipeline statistics
+    testDecodeStats() {
+        try {
+            this.totalTests++;
+            console.log('Testing: decoder statistics');
+            
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12", "CQ N3QRS FN20"];
+            const band = Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 800 + 400 * i, timeOffset: 0.5, snr: -5 })),
+                duration: 15,
+                seed: 3
+            });
+            const audio = band.audio;
+            
+            const decoder = new MessageDecoder({ protocol: 'FT8', collectStats: true });
+            const messages = decoder.decode(audio);
+            const stats = decoder.getStats();
+            const sum = (histogram) => histogram.counts.reduce((a, b) => a + b, 0);
+            
+            CHECK(stats.enabled, "Statistics not enabled");
+            CHECK(stats.calls === 1 && stats.decoded === messages.length, "Wrong call or message count");
+            CHECK(stats.stages.monitor.count > 0, "No monitor blocks counted");
+            CHECK(stats.stages.findCandidates.count === 1, "Expected one candidate search");
+            const { likelihood, ldpc, crc, unpack } = stats.stages;
+            CHECK(likelihood.count === ldpc.count && ldpc.count <= stats.stages.findCandidates.candidates, "Likelihood and LDPC counts disagree");
+            CHECK(ldpc.count - ldpc.failures - crc.failures === unpack.count, "Stage counts do not add up");
+            CHECK(unpack.count - unpack.failures === messages.length, "Unpacked messages do not match results");
+            CHECK(ldpc.iterations >= ldpc.count - ldpc.failures, "LDPC iterations missing");
+            CHECK(sum(stats.histograms.ldpcIterations) === ldpc.count, "LDPC histogram count");
+            CHECK(sum(stats.histograms.decodeMs) === 1 && sum(stats.histograms.messages) === 1, "Per-call histogram count");
+            CHECK(stats.hash.saves > 0, "No callsigns saved to the hash table");
+            
+            decoder.setStatsEnabled(false);
+            decoder.decode(audio);
+            CHECK(decoder.getStats().calls === 1, "Counted while disabled");
+            
+            decoder.resetStats();
+            const reset = decoder.getStats();
+            CHECK(reset.calls === 0 && reset.stages.ldpc.count === 0 && reset.histograms.decodeMs.counts.length === 0, "resetStats left counters");
+            
+            this.passedTests++;
+            TEST_END('Decoder statistics');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Decoder statistics test failed: ${error.message}`);
+        }
+    }
+
+    // Test narrow-band decoding around a known frequency
+    testDecodeFocused() {
+        try {
+            this.totalTests++;
+            console.log('Testing: focused decode');
+            
+            const texts = ["CQ W1ABC FN42", "W1ABC K2XYZ EM12", "CQ N3QRS FN20"];
+            const band = Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 800 + 400 * i, timeOffset: 0.5, snr: -5 })),
+                duration: 15,
+                seed: 5
+            });
+            
+            const decoder = new MessageDecoder({ protocol: 'FT8' });
+            let threw = false;
+            try {
+                decoder.decodeFocused(null, { centerHz: 1200 });
+            } catch (e) {
+                threw = true;
+            }
+            CHECK(threw, "Reusing a missing waterfall did not throw");
+            
+            const all = decoder.decode(band.audio);
+            CHECK(all.length === texts.length, `Full decode found ${all.length} messages`);
+            
+            // Reuse the cached waterfall; only the signal inside the band may come back
+            const reused = decoder.decodeFocused(null, { centerHz: 1200, spanHz: 60 });
+            CHECK(reused.length === 1 && reused[0].text === texts[1], "Focused decode of the cached waterfall");
+            CHECK(Math.abs(reused[0].frequency - 1200) < 10, "Focused decode reported the wrong frequency");
+            
+            // Own audio goes through a narrow-band waterfall
+            const fresh = decoder.decodeFocused(band.audio, { centerHz: 1600 });
+            CHECK(fresh.length === 1 && fresh[0].text === texts[2], "Focused decode of new audio");
+            
+            // The full-band waterfall is untouched by the narrow one
+            const again = decoder.decodeFocused(null, { centerHz: 800 });
+            CHECK(again.length === 1 && again[0].text === texts[0], "Cached waterfall was replaced");
+            
+            const outside = decoder.decodeFocused(null, { centerHz: 1200, timeWindow: [5, 6] });
+            CHECK(outside.length === 0, "Time window was not applied");
+            
+            // Callsigns learned by the narrow-band decode land in the decoder's own table
+            const learner = new MessageDecoder({ protocol: 'FT8' });
+            learner.decodeFocused(band.audio, { centerHz: 1200 });
+            const learned = learner.exportHashes();
+            CHECK(learned.includes('W1ABC') && learned.includes('K2XYZ'), "Focused decode did not save callsigns to the decoder");
+            
+            // Regions outside the decoder's frequency range or the slot are rejected
+            const rejects = (options) => {
+                try {
+                    decoder.decodeFocused(band.audio, options);
+                } catch (e) {
+                    return e instanceof RangeError;
+                }
+                return false;
+            };
+            CHECK(rejects({ centerHz: NaN }), "NaN centerHz was accepted");
+            CHECK(rejects({ centerHz: 1200, spanHz: Infinity }), "Infinite spanHz was accepted");
+            CHECK(rejects({ centerHz: -500 }), "Band below frequencyMin was accepted");
+            CHECK(rejects({ centerHz: 20000 }), "Band above frequencyMax was accepted");
+            CHECK(rejects({ centerHz: 1200, timeWindow: [20, 30] }), "Time window after the slot was accepted");
+            
+            // A band straddling the edge is clipped rather than rejected
+            const edge = decoder.decodeFocused(band.audio, { centerHz: 200, spanHz: 400 });
+            CHECK(Array.isArray(edge), "Band straddling frequencyMin was rejected");
+            
+            this.passedTests++;
+            TEST_END('Focused decode');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Focused decode test failed: ${error.message}`);
+        }
+    }
+
+    // Test the decoder configuration sweep
+    async testTuneDecoder() {
+        const wavPath = path.join(os.tmpdir(), `ft8_lib_tune_${process.pid}.wav`);
+        try {
+            this.totalTests++;
+            console.log('Testing: tuneDecoder');
+            
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12", "CQ N3QRS FN20"];
+            const bands = [5, 6].map(seed => Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 700 + 500 * i, timeOffset: 0.5, snr: -12 })),
+                duration: 15,
+                seed
+            }));
+            await Utils.Audio.saveWav(wavPath, bands[1].audio);
+            
+            const corpus = [{ audio: bands[0].audio, expected: texts }, wavPath];
+            const grid = { minScore: 10, maxCandidates: [10, 140], maxLdpcIterations: [5, 25], freqOsr: [1, 2], timeOsr: 2 };
+            const report = await Utils.tuneDecoder(corpus, { protocol: 'FT8', grid });
+            
+            CHECK(report.slots === 2, "Wrong slot count");
+            CHECK(report.configs.length === 8, `Expected 8 configurations, got ${report.configs.length}`);
+            CHECK(report.configs.every((r, i) => i === 0 || r.meanMs >= report.configs[i - 1].meanMs), "Configurations not sorted by time");
+            CHECK(report.configs.every(r => r.meanMs > 0 && r.maxMs >= r.meanMs), "Missing CPU times");
+            CHECK(report.pareto.length > 0 && report.pareto.every(r => r.pareto), "Bad Pareto front");
+            
+            const best = Math.max(...report.configs.map(r => r.found));
+            CHECK(report.recommended && report.recommended.found === best, "Recommendation without budget should decode the most");
+            CHECK(best >= texts.length, "Expected slot not decoded");
+            const { config } = report.recommended;
+            CHECK(new MessageDecoder(config).decode(bands[0].audio).length > 0, "Recommended config does not decode");
+            
+            const tight = await Utils.tuneDecoder(corpus, { grid, cpuBudgetMs: 1e-6 });
+            CHECK(tight.recommended === null && tight.budgetMs === 1e-6, "Impossible budget should give no recommendation");
+            
+            let rejected = false;
+            await Utils.tuneDecoder([path.join(os.tmpdir(), 'ft8_lib_missing.wav')]).catch(() => { rejected = true; });
+            CHECK(rejected, "Missing WAV should reject");
+            
+            this.passedTests++;
+            TEST_END('Decoder tuning');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Decoder tuning test failed: ${error.message}`);
+        } finally {
+            fs.rmSync(wavPath, { force: true });
+        }
+    }
+
+    // Test adaptive load shedding
+    testLoadController() {
+        try {
+            this.totalTests++;
+            console.log('Testing: LoadController');
+            
+            const band = Utils.Audio.synthesizeBand({ signals: [{ text: "CQ W1ABC FN42", frequency: 1200, timeOffset: 0.5, snr: 0 }], duration: 15, seed: 4 });
+            
+            // Any decode is "too slow": every report steps down until the cheapest profile
+            const shedding = new LoadController({ highLoad: 1e-9, lowLoad: 0, downReports: 1 });
+            const names = shedding.getProfiles().map(p => p.name);
+            CHECK(names.join() === 'full,reduced,light,minimal', `Unexpected default profiles ${names}`);
+            const decoder = new MessageDecoder({ protocol: 'FT8', loadController: shedding });
+            
+            const used = [];
+            for (let i = 0; i < 5; i++) {
+                const messages = decoder.decode(band.audio);
+                CHECK(messages.some(m => m.text === "CQ W1ABC FN42"), `Decode failed at profile ${decoder.getStats().profile.name}`);
+                used.push(decoder.getStats().profile.level);
+            }
+            CHECK(used.join() === '0,1,2,3,3', `Unexpected profile sequence ${used}`);
+            let stats = shedding.getStats();
+            CHECK(stats.level === 3 && stats.profile.name === 'minimal' && stats.stepsDown === 3, "Controller did not step down");
+            CHECK(stats.reports === 5 && stats.peakLoad > 0, "Reports not counted");
+            
+            shedding.setLevel(0);
+            decoder.decode(band.audio);
+            stats = shedding.getStats();
+            CHECK(stats.pinned && stats.level === 0 && decoder.getStats().profile.name === 'full', "setLevel did not pin");
+            
+            // Every decode is fast: step back up after two reports
+            const recovering = new LoadController({
+                highLoad: 1e9, lowLoad: 1e8, upReports: 2,
+                profiles: [{ name: 'a', maxCandidates: 100 }, { name: 'b', maxCandidates: 50, timeOsr: 1 }]
+            });
+            recovering.setLevel(1);
+            recovering.setLevel(null);
+            const fast = new MessageDecoder({ protocol: 'FT8', loadController: recovering });
+            fast.decode(band.audio);
+            CHECK(recovering.getStats().level === 1, "Stepped up too early");
+            fast.decode(band.audio);
+            stats = recovering.getStats();
+            CHECK(!stats.pinned && stats.level === 0 && stats.stepsUp === 1, "Controller did not step up");
+            CHECK(new MessageDecoder().getStats().profile === null, "Profile reported without a controller");
+            
+            // Profiles only shed load: a receiver set up lighter is not raised to full effort
+            const light = new MessageDecoder({ protocol: 'FT8', freqOsr: 1, timeOsr: 1, loadController: new LoadController() });
+            light.decode(band.audio);
+            const lightWaterfall = light.getWaterfall();
+            CHECK(light.getStats().profile.name === 'full', "Light receiver did not start at the full profile");
+            CHECK(lightWaterfall.freqOsr === 1 && lightWaterfall.timeOsr === 1, "Full profile raised the receiver's oversampling");
+            
+            let threw = false;
+            try { new MessageDecoder({ loadController: {} }); } catch (e) { threw = true; }
+            CHECK(threw, "Invalid loadController accepted");
+            
+            this.passedTests++;
+            TEST_END('Load controller');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Load controller test failed: ${error.message}`);
+        }
+    }
+
+    // Test Chrome trace output
+    async testTrace() {
+        const tracePath = path.join(os.tmpdir(), `ft8_lib_trace_${process.pid}.json`);
+        try {
+            this.totalTests++;
+            console.log('Testing: Utils.Trace');
+            
+            const band = Utils.Audio.synthesizeBand({ signals: [{ text: "CQ W1ABC FN42", snr: 0 }], duration: 15, seed: 9 });
+            
+            Utils.Trace.start();
+            CHECK(Utils.Trace.isEnabled(), "Tracing not enabled after start()");
+            this.decoder.decode(band.audio);
+            this.encoder.encode("CQ K2XYZ EM12");
+            const summary = await Utils.Trace.stop(tracePath);
+            CHECK(!Utils.Trace.isEnabled(), "Tracing still enabled after stop()");
+            
+            const trace = JSON.parse(fs.readFileSync(tracePath, 'utf8'));
+            const events = trace.traceEvents.filter(e => e.ph === 'B' || e.ph === 'E');
+            CHECK(events.length === summary.events && summary.dropped === 0, "Summary does not match the file");
+            for (const name of ['monitor', 'findCandidates', 'decodeCandidate', 'decode', 'encode']) {
+                const begins = events.filter(e => e.name === name && e.ph === 'B').length;
+                const ends = events.filter(e => e.name === name && e.ph === 'E').length;
+                CHECK(begins > 0 && begins === ends, `Unbalanced or missing "${name}" spans`);
+            }
+            const decodeEnd = events.find(e => e.name === 'decode' && e.ph === 'E');
+            CHECK(decodeEnd.args && decodeEnd.args.messages >= 1, "decode span lacks its message count");
+            CHECK(events.every(e => Number.isInteger(e.tid) && e.pid === process.pid), "Events lack thread or process IDs");
+            CHECK(trace.traceEvents.some(e => e.ph === 'M' && e.args.name === 'main'), "Main thread not named");
+            
+            this.passedTests++;
+            TEST_END('Trace output');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Trace test failed: ${error.message}`);
+        } finally {
+            fs.rmSync(tracePath, { force: true });
+        }
+    }
+
+    // Test decoding from a SharedArrayBuffer ring
+    async testRingReceiver() {
+        let receiver = null;
+        try {
+            this.totalTests++;
+            console.log('Testing: RingReceiver');
+            
+            const texts = ["CQ W1ABC FN42", "CQ K2XYZ EM12"];
+            const band = Utils.Audio.synthesizeBand({
+                signals: texts.map((text, i) => ({ text, frequency: 1200, timeOffset: i * 15 + 0.5, snr: 0 })),
+                duration: 30,
+                seed: 5
+            });
+            
+            const capacity = 1 << 17;
+            const sab = new SharedArrayBuffer(16 + 4 * capacity);
+            const control = new Int32Array(sab, 0, 4);
+            const samples = new Float32Array(sab, 16, capacity);
+            
+            const startTime = Date.UTC(2025, 4, 24, 12, 0, 0);
+            const slots = [];
+            let resolveDone;
+            const done = new Promise(resolve => { resolveDone = resolve; });
+            receiver = new RingReceiver({
+                control,
+                samples,
+                protocol: 'FT8',
+                startTime,
+                waterfallRows: 64,
+                onDecode: (slot) => {
+                    slots.push(slot);
+                    if (slots.length === texts.length) resolveDone();
+                }
+            });
+            receiver.start();
+            
+            // Produce in 100 ms chunks, waiting for the receiver whenever the ring is full
+            const chunk = 1200;
+            for (let pos = 0; pos < band.audio.samples.length; ) {
+                const write = Atomics.load(control, 0) >>> 0;
+                const read = Atomics.load(control, 1) >>> 0;
+                const n = Math.min(chunk, band.audio.samples.length - pos);
+                if (capacity - ((write - read) >>> 0) < n) {
+                    await new Promise(resolve => setTimeout(resolve, 5));
+                    continue;
+                }
+                for (let i = 0; i < n; i++) {
+                    samples[(write + i) & (capacity - 1)] = band.audio.samples[pos + i];
+                }
+                Atomics.store(control, 0, (write + n) | 0);
+                pos += n;
+            }
+            Atomics.or(control, 2, 1);
+            
+            await Promise.race([
+                done,
+                new Promise((_, reject) => setTimeout(() => reject(new Error("Timed out waiting for slots")), 20000))
+            ]);
+            
+            const stats = receiver.getStats();
+            CHECK(stats.samplesConsumed === band.audio.samples.length, `Consumed ${stats.samplesConsumed} of ${band.audio.samples.length} samples`);
+            CHECK(stats.overruns === 0, "Unexpected overruns");
+            slots.forEach((slot, i) => {
+                CHECK(slot.index === i, "Slots delivered out of order");
+                CHECK(slot.utcStart === startTime + i * 15000, "Wrong slot UTC start");
+                CHECK(slot.messages.some(m => m.text === texts[i]), `Slot ${i} missing "${texts[i]}"`);
+            });
+            
+            // Only the newest waterfallRows blocks are kept
+            const rows = receiver.readWaterfall(0);
+            const blocks = slots.reduce((sum, slot) => sum + slot.blocks, 0);
+            CHECK(rows.next === blocks && rows.first === blocks - 64 && rows.numBlocks === 64, "Wrong waterfall block range");
+            CHECK(rows.mag.length === rows.numBlocks * rows.blockStride && rows.times.length === rows.numBlocks, "Wrong waterfall row size");
+            CHECK(rows.times.every((t, i) => i === 0 || t > rows.times[i - 1]), "Waterfall times not increasing");
+            CHECK(receiver.readWaterfall(rows.next).numBlocks === 0, "Rows returned twice");
+            
+            this.passedTests++;
+            TEST_END('Ring receiver');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Ring receiver test failed: ${error.message}`);
+        } finally {
+            if (receiver) receiver.stop();
+        }
+    }
+
+    // Test the UTC slot scheduler
+    async testSlotScheduler() {
+        let scheduler = null;
+        try {
+            this.totalTests++;
+            console.log('Testing: SlotScheduler');
+            
+            // Render the TX audio about 300 ms from now
+            const slotMs = 7500;
+            const now = Date.now();
+            const target = Math.ceil((now + 1000) / slotMs);
+            const txLead = (target * slotMs - now - 300) / 1000;
+            
+            const events = [];
+            let resolveTx;
+            const txDone = new Promise(resolve => { resolveTx = resolve; });
+            scheduler = new SlotScheduler({
+                protocol: 'FT4',
+                decodeOffsets: [0.25, 1.5, 3.0, 4.5, 6.0],
+                txLead,
+                onEvent: (event) => {
+                    events.push(event);
+                    if (event.type === 'tx') resolveTx(event);
+                }
+            });
+            CHECK(Math.abs(scheduler.now() - Date.now()) < 50, "Scheduler clock differs from Date.now()");
+            
+            const slot = scheduler.queueTx("CQ W1ABC FN42", { slot: target, frequency: 1200 });
+            CHECK(slot === target, "queueTx returned the wrong slot");
+            scheduler.start();
+            
+            const tx = await Promise.race([
+                txDone,
+                new Promise((_, reject) => setTimeout(() => reject(new Error("Timed out waiting for TX render")), 5000))
+            ]);
+            // Wait for the next decode offset as well
+            await new Promise(resolve => setTimeout(resolve, 1600));
+            
+            CHECK(tx.slot === target && tx.slotStart === target * slotMs, "TX rendered for the wrong slot");
+            CHECK(tx.text === "CQ W1ABC FN42" && tx.frequency === 1200, "Wrong TX message");
+            CHECK(tx.audio.length === Math.round(105 * 0.048 * 12000), `Unexpected TX audio length ${tx.audio.length}`);
+            CHECK(tx.playAt === tx.slotStart + 500, "Wrong playAt");
+            CHECK(tx.lateMs >= 0 && tx.lateMs < 100, `TX trigger ran ${tx.lateMs} ms late`);
+            
+            const decodes = events.filter(e => e.type === 'decode');
+            CHECK(decodes.length > 0, "No decode events fired");
+            decodes.forEach(e => {
+                CHECK(e.scheduledTime === e.slotStart + e.offset * 1000, "Decode event off its slot offset");
+            });
+            
+            const stats = scheduler.getStats();
+            CHECK(stats.fired >= events.length, `Fired ${stats.fired} events, received ${events.length}`);
+            CHECK(stats.trigger.count === stats.fired && stats.delivery.count === events.length, "Jitter sample counts");
+            CHECK(stats.trigger.maxMs < 100, `Trigger jitter ${stats.trigger.maxMs} ms`);
+            CHECK(stats.queuedTx === 0, "TX still queued");
+            
+            this.passedTests++;
+            TEST_END('Slot scheduler');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Slot scheduler test failed: ${error.message}`);
+        } finally {
+            if (scheduler) scheduler.stop();
+        }
+    }
+
+    // Test scheduler TX rendering at a sample rate where samples per symbol round up
+    async testSlotSchedulerSampleRate() {
+        let scheduler = null;
+        try {
+            this.totalTests++;
+            console.log('Testing: SlotScheduler FT4 at 44.1 kHz');
+            
+            const slotMs = 7500;
+            const now = Date.now();
+            const target = Math.ceil((now + 1000) / slotMs);
+            const txLead = (target * slotMs - now - 300) / 1000;
+            
+            let resolveTx;
+            const txDone = new Promise(resolve => { resolveTx = resolve; });
+            scheduler = new SlotScheduler({
+                protocol: 'FT4',
+                sampleRate: 44100,
+                decodeOffsets: [],
+                txLead,
+                onEvent: (event) => {
+                    if (event.type === 'tx') resolveTx(event);
+                }
+            });
+            scheduler.queueTx("CQ W1ABC FN42", { slot: target, frequency: 1500 });
+            scheduler.start();
+            
+            const tx = await Promise.race([
+                txDone,
+                new Promise((_, reject) => setTimeout(() => reject(new Error("Timed out waiting for TX render")), 5000))
+            ]);
+            
+            // 0.048 s * 44100 Hz = 2116.8 samples per symbol, rendered as 2117
+            const expected = 105 * Math.round(0.048 * 44100);
+            CHECK(tx.sampleRate === 44100, `Wrong TX sample rate ${tx.sampleRate}`);
+            CHECK(tx.audio.length === expected, `TX audio length ${tx.audio.length}, expected ${expected}`);
+            CHECK(tx.audio.every(Number.isFinite), "TX audio contains non-finite samples");
+            
+            const ft4Encoder = new MessageEncoder({ protocol: 'FT4' });
+            const encoded = ft4Encoder.generateAudio(ft4Encoder.encode("CQ W1ABC FN42").tones,
+                                                     { protocol: 'FT4', sampleRate: 44100, frequency: 1500 });
+            CHECK(encoded.samples.length >= expected, `generateAudio returned ${encoded.samples.length} samples`);
+            
+            this.passedTests++;
+            TEST_END('Slot scheduler sample rate');
+        
+        } catch (error) {
+            this.failedTests++;
+            console.error(`✗ Slot scheduler sample rate test failed: ${error.message}`);
+        } finally {
+            if (scheduler) scheduler.stop();
+        }
+    }
+
     // Test WAV file decoding
     async testWavFile(wavPath, expectedFile) {
         try {
@@ -249,6 +1575,29 @@ class FT8ComprehensiveTest {
             
             // Run message encoding/decoding tests (equivalent to C test)
             this.runMessageTests();
+            this.testEncodeBatch();
+            this.testMessageAnalysis();
+            this.testSynthesizeBand();
+            this.testCpuFeatures();
+            this.testPcmConversion();
+            await this.testWavRoundTrip();
+            await this.testOpenWav();
+            await this.testDecodeFile();
+            this.testDecodeStats();
+            this.testDecodeFocused();
+            this.testWaterfall();
+            this.testSpectrumSnapshot();
+            this.testCallsignHashes();
+            this.testSnr();
+            this.testMultiPass();
+            this.testCandidateRetry();
+            await this.testTuneDecoder();
+            this.testLoadController();
+            await this.testTrace();
+            await this.testRingReceiver();
+            await this.testWorkerThreads();
+            await this.testSlotScheduler();
+            await this.testSlotSchedulerSampleRate();
             
             // Run WAV file tests
             await this.runWavTests();